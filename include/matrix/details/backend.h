@@ -0,0 +1,64 @@
+/**
+ * @file backend.h
+ * @brief declaration of functions to select the blas and lapack backend at
+ * runtime.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_BACKEND_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_BACKEND_H_
+
+#include <string>
+
+namespace matrix {
+
+using std::string;
+
+/**
+ * @brief Select the blas and lapack backend used by the library.
+ *
+ * @details The backend libraries are loaded by `dlopen` and all the blas and
+ * lapack functions called by the library are dispatched to them afterwards.
+ * The initial backend is "default", unless it is specified by the
+ * environment variable `MATRIX_BLAS_BACKEND` with the same values as
+ * \p backend.
+ *
+ * @param [in] backend: "default": the blas and lapack libraries linked at
+ * build time.\n
+ * "openblas": `libopenblas.so`.\n
+ * "mkl": `libmkl_rt.so`.\n
+ * "blis": `libblis.so` for blas, and the default lapack.\n
+ * "reference": the system `libblas.so.3` and `liblapack.so.3`.\n
+ * Otherwise, \p backend is the path to a shared library that provides all
+ * the blas functions. The lapack functions are taken from the same library.
+ *
+ * @note An exception is thrown if the backend cannot be loaded, and the
+ * active backend is not changed. Selecting a backend other than "default"
+ * also selects blas `dgemm` as the dgemm engine, and selecting "default"
+ * resets the dgemm engine to its default, see set_dgemm_engine().
+ * Loaded libraries are never unloaded.
+ */
+void set_blas_backend(const string &backend);
+
+/**
+ * @brief Get the name of the active blas and lapack backend.
+ */
+string get_blas_backend();
+
+/**
+ * @brief Get the number of threads used by the active backend.
+ *
+ * @return int: the number of threads, or 1 if the backend does not provide
+ * thread control.
+ */
+int get_blas_num_threads();
+
+/**
+ * @brief Set the number of threads used by the active backend. It is ignored
+ * if the backend does not provide thread control.
+ *
+ * @param [in] num_threads: the number of threads.
+ */
+void set_blas_num_threads(int num_threads);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_BACKEND_H_
@@ -0,0 +1,311 @@
+/**
+ * @file band_matrix.h
+ * @brief declaration of the band and tridiagonal matrices and their lapack
+ * drivers.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_BAND_MATRIX_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_BAND_MATRIX_H_
+
+#include "matrix.h"
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Square band matrix with `kl` sub-diagonals and `ku`
+ * super-diagonals in the lapack band storage.
+ *
+ * @details The diagonals are stored column by column in an array of
+ * dimension [ldab, n], with ldab = 2 * kl + ku + 1, which is the storage
+ * used by lapack `dgbtrf`. The element (i, j) in the band is stored at
+ * `data()[kl + ku + i - j + j * ldab]`, and the first `kl` rows are reserved
+ * for the fill-in of the LU factorization. The memory and the cost of the
+ * solvers scale with n * (kl + ku) instead of n^2 and n^3.
+ */
+class BandMatrix {
+  public:
+    /**
+     * @brief Construct a band matrix with all the elements being zero.
+     *
+     * @param [in] n: dimension of the matrix.
+     * @param [in] kl: number of the sub-diagonals.
+     * @param [in] ku: number of the super-diagonals.
+     */
+    explicit BandMatrix(size_t n = 0, size_t kl = 0, size_t ku = 0);
+
+    /**
+     * @brief Construct a band matrix from a square matrix, whose bandwidth
+     * is detected as the smallest one that contains all the elements with
+     * absolute value larger than \p threshold.
+     *
+     * @param [in] A: the square matrix.
+     * @param [in] threshold: the elements out of the band are dropped if
+     * their absolute values are not larger than it. The elements that are
+     * not finite are always kept.
+     */
+    explicit BandMatrix(const Matrix &A, double threshold = 0.0);
+
+    /**
+     * @brief Construct a band matrix from the band of a square matrix. The
+     * elements out of the band are ignored.
+     *
+     * @param [in] A: the square matrix.
+     * @param [in] kl: number of the sub-diagonals.
+     * @param [in] ku: number of the super-diagonals.
+     */
+    BandMatrix(const Matrix &A, size_t kl, size_t ku);
+
+    /**
+     * @brief Get the full matrix.
+     * @return Matrix
+     */
+    Matrix to_matrix() const;
+
+    /**
+     * @brief Check if the element (i, j) is in the band.
+     */
+    bool is_in_band(size_t i, size_t j) const
+    {
+        return i <= j + kl_ && j <= i + ku_;
+    }
+
+    /**
+     * @brief Access the element (i, j) in the band.
+     *
+     * @note An exception is thrown if the element is out of the band. Read
+     * the elements out of the band through a const matrix.
+     */
+    double &operator()(size_t i, size_t j);
+
+    /**
+     * @brief Get the element (i, j), which is zero out of the band.
+     */
+    double operator()(size_t i, size_t j) const
+    {
+        return is_in_band(i, j) ? data_[index(i, j)] : 0.0;
+    }
+
+    /**
+     * @brief Get the dimension of the matrix.
+     */
+    size_t dim() const { return n_; }
+
+    /**
+     * @brief Get the number of the sub-diagonals.
+     */
+    size_t kl() const { return kl_; }
+
+    /**
+     * @brief Get the number of the super-diagonals.
+     */
+    size_t ku() const { return ku_; }
+
+    /**
+     * @brief Get the leading dimension of the band storage.
+     */
+    size_t ldab() const { return 2 * kl_ + ku_ + 1; }
+
+    /**
+     * @brief Get the pointer to the band storage.
+     */
+    double *data() { return data_.data(); }
+
+    /**
+     * @brief Get the pointer to the band storage.
+     */
+    const double *data() const { return data_.data(); }
+
+  private:
+    size_t index(size_t i, size_t j) const
+    {
+        return kl_ + ku_ + i - j + j * ldab();
+    }
+
+    void copy_band(const Matrix &A);
+
+    size_t n_;
+    size_t kl_;
+    size_t ku_;
+    vector<double> data_;
+};
+
+/**
+ * @brief Square tridiagonal matrix stored by its three diagonals.
+ */
+class TridiagonalMatrix {
+  public:
+    /**
+     * @brief Construct a tridiagonal matrix with all the elements being zero.
+     *
+     * @param [in] n: dimension of the matrix.
+     */
+    explicit TridiagonalMatrix(size_t n = 0);
+
+    /**
+     * @brief Construct a tridiagonal matrix from a square matrix.
+     *
+     * @param [in] A: the square matrix.
+     * @param [in] threshold: the largest absolute value allowed for the
+     * elements out of the three diagonals, which are dropped.
+     *
+     * @note An exception is thrown if \p A is not tridiagonal within
+     * \p threshold, or has non-finite elements out of the three diagonals.
+     */
+    explicit TridiagonalMatrix(const Matrix &A, double threshold = 0.0);
+
+    /**
+     * @brief Get the full matrix.
+     * @return Matrix
+     */
+    Matrix to_matrix() const;
+
+    /**
+     * @brief Get the element (i, j), which is zero out of the three
+     * diagonals.
+     */
+    double operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Get the dimension of the matrix.
+     */
+    size_t dim() const { return d_.size(); }
+
+    /**
+     * @brief Get the sub-diagonal, with n - 1 elements A(i + 1, i).
+     */
+    vector<double> &lower() { return dl_; }
+    const vector<double> &lower() const { return dl_; }
+
+    /**
+     * @brief Get the diagonal, with n elements A(i, i).
+     */
+    vector<double> &diag() { return d_; }
+    const vector<double> &diag() const { return d_; }
+
+    /**
+     * @brief Get the super-diagonal, with n - 1 elements A(i, i + 1).
+     */
+    vector<double> &upper() { return du_; }
+    const vector<double> &upper() const { return du_; }
+
+  private:
+    vector<double> dl_;
+    vector<double> d_;
+    vector<double> du_;
+};
+
+/**
+ * @brief Solve a band linear system A * X = B by lapack `dgbsv`, which is
+ * based on LU factorization with partial pivoting.
+ *
+ * @param [in, out] A: The input band matrix. On exit, it is overwritten by
+ * its LU factors.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_band_matrix_dgbsv(BandMatrix &A, Matrix &B);
+
+/**
+ * @brief LU factorization of a band matrix by lapack `dgbtrf`, which can be
+ * used by solve_band_matrix_dgbtrs() repeatedly.
+ *
+ * @param [in, out] A: The input band matrix. On exit, it is overwritten by
+ * its LU factors.
+ * @param [out] ipiv: The pivots in the lapack convention.
+ * @return int: 0 for success, and others for failure.
+ */
+int factorize_band_matrix_dgbtrf(BandMatrix &A, vector<int> &ipiv);
+
+/**
+ * @brief Solve a band linear system A * X = B by lapack `dgbtrs` with the LU
+ * factors from factorize_band_matrix_dgbtrf().
+ *
+ * @param [in] A: The LU factors.
+ * @param [in] ipiv: The pivots.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_band_matrix_dgbtrs(const BandMatrix &A, const vector<int> &ipiv,
+                             Matrix &B);
+
+/**
+ * @brief Solve a real symmetric positive definite (spd) band linear system
+ * A * X = B by lapack `dpbsv`, which is based on Cholesky factorization.
+ *
+ * @param [in] A: The input spd band matrix with kl == ku. Only the upper
+ * triangular part is referred.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_spd_band_matrix_dpbsv(const BandMatrix &A, Matrix &B);
+
+/**
+ * @brief Solve a tridiagonal linear system A * X = B by lapack `dgtsv`,
+ * which is based on Gaussian elimination with partial pivoting.
+ *
+ * @param [in, out] A: The input tridiagonal matrix. On exit, it is
+ * overwritten by the factors.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_tridiagonal_matrix_dgtsv(TridiagonalMatrix &A, Matrix &B);
+
+/**
+ * @brief Solve a real symmetric positive definite (spd) tridiagonal linear
+ * system A * X = B by lapack `dptsv`, which is based on L*D*L^T
+ * factorization.
+ *
+ * @param [in, out] A: The input spd tridiagonal matrix. Only the diagonal
+ * and the sub-diagonal are referred. On exit, they are overwritten by the
+ * factors D and L.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_spd_tridiagonal_matrix_dptsv(TridiagonalMatrix &A, Matrix &B);
+
+/**
+ * @brief Wrapper of lapack `dstevr` function to diagonalize a symmetric
+ * tridiagonal matrix by the MRRR algorithm.
+ *
+ * @param [in] A: The symmetric tridiagonal matrix. Only the diagonal and the
+ * sub-diagonal are referred.
+ * @param [out] eig: The eigenvalues in ascending order when succeed.
+ * @param [out] Q: The eigenvectors with dimension [n, n]. Each eigenvector
+ * is stored continuously in memory, the same as
+ * diagonalize_sym_matrix_dsyev().
+ * @return int: 0 for success, and others for failure.
+ */
+int diagonalize_sym_tridiagonal_matrix_dstevr(const TridiagonalMatrix &A,
+                                              vector<double> &eig, Matrix &Q);
+
+/**
+ * @brief Wrapper of lapack `dstemr` function to calculate the eigenvalues
+ * and eigenvectors of a symmetric tridiagonal matrix with indices in
+ * [first, last].
+ *
+ * @param [in] A: The symmetric tridiagonal matrix. Only the diagonal and the
+ * sub-diagonal are referred.
+ * @param [in] first: index of the first eigenvalue in ascending order.
+ * @param [in] last: index of the last eigenvalue in ascending order.
+ * @param [out] eig: The m = last - first + 1 eigenvalues in ascending order
+ * when succeed.
+ * @param [out] Q: The eigenvectors with dimension [m, n]. Each eigenvector
+ * is stored continuously in memory.
+ * @return int: 0 for success, and others for failure.
+ */
+int diagonalize_sym_tridiagonal_matrix_dstemr(const TridiagonalMatrix &A,
+                                              size_t first, size_t last,
+                                              vector<double> &eig, Matrix &Q);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_BAND_MATRIX_H_
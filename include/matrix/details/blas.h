@@ -8,6 +8,7 @@
 #define _MATRIX_INCLUDE_MATRIX_DETAILS_BLAS_H_
 
 #include "matrix.h"
+#include <memory>
 
 namespace matrix {
 
@@ -33,6 +34,80 @@ int mult_dgemm(const double alpha, const Matrix &A, const string &op_A,
                const Matrix &B, const string &op_B, const double beta,
                Matrix &C);
 
+/**
+ * @brief Select the engine used by mult_dgemm() and the other functions
+ * based on general matrix multiplication.
+ *
+ * @details By default, blas `dgemm` is used when the library is linked to an
+ * optimized blas library, otherwise the built-in engine is used.
+ *
+ * @param [in] engine: "blas": blas `dgemm`.\n
+ * "internal": the built-in engine with the fastest microkernel supported by
+ * the CPU.\n
+ * "internal-generic", "internal-avx2", "internal-avx512": the built-in engine
+ * with the specified microkernel.
+ *
+ * @note An exception is thrown if the engine is unknown or not supported by
+ * the CPU.
+ */
+void set_dgemm_engine(const string &engine);
+
+/**
+ * @brief Get the engine used by mult_dgemm().
+ *
+ * @return string: "blas", or "internal-<microkernel>" for the built-in
+ * engine, e.g. "internal-avx2".
+ */
+string get_dgemm_engine();
+
+/**
+ * @brief general matrix multiplication by the Strassen-Winograd algorithm.
+ *
+ * @par Purpose
+ * calculate C = alpha * op(A) * op(B) + beta * C, the same as mult_dgemm(),
+ * with fewer floating-point operations for large matrices.
+ *
+ * @details Each level of recursion splits the product into 7 half-size
+ * products instead of 8, and saves 12.5% of the operations. The recursion
+ * goes on while all the dimensions of the product are at least \p cutoff
+ * and the scratch memory is within \p max_scratch, and the half-size
+ * products of the last level are calculated by the dgemm engine selected by
+ * set_dgemm_engine(). Odd dimensions are handled by peeling off the last
+ * row or column, which is calculated by dgemm. If no recursion is possible,
+ * mult_dgemm() is called.
+ *
+ * The scratch memory of the recursion is about half of C for each level, and
+ * 2/3 of C in total for square matrices, plus the memory of C when
+ * \p beta is not 0.
+ *
+ * @par Error bound
+ * The result is less accurate than mult_dgemm(). With L levels of recursion
+ * of an n x n product, the error is bounded by (Higham, Accuracy and
+ * Stability of Numerical Algorithms, 2nd ed., Theorem 23.3)\n
+ * max|C - fl(C)| <= [18^L (n0^2 + 6 n0) - 6 n] u max|A| max|B| + O(u^2),\n
+ * where n0 = n / 2^L is the dimension of the dgemm products and u is the
+ * unit roundoff, compared with n u max|A| max|B| for the conventional
+ * algorithm. The error of each level of recursion is up to 18 times larger,
+ * and it is not componentwise, so that small elements of C may have large
+ * relative errors.
+ *
+ * @param [in] alpha: scalar coefficient on op(A) * op(B).
+ * @param [in] A: matrix view that represents op(A).
+ * @param [in] op_A:  operation acting on matrix A.
+ * @param [in] B: matrix view that represents op(B).
+ * @param [in] op_B: operation acting on matrix B.
+ * @param [in] beta: scalar coefficient on matrix C.
+ * @param [out] C: matrix C.
+ * @param [in] cutoff: the minimal dimension of the products that are split
+ * by recursion.
+ * @param [in] max_scratch: the maximal scratch memory in bytes, or 0 for no
+ * limit. The recursion stops at the level that needs more memory.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dgemm_fast(const double alpha, const Matrix &A, const string &op_A,
+                    const Matrix &B, const string &op_B, const double beta,
+                    Matrix &C, size_t cutoff = 4096, size_t max_scratch = 0);
+
 /**
  * @brief convenient function wrapper for three general matrix multiplication.
  *
@@ -41,9 +116,14 @@ int mult_dgemm(const double alpha, const Matrix &A, const string &op_A,
  *
  * @param [in] A: matrix A.
  * @param [in] B: matrix B.
- * @param [in] C: matrix C.
+ * @param [out] C: matrix C.
+ * @param [in, out] scratch: optional buffer for the intermediate A * B. It is
+ * resized if its dimension is not [A.row(), B.col()], so that the same buffer
+ * can be reused by the following calls without memory allocation.
+ * @return int: 0 for success, and others for failure.
  */
-int mult_dgemm_ABAT(const Matrix &A, const Matrix &B, Matrix &C);
+int mult_dgemm_ABAT(const Matrix &A, const Matrix &B, Matrix &C,
+                    Matrix *scratch = nullptr);
 
 /**
  * @brief convenient function wrapper for three general matrix multiplication.
@@ -53,9 +133,215 @@ int mult_dgemm_ABAT(const Matrix &A, const Matrix &B, Matrix &C);
  *
  * @param [in] A: matrix A.
  * @param [in] B: matrix B.
- * @param [in] C: matrix C.
+ * @param [out] C: matrix C.
+ * @param [in, out] scratch: optional buffer for the intermediate B * A. It is
+ * resized if its dimension is not [B.row(), A.col()], so that the same buffer
+ * can be reused by the following calls without memory allocation.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dgemm_ATBA(const Matrix &A, const Matrix &B, Matrix &C,
+                    Matrix *scratch = nullptr);
+
+/**
+ * @brief three matrix multiplication with a symmetric matrix B.
+ *
+ * @par Purpose
+ * calculate C = A * B * A^T, where B is symmetric. A * B is calculated by
+ * `dsymm`, and only half of the symmetric result C is calculated before it is
+ * copied to the other half.
+ *
+ * @param [in] uplo: "U": only the upper triangular of B is referred.\n
+ * "L": only the lower triangular of B is referred.
+ * @param [in] A: matrix A.
+ * @param [in] B: symmetric matrix B.
+ * @param [out] C: symmetric matrix C.
+ * @param [in, out] scratch: optional buffer for the intermediate A * B. It is
+ * resized if its dimension is not [A.row(), B.col()].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsymm_ABAT(const string &uplo, const Matrix &A, const Matrix &B,
+                    Matrix &C, Matrix *scratch = nullptr);
+
+/**
+ * @brief three matrix multiplication with a symmetric matrix B.
+ *
+ * @par Purpose
+ * calculate C = A^T * B * A, where B is symmetric. B * A is calculated by
+ * `dsymm`, and only half of the symmetric result C is calculated before it is
+ * copied to the other half.
+ *
+ * @param [in] uplo: "U": only the upper triangular of B is referred.\n
+ * "L": only the lower triangular of B is referred.
+ * @param [in] A: matrix A.
+ * @param [in] B: symmetric matrix B.
+ * @param [out] C: symmetric matrix C.
+ * @param [in, out] scratch: optional buffer for the intermediate B * A. It is
+ * resized if its dimension is not [B.row(), A.col()].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsymm_ATBA(const string &uplo, const Matrix &A, const Matrix &B,
+                    Matrix &C, Matrix *scratch = nullptr);
+
+/**
+ * @brief batched three matrix multiplication with the same matrix A.
+ *
+ * @par Purpose
+ * calculate C[i] = A * B[i] * A^T for all i. The whole batch is calculated
+ * by two large `dgemm` calls instead of two calls for each B[i].
+ *
+ * @param [in] A: matrix A.
+ * @param [in] B: matrices B[i]. All of them have dimension
+ * [A.col(), A.col()].
+ * @param [out] C: matrices C[i]. All of them have dimension
+ * [A.row(), A.row()].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dgemm_ABAT_batched(const Matrix &A,
+                            const vector<std::shared_ptr<const Matrix>> &B,
+                            const vector<std::shared_ptr<Matrix>> &C);
+
+/**
+ * @brief batched three matrix multiplication with the same matrix A.
+ *
+ * @par Purpose
+ * calculate C[i] = A^T * B[i] * A for all i. The whole batch is calculated
+ * by two large `dgemm` calls instead of two calls for each B[i].
+ *
+ * @param [in] A: matrix A.
+ * @param [in] B: matrices B[i]. All of them have dimension
+ * [A.row(), A.row()].
+ * @param [out] C: matrices C[i]. All of them have dimension
+ * [A.col(), A.col()].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dgemm_ATBA_batched(const Matrix &A,
+                            const vector<std::shared_ptr<const Matrix>> &B,
+                            const vector<std::shared_ptr<Matrix>> &C);
+
+/**
+ * @brief wrapper of blas `dsyrk` function for symmetric rank-k update.
+ *
+ * @par Purpose
+ * calculate C = alpha * op(A) * op(A)^T + beta * C, where C is symmetric.\n
+ * op(A) = A or op(A) = A^T.
+ *
+ * @param [in] uplo: "U": only the upper triangular of C is calculated.\n
+ * "L": only the lower triangular of C is calculated.
+ * @param [in] alpha: scalar coefficient on op(A) * op(A)^T.
+ * @param [in] A: matrix A.
+ * @param [in] op_A: operation acting on matrix A.
+ * @param [in] beta: scalar coefficient on matrix C.
+ * @param [in, out] C: symmetric matrix C. Only the triangular part specified
+ * by \p uplo is referred on entry.
+ * @param [in] to_full: If true, the other triangular part of C is filled on
+ * exit, otherwise it is not referred and left unchanged. Default is true.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsyrk(const string &uplo, const double alpha, const Matrix &A,
+               const string &op_A, const double beta, Matrix &C,
+               bool to_full = true);
+
+/**
+ * @brief wrapper of blas `dsyr2k` function for symmetric rank-2k update.
+ *
+ * @par Purpose
+ * calculate C = alpha * (op(A) * op(B)^T + op(B) * op(A)^T) + beta * C,
+ * where C is symmetric.\n
+ * op(A) = A or op(A) = A^T, and the same operation acts on B.
+ *
+ * @param [in] uplo: "U": only the upper triangular of C is calculated.\n
+ * "L": only the lower triangular of C is calculated.
+ * @param [in] alpha: scalar coefficient on the rank-2k term.
+ * @param [in] A: matrix A.
+ * @param [in] B: matrix B. It has the same dimension as A.
+ * @param [in] op: operation acting on matrix A and B.
+ * @param [in] beta: scalar coefficient on matrix C.
+ * @param [in, out] C: symmetric matrix C. Only the triangular part specified
+ * by \p uplo is referred on entry.
+ * @param [in] to_full: If true, the other triangular part of C is filled on
+ * exit, otherwise it is not referred and left unchanged. Default is true.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsyr2k(const string &uplo, const double alpha, const Matrix &A,
+                const Matrix &B, const string &op, const double beta,
+                Matrix &C, bool to_full = true);
+
+/**
+ * @brief wrapper of blas `dsymm` function for symmetric matrix
+ * multiplication.
+ *
+ * @par Purpose
+ * calculate C = alpha * A * B + beta * C when \p side is "L", or
+ * C = alpha * B * A + beta * C when \p side is "R", where A is symmetric.
+ *
+ * @param [in] side: "L": A multiplies B from the left.\n
+ * "R": A multiplies B from the right.
+ * @param [in] uplo: "U": only the upper triangular of A is referred.\n
+ * "L": only the lower triangular of A is referred.
+ * @param [in] alpha: scalar coefficient on the product.
+ * @param [in] A: symmetric matrix A.
+ * @param [in] B: matrix B.
+ * @param [in] beta: scalar coefficient on matrix C.
+ * @param [in, out] C: matrix C.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsymm(const string &side, const string &uplo, const double alpha,
+               const Matrix &A, const Matrix &B, const double beta, Matrix &C);
+
+/**
+ * @brief wrapper of blas `dtrmm` function for triangular matrix
+ * multiplication.
+ *
+ * @par Purpose
+ * calculate B = alpha * op(A) * B when \p side is "L", or
+ * B = alpha * B * op(A) when \p side is "R".\n
+ * A is a triangular matrix and op(A) = A or op(A) = A^T.
+ *
+ * @param [in] side: "L": op(A) multiplies B from the left.\n
+ * "R": op(A) multiplies B from the right.
+ * @param [in] uplo: "U": A is upper triangular.\n
+ * "L": A is lower triangular.
+ * @param [in] op_A: operation acting on matrix A.
+ * @param [in] diag: "N": A is non-unit triangular.\n
+ * "U": A is unit triangular and its diagonal elements are not referred.
+ * @param [in] alpha: scalar coefficient on op(A) * B.
+ * @param [in] A: the triangular matrix A. Only the triangular part specified
+ * by \p uplo is referred.
+ * @param [in, out] B: matrix B. On exit, it is overwritten by the product.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dtrmm(const string &side, const string &uplo, const string &op_A,
+               const string &diag, const double alpha, const Matrix &A,
+               Matrix &B);
+
+/**
+ * @brief wrapper of blas `dtrsm` function to solve a triangular matrix
+ * equation.
+ *
+ * @par Purpose
+ * solve op(A) * X = alpha * B when \p side is "L", or
+ * X * op(A) = alpha * B when \p side is "R".\n
+ * A is a triangular matrix and op(A) = A or op(A) = A^T.
+ *
+ * @param [in] side: "L": op(A) appears on the left of X.\n
+ * "R": op(A) appears on the right of X.
+ * @param [in] uplo: "U": A is upper triangular.\n
+ * "L": A is lower triangular.
+ * @param [in] op_A: operation acting on matrix A.
+ * @param [in] diag: "N": A is non-unit triangular.\n
+ * "U": A is unit triangular and its diagonal elements are not referred.
+ * @param [in] alpha: scalar coefficient on matrix B.
+ * @param [in] A: the triangular matrix A. Only the triangular part specified
+ * by \p uplo is referred.
+ * @param [in, out] B: the right-hand side matrix B. On exit, it is
+ * overwritten by the solution X.
+ * @return int: 0 for success, and others for failure.
+ *
+ * @note No singularity check is performed on matrix A.
  */
-int mult_dgemm_ATBA(const Matrix &A, const Matrix &B, Matrix &C);
+int solve_tri_matrix_dtrsm(const string &side, const string &uplo,
+                           const string &op_A, const string &diag,
+                           const double alpha, const Matrix &A, Matrix &B);
 
 /**
  * @brief wrapper of blas dscal function to scale matrix by a constant.
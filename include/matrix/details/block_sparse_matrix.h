@@ -0,0 +1,216 @@
+/**
+ * @file block_sparse_matrix.h
+ * @brief declaration of the block-sparse tiled matrix and its screened
+ * matrix product.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_BLOCK_SPARSE_MATRIX_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_BLOCK_SPARSE_MATRIX_H_
+
+#include "matrix.h"
+#include <algorithm>
+#include <vector>
+
+namespace matrix {
+
+using std::vector;
+
+/**
+ * @brief Matrix split into square tiles, of which only the nonzero ones are
+ * stored, together with their Frobenius norms.
+ *
+ * @details The tiles are indexed by the tile row I and the tile column J,
+ * and tile (I, J) holds the elements (I * tile + i, J * tile + j). The tiles
+ * at the last tile row or column are smaller if the dimension is not a
+ * multiple of the tile size. The stored tiles are kept tile row by tile row
+ * in a compressed sparse row layout, as SparseMatrix: the tile columns of
+ * the tiles in tile row I are `tile_col()[k]` for k in
+ * [`tile_row_ptr()[I]`, `tile_row_ptr()[I + 1]`), strictly increasing, and
+ * the elements of each tile are stored row-wise and continuously.
+ */
+class BlockSparseMatrix {
+  public:
+    /**
+     * @brief Construct a block-sparse matrix without any tile.
+     *
+     * @param [in] row: number of rows.
+     * @param [in] col: number of columns.
+     * @param [in] tile: size of the tiles.
+     */
+    explicit BlockSparseMatrix(size_t row = 0, size_t col = 0,
+                               size_t tile = 64);
+
+    /**
+     * @brief Construct a block-sparse matrix from its tiles.
+     *
+     * @param [in] row: number of rows.
+     * @param [in] col: number of columns.
+     * @param [in] tile: size of the tiles.
+     * @param [in] tile_row_ptr: offsets of the tile rows, with
+     * num_tile_rows() + 1 elements.
+     * @param [in] tile_col: tile columns of the tiles, strictly increasing in
+     * each tile row.
+     * @param [in] data: elements of the tiles, one after another.
+     *
+     * @note An exception is thrown if the arrays do not match.
+     */
+    BlockSparseMatrix(size_t row, size_t col, size_t tile,
+                      vector<size_t> tile_row_ptr, vector<size_t> tile_col,
+                      vector<double> data);
+
+    /**
+     * @brief Construct a block-sparse matrix from a dense matrix.
+     *
+     * @param [in] A: the dense matrix.
+     * @param [in] tile: size of the tiles.
+     * @param [in] threshold: the tiles whose Frobenius norms are not larger
+     * than it are dropped. The tiles with elements that are not finite are
+     * always kept.
+     */
+    BlockSparseMatrix(const Matrix &A, size_t tile, double threshold = 0.0);
+
+    /**
+     * @brief Get the dense matrix.
+     * @return Matrix
+     */
+    Matrix to_matrix() const;
+
+    /**
+     * @brief Store the tile (I, J), which replaces the old one if any.
+     *
+     * @param [in] I: tile row.
+     * @param [in] J: tile column.
+     * @param [in] T: the tile with dimension
+     * [tile_height(I), tile_width(J)].
+     *
+     * @note The tiles after (I, J) are moved, so that the matrix is built
+     * efficiently in the order of the tiles.
+     */
+    void set_tile(size_t I, size_t J, const Matrix &T);
+
+    /**
+     * @brief Get the elements of the tile (I, J) stored row-wise, or nullptr
+     * if it is not stored.
+     */
+    const double *tile(size_t I, size_t J) const;
+
+    /**
+     * @brief Get the Frobenius norm of the tile (I, J), which is zero if it
+     * is not stored.
+     */
+    double tile_norm(size_t I, size_t J) const;
+
+    /**
+     * @brief Get the number of rows.
+     */
+    size_t row() const { return row_; }
+
+    /**
+     * @brief Get the number of columns.
+     */
+    size_t col() const { return col_; }
+
+    /**
+     * @brief Get the size of the tiles.
+     */
+    size_t tile_size() const { return tile_; }
+
+    /**
+     * @brief Get the number of the tile rows.
+     */
+    size_t num_tile_rows() const { return (row_ + tile_ - 1) / tile_; }
+
+    /**
+     * @brief Get the number of the tile columns.
+     */
+    size_t num_tile_cols() const { return (col_ + tile_ - 1) / tile_; }
+
+    /**
+     * @brief Get the number of rows of the tiles in tile row I.
+     */
+    size_t tile_height(size_t I) const
+    {
+        return std::min(tile_, row_ - I * tile_);
+    }
+
+    /**
+     * @brief Get the number of columns of the tiles in tile column J.
+     */
+    size_t tile_width(size_t J) const
+    {
+        return std::min(tile_, col_ - J * tile_);
+    }
+
+    /**
+     * @brief Get the number of the stored tiles.
+     */
+    size_t num_tiles() const { return tile_col_.size(); }
+
+    /**
+     * @brief Get the offsets of the tile rows.
+     */
+    const vector<size_t> &tile_row_ptr() const { return tile_row_ptr_; }
+
+    /**
+     * @brief Get the tile columns of the stored tiles.
+     */
+    const vector<size_t> &tile_col() const { return tile_col_; }
+
+    /**
+     * @brief Get the Frobenius norms of the stored tiles.
+     */
+    const vector<double> &norms() const { return norms_; }
+
+    /**
+     * @brief Get the elements of the k-th stored tile.
+     */
+    const double *tile_data(size_t k) const
+    {
+        return data_.data() + offset_[k];
+    }
+
+  private:
+    size_t find(size_t I, size_t J) const;
+
+    void update_offsets_and_norms();
+
+    size_t row_;
+    size_t col_;
+    size_t tile_;
+    vector<size_t> tile_row_ptr_;
+    vector<size_t> tile_col_;
+    vector<size_t> offset_;
+    vector<double> norms_;
+    vector<double> data_;
+};
+
+/**
+ * @brief Matrix product of block-sparse matrices with norm screening.
+ *
+ * @par Purpose
+ * calculate C = alpha * A * B, where the tile products A(I, K) * B(K, J)
+ * are skipped if the product of the norms of the tiles is less than
+ * \p threshold. The products with the tiles that are not finite are never
+ * skipped, so that NaN and INF propagate to C.
+ *
+ * @details Each tile product computed is dispatched to the dgemm engine,
+ * and the tiles of C are computed in parallel. Since
+ * |A(I, K) * B(K, J)| <= |A(I, K)| * |B(K, J)| in the Frobenius norm, the
+ * error of each tile of C is bounded by |alpha| * \p threshold times the
+ * number of the skipped products. The tiles of C without any product are not
+ * stored, so that the cost scales with the number of the significant tile
+ * products instead of n^3.
+ *
+ * @param [in] alpha: scalar coefficient on A * B.
+ * @param [in] A: block-sparse matrix A.
+ * @param [in] B: block-sparse matrix B with the same tile size as A.
+ * @param [in] threshold: the smallest product of the tile norms computed.
+ * @param [out] C: block-sparse matrix C with dimension [A.row(), B.col()].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_block_sparse_dgemm(const double alpha, const BlockSparseMatrix &A,
+                            const BlockSparseMatrix &B, const double threshold,
+                            BlockSparseMatrix &C);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_BLOCK_SPARSE_MATRIX_H_
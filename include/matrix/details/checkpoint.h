@@ -0,0 +1,141 @@
+/**
+ * @file checkpoint.h
+ * @brief declaration of the incremental checkpoint store of matrices.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_CHECKPOINT_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_CHECKPOINT_H_
+
+#include "matrix.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Incremental checkpoints of a set of matrices in a log-structured
+ * file.
+ *
+ * @details The data of each matrix is split into tiles of a fixed number of
+ * elements in row-wise order, and a 64-bit hash of each tile is kept. A
+ * checkpoint hashes the tiles in parallel when matrix is built with OpenMP,
+ * and appends only the tiles whose hash is changed since the previous
+ * checkpoint to the end of the file, so that its cost scales with the
+ * amount of change instead of the total size. All the tiles of a matrix are
+ * written if its dimension is changed.
+ *
+ * Each checkpoint is a record with the dimensions of all the matrices, a
+ * table of the tiles in the record with their hashes, the tile data and a
+ * trailer with a checksum of the record. A record is only valid when its
+ * trailer is written, so a checkpoint interrupted by a crash is discarded
+ * when the store is opened again. The store keeps the location of the
+ * latest version of each tile, and restore() reads each tile once, merging
+ * the neighbouring tiles into a single read, instead of replaying the whole
+ * log. compact() rewrites the log with the latest checkpoint only.
+ *
+ * @code
+ * CheckpointStore store("state.ckpt");
+ * for (size_t step = 0; step < nstep; step++) {
+ *     update(mat);
+ *     store.checkpoint(mat);
+ * }
+ * auto restored = CheckpointStore("state.ckpt").restore();
+ * @endcode
+ *
+ * @note A store is not thread-safe. The file must not be opened by two
+ * stores at the same time.
+ */
+class CheckpointStore {
+  public:
+    /**
+     * @brief Open a checkpoint file, or create it if it does not exist.
+     *
+     * @param [in] fname: the checkpoint file name.
+     * @param [in] tile_size: number of elements of a tile for a new file.
+     * The tile size of an existing file is kept.
+     */
+    explicit CheckpointStore(const string &fname, size_t tile_size = 8192);
+
+    ~CheckpointStore();
+
+    CheckpointStore(const CheckpointStore &) = delete;
+    CheckpointStore &operator=(const CheckpointStore &) = delete;
+
+    /**
+     * @brief Write a checkpoint of the matrices.
+     *
+     * @param [in] Mat: the matrices. The number of the matrices and their
+     * dimensions can be different from the previous checkpoint.
+     * @param [in] sync: flush the checkpoint to the storage device by
+     * `fdatasync` before returning.
+     * @return uint64_t: number of bytes appended to the file.
+     */
+    uint64_t checkpoint(const vector<std::shared_ptr<const Matrix>> &Mat,
+                        bool sync = true);
+
+    /**
+     * @brief Read the matrices of the latest checkpoint.
+     *
+     * @param [in] verify: verify the hash of each tile.
+     * @return std::vector<std::shared_ptr<Matrix>>: the matrices, which is
+     * empty if there is no checkpoint.
+     */
+    std::vector<std::shared_ptr<Matrix>> restore(bool verify = true) const;
+
+    /**
+     * @brief Rewrite the file with the latest checkpoint only, to reclaim
+     * the space of the tiles that are overwritten by later checkpoints. The
+     * new file replaces the old one atomically by `rename`.
+     */
+    void compact();
+
+    /**
+     * @brief Get the number of checkpoints in the file.
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Get the number of elements of a tile.
+     */
+    size_t tile_size() const { return tile_size_; }
+
+    /**
+     * @brief Get the size of the file in bytes.
+     */
+    uint64_t file_size() const { return offset_; }
+
+  private:
+    /**
+     * @brief The latest version of a tile.
+     */
+    struct Tile {
+        uint64_t hash;
+        uint64_t offset; /* file offset of the data. */
+    };
+
+    /**
+     * @brief The latest version of a matrix.
+     */
+    struct MatrixState {
+        size_t row;
+        size_t col;
+        vector<Tile> tiles;
+    };
+
+    void load();
+
+    string fname_;
+    int fd_;
+    size_t tile_size_;
+    uint64_t offset_; /* end of the valid records. */
+    size_t count_;
+    vector<MatrixState> state_;
+};
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_CHECKPOINT_H_
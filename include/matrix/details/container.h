@@ -0,0 +1,232 @@
+/**
+ * @file container.h
+ * @brief declaration of the versioned binary container of matrices.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_CONTAINER_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_CONTAINER_H_
+
+#include "matrix.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Element types of the matrices in a container.
+ */
+enum ContainerDtype {
+    kDtypeFloat64 = 1, /**< IEEE 754 double. */
+};
+
+/**
+ * @brief Encodings of the matrix data in a container.
+ *
+ * @details An encoding is a filter combined with a compressor by bitwise OR,
+ * e.g. `kCodecXorDelta | kCodecDeflate`. All the encodings are lossless. The
+ * filters reorder the bytes of the elements so that the compressors work
+ * better on floating-point data: the shuffle groups the bytes of the same
+ * significance of all the elements, and the XOR-delta additionally XORs each
+ * element with the previous one, which zeros the bytes shared by
+ * neighbouring elements of a smooth matrix. The compressors marked optional
+ * are available if the library is found when matrix is built, see
+ * matrix::is_container_codec_supported().
+ */
+enum ContainerCodec {
+    kCodecNone = 0,         /**< the raw elements in row-wise order. */
+    kCodecShuffle = 0x1,    /**< filter: byte shuffle. */
+    kCodecXorDelta = 0x2,   /**< filter: XOR-delta, then byte shuffle. */
+    kCodecRle = 0x100,      /**< compressor: built-in run-length encoding. */
+    kCodecDeflate = 0x200,  /**< compressor: zlib deflate, optional. */
+    kCodecZstd = 0x300,     /**< compressor: zstd, optional. */
+};
+
+/**
+ * @brief An entry in the table of contents of a container.
+ */
+struct ContainerEntry {
+    string name;       /**< name of the matrix, which can be empty. */
+    size_t row;        /**< number of rows. */
+    size_t col;        /**< number of columns. */
+    uint64_t offset;   /**< file offset of the data, a multiple of 64. */
+    uint64_t size;     /**< number of bytes of the encoded data. */
+    uint32_t dtype;    /**< element type, see matrix::ContainerDtype. */
+    uint32_t codec;    /**< data encoding, see matrix::ContainerCodec. */
+    uint32_t checksum; /**< CRC32C of the data in the file. */
+};
+
+/**
+ * @brief Writer of the version 2 binary container of matrices.
+ *
+ * @details The container starts with a 64-byte header, which has a magic
+ * number, the format version, a byte order marker and the location of the
+ * table of contents. The data of each matrix is aligned to 64 bytes, and the
+ * table of contents with the name, the offset, the shape, the element type
+ * and the CRC32C checksum of each matrix is written at the end of the file
+ * by close(). A matrix in the container can be read without reading the
+ * others, see matrix::ContainerReader.
+ *
+ * The data can be compressed by a matrix::ContainerCodec. The matrix is then
+ * split into chunks of 64Ki elements, which are encoded and decoded in
+ * parallel when matrix is built with OpenMP.
+ *
+ * @code
+ * ContainerWriter writer("data.bin");
+ * writer.append(A, "overlap");
+ * writer.append(B, "fock");
+ * writer.close();
+ * @endcode
+ */
+class ContainerWriter {
+  public:
+    /**
+     * @brief Create a container file. An existing file is overwritten.
+     * @param [in] fname: the container file name.
+     * @param [in] codec: encoding of the matrix data, see
+     * matrix::ContainerCodec.
+     */
+    explicit ContainerWriter(const string &fname, int codec = kCodecNone);
+
+    /**
+     * @brief Close the container if close() is not called. Errors are
+     * ignored, call close() to handle them.
+     */
+    ~ContainerWriter();
+
+    ContainerWriter(const ContainerWriter &) = delete;
+    ContainerWriter &operator=(const ContainerWriter &) = delete;
+
+    /**
+     * @brief Append a matrix to the container.
+     *
+     * @param [in] A: the matrix.
+     * @param [in] name: name of the matrix. Non-empty names must be unique
+     * in the container.
+     * @return size_t: the index of the matrix in the container.
+     */
+    size_t append(const Matrix &A, const string &name = "");
+
+    /**
+     * @brief Write the table of contents and close the file.
+     */
+    void close();
+
+  private:
+    string fname_;
+    int fd_;
+    int codec_;
+    uint64_t offset_;
+    vector<ContainerEntry> entries_;
+    std::map<string, size_t> names_;
+};
+
+/**
+ * @brief Reader of the version 2 binary container of matrices written by
+ * matrix::ContainerWriter.
+ *
+ * @details The header and the table of contents are read and verified when
+ * the container is opened. Afterwards, each matrix is read by a single
+ * positioned read at its offset, without reading the other matrices. A
+ * reader can be used by multiple threads at the same time.
+ */
+class ContainerReader {
+  public:
+    /**
+     * @brief Open a container file.
+     * @param [in] fname: the container file name.
+     */
+    explicit ContainerReader(const string &fname);
+
+    ~ContainerReader();
+
+    ContainerReader(const ContainerReader &) = delete;
+    ContainerReader &operator=(const ContainerReader &) = delete;
+
+    /**
+     * @brief Get the number of matrices in the container.
+     */
+    size_t size() const { return entries_.size(); }
+
+    /**
+     * @brief Get the table of contents.
+     */
+    const vector<ContainerEntry> &entries() const { return entries_; }
+
+    /**
+     * @brief Get the index of a named matrix.
+     * @note An exception is thrown if the name is not found.
+     */
+    size_t index_of(const string &name) const;
+
+    /**
+     * @brief Read the \p index -th matrix.
+     *
+     * @param [in] index: index of the matrix.
+     * @param [in] verify: verify the CRC32C checksum of the data.
+     * @return std::shared_ptr<Matrix>: the matrix.
+     */
+    std::shared_ptr<Matrix> read_matrix_at(size_t index,
+                                           bool verify = true) const;
+
+    /**
+     * @brief Read a named matrix.
+     * @see read_matrix_at(size_t, bool)
+     */
+    std::shared_ptr<Matrix> read_matrix_at(const string &name,
+                                           bool verify = true) const;
+
+    /**
+     * @brief Read the \p index -th matrix into a given matrix, which is
+     * resized if its dimension is not matched, so that the same matrix can be
+     * reused by the following calls without memory allocation.
+     *
+     * @param [in] index: index of the matrix.
+     * @param [out] A: the matrix.
+     * @param [in] verify: verify the CRC32C checksum of the data.
+     */
+    void read_matrix_at(size_t index, Matrix &A, bool verify = true) const;
+
+  private:
+    string fname_;
+    int fd_;
+    vector<ContainerEntry> entries_;
+    std::map<string, size_t> names_;
+};
+
+/**
+ * @brief Check if a file is a version 2 container by its magic number.
+ * @param [in] fname: the file name.
+ * @return bool.
+ */
+bool is_matrix_container(const string &fname);
+
+/**
+ * @brief Check if an encoding of the matrix data in a container is supported
+ * by this build.
+ * @param [in] codec: the encoding, see matrix::ContainerCodec.
+ * @return bool.
+ */
+bool is_container_codec_supported(int codec);
+
+/**
+ * @brief Write a vector of matrices into a version 2 container.
+ *
+ * @param [in] Mat: the matrices.
+ * @param [in] fname: the container file name.
+ * @param [in] names: names of the matrices, which is either empty or has the
+ * same size as \p Mat.
+ * @param [in] codec: encoding of the matrix data, see matrix::ContainerCodec.
+ * @see matrix::ContainerWriter
+ */
+void write_matrices_to_container(
+    const vector<std::shared_ptr<const Matrix>> &Mat, const string &fname,
+    const vector<string> &names = {}, int codec = kCodecNone);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_CONTAINER_H_
@@ -0,0 +1,254 @@
+/**
+ * @file factorization.h
+ * @brief declaration of reusable matrix factorizations based on lapack.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_FACTORIZATION_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_FACTORIZATION_H_
+
+#include "matrix.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Base class of a factorized square matrix.
+ *
+ * @details A factorization owns the factors and the pivots computed by
+ * lapack, so that the linear systems, the inverse, the determinant and the
+ * condition number of the original matrix can be calculated repeatedly
+ * without factorizing the matrix again.
+ */
+class Factorization {
+  public:
+    /**
+     * @brief factorization types.
+     */
+    enum Type {
+        kLU,       /**< LU factorization of a general matrix (`dgetrf`). */
+        kCholesky, /**< Cholesky factorization of an spd matrix (`dpotrf`). */
+        kLDLT,     /**< LDL^T factorization of a symmetric matrix (`dsytrf`). */
+    };
+
+    virtual ~Factorization() {}
+
+    /**
+     * @brief Get the factorization type.
+     * @return Type.
+     */
+    virtual Type type() const = 0;
+
+    /**
+     * @brief Solve A * X = B with the factorized matrix A.
+     *
+     * @param [in, out] B: The right-hand sides stored column by column, with
+     * dimension [n, nrhs]. On exit, it stores the solution X.
+     * @return int: 0 for success, and others for failure.
+     */
+    virtual int solve(Matrix &B) const = 0;
+
+    /**
+     * @brief Calculate the inverse of the factorized matrix.
+     * @return Matrix: the inverse matrix.
+     */
+    virtual Matrix inverse() const = 0;
+
+    /**
+     * @brief Calculate the logarithm of the absolute value of the determinant
+     * of the factorized matrix.
+     * @return double: log(|det(A)|).
+     * @see det_sign()
+     */
+    virtual double log_det() const = 0;
+
+    /**
+     * @brief Get the sign of the determinant of the factorized matrix.
+     * @return int: 1 or -1.
+     */
+    virtual int det_sign() const = 0;
+
+    /**
+     * @brief Estimate the reciprocal of the condition number of the
+     * factorized matrix in the 1-norm.
+     * @return double: the reciprocal condition number.
+     */
+    virtual double rcond() const = 0;
+
+    /**
+     * @brief Get the dimension of the factorized matrix.
+     * @return size_t
+     */
+    size_t dim() const { return factor_.row(); }
+
+    /**
+     * @brief Get the factors in the lapack storage.
+     * @return const Matrix &
+     */
+    const Matrix &factor() const { return factor_; }
+
+    /**
+     * @brief Get the pivots in the lapack convention (index starts from 1).
+     * It is empty for Cholesky factorization.
+     * @return const vector<int> &
+     */
+    const vector<int> &pivots() const { return ipiv_; }
+
+    /**
+     * @brief Get the label of the triangular part being factorized. It is
+     * empty for LU factorization.
+     * @return const string &
+     */
+    const string &uplo() const { return uplo_; }
+
+    /**
+     * @brief Get the 1-norm of the original matrix.
+     * @return double
+     */
+    double norm() const { return anorm_; }
+
+    /**
+     * @brief Create a factorization from the data stored by a former
+     * factorization of the same type.
+     *
+     * @param [in] type: factorization type.
+     * @param [in] uplo: label of the triangular part. It is ignored for LU
+     * factorization.
+     * @param [in] factor: the factors in the lapack storage.
+     * @param [in] ipiv: the pivots. It is ignored for Cholesky factorization.
+     * @param [in] anorm: the 1-norm of the original matrix.
+     * @return std::shared_ptr<Factorization>: the restored factorization.
+     * @see factor(), pivots(), uplo() and norm().
+     */
+    static std::shared_ptr<Factorization>
+    create(Type type, const string &uplo, const Matrix &factor,
+           const vector<int> &ipiv, double anorm);
+
+  protected:
+    Factorization() : anorm_{0.0} {}
+
+    /**
+     * @brief Throw an exception if the dimension of the right-hand sides does
+     * not match the factorized matrix.
+     */
+    void check_rhs(const Matrix &B) const;
+
+    Matrix factor_;     /* factors in the lapack storage. */
+    vector<int> ipiv_;  /* pivots from lapack. */
+    string uplo_;       /* label of the factorized triangular part. */
+    double anorm_;      /* 1-norm of the original matrix. */
+};
+
+/**
+ * @brief LU factorization of a general square matrix computed by lapack
+ * `dgetrf`.
+ */
+class LUFactorization : public Factorization {
+  public:
+    /**
+     * @brief Create an empty factorization.
+     */
+    LUFactorization() {}
+
+    /**
+     * @brief Factorize a general square matrix.
+     * @param [in] A: the matrix to be factorized.
+     */
+    explicit LUFactorization(const Matrix &A) { factorize(A); }
+
+    /**
+     * @brief Factorize a general square matrix.
+     * @param [in] A: the matrix to be factorized.
+     */
+    void factorize(const Matrix &A);
+
+    Type type() const override { return kLU; }
+    int solve(Matrix &B) const override;
+    Matrix inverse() const override;
+    double log_det() const override;
+    int det_sign() const override;
+    double rcond() const override;
+};
+
+/**
+ * @brief Cholesky factorization of a real symmetric positive definite (spd)
+ * matrix computed by lapack `dpotrf`.
+ */
+class CholeskyFactorization : public Factorization {
+  public:
+    /**
+     * @brief Create an empty factorization.
+     */
+    CholeskyFactorization() {}
+
+    /**
+     * @brief Factorize an spd matrix.
+     * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+     * "L": only the lower triangular will be refereed.
+     * @param [in] A: the matrix to be factorized.
+     */
+    CholeskyFactorization(const string &uplo, const Matrix &A)
+    {
+        factorize(uplo, A);
+    }
+
+    /**
+     * @brief Factorize an spd matrix.
+     * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+     * "L": only the lower triangular will be refereed.
+     * @param [in] A: the matrix to be factorized.
+     */
+    void factorize(const string &uplo, const Matrix &A);
+
+    Type type() const override { return kCholesky; }
+    int solve(Matrix &B) const override;
+    Matrix inverse() const override;
+    double log_det() const override;
+    int det_sign() const override { return 1; }
+    double rcond() const override;
+};
+
+/**
+ * @brief Factorization A = U*D*U**T or A = L*D*L**T of a real symmetric
+ * indefinite matrix computed by lapack `dsytrf`.
+ */
+class LDLTFactorization : public Factorization {
+  public:
+    /**
+     * @brief Create an empty factorization.
+     */
+    LDLTFactorization() {}
+
+    /**
+     * @brief Factorize a symmetric matrix.
+     * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+     * "L": only the lower triangular will be refereed.
+     * @param [in] A: the matrix to be factorized.
+     */
+    LDLTFactorization(const string &uplo, const Matrix &A)
+    {
+        factorize(uplo, A);
+    }
+
+    /**
+     * @brief Factorize a symmetric matrix.
+     * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+     * "L": only the lower triangular will be refereed.
+     * @param [in] A: the matrix to be factorized.
+     */
+    void factorize(const string &uplo, const Matrix &A);
+
+    Type type() const override { return kLDLT; }
+    int solve(Matrix &B) const override;
+    Matrix inverse() const override;
+    double log_det() const override;
+    int det_sign() const override;
+    double rcond() const override;
+};
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_FACTORIZATION_H_
@@ -20,6 +20,16 @@ namespace matrix {
  */
 int set_matrix_random_orthogonal(Matrix &A, bool using_fixed_seed = true);
 
+/**
+ * @brief Release the lapack workspace of the calling thread.
+ *
+ * @details The optimal workspace size of the lapack routines is queried once
+ * for each matrix dimension, and the work arrays are reused by the following
+ * calls in the same thread. Call this function to free the memory held by
+ * the calling thread, e.g. after working on a few very large matrices.
+ */
+void release_lapack_workspace();
+
 /**
  * @brief Wrapper of lapack `dsyev` function to diagonalize a symmetric matrix.
  *
@@ -89,6 +99,48 @@ int invert_sym_matrix_dsytri(const string &uplo, Matrix &A);
  */
 int invert_sym_matrix_dsytri_rook(const string &uplo, Matrix &A);
 
+/**
+ * @brief Solve a general linear system A * X = B by lapack `dgetrs`, which is
+ * based on LU factorization computed by lapack `dgetrf`.
+ *
+ * @param [in, out] A: The input general square matrix. On exit, it is
+ * overwritten by its LU factors.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_gen_matrix_dgetrs(Matrix &A, Matrix &B);
+
+/**
+ * @brief Solve a real symmetric positive definite (spd) linear system
+ * A * X = B by lapack `dpotrs`, which is based on Cholesky factorization
+ * computed by lapack `dpotrf`.
+ *
+ * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+ *  "L": only the lower triangular will be refereed.
+ * @param [in, out] A: The input spd matrix. On exit, the triangular part
+ * specified by \p uplo is overwritten by its Cholesky factor.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_spd_matrix_dpotrs(const string &uplo, Matrix &A, Matrix &B);
+
+/**
+ * @brief Solve a real symmetric indefinite linear system A * X = B by lapack
+ * `dsytrs`, which is based on factorization A = U*D*U**T or A = L*D*L**T
+ * computed by lapack `dsytrf`.
+ *
+ * @param [in] uplo: "U": only the upper triangular will be refereed.\n
+ * "L": only the lower triangular will be refereed.
+ * @param [in, out] A: The input symmetric matrix. On exit, the triangular part
+ * specified by \p uplo is overwritten by its factors.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_sym_matrix_dsytrs(const string &uplo, Matrix &A, Matrix &B);
+
 } // namespace matrix
 
 #endif // _MATRIX_SRC_LAPACK_H_H
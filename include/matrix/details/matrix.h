@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -41,6 +42,9 @@ class Matrix {
     double *data_ptr_; /* This pointer will always point to the head of the
                         * matrix data.
                         * No memory allocation is assigned for this pointer. */
+    std::shared_ptr<void> data_owner_; /* Keep the memory outside of the
+                                        * object alive, e.g. a memory-mapped
+                                        * file. It is empty otherwise. */
 
   public:
     /**
@@ -122,6 +126,26 @@ class Matrix {
     Matrix(size_t row, size_t col, double *inp_data_ptr,
            CopyType copy_type = kDeepCopy);
 
+    /**
+     * @brief Construct a matrix from a double array pointer whose memory is
+     * kept alive by an owner.
+     *
+     * @details The matrix gains the access to the data as a shallow copy, and
+     * shares the ownership of the memory with \p owner. The memory stays
+     * valid as long as the matrix exists, e.g. a memory-mapped file is
+     * unmapped when the last matrix on it is destroyed.
+     *
+     * @param [in] inp_data_ptr: a pointer points to double array that stores
+     * the matrix data.
+     * @param [in] owner: the owner of the memory of \p inp_data_ptr.
+     *
+     * @note The data size of the array will NOT be check to match the matrix
+     * size. The ownership is released if the matrix data is reallocated, e.g.
+     * by resize() or the copy assignment.
+     */
+    Matrix(size_t row, size_t col, double *inp_data_ptr,
+           std::shared_ptr<void> owner);
+
     /**
      * @brief Default constructor.
      * @details Create an empty matrix object with dimension [0, 0].
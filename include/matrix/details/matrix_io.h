@@ -5,7 +5,9 @@
 #ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_MATRIX_IO_H_
 #define _MATRIX_INCLUDE_MATRIX_DETAILS_MATRIX_IO_H_
 
+#include "factorization.h"
 #include "matrix.h"
+#include "sparse_matrix.h"
 #include <memory>
 
 namespace matrix {
@@ -28,6 +30,8 @@ void read_matrices_from_binary(vector<std::shared_ptr<Matrix>> &Mat,
 
 /**
  * @brief Read matrix/matrices from binary file and create a vector of matrices.
+ * @details Both the files written by matrix::write_matrices_to_binary() and
+ * the version 2 containers written by matrix::ContainerWriter are supported.
  * @param [in] fname: binary file name.
  * @return std::vector<std::shared_ptr<Matrix>>: a vector of matrices.
  */
@@ -41,6 +45,115 @@ read_matrices_from_binary(const char *fname);
  */
 std::vector<std::shared_ptr<Matrix>> read_matrices_from_binary(string &fname);
 
+/**
+ * @brief Set the number of threads that read and write the data of large
+ * matrices in binary files.
+ *
+ * @details The data of a matrix larger than two chunks, see
+ * set_io_chunk_size(), is split into chunks which are read or written by
+ * `pread` or `pwrite` in parallel, straight from or into the memory of the
+ * matrix. It is used by matrix::write_matrices_to_binary(),
+ * matrix::read_matrices_from_binary() and the uncompressed entries of
+ * matrix::ContainerWriter and matrix::ContainerReader.
+ *
+ * @param [in] num_threads: the number of threads. The default is the number
+ * of hardware threads, up to 8, if \p num_threads <= 0.
+ */
+void set_io_num_threads(int num_threads);
+
+/**
+ * @brief Get the number of threads that read and write the data of large
+ * matrices in binary files.
+ */
+int get_io_num_threads();
+
+/**
+ * @brief Set the size in bytes of the chunks of parallel binary I/O.
+ * @param [in] chunk_size: the chunk size, rounded up to a multiple of 4096.
+ * The default is 8 MiB.
+ */
+void set_io_chunk_size(size_t chunk_size);
+
+/**
+ * @brief Get the size in bytes of the chunks of parallel binary I/O.
+ */
+size_t get_io_chunk_size();
+
+/**
+ * @brief Enable or disable direct I/O (`O_DIRECT`) for the chunks of
+ * parallel binary I/O, so that the data bypasses the page cache.
+ *
+ * @details The data is copied through page-aligned buffers, since the memory
+ * of a matrix is not aligned to the blocks of the file system. Buffered I/O
+ * is used instead if the file system does not support direct I/O. Disabled
+ * by default.
+ */
+void set_io_direct(bool direct);
+
+/**
+ * @brief Check if direct I/O is enabled for parallel binary I/O.
+ */
+bool get_io_direct();
+
+/**
+ * @brief Access pattern hints for memory-mapped matrices, passed to
+ * `madvise`. The hints can be combined by bitwise or.
+ */
+enum MapAdvice {
+    kMapNormal = 0,     /**< no hint. */
+    kMapSequential = 1, /**< the data is read in order, pages are read ahead
+                           aggressively and dropped soon after use. */
+    kMapRandom = 2,     /**< the data is read in random order, no read-ahead. */
+    kMapWillNeed = 4,   /**< start to load all the pages in the background. */
+    kMapHugePage = 8,   /**< back the mapping by transparent huge pages where
+                           the kernel and the file system support it. */
+};
+
+/**
+ * @brief Map the matrices in a binary file written by
+ * matrix::write_matrices_to_binary() or matrix::ContainerWriter into memory,
+ * read-only.
+ *
+ * @details The file is mapped by `mmap` and each matrix accesses its data in
+ * the mapping directly, so that no data is read until it is used, and the
+ * pages are loaded on demand by the kernel. The mapping is released when all
+ * the matrices are destroyed.
+ *
+ * @param [in] fname: binary file name.
+ * @param [in] advice: access pattern hints, see matrix::MapAdvice.
+ * @return std::vector<std::shared_ptr<const Matrix>>: a vector of matrices.
+ *
+ * @note The matrices must not be modified, and the file must not be
+ * truncated while they are in use. Copies of the matrices are ordinary
+ * matrices that store the data inside.
+ */
+std::vector<std::shared_ptr<const Matrix>>
+map_matrices_from_binary(const char *fname, int advice = kMapNormal);
+
+/**
+ * @brief Map the matrices in a binary file written by
+ * matrix::write_matrices_to_binary() or matrix::ContainerWriter into memory,
+ * copy-on-write.
+ *
+ * @details The same as matrix::map_matrices_from_binary(), but the matrices
+ * can be modified. A page of the file is copied into private memory when it
+ * is modified for the first time, and the file itself is never changed.
+ *
+ * @param [in] fname: binary file name.
+ * @param [in] advice: access pattern hints, see matrix::MapAdvice.
+ * @return std::vector<std::shared_ptr<Matrix>>: a vector of matrices.
+ */
+std::vector<std::shared_ptr<Matrix>>
+map_matrices_from_binary_cow(const char *fname, int advice = kMapNormal);
+
+/**
+ * @brief Number formats of the txt matrix files.
+ */
+enum TxtFormat {
+    kTxtScientific = 0, /**< `printf("%.16e")`, 17 significant digits. */
+    kTxtShortest = 1,   /**< the shortest digits that are read back exactly. */
+};
+
 /**
  * @brief Write a vector of matrices into a txt file.
  * @details The matrices are write in order. For each matrix, the format is the
@@ -54,14 +167,23 @@ std::vector<std::shared_ptr<Matrix>> read_matrices_from_binary(string &fname);
  * @param [in] Mat: The set of input matrices to be written.
  * @param [in] fname: The name of the output txt file.
  * @param [in] num_per_line: number of matrix elements per line.
+ * @param [in] format: number format of the matrix elements, see
+ * matrix::TxtFormat. Both formats are read back exactly by
+ * matrix::read_matrices_from_txt(), and matrix::kTxtShortest is smaller and
+ * faster to write, e.g. `0.1` instead of `1.0000000000000001e-01`.
  */
 void write_matrices_to_txt(vector<std::shared_ptr<Matrix>> &Mat,
-                           const string &fname, size_t num_per_line = 5);
+                           const string &fname, size_t num_per_line = 5,
+                           TxtFormat format = kTxtScientific);
 
 /**
  * @brief Read a vector of matrices from a txt file generated from
  * matrix::write_matrices_to_txt().
  *
+ * @details The elements are parsed without memory allocation and rounded
+ * correctly, so the values written by matrix::write_matrices_to_txt() are
+ * read back exactly.
+ *
  * @param [in] fname: the name (relative or absolute path) of the matrix txt
  * file.
  * @return std::vector<std::shared_ptr<Matrix>>: a vector of matrices.
@@ -69,6 +191,164 @@ void write_matrices_to_txt(vector<std::shared_ptr<Matrix>> &Mat,
  */
 std::vector<std::shared_ptr<Matrix>> read_matrices_from_txt(const string &fname);
 
+/**
+ * @brief Formats of the Matrix Market files.
+ */
+enum MtxFormat {
+    kMtxArray = 0,      /**< all the elements column by column. */
+    kMtxCoordinate = 1, /**< the nonzero elements with their 1-based row and
+                           column indices. */
+};
+
+/**
+ * @brief Write a matrix into a Matrix Market (`.mtx`) file of real numbers.
+ *
+ * @details The elements are written column by column by the shortest decimal
+ * representation that is read back exactly.
+ *
+ * @param [in] A: the matrix.
+ * @param [in] fname: the Matrix Market file name.
+ * @param [in] format: see matrix::MtxFormat.
+ * @param [in] symmetric: write the matrix as symmetric, only the lower
+ * triangle including the diagonal is written. \p A must be square.
+ */
+void write_matrix_to_mtx(const Matrix &A, const string &fname,
+                         int format = kMtxArray, bool symmetric = false);
+
+/**
+ * @brief Read a dense matrix from a Matrix Market (`.mtx`) file.
+ *
+ * @details Both the array and the coordinate formats are supported, with
+ * real, integer and pattern (all the values are 1) fields, and general,
+ * symmetric and skew-symmetric matrices. The other triangle of a symmetric
+ * or a skew-symmetric matrix is filled. The elements not in a coordinate file
+ * are 0, and the values of the duplicated entries are summed up. The file
+ * is read in blocks and each block is parsed in parallel, so the text of the
+ * whole file is never held in memory.
+ *
+ * @param [in] fname: the Matrix Market file name.
+ * @return std::shared_ptr<Matrix>: the matrix.
+ */
+std::shared_ptr<Matrix> read_matrix_from_mtx(const string &fname);
+
+/**
+ * @brief Read a sparse matrix from a Matrix Market (`.mtx`) file.
+ *
+ * @details The same files as read_matrix_from_mtx() are supported. Only the
+ * entries in a coordinate file are stored, including the explicit zeros, and
+ * the values of the duplicated entries are summed up.
+ *
+ * @param [in] fname: the Matrix Market file name.
+ * @return std::shared_ptr<SparseMatrix>: the sparse matrix.
+ */
+std::shared_ptr<SparseMatrix> read_sparse_matrix_from_mtx(const string &fname);
+
+/**
+ * @brief Write a matrix into a NumPy `.npy` file.
+ * @details The matrix is stored as a C-order float64 (`<f8`) array of shape
+ * (row, col), and the data is aligned to 64 bytes in the file. It is read by
+ * `numpy.load()` in Python.
+ *
+ * @param [in] A: the matrix.
+ * @param [in] fname: the npy file name.
+ */
+void write_matrix_to_npy(const Matrix &A, const string &fname);
+
+/**
+ * @brief Read a matrix from a NumPy `.npy` file.
+ *
+ * @details The file is mapped into memory copy-on-write. If the array is
+ * made of native float64 in C order, which is the same layout as the matrix,
+ * the matrix accesses the data in the mapping directly and nothing is copied
+ * until it is modified. Otherwise the elements are converted in parallel into
+ * a new matrix. Float (`f4`, `f8`), integer, unsigned integer and bool arrays
+ * of both byte orders and both C and Fortran orders are supported. A 0-d
+ * array is read as a [1, 1] matrix, and a 1-d array of n elements as a
+ * [1, n] matrix.
+ *
+ * @param [in] fname: the npy file name.
+ * @return std::shared_ptr<Matrix>: the matrix.
+ */
+std::shared_ptr<Matrix> read_matrix_from_npy(const string &fname);
+
+/**
+ * @brief Write a vector of matrices into an uncompressed NumPy `.npz` file,
+ * the same as `numpy.savez()`.
+ *
+ * @param [in] Mat: the matrices, each is stored as by
+ * matrix::write_matrix_to_npy().
+ * @param [in] fname: the npz file name.
+ * @param [in] names: names of the matrices, which is either empty or has the
+ * same size as \p Mat. The default names are `arr_0`, `arr_1`, ..., the same
+ * as the positional arguments of `numpy.savez()`.
+ */
+void write_matrices_to_npz(const vector<std::shared_ptr<const Matrix>> &Mat,
+                           const string &fname,
+                           const vector<string> &names = {});
+
+/**
+ * @brief Read the matrices in an uncompressed NumPy `.npz` file written by
+ * `numpy.savez()` or matrix::write_matrices_to_npz().
+ *
+ * @details The matrices are read as by matrix::read_matrix_from_npy(), and
+ * share the mapping of the whole file when they are not converted. The zip
+ * checksums are not verified. Compressed files written by
+ * `numpy.savez_compressed()` are not supported.
+ *
+ * @param [in] fname: the npz file name.
+ * @param [out] names: if not nullptr, the names of the matrices without the
+ * `.npy` suffix.
+ * @return std::vector<std::shared_ptr<Matrix>>: the matrices in the order of
+ * the file.
+ */
+std::vector<std::shared_ptr<Matrix>>
+read_matrices_from_npz(const string &fname, vector<string> *names = nullptr);
+
+/**
+ * @brief Write a factorization into binary file.
+ * @details The factorization is stored as three matrices by
+ * matrix::write_matrices_to_binary(): a [1, 3] matrix with the factorization
+ * type, the triangular label and the 1-norm of the original matrix, then the
+ * factors, and a [1, n] matrix with the pivots.
+ *
+ * @param [in] F: the factorization to be written.
+ * @param [in] fname: the binary file name (relative/absolute path).
+ */
+void write_factorization_to_binary(const Factorization &F, const char *fname);
+
+/**
+ * @brief Read a factorization from binary file generated by
+ * matrix::write_factorization_to_binary().
+ *
+ * @param [in] fname: the binary file name (relative/absolute path).
+ * @return std::shared_ptr<Factorization>: the factorization.
+ * @see matrix::write_factorization_to_binary()
+ */
+std::shared_ptr<Factorization> read_factorization_from_binary(const char *fname);
+
+/**
+ * @brief Write a sparse matrix into binary file.
+ * @details The file has a header of the magic string `MTXCSR`, padded to 8
+ * bytes, and the 64-bit row, col and nnz, followed by the CSR arrays:
+ * row_ptr with row + 1 64-bit integers, col_index with nnz 64-bit integers
+ * and values with nnz doubles.
+ *
+ * @param [in] A: the sparse matrix to be written.
+ * @param [in] fname: the binary file name (relative/absolute path).
+ */
+void write_sparse_matrix_to_binary(const SparseMatrix &A, const char *fname);
+
+/**
+ * @brief Read a sparse matrix from binary file generated by
+ * matrix::write_sparse_matrix_to_binary().
+ *
+ * @param [in] fname: the binary file name (relative/absolute path).
+ * @return std::shared_ptr<SparseMatrix>: the sparse matrix.
+ * @see matrix::write_sparse_matrix_to_binary()
+ */
+std::shared_ptr<SparseMatrix>
+read_sparse_matrix_from_binary(const char *fname);
+
 } // namespace matrix
 
 #endif // _MATRIX_SRC_MATRIX_IO_H_
@@ -0,0 +1,216 @@
+/**
+ * @file matrix_stream.h
+ * @brief declaration of the streaming reader and the asynchronous writer of
+ * binary matrix files.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_MATRIX_STREAM_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_MATRIX_STREAM_H_
+
+#include "container.h"
+#include "matrix.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Read the matrices in a binary file one at a time, with read-ahead
+ * on a background thread.
+ *
+ * @details Both the files written by matrix::write_matrices_to_binary() and
+ * the version 2 containers written by matrix::ContainerWriter are supported.
+ * The matrices are read in order into a fixed number of reusable buffers: one
+ * for the matrix returned by next(), and the others for the matrices read
+ * ahead while it is processed. The memory used is bounded by the number of
+ * buffers times the size of the largest matrix, independent of the file
+ * size.
+ *
+ * @code
+ * MatrixStreamReader stream("data.bin");
+ * while (Matrix *A = stream.next()) {
+ *     process(*A);
+ * }
+ * @endcode
+ */
+class MatrixStreamReader {
+  public:
+    /**
+     * @brief Open a binary matrix file and start reading ahead.
+     *
+     * @param [in] fname: the binary file name.
+     * @param [in] buffers: number of matrix buffers, at least 2.
+     */
+    explicit MatrixStreamReader(const string &fname, size_t buffers = 2);
+
+    /**
+     * @brief Stop reading ahead and close the file.
+     */
+    ~MatrixStreamReader();
+
+    MatrixStreamReader(const MatrixStreamReader &) = delete;
+    MatrixStreamReader &operator=(const MatrixStreamReader &) = delete;
+
+    /**
+     * @brief Get the next matrix in the file.
+     *
+     * @return Matrix *: the next matrix, or nullptr at the end of the file.
+     * The matrix is stored in a buffer of the reader, and it is valid until
+     * the next call of next(). It can be modified or copied.
+     *
+     * @note An exception raised by the background read is thrown by the call
+     * that would return the failed matrix.
+     */
+    Matrix *next();
+
+    /**
+     * @brief Get the number of matrices returned by next() so far.
+     */
+    size_t count() const { return count_; }
+
+  private:
+    /**
+     * @brief A buffer that holds one matrix.
+     */
+    struct Slot {
+        vector<double> data;
+        vector<char> buffer; /* the encoded data in a container. */
+        std::unique_ptr<Matrix> matrix;
+    };
+
+    void read_ahead();
+    bool read_matrix(Slot &slot);
+
+    string fname_;
+    int fd_;
+    /* the matrices in a container are read by index, otherwise in order. */
+    bool is_container_;
+    uint64_t offset_; /* offset of the next matrix in a plain file. */
+    size_t next_index_;
+    vector<ContainerEntry> entries_;
+
+    vector<Slot> slots_;
+    size_t head_;   /* the slot of the matrix returned by next(). */
+    size_t filled_; /* number of slots read, including the returned one. */
+    bool holding_;  /* if the head slot is returned by next(). */
+    bool finished_; /* if the background read is finished. */
+    bool stop_;     /* request to stop the background read. */
+    std::exception_ptr error_;
+    size_t count_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+
+/**
+ * @brief Write matrices into a binary file on a background thread.
+ *
+ * @details The file has the same format as the one written by
+ * matrix::write_matrices_to_binary(). A matrix passed by reference is copied
+ * into one of a fixed number of reusable buffers, and the call returns as
+ * soon as the copy is done, while the buffers queued before are written by
+ * the background thread. The matrices queued at the same time are written
+ * together by a single vectored write. A matrix passed by a shared pointer is
+ * written without a copy. Use flush() as a barrier to wait for the queued
+ * matrices.
+ *
+ * @code
+ * MatrixStreamWriter writer("checkpoint.bin");
+ * writer.write(A);
+ * writer.write(B);
+ * // computation overlapped with the write ...
+ * writer.close();
+ * @endcode
+ */
+class MatrixStreamWriter {
+  public:
+    /**
+     * @brief Create a binary matrix file and start the background writer.
+     * An existing file is overwritten.
+     *
+     * @param [in] fname: the binary file name.
+     * @param [in] buffers: number of snapshot buffers, at least 2.
+     */
+    explicit MatrixStreamWriter(const string &fname, size_t buffers = 2);
+
+    /**
+     * @brief Close the file if close() is not called. Errors are ignored,
+     * call close() to handle them.
+     */
+    ~MatrixStreamWriter();
+
+    MatrixStreamWriter(const MatrixStreamWriter &) = delete;
+    MatrixStreamWriter &operator=(const MatrixStreamWriter &) = delete;
+
+    /**
+     * @brief Queue a snapshot of a matrix to be written. The matrix can be
+     * modified as soon as the call returns.
+     *
+     * @param [in] A: the matrix.
+     * @note The call waits for a free buffer if all the buffers are queued.
+     */
+    void write(const Matrix &A);
+
+    /**
+     * @brief Queue a matrix to be written without copying it. The matrix
+     * must not be modified before it is written, see flush().
+     *
+     * @param [in] A: the matrix, which is kept alive until it is written.
+     */
+    void write(std::shared_ptr<const Matrix> A);
+
+    /**
+     * @brief Wait until all the queued matrices are written to the file.
+     *
+     * @param [in] sync: also flush the file data to the storage device.
+     * @note An exception raised by the background write is thrown by this
+     * call, and the following calls of write() also throw.
+     */
+    void flush(bool sync = false);
+
+    /**
+     * @brief Write all the queued matrices and close the file.
+     */
+    void close();
+
+  private:
+    /**
+     * @brief A queued matrix.
+     */
+    struct Job {
+        size_t header[2];                    /* the row and the column. */
+        const double *data;                  /* the matrix data. */
+        size_t buffer;                       /* the snapshot buffer. */
+        std::shared_ptr<const Matrix> owner; /* the matrix written in place. */
+    };
+
+    void write_behind();
+    void write_batch(vector<Job> &batch);
+    void push(Job &job);
+
+    string fname_;
+    int fd_;
+    uint64_t offset_;
+
+    vector<vector<double>> buffers_;
+    vector<size_t> free_; /* indices of the free snapshot buffers. */
+    std::deque<Job> queue_;
+    bool writing_; /* if a batch is being written. */
+    bool stop_;    /* request to stop the background write. */
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_MATRIX_STREAM_H_
@@ -0,0 +1,117 @@
+/**
+ * @file shared_memory.h
+ * @brief declaration of the POSIX shared-memory store of matrices.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_SHARED_MEMORY_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_SHARED_MEMORY_H_
+
+#include "matrix.h"
+#include <memory>
+#include <string>
+
+namespace matrix {
+
+using std::string;
+
+/**
+ * @brief Named matrices in POSIX shared memory, which are shared between the
+ * processes on a node without copy.
+ *
+ * @details Each matrix is published to its own segment
+ * `/<prefix>.<name>` created by `shm_open`, with a header page followed by
+ * the matrix data in row-wise order. A process attaches to a published matrix
+ * by mapping the data of the segment read-only, and the returned matrix
+ * refers to the mapped memory as its external storage (see
+ * Matrix::is_data_stored_outside()), so all the processes share one physical
+ * copy of the data.
+ *
+ * The header keeps the number of the references to the matrix from all the
+ * processes. Each matrix returned by publish() or attach() holds one
+ * reference, which is released when the matrix is destroyed. The segment of
+ * a non-persistent matrix is unlinked when its last reference is released,
+ * and attaching to it fails from then on. A persistent matrix lives until
+ * remove() is called, or the system is rebooted.
+ *
+ * @code
+ * // the master process.
+ * SharedMatrixStore store("job42");
+ * auto F = store.publish("fock", fock);
+ * spawn_workers();
+ * wait_workers();
+ *
+ * // a worker process.
+ * auto F = SharedMatrixStore("job42").attach("fock");
+ * @endcode
+ *
+ * @note The reference count of a process that exits without destroying its
+ * matrices, e.g. by a crash, is never released. Use remove() to clean up the
+ * segment in this case.
+ */
+class SharedMatrixStore {
+  public:
+    /**
+     * @brief Construct a store.
+     *
+     * @param [in] prefix: prefix of the segment names, which is shared by
+     * the processes using the same matrices. It must not contain '/'.
+     */
+    explicit SharedMatrixStore(const string &prefix);
+
+    /**
+     * @brief Copy a matrix to a new segment.
+     *
+     * @param [in] name: name of the matrix. It must not contain '/'.
+     * @param [in] A: the matrix.
+     * @param [in] persistent: keep the segment after the last reference is
+     * released.
+     * @return std::shared_ptr<const Matrix>: the published matrix, which
+     * holds one reference.
+     *
+     * @note An exception is thrown if the name is already published.
+     */
+    std::shared_ptr<const Matrix> publish(const string &name, const Matrix &A,
+                                          bool persistent = false) const;
+
+    /**
+     * @brief Attach to a published matrix.
+     *
+     * @param [in] name: name of the matrix.
+     * @return std::shared_ptr<const Matrix>: the matrix on the shared memory,
+     * which holds one reference.
+     */
+    std::shared_ptr<const Matrix> attach(const string &name) const;
+
+    /**
+     * @brief Check if a matrix is published and can be attached to.
+     */
+    bool contains(const string &name) const;
+
+    /**
+     * @brief Get the number of the references to a published matrix from all
+     * the processes, which is 0 if the matrix is not published.
+     */
+    size_t ref_count(const string &name) const;
+
+    /**
+     * @brief Unlink the segment of a matrix. The attached matrices stay
+     * valid, and the memory is freed when all of them are destroyed.
+     *
+     * @return bool: true if the segment is unlinked, false if it does not
+     * exist.
+     */
+    bool remove(const string &name) const;
+
+    /**
+     * @brief Get the prefix of the segment names.
+     */
+    const string &prefix() const { return prefix_; }
+
+  private:
+    string segment_name(const string &name) const;
+
+    string prefix_;
+};
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_SHARED_MEMORY_H_
@@ -0,0 +1,172 @@
+/**
+ * @file sparse_matrix.h
+ * @brief declaration of the sparse matrix in compressed sparse row (CSR)
+ * storage.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_SPARSE_MATRIX_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_SPARSE_MATRIX_H_
+
+#include "matrix.h"
+#include <vector>
+
+namespace matrix {
+
+using std::vector;
+
+/**
+ * @brief Sparse matrix in compressed sparse row (CSR) storage.
+ *
+ * @details The nonzero elements are stored row by row. The column indices
+ * and the values of the elements in row i are
+ * `col_index()[k]` and `values()[k]` for k in
+ * [`row_ptr()[i]`, `row_ptr()[i + 1]`), and the column indices in a row are
+ * strictly increasing. The memory and the cost of the products scale with
+ * the number of the nonzero elements instead of row * col.
+ */
+class SparseMatrix {
+  public:
+    /**
+     * @brief Construct a sparse matrix with all the elements being zero.
+     *
+     * @param [in] row: number of rows.
+     * @param [in] col: number of columns.
+     */
+    explicit SparseMatrix(size_t row = 0, size_t col = 0);
+
+    /**
+     * @brief Construct a sparse matrix from the CSR arrays.
+     *
+     * @param [in] row: number of rows.
+     * @param [in] col: number of columns.
+     * @param [in] row_ptr: offsets of the rows, with row + 1 elements.
+     * @param [in] col_index: column indices of the elements, strictly
+     * increasing in each row.
+     * @param [in] values: values of the elements.
+     *
+     * @note An exception is thrown if the arrays are not a valid CSR storage.
+     */
+    SparseMatrix(size_t row, size_t col, vector<size_t> row_ptr,
+                 vector<size_t> col_index, vector<double> values);
+
+    /**
+     * @brief Construct a sparse matrix from a dense matrix.
+     *
+     * @param [in] A: the dense matrix.
+     * @param [in] threshold: the elements whose absolute values are not
+     * larger than it are dropped. The elements that are not finite are
+     * always kept.
+     */
+    explicit SparseMatrix(const Matrix &A, double threshold = 0.0);
+
+    /**
+     * @brief Construct a sparse matrix from the elements in the coordinate
+     * format. The elements can be in any order, and the values of the
+     * duplicated elements are summed up.
+     *
+     * @param [in] row: number of rows.
+     * @param [in] col: number of columns.
+     * @param [in] rows: row indices of the elements.
+     * @param [in] cols: column indices of the elements.
+     * @param [in] values: values of the elements.
+     * @return SparseMatrix
+     */
+    static SparseMatrix from_triplets(size_t row, size_t col,
+                                      const vector<size_t> &rows,
+                                      const vector<size_t> &cols,
+                                      const vector<double> &values);
+
+    /**
+     * @brief Get the dense matrix.
+     * @return Matrix
+     */
+    Matrix to_matrix() const;
+
+    /**
+     * @brief Get the transpose of the matrix, which is also the CSC storage
+     * of the matrix.
+     * @return SparseMatrix
+     */
+    SparseMatrix transpose() const;
+
+    /**
+     * @brief Get the element (i, j), which is zero if it is not stored.
+     */
+    double operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Get the number of rows.
+     */
+    size_t row() const { return row_; }
+
+    /**
+     * @brief Get the number of columns.
+     */
+    size_t col() const { return col_; }
+
+    /**
+     * @brief Get the number of the stored elements.
+     */
+    size_t nnz() const { return values_.size(); }
+
+    /**
+     * @brief Get the offsets of the rows.
+     */
+    const vector<size_t> &row_ptr() const { return row_ptr_; }
+
+    /**
+     * @brief Get the column indices of the stored elements.
+     */
+    const vector<size_t> &col_index() const { return col_index_; }
+
+    /**
+     * @brief Get the values of the stored elements, which can be changed in
+     * place.
+     */
+    vector<double> &values() { return values_; }
+    const vector<double> &values() const { return values_; }
+
+  private:
+    size_t row_;
+    size_t col_;
+    vector<size_t> row_ptr_;
+    vector<size_t> col_index_;
+    vector<double> values_;
+};
+
+/**
+ * @brief Sparse matrix-vector product.
+ *
+ * @par Purpose
+ * calculate y = alpha * A * x + beta * y.
+ *
+ * @param [in] alpha: scalar coefficient on A * x.
+ * @param [in] A: the sparse matrix.
+ * @param [in] x: vector x with A.col() elements.
+ * @param [in] beta: scalar coefficient on y. y is not read if it is 0.
+ * @param [in, out] y: vector y with A.row() elements.
+ * @return int: 0 for success, and others for failure.
+ *
+ * @note Use SparseMatrix::transpose() for A^T * x.
+ */
+int mult_spmv(const double alpha, const SparseMatrix &A,
+              const vector<double> &x, const double beta, vector<double> &y);
+
+/**
+ * @brief Sparse-dense matrix product.
+ *
+ * @par Purpose
+ * calculate C = alpha * A * B + beta * C.
+ *
+ * @param [in] alpha: scalar coefficient on A * B.
+ * @param [in] A: the sparse matrix.
+ * @param [in] B: dense matrix B with dimension [A.col(), n].
+ * @param [in] beta: scalar coefficient on C. C is not read if it is 0.
+ * @param [in, out] C: dense matrix C with dimension [A.row(), n].
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_spmm(const double alpha, const SparseMatrix &A, const Matrix &B,
+              const double beta, Matrix &C);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_SPARSE_MATRIX_H_
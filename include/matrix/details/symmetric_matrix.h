@@ -0,0 +1,194 @@
+/**
+ * @file symmetric_matrix.h
+ * @brief declaration of the symmetric matrix in packed storages.
+ */
+#ifndef _MATRIX_INCLUDE_MATRIX_DETAILS_SYMMETRIC_MATRIX_H_
+#define _MATRIX_INCLUDE_MATRIX_DETAILS_SYMMETRIC_MATRIX_H_
+
+#include "matrix.h"
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Real symmetric matrix that stores one triangular part only.
+ *
+ * @details Two lapack storages are supported, both of which need
+ * n * (n + 1) / 2 elements, about half of a full matrix.
+ * - Packed storage: the triangle is packed column by column. It is used by
+ * the `dsp*` and `dpp*` routines of lapack, which are level-2 blas based.
+ * - Rectangular full packed (RFP) storage: the triangle is rearranged into a
+ * rectangular full matrix, so that the `dpf*` routines and `dsfrk` work on
+ * it with level-3 blas at the speed of the full storage.
+ *
+ * The data are stored in the column-wise convention of lapack, and uplo()
+ * labels the triangle being stored. The element (i, j) and (j, i) refer to
+ * the same data.
+ */
+class SymmetricMatrix {
+  public:
+    /**
+     * @brief storage types.
+     */
+    enum Storage {
+        kPacked, /**< packed storage. */
+        kRFP,    /**< rectangular full packed storage, with TRANSR = 'N'. */
+    };
+
+    /**
+     * @brief Construct a symmetric matrix with uninitialized elements.
+     *
+     * @param [in] n: dimension of the matrix.
+     * @param [in] storage: storage type.
+     */
+    explicit SymmetricMatrix(size_t n = 0, Storage storage = kRFP);
+
+    /**
+     * @brief Construct a symmetric matrix from a square matrix.
+     *
+     * @param [in] A: the square matrix.
+     * @param [in] storage: storage type.
+     * @param [in] uplo: "U": only the upper triangular of \p A is referred.\n
+     * "L": only the lower triangular of \p A is referred.
+     */
+    SymmetricMatrix(const Matrix &A, Storage storage = kRFP,
+                    const string &uplo = "L");
+
+    /**
+     * @brief Get the full matrix with both triangular parts.
+     * @return Matrix
+     */
+    Matrix to_matrix() const;
+
+    /**
+     * @brief Get a copy of the matrix in another storage.
+     *
+     * @param [in] storage: storage type of the copy.
+     * @return SymmetricMatrix
+     */
+    SymmetricMatrix to_storage(Storage storage) const;
+
+    /**
+     * @brief Access the element (i, j), which is the same as (j, i).
+     */
+    double &operator()(size_t i, size_t j) { return data_[index(i, j)]; }
+
+    /**
+     * @brief Access the element (i, j), which is the same as (j, i).
+     */
+    double operator()(size_t i, size_t j) const { return data_[index(i, j)]; }
+
+    /**
+     * @brief Set all the elements to a value.
+     */
+    void fill_all(double val);
+
+    /**
+     * @brief Get the dimension of the matrix.
+     */
+    size_t dim() const { return n_; }
+
+    /**
+     * @brief Get the number of the stored elements, which is n * (n + 1) / 2.
+     */
+    size_t size() const { return data_.size(); }
+
+    /**
+     * @brief Get the storage type.
+     */
+    Storage storage() const { return storage_; }
+
+    /**
+     * @brief Get the lapack label of the stored triangle, "U" or "L", in the
+     * column-wise convention.
+     */
+    const string &uplo() const { return uplo_; }
+
+    /**
+     * @brief Get the pointer to the stored data.
+     */
+    double *data() { return data_.data(); }
+
+    /**
+     * @brief Get the pointer to the stored data.
+     */
+    const double *data() const { return data_.data(); }
+
+  private:
+    /**
+     * @brief Get the index of the element (i, j) in the stored data.
+     */
+    size_t index(size_t i, size_t j) const;
+
+    size_t n_;
+    Storage storage_;
+    string uplo_; /* lapack label of the stored triangle. */
+    vector<double> data_;
+};
+
+/**
+ * @brief Invert a real symmetric positive definite (spd) matrix by lapack
+ * `dpftri` for the RFP storage or `dpptri` for the packed storage, which is
+ * based on Cholesky factorization computed by `dpftrf` or `dpptrf`.
+ *
+ * @param [in, out] A: The input spd matrix. On exit, if succeed, it stores
+ * the inverse of the original matrix A.
+ * @return int: 0 for success, and others for failure.
+ */
+int invert_spd_matrix_dpftri(SymmetricMatrix &A);
+
+/**
+ * @brief Solve a real symmetric positive definite (spd) linear system
+ * A * X = B by lapack `dpftrs` for the RFP storage or `dpptrs` for the packed
+ * storage, which is based on Cholesky factorization computed by `dpftrf` or
+ * `dpptrf`.
+ *
+ * @param [in, out] A: The input spd matrix. On exit, it is overwritten by
+ * its Cholesky factor.
+ * @param [in, out] B: The right-hand sides stored column by column, with
+ * dimension [n, nrhs]. On exit, if succeed, it stores the solution X.
+ * @return int: 0 for success, and others for failure.
+ */
+int solve_spd_matrix_dpftrs(SymmetricMatrix &A, Matrix &B);
+
+/**
+ * @brief wrapper of lapack `dsfrk` function for symmetric rank-k update in
+ * the RFP storage.
+ *
+ * @par Purpose
+ * calculate C = alpha * op(A) * op(A)^T + beta * C, where C is symmetric.\n
+ * op(A) = A or op(A) = A^T.
+ *
+ * @param [in] alpha: scalar coefficient on op(A) * op(A)^T.
+ * @param [in] A: matrix A.
+ * @param [in] op_A: operation acting on matrix A, "N" or "T".
+ * @param [in] beta: scalar coefficient on matrix C.
+ * @param [in, out] C: symmetric matrix C. A matrix in the packed storage is
+ * converted to the RFP storage temporarily.
+ * @return int: 0 for success, and others for failure.
+ */
+int mult_dsfrk(const double alpha, const Matrix &A, const string &op_A,
+               const double beta, SymmetricMatrix &C);
+
+/**
+ * @brief Wrapper of lapack `dspevd` function to diagonalize a symmetric
+ * matrix in the packed storage by the divide and conquer algorithm. A matrix
+ * in the RFP storage is converted to the packed storage temporarily.
+ *
+ * @param [in] A: The matrix to be diagonalized.
+ * @param [out] eig: The eigenvalues in ascending order when succeed.
+ * @param [out] Q: The eigenvectors with dimension [n, n]. Each eigenvector
+ * is stored continuously in memory, the same as
+ * diagonalize_sym_matrix_dsyev().
+ * @return int: 0 for success, and others for failure.
+ */
+int diagonalize_sym_matrix_dspevd(const SymmetricMatrix &A,
+                                  vector<double> &eig, Matrix &Q);
+
+} // namespace matrix
+
+#endif // _MATRIX_INCLUDE_MATRIX_DETAILS_SYMMETRIC_MATRIX_H_
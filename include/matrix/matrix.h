@@ -14,9 +14,19 @@
 
 #include "details/matrix.h"
 #include "details/matrix_io.h"
+#include "details/container.h"
+#include "details/matrix_stream.h"
+#include "details/checkpoint.h"
+#include "details/shared_memory.h"
 #include "details/comma_initialize.h"
 #include "details/blas.h"
 #include "details/lapack.h"
+#include "details/factorization.h"
+#include "details/symmetric_matrix.h"
+#include "details/band_matrix.h"
+#include "details/sparse_matrix.h"
+#include "details/block_sparse_matrix.h"
+#include "details/backend.h"
 #include "details/exception.h"
 
 #endif
@@ -0,0 +1,331 @@
+#include <matrix/details/backend.h>
+#include <matrix/details/blas.h>
+#include <matrix/details/exception.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "blas_base.h"
+#include "gemm.h"
+#include "lapack_base.h"
+
+namespace matrix {
+
+namespace backend {
+
+/**
+ * @brief Thread control interface provided by a backend.
+ */
+enum ThreadApi {
+    kNoThreadApi,
+    kOpenBLAS,
+    kMKL,
+    kBLIS,
+};
+
+/**
+ * @brief A blas and lapack backend: the dispatch tables and the thread
+ * control functions.
+ */
+struct Backend {
+    string name;
+    blas::Table blas;
+    lapack::Table lapack;
+    ThreadApi thread_api;
+    void *get_num_threads;
+    void *set_num_threads;
+};
+
+/**
+ * @brief Libraries searched for a named backend.
+ */
+struct Candidate {
+    const char *name;
+    vector<const char *> blas_libs;
+    vector<const char *> lapack_libs;
+};
+
+static const vector<Candidate> &candidates()
+{
+#ifdef MATRIX_BLAS_ILP64
+    // the libraries must use 64-bit integers as well. `libmkl_rt.so` selects
+    // its interface by the environment variable `MKL_INTERFACE_LAYER=ILP64`.
+    static const vector<Candidate> list = {
+        {"openblas",
+         {"libopenblas64.so.0", "libopenblas64.so"},
+         {"libopenblas64.so.0", "libopenblas64.so"}},
+        {"mkl",
+         {"libmkl_rt.so.2", "libmkl_rt.so.1", "libmkl_rt.so"},
+         {"libmkl_rt.so.2", "libmkl_rt.so.1", "libmkl_rt.so"}},
+        {"blis", {"libblis64.so.4", "libblis64.so.3", "libblis64.so"}, {}},
+        {"reference",
+         {"libblas64.so.3", "libblas64.so"},
+         {"liblapack64.so.3", "liblapack64.so"}},
+    };
+#else
+    static const vector<Candidate> list = {
+        {"openblas",
+         {"libopenblas.so.0", "libopenblas.so"},
+         {"libopenblas.so.0", "libopenblas.so"}},
+        {"mkl",
+         {"libmkl_rt.so.2", "libmkl_rt.so.1", "libmkl_rt.so"},
+         {"libmkl_rt.so.2", "libmkl_rt.so.1", "libmkl_rt.so"}},
+        {"blis", {"libblis.so.4", "libblis.so.3", "libblis.so"}, {}},
+        {"reference",
+         {"libblas.so.3", "libblas.so"},
+         {"liblapack.so.3", "liblapack.so"}},
+    };
+#endif
+    return list;
+}
+
+/**
+ * @brief Find the thread control functions in a library handle, or in the
+ * whole process for RTLD_DEFAULT.
+ */
+static void find_thread_api(void *handle, Backend &b)
+{
+    struct ThreadSymbols {
+        ThreadApi api;
+        const char *get;
+        const char *set;
+    };
+    static const ThreadSymbols symbols[] = {
+        {kOpenBLAS, "openblas_get_num_threads", "openblas_set_num_threads"},
+        {kMKL, "MKL_Get_Max_Threads", "MKL_Set_Num_Threads"},
+        {kBLIS, "bli_thread_get_num_threads", "bli_thread_set_num_threads"},
+    };
+    b.thread_api = kNoThreadApi;
+    b.get_num_threads = nullptr;
+    b.set_num_threads = nullptr;
+    for (const auto &s : symbols) {
+        void *get = dlsym(handle, s.get);
+        void *set = dlsym(handle, s.set);
+        if (get != nullptr && set != nullptr) {
+            b.thread_api = s.api;
+            b.get_num_threads = get;
+            b.set_num_threads = set;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief The backend linked at build time.
+ */
+static const Backend &linked_backend()
+{
+    static const Backend linked = []() {
+        Backend b;
+        b.name = "default";
+#define MATRIX_LINK_BLAS(name) b.blas.name = blas::linked::name;
+        MATRIX_BLAS_SYMBOLS(MATRIX_LINK_BLAS)
+#undef MATRIX_LINK_BLAS
+#define MATRIX_LINK_LAPACK(name) b.lapack.name = lapack::linked::name;
+        MATRIX_LAPACK_SYMBOLS(MATRIX_LINK_LAPACK)
+#undef MATRIX_LINK_LAPACK
+        find_thread_api(RTLD_DEFAULT, b);
+        return b;
+    }();
+    return linked;
+}
+
+/**
+ * @brief Open the first library that can be loaded.
+ */
+static void *open_library(const vector<const char *> &libs, string &tried)
+{
+    for (auto lib : libs) {
+        void *handle = dlopen(lib, RTLD_NOW | RTLD_LOCAL);
+        if (handle != nullptr) {
+            return handle;
+        }
+        tried += string(" ") + lib;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Load a symbol into a dispatch table entry, and record its name if
+ * it is missing.
+ */
+template <typename Func>
+static void load_symbol(void *handle, const char *name, Func &func,
+                        string &missing)
+{
+    void *p = dlsym(handle, name);
+    if (p == nullptr) {
+        missing += string(" ") + name;
+    } else {
+        func = reinterpret_cast<Func>(p);
+    }
+}
+
+/**
+ * @brief Load a backend by name or by the path of a shared library.
+ */
+static std::unique_ptr<Backend> load_backend(const string &name)
+{
+    Candidate candidate = {name.c_str(), {name.c_str()}, {name.c_str()}};
+    for (const auto &c : candidates()) {
+        if (name == c.name) {
+            candidate = c;
+        }
+    }
+
+    std::unique_ptr<Backend> b(new Backend(linked_backend()));
+    b->name = name;
+    string tried;
+    void *blas_handle = open_library(candidate.blas_libs, tried);
+    if (blas_handle == nullptr) {
+        throw exception::MatrixException(
+            "Error in matrix::set_blas_backend(): cannot load blas backend " +
+            name + ", tried:" + tried);
+    }
+    string missing;
+#define MATRIX_LOAD_BLAS(name)                                                 \
+    load_symbol(blas_handle, #name, b->blas.name, missing);
+    MATRIX_BLAS_SYMBOLS(MATRIX_LOAD_BLAS)
+#undef MATRIX_LOAD_BLAS
+    if (!missing.empty()) {
+        throw exception::MatrixException(
+            "Error in matrix::set_blas_backend(): blas functions are missing "
+            "in backend " +
+            name + ":" + missing);
+    }
+
+    // backends without lapack, e.g. blis, use the default lapack.
+    if (!candidate.lapack_libs.empty()) {
+        tried.clear();
+        void *lapack_handle = open_library(candidate.lapack_libs, tried);
+        if (lapack_handle == nullptr) {
+            throw exception::MatrixException(
+                "Error in matrix::set_blas_backend(): cannot load lapack "
+                "backend " +
+                name + ", tried:" + tried);
+        }
+#define MATRIX_LOAD_LAPACK(name)                                               \
+    load_symbol(lapack_handle, #name, b->lapack.name, missing);
+        MATRIX_LAPACK_SYMBOLS(MATRIX_LOAD_LAPACK)
+#undef MATRIX_LOAD_LAPACK
+        if (!missing.empty()) {
+            throw exception::MatrixException(
+                "Error in matrix::set_blas_backend(): lapack functions are "
+                "missing in backend " +
+                name + ":" + missing);
+        }
+    }
+    find_thread_api(blas_handle, *b);
+    return b;
+}
+
+/**
+ * @brief Get a backend by name. Backends are loaded once and kept alive, so
+ * that the dispatch tables in use are never released.
+ */
+static const Backend *get_backend(const string &name)
+{
+    static std::mutex mutex;
+    static std::map<string, std::unique_ptr<Backend>> loaded;
+    if (name == "default") {
+        return &linked_backend();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto p = loaded.find(name);
+    if (p == loaded.end()) {
+        p = loaded.emplace(name, load_backend(name)).first;
+    }
+    return p->second.get();
+}
+
+/**
+ * @brief The active backend, initialized by the environment variable
+ * `MATRIX_BLAS_BACKEND` if it is set.
+ */
+static std::atomic<const Backend *> &active_backend()
+{
+    static std::atomic<const Backend *> active([]() {
+        const char *env = std::getenv("MATRIX_BLAS_BACKEND");
+        return get_backend(env != nullptr && *env != '\0' ? env : "default");
+    }());
+    return active;
+}
+
+static const Backend &active()
+{
+    return *active_backend().load(std::memory_order_acquire);
+}
+
+} // namespace backend
+
+namespace blas {
+
+const Table &table()
+{
+    return backend::active().blas;
+}
+
+} // namespace blas
+
+namespace lapack {
+
+const Table &table()
+{
+    return backend::active().lapack;
+}
+
+} // namespace lapack
+
+void set_blas_backend(const string &backend)
+{
+    const backend::Backend *b = backend::get_backend(backend);
+    backend::active_backend().store(b, std::memory_order_release);
+    if (backend != "default") {
+        set_dgemm_engine("blas");
+    } else {
+        gemm::reset_engine();
+    }
+}
+
+string get_blas_backend()
+{
+    return backend::active().name;
+}
+
+int get_blas_num_threads()
+{
+    const backend::Backend &b = backend::active();
+    switch (b.thread_api) {
+    case backend::kOpenBLAS:
+    case backend::kMKL:
+        return reinterpret_cast<int (*)()>(b.get_num_threads)();
+    case backend::kBLIS:
+        return (int)reinterpret_cast<int64_t (*)()>(b.get_num_threads)();
+    default:
+        return 1;
+    }
+}
+
+void set_blas_num_threads(int num_threads)
+{
+    const backend::Backend &b = backend::active();
+    switch (b.thread_api) {
+    case backend::kOpenBLAS:
+    case backend::kMKL:
+        reinterpret_cast<void (*)(int)>(b.set_num_threads)(num_threads);
+        break;
+    case backend::kBLIS:
+        reinterpret_cast<void (*)(int64_t)>(b.set_num_threads)(num_threads);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace matrix
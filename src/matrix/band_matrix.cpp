@@ -0,0 +1,466 @@
+#include <matrix/details/band_matrix.h>
+#include <matrix/details/exception.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include "lapack_base.h"
+#include "lapack_utils.h"
+#include "workspace.h"
+
+namespace matrix {
+
+/**
+ * @brief Throw an exception if a lapack routine reports an illegal argument.
+ */
+static void check_argument(blas_int info, const char *func_name)
+{
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+/**
+ * @brief Check the exit status of a solver based on LU factorization.
+ */
+static void check_singular(blas_int info, const char *func_name)
+{
+    check_argument(info, func_name);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "The (" << info << "," << info
+            << ") element of the factor U is zero, and the solution could "
+               "not be computed.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+/**
+ * @brief Check the exit status of a solver based on Cholesky or L*D*L^T
+ * factorization.
+ */
+static void check_positive_definite(blas_int info, const char *func_name)
+{
+    check_argument(info, func_name);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "The leading minor of order " << info
+            << " is not positive definite, and the solution could not be "
+               "computed.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+static void check_rhs(size_t n, const Matrix &B, const char *func_name)
+{
+    if (n != B.row()) {
+        throw exception::DimensionError(
+            n, B.row(),
+            string("Error in matrix::") + func_name +
+                "(): dimension error between matrix A and B.");
+    }
+}
+
+static void check_square(const Matrix &A, const char *type)
+{
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            string("Cannot convert a non-square matrix to a ") + type +
+            " matrix.");
+    }
+}
+
+BandMatrix::BandMatrix(size_t n, size_t kl, size_t ku)
+    : n_(n), kl_(kl), ku_(ku), data_(ldab() * n, 0.0)
+{
+}
+
+/**
+ * @details The bandwidth is the largest distance to the diagonal of the
+ * elements larger than the threshold or not finite, which is found row by
+ * row in parallel. Each row is only scanned out of the band found so far.
+ */
+BandMatrix::BandMatrix(const Matrix &A, double threshold)
+    : n_(A.row()), kl_(0), ku_(0)
+{
+    check_square(A, "band");
+    const size_t n = n_;
+    size_t kl = 0;
+    size_t ku = 0;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) reduction(max : kl, ku)
+#endif
+    for (size_t i = 0; i < n; i++) {
+        const double *row = A.data() + i * n;
+        for (size_t j = 0; j + kl < i; j++) {
+            if (!(std::fabs(row[j]) <= threshold)) {
+                kl = i - j;
+                break;
+            }
+        }
+        for (size_t j = n - 1; j > i + ku; j--) {
+            if (!(std::fabs(row[j]) <= threshold)) {
+                ku = j - i;
+                break;
+            }
+        }
+    }
+    kl_ = kl;
+    ku_ = ku;
+    copy_band(A);
+}
+
+BandMatrix::BandMatrix(const Matrix &A, size_t kl, size_t ku)
+    : n_(A.row()), kl_(std::min(kl, n_ > 0 ? n_ - 1 : 0)),
+      ku_(std::min(ku, n_ > 0 ? n_ - 1 : 0))
+{
+    check_square(A, "band");
+    copy_band(A);
+}
+
+void BandMatrix::copy_band(const Matrix &A)
+{
+    data_.assign(ldab() * n_, 0.0);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t j = 0; j < n_; j++) {
+        const size_t last = std::min(n_ - 1, j + kl_);
+        for (size_t i = j > ku_ ? j - ku_ : 0; i <= last; i++) {
+            data_[index(i, j)] = A(i, j);
+        }
+    }
+}
+
+Matrix BandMatrix::to_matrix() const
+{
+    Matrix A(n_, n_);
+    A.fill_all(0.0);
+    for (size_t j = 0; j < n_; j++) {
+        const size_t last = std::min(n_ - 1, j + kl_);
+        for (size_t i = j > ku_ ? j - ku_ : 0; i <= last; i++) {
+            A(i, j) = data_[index(i, j)];
+        }
+    }
+    return A;
+}
+
+double &BandMatrix::operator()(size_t i, size_t j)
+{
+    if (!is_in_band(i, j)) {
+        std::stringstream msg;
+        msg << "Error in matrix::BandMatrix::operator(): element (" << i
+            << ", " << j << ") is out of the band.";
+        throw exception::MatrixException(msg.str());
+    }
+    return data_[index(i, j)];
+}
+
+TridiagonalMatrix::TridiagonalMatrix(size_t n)
+    : dl_(n > 0 ? n - 1 : 0, 0.0), d_(n, 0.0), du_(n > 0 ? n - 1 : 0, 0.0)
+{
+}
+
+TridiagonalMatrix::TridiagonalMatrix(const Matrix &A, double threshold)
+    : TridiagonalMatrix(A.row())
+{
+    check_square(A, "tridiagonal");
+    const size_t n = A.row();
+    bool outside = false;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(|| : outside)
+#endif
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if ((i > j + 1 || j > i + 1) &&
+                !(std::fabs(A(i, j)) <= threshold)) {
+                outside = true;
+            }
+        }
+    }
+    if (outside) {
+        throw exception::MatrixException(
+            "Cannot convert a matrix to a tridiagonal matrix: elements out of "
+            "the three diagonals are larger than the threshold.");
+    }
+    for (size_t i = 0; i < n; i++) {
+        d_[i] = A(i, i);
+        if (i + 1 < n) {
+            dl_[i] = A(i + 1, i);
+            du_[i] = A(i, i + 1);
+        }
+    }
+}
+
+Matrix TridiagonalMatrix::to_matrix() const
+{
+    const size_t n = dim();
+    Matrix A(n, n);
+    A.fill_all(0.0);
+    for (size_t i = 0; i < n; i++) {
+        A(i, i) = d_[i];
+        if (i + 1 < n) {
+            A(i + 1, i) = dl_[i];
+            A(i, i + 1) = du_[i];
+        }
+    }
+    return A;
+}
+
+double TridiagonalMatrix::operator()(size_t i, size_t j) const
+{
+    if (i == j) {
+        return d_[i];
+    } else if (i == j + 1) {
+        return dl_[j];
+    } else if (j == i + 1) {
+        return du_[i];
+    }
+    return 0.0;
+}
+
+int solve_band_matrix_dgbsv(BandMatrix &A, Matrix &B)
+{
+    check_rhs(A.dim(), B, "solve_band_matrix_dgbsv");
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int kl = to_blas_int(A.kl());
+    blas_int ku = to_blas_int(A.ku());
+    blas_int ldab = to_blas_int(A.ldab());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    blas_int *ipiv = workspace::LapackWorkspace::local().iwork(n);
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dgbsv_(&n, &kl, &ku, &nrhs, A.data(), &ldab, ipiv, b, &n, &info);
+    check_singular(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+int factorize_band_matrix_dgbtrf(BandMatrix &A, vector<int> &ipiv)
+{
+    ipiv.assign(A.dim(), 0);
+    if (A.dim() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int kl = to_blas_int(A.kl());
+    blas_int ku = to_blas_int(A.ku());
+    blas_int ldab = to_blas_int(A.ldab());
+    blas_int info = 0;
+    vector<blas_int> pivots;
+    lapack::dgbtrf_(&n, &n, &kl, &ku, A.data(), &ldab,
+                    blas_pivots(ipiv, pivots), &info);
+    restore_pivots(pivots, ipiv);
+    check_singular(info, __FUNCTION__);
+    return 0;
+}
+
+int solve_band_matrix_dgbtrs(const BandMatrix &A, const vector<int> &ipiv,
+                             Matrix &B)
+{
+    check_rhs(A.dim(), B, "solve_band_matrix_dgbtrs");
+    if (ipiv.size() != A.dim()) {
+        throw exception::DimensionError(
+            A.dim(), ipiv.size(),
+            "Error in matrix::solve_band_matrix_dgbtrs(): dimension error "
+            "between the factors and the pivots.");
+    }
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int kl = to_blas_int(A.kl());
+    blas_int ku = to_blas_int(A.ku());
+    blas_int ldab = to_blas_int(A.ldab());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<blas_int> pivots;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dgbtrs_("N", &n, &kl, &ku, &nrhs, A.data(), &ldab,
+                    blas_pivots(ipiv, pivots), b, &n, &info);
+    check_argument(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+/**
+ * @details The upper triangular part of the band is copied to the storage of
+ * `dpbsv` with kd + 1 rows, so that \p A is kept unchanged.
+ */
+int solve_spd_band_matrix_dpbsv(const BandMatrix &A, Matrix &B)
+{
+    check_rhs(A.dim(), B, "solve_spd_band_matrix_dpbsv");
+    if (A.kl() != A.ku()) {
+        throw exception::MatrixException(
+            "Error in matrix::solve_spd_band_matrix_dpbsv(): the band of a "
+            "symmetric matrix must have kl == ku.");
+    }
+    if (B.size() == 0) {
+        return 0;
+    }
+    const size_t kd = A.ku();
+    const size_t ld = kd + 1;
+    vector<double> ab(ld * A.dim());
+    for (size_t j = 0; j < A.dim(); j++) {
+        for (size_t i = j > kd ? j - kd : 0; i <= j; i++) {
+            ab[kd + i - j + j * ld] = A(i, j);
+        }
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int bkd = to_blas_int(kd);
+    blas_int ldab = to_blas_int(ld);
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dpbsv_("U", &n, &bkd, &nrhs, ab.data(), &ldab, b, &n, &info);
+    check_positive_definite(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+int solve_tridiagonal_matrix_dgtsv(TridiagonalMatrix &A, Matrix &B)
+{
+    check_rhs(A.dim(), B, "solve_tridiagonal_matrix_dgtsv");
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dgtsv_(&n, &nrhs, A.lower().data(), A.diag().data(),
+                   A.upper().data(), b, &n, &info);
+    check_singular(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+int solve_spd_tridiagonal_matrix_dptsv(TridiagonalMatrix &A, Matrix &B)
+{
+    check_rhs(A.dim(), B, "solve_spd_tridiagonal_matrix_dptsv");
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(A.dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dptsv_(&n, &nrhs, A.diag().data(), A.lower().data(), b, &n,
+                   &info);
+    check_positive_definite(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+/**
+ * @note The eigenvectors are the columns of the column-wise matrix Z from
+ * lapack, which are the rows of the row-wise matrix Q.
+ */
+int diagonalize_sym_tridiagonal_matrix_dstevr(const TridiagonalMatrix &A,
+                                              vector<double> &eig, Matrix &Q)
+{
+    const size_t dim = A.dim();
+    if (dim > eig.size()) {
+        string msg{"Fail to diagonalize a symmetric matrix: eigenvector size "
+                   "is too small."};
+        throw exception::DimensionError(dim, eig.size(), msg);
+    }
+    if (Q.row() != dim || Q.col() != dim) {
+        Q.resize(dim, dim);
+    }
+    if (dim == 0) {
+        return 0;
+    }
+
+    // dstevr overwrites the diagonals.
+    vector<double> d = A.diag();
+    vector<double> e(dim);
+    std::copy(A.lower().begin(), A.lower().end(), e.begin());
+    vector<blas_int> isuppz(2 * dim);
+    blas_int n = to_blas_int(dim);
+    blas_int lwork = 20 * n;
+    blas_int liwork = 10 * n;
+    auto &ws = workspace::LapackWorkspace::local();
+    double *work = ws.work(lwork);
+    blas_int *iwork = ws.iwork(liwork);
+    const double vl = 0.0;
+    const double vu = 0.0;
+    const double abstol = 0.0;
+    blas_int m = 0;
+    blas_int info = 0;
+    lapack::dstevr_("V", "A", &n, d.data(), e.data(), &vl, &vu, blas::ione,
+                    &n, &abstol, &m, eig.data(), Q.data(), &n, isuppz.data(),
+                    work, &lwork, iwork, &liwork, &info);
+    if (info > 0) {
+        throw exception::MatrixOperationError(__FUNCTION__,
+                                              "internal error in dstevr");
+    }
+    check_argument(info, __FUNCTION__);
+    return 0;
+}
+
+/**
+ * @note The eigenvectors are the columns of the column-wise matrix Z from
+ * lapack, which are the rows of the row-wise matrix Q.
+ */
+int diagonalize_sym_tridiagonal_matrix_dstemr(const TridiagonalMatrix &A,
+                                              size_t first, size_t last,
+                                              vector<double> &eig, Matrix &Q)
+{
+    const size_t dim = A.dim();
+    if (first > last || last >= dim) {
+        std::stringstream msg;
+        msg << "Error in matrix::diagonalize_sym_tridiagonal_matrix_dstemr(): "
+            << "invalid range of the eigenvalues [" << first << ", " << last
+            << "] for dimension " << dim << ".";
+        throw exception::MatrixException(msg.str());
+    }
+    const size_t count = last - first + 1;
+    if (Q.row() != count || Q.col() != dim) {
+        Q.resize(count, dim);
+    }
+
+    // dstemr overwrites the diagonals, and uses e[n - 1] as workspace.
+    vector<double> d = A.diag();
+    vector<double> e(dim);
+    std::copy(A.lower().begin(), A.lower().end(), e.begin());
+    vector<double> w(dim);
+    vector<blas_int> isuppz(2 * count);
+    blas_int n = to_blas_int(dim);
+    blas_int il = to_blas_int(first + 1);
+    blas_int iu = to_blas_int(last + 1);
+    blas_int nzc = to_blas_int(count);
+    blas_int tryrac = 1;
+    blas_int lwork = 18 * n;
+    blas_int liwork = 10 * n;
+    auto &ws = workspace::LapackWorkspace::local();
+    double *work = ws.work(lwork);
+    blas_int *iwork = ws.iwork(liwork);
+    const double vl = 0.0;
+    const double vu = 0.0;
+    blas_int m = 0;
+    blas_int info = 0;
+    lapack::dstemr_("V", "I", &n, d.data(), e.data(), &vl, &vu, &il, &iu, &m,
+                    w.data(), Q.data(), &n, &nzc, isuppz.data(), &tryrac, work,
+                    &lwork, iwork, &liwork, &info);
+    if (info > 0) {
+        throw exception::MatrixOperationError(__FUNCTION__,
+                                              "internal error in dstemr");
+    }
+    check_argument(info, __FUNCTION__);
+    eig.assign(w.begin(), w.begin() + m);
+    return 0;
+}
+
+} // namespace matrix
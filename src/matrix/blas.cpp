@@ -1,9 +1,11 @@
 #include <matrix/details/blas.h>
 #include <matrix/details/exception.h>
 #include <matrix/details/matrix.h>
+#include <algorithm>
 #include <string>
 
 #include "blas_base.h"
+#include "gemm.h"
 
 namespace matrix {
 
@@ -26,9 +28,9 @@ static int mult_dgemm_NN(double alpha, const Matrix &A, const Matrix &B,
     // B: N x K
     // AB: M x K
     // BT AT: K x M
-    int M = A.row();
-    int N = A.col();
-    int K = B.col();
+    blas_int M = to_blas_int(A.row());
+    blas_int N = to_blas_int(A.col());
+    blas_int K = to_blas_int(B.col());
     // dimension check.
     if (N != B.row()) {
         // dimension check for A and B:
@@ -44,7 +46,7 @@ static int mult_dgemm_NN(double alpha, const Matrix &A, const Matrix &B,
     }
     // calculate (AB)^T=(B^T A^T) by dgemm to get (AB) stored in row-wise
     // matrix.
-    blas::dgemm_("N", "N", &K, &M, &N, &alpha, B.data(), &K, A.data(), &N,
+    gemm::dgemm("N", "N", &K, &M, &N, &alpha, B.data(), &K, A.data(), &N,
                  &beta, C.data(), &K);
     return 0;
 }
@@ -66,9 +68,9 @@ static int mult_dgemm_TT(double alpha, const Matrix &A, const Matrix &B,
     // B: K x M
     // A^T B^T: N x K
     // BA: K x N
-    int M = A.row();
-    int N = A.col();
-    int K = B.row();
+    blas_int M = to_blas_int(A.row());
+    blas_int N = to_blas_int(A.col());
+    blas_int K = to_blas_int(B.row());
     if (M != B.col()) {
         // dimension check for A and B:
         throw exception::DimensionError(
@@ -82,7 +84,7 @@ static int mult_dgemm_TT(double alpha, const Matrix &A, const Matrix &B,
             "(A^T B^T) and C.");
     }
     // calculate BA by dgemm to get (A^T B^T) stored in row-wise matrix.
-    blas::dgemm_("T", "T", &K, &N, &M, &alpha, B.data(), &M, A.data(), &N,
+    gemm::dgemm("T", "T", &K, &N, &M, &alpha, B.data(), &M, A.data(), &N,
                  &beta, C.data(), &K);
     return 0;
 }
@@ -104,9 +106,9 @@ static int mult_dgemm_NT(double alpha, const Matrix &A, const Matrix &B,
     // B: K x N
     // A B^T: M x K
     // B A^T: K x M
-    int M = A.row();
-    int N = A.col();
-    int K = B.row();
+    blas_int M = to_blas_int(A.row());
+    blas_int N = to_blas_int(A.col());
+    blas_int K = to_blas_int(B.row());
     if (N != B.col()) {
         // dimension check for A and B:
         throw exception::DimensionError(
@@ -120,7 +122,7 @@ static int mult_dgemm_NT(double alpha, const Matrix &A, const Matrix &B,
             "(A B^T) and C.");
     }
     // calculate B A^T by dgemm to get (A B^T) stored in row-wise matrix.
-    blas::dgemm_("T", "N", &K, &M, &N, &alpha, B.data(), &N, A.data(), &N,
+    gemm::dgemm("T", "N", &K, &M, &N, &alpha, B.data(), &N, A.data(), &N,
                  &beta, C.data(), &K);
     return 0;
 }
@@ -141,9 +143,9 @@ static int mult_dgemm_TN(double alpha, const Matrix &A, const Matrix &B,
     // B: M x K
     // A^T B: N x K
     // B^T A: K x N
-    int M = A.row();
-    int N = A.col();
-    int K = B.col();
+    blas_int M = to_blas_int(A.row());
+    blas_int N = to_blas_int(A.col());
+    blas_int K = to_blas_int(B.col());
     if (M != B.row()) {
         // dimension check for A and B:
         throw exception::DimensionError(
@@ -157,7 +159,7 @@ static int mult_dgemm_TN(double alpha, const Matrix &A, const Matrix &B,
             "(A^T B) and C.");
     }
     // calculate B^T A by dgemm to get (A B^T) stored in row-wise matrix.
-    blas::dgemm_("N", "T", &K, &N, &M, &alpha, B.data(), &K, A.data(), &N,
+    gemm::dgemm("N", "T", &K, &N, &M, &alpha, B.data(), &K, A.data(), &N,
                  &beta, C.data(), &K);
     return 0;
 }
@@ -187,35 +189,544 @@ int mult_dgemm(const double alpha, const Matrix &A, const string &op_A,
 }
 
 /**
- * @note It will throw an exception when the output matrix `C` is either `A` or
- * `B` matrix.
+ * @brief Get the buffer used for the intermediate product of three matrix
+ * multiplication.
+ *
+ * @param [in] scratch: buffer supplied by the caller, or nullptr.
+ * @param [in] local: buffer used when \p scratch is nullptr.
+ * @param [in] row: number of rows of the intermediate product.
+ * @param [in] col: number of columns of the intermediate product.
+ * @return Matrix &: the buffer with dimension [row, col].
+ */
+static Matrix &get_scratch(Matrix *scratch, Matrix &local, size_t row,
+                           size_t col)
+{
+    Matrix &buf = (scratch == nullptr ? local : *scratch);
+    if (buf.row() != row || buf.col() != col) {
+        buf.resize(row, col);
+    }
+    return buf;
+}
+
+/**
+ * @brief Check that the output and the scratch matrix of three matrix
+ * multiplication are not any of the input matrices.
  */
-int mult_dgemm_ABAT(const Matrix &A, const Matrix &B, Matrix &C)
+static void check_triple_product_alias(const char *func_name, const Matrix &A,
+                                       const Matrix &B, const Matrix &C,
+                                       const Matrix *scratch)
 {
     if (&C == &A || &C == &B) {
+        throw exception::MatrixException(string("Error in matrix::") +
+                                         func_name +
+                                         "(): output matrix is one of the "
+                                         "input matrix.");
+    }
+    if (scratch == &A || scratch == &B || scratch == &C) {
         throw exception::MatrixException(
-            "Error in matrix::mult_dgemm_ABAT(): output matrix is one of the "
-            "input matrix.");
+            string("Error in matrix::") + func_name +
+            "(): scratch matrix is one of the input or output matrix.");
     }
-    Matrix AB(A.row(), B.col());
+}
+
+/**
+ * @note It will throw an exception when the output matrix `C` is either `A` or
+ * `B` matrix.
+ */
+int mult_dgemm_ABAT(const Matrix &A, const Matrix &B, Matrix &C,
+                    Matrix *scratch)
+{
+    check_triple_product_alias("mult_dgemm_ABAT", A, B, C, scratch);
+    Matrix local;
+    Matrix &AB = get_scratch(scratch, local, A.row(), B.col());
     mult_dgemm(1.0, A, "N", B, "N", 0.0, AB);
     mult_dgemm(1.0, AB, "N", A, "T", 0.0, C);
+    return 0;
 }
 
 /**
  * @note It will throw an exception when the output matrix `C` is either `A` or
  * `B` matrix.
  */
-int mult_dgemm_ATBA(const Matrix &A, const Matrix &B, Matrix &C)
+int mult_dgemm_ATBA(const Matrix &A, const Matrix &B, Matrix &C,
+                    Matrix *scratch)
+{
+    check_triple_product_alias("mult_dgemm_ATBA", A, B, C, scratch);
+    Matrix local;
+    Matrix &BA = get_scratch(scratch, local, B.row(), A.col());
+    mult_dgemm(1.0, B, "N", A, "N", 0.0, BA);
+    mult_dgemm(1.0, A, "T", BA, "N", 0.0, C);
+    return 0;
+}
+
+/**
+ * @brief Block size used by mult_dgemm_sym_result().
+ */
+static const blas_int kSymResultBlock = 64;
+
+/**
+ * @brief General matrix multiplication whose result is known to be symmetric:
+ * C = X * Y^T (op is "N") or C = X^T * Y (op is "T").
+ *
+ * @details Only the lower triangular part of C is calculated block column by
+ * block column, which saves about half of the flops of `dgemm`, as `dgemmt`
+ * does. The upper triangular part is copied from the lower one on exit.
+ *
+ * @param [in] op: "N" or "T".
+ * @param [in] X: matrix X.
+ * @param [in] Y: matrix Y. It has the same dimension as X.
+ * @param [out] C: the symmetric matrix C.
+ */
+static void mult_dgemm_sym_result(const string &op, const Matrix &X,
+                                  const Matrix &Y, Matrix &C)
+{
+    if (X.row() != Y.row() || X.col() != Y.col()) {
+        throw exception::DimensionError(
+            X, Y,
+            "Error in matrix::mult_dgemm_sym_result(): dimension error "
+            "between matrix X and Y.");
+    }
+    // C: N x N, and the inner dimension is K.
+    const blas_int N = to_blas_int(op == "N" ? X.row() : X.col());
+    const blas_int K = to_blas_int(op == "N" ? X.col() : X.row());
+    if (C.row() != (size_t)N || C.col() != (size_t)N) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dgemm_sym_result(): dimension error of the "
+            "output matrix C.");
+    }
+    if (K == 0) {
+        C.fill_all(0.0);
+        return;
+    }
+    const double one = 1.0;
+    const double zero = 0.0;
+    // The row-wise C(i:N, j:j+nb) is the column-wise block C^T(j:j+nb, i:N)
+    // seen by blas, and C^T = Y * X^T (op is "N") or Y^T * X (op is "T").
+    for (blas_int j = 0; j < N; j += kSymResultBlock) {
+        blas_int nb = std::min(kSymResultBlock, N - j);
+        blas_int nrow = N - j;
+        double *c = C.data() + (size_t)j * N + j;
+        if (op == "N") {
+            const double *y = Y.data() + (size_t)j * K;
+            const double *x = X.data() + (size_t)j * K;
+            gemm::dgemm("T", "N", &nb, &nrow, &K, &one, y, &K, x, &K, &zero,
+                         c, &N);
+        } else {
+            const double *y = Y.data() + j;
+            const double *x = X.data() + j;
+            gemm::dgemm("N", "T", &nb, &nrow, &K, &one, y, &N, x, &N, &zero,
+                         c, &N);
+        }
+    }
+    C.to_symmetric("L");
+}
+
+/**
+ * @note B * A is calculated as A^T * B by `dsymm`, and the symmetric result
+ * is calculated by half.
+ */
+int mult_dsymm_ABAT(const string &uplo, const Matrix &A, const Matrix &B,
+                    Matrix &C, Matrix *scratch)
+{
+    check_triple_product_alias("mult_dsymm_ABAT", A, B, C, scratch);
+    Matrix local;
+    Matrix &AB = get_scratch(scratch, local, A.row(), B.col());
+    mult_dsymm("R", uplo, 1.0, B, A, 0.0, AB);
+    mult_dgemm_sym_result("N", AB, A, C);
+    return 0;
+}
+
+/**
+ * @note The symmetric result is calculated by half.
+ */
+int mult_dsymm_ATBA(const string &uplo, const Matrix &A, const Matrix &B,
+                    Matrix &C, Matrix *scratch)
+{
+    check_triple_product_alias("mult_dsymm_ATBA", A, B, C, scratch);
+    Matrix local;
+    Matrix &BA = get_scratch(scratch, local, B.row(), A.col());
+    mult_dsymm("L", uplo, 1.0, B, A, 0.0, BA);
+    mult_dgemm_sym_result("T", A, BA, C);
+    return 0;
+}
+
+/**
+ * @brief Batched three matrix multiplication C[i] = op(A) * B[i] * op(A)^T.
+ *
+ * @details The batch is calculated by two `dgemm` calls:
+ * 1. T = op(A) * [B[0], B[1], ...], where B[i] are concatenated horizontally.
+ * 2. [C[0]; C[1]; ...] = [T[0]; T[1]; ...] * op(A)^T, where the column blocks
+ *    T[i] of T are stacked vertically.
+ *
+ * @param [in] func_name: name of the caller used in error messages.
+ * @param [in] op_A: "N" for A * B * A^T, and "T" for A^T * B * A.
+ */
+static int
+mult_dgemm_triple_batched(const char *func_name, const string &op_A,
+                          const Matrix &A,
+                          const vector<std::shared_ptr<const Matrix>> &B,
+                          const vector<std::shared_ptr<Matrix>> &C)
+{
+    if (B.size() != C.size()) {
+        throw exception::MatrixException(
+            string("Error in matrix::") + func_name +
+            "(): numbers of input and output matrices are different.");
+    }
+    const size_t nbatch = B.size();
+    // op(A): p x q, B[i]: q x q, C[i]: p x p.
+    const size_t p = op_A == "N" ? A.row() : A.col();
+    const size_t q = op_A == "N" ? A.col() : A.row();
+    for (size_t i = 0; i < nbatch; i++) {
+        if (B[i]->row() != q || B[i]->col() != q) {
+            throw exception::DimensionError(
+                A, *B[i],
+                string("Error in matrix::") + func_name +
+                    "(): dimension error between matrix A and B[" +
+                    std::to_string(i) + "].");
+        }
+        if (C[i]->row() != p || C[i]->col() != p) {
+            throw exception::DimensionError(
+                string("Error in matrix::") + func_name +
+                "(): dimension error of the output matrix C[" +
+                std::to_string(i) + "].");
+        }
+        if (C[i].get() == &A || C[i].get() == B[i].get()) {
+            throw exception::MatrixException(
+                string("Error in matrix::") + func_name +
+                "(): output matrix is one of the input matrix.");
+        }
+    }
+    if (nbatch == 0 || p == 0) {
+        return 0;
+    }
+
+    const size_t ncol = nbatch * q;
+    Matrix B_cat(q, ncol);
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t r = 0; r < q; r++) {
+        for (size_t i = 0; i < nbatch; i++) {
+            std::copy(B[i]->data() + r * q, B[i]->data() + (r + 1) * q,
+                      B_cat.data() + r * ncol + i * q);
+        }
+    }
+    Matrix T(p, ncol);
+    mult_dgemm(1.0, A, op_A, B_cat, "N", 0.0, T);
+
+    Matrix T_stack(nbatch * p, q);
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t r = 0; r < p; r++) {
+        for (size_t i = 0; i < nbatch; i++) {
+            std::copy(T.data() + r * ncol + i * q,
+                      T.data() + r * ncol + (i + 1) * q,
+                      T_stack.data() + (i * p + r) * q);
+        }
+    }
+    Matrix C_stack(nbatch * p, p);
+    mult_dgemm(1.0, T_stack, "N", A, (op_A == "N" ? "T" : "N"), 0.0, C_stack);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < nbatch; i++) {
+        std::copy(C_stack.data() + i * p * p, C_stack.data() + (i + 1) * p * p,
+                  C[i]->data());
+    }
+    return 0;
+}
+
+int mult_dgemm_ABAT_batched(const Matrix &A,
+                            const vector<std::shared_ptr<const Matrix>> &B,
+                            const vector<std::shared_ptr<Matrix>> &C)
+{
+    return mult_dgemm_triple_batched("mult_dgemm_ABAT_batched", "N", A, B, C);
+}
+
+int mult_dgemm_ATBA_batched(const Matrix &A,
+                            const vector<std::shared_ptr<const Matrix>> &B,
+                            const vector<std::shared_ptr<Matrix>> &C)
+{
+    return mult_dgemm_triple_batched("mult_dgemm_ATBA_batched", "T", A, B, C);
+}
+
+/**
+ * @brief Get the blas label of the triangular part of a row-wise matrix.
+ *
+ * @details The upper triangular part of a row-wise matrix is the lower
+ * triangular part of the column-wise matrix seen by blas, and vice versa.
+ *
+ * @param [in] func_name: name of the caller used in error messages.
+ * @param [in] uplo: "U" or "L" for the row-wise matrix.
+ */
+static string blas_uplo(const char *func_name, const string &uplo)
+{
+    if (uplo == "U") {
+        return "L";
+    } else if (uplo == "L") {
+        return "U";
+    } else {
+        throw exception::MatrixException(
+            string("Error in matrix::") + func_name +
+            "(): unknown label to access a triangular matrix: label=" + uplo);
+    }
+}
+
+/**
+ * @brief Get the blas label of the operation on the rank-k factor of a
+ * row-wise matrix.
+ *
+ * @details op(A) * op(A)^T of the row-wise matrix A is op(A^T)^T * op(A^T)
+ * for the column-wise matrix A^T seen by blas, so the operation is flipped.
+ *
+ * @param [in] func_name: name of the caller used in error messages.
+ * @param [in] op: "N" or "T" for the row-wise matrix.
+ */
+static string blas_rank_k_trans(const char *func_name, const string &op)
+{
+    if (op == "N") {
+        return "T";
+    } else if (op == "T") {
+        return "N";
+    } else {
+        throw exception::MatrixException(string("Error in matrix::") +
+                                         func_name +
+                                         "(): unknown operation on matrix. "
+                                         "op=" +
+                                         op);
+    }
+}
+
+/**
+ * @note The row-wise matrix A is seen by blas as the column-wise matrix A^T,
+ * so op(A) * op(A)^T is calculated by blas with the flipped operation and the
+ * other triangular part. Only half of the result is computed by `dsyrk`, and
+ * it is copied to the other half if `to_full` is true.
+ */
+int mult_dsyrk(const string &uplo, const double alpha, const Matrix &A,
+               const string &op_A, const double beta, Matrix &C, bool to_full)
+{
+    if (&C == &A) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dsyrk(): output matrix cannot be the input "
+            "matrix.");
+    }
+    const string used_uplo = blas_uplo("mult_dsyrk", uplo);
+    const string trans = blas_rank_k_trans("mult_dsyrk", op_A);
+    // op(A): N x K
+    blas_int N = to_blas_int(op_A == "N" ? A.row() : A.col());
+    blas_int K = to_blas_int(op_A == "N" ? A.col() : A.row());
+    if (!C.is_square() || (size_t)N != C.row()) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dsyrk(): dimension error between matrix "
+            "op(A) op(A)^T and C.");
+    }
+    if (N == 0) {
+        return 0;
+    }
+    blas_int lda = A.col() > 0 ? to_blas_int(A.col()) : 1;
+    blas::dsyrk_(used_uplo.c_str(), trans.c_str(), &N, &K, &alpha, A.data(),
+                 &lda, &beta, C.data(), &N);
+    if (to_full) {
+        C.to_symmetric(uplo);
+    }
+    return 0;
+}
+
+/**
+ * @note The same row-wise convention as mult_dsyrk() is used.
+ */
+int mult_dsyr2k(const string &uplo, const double alpha, const Matrix &A,
+                const Matrix &B, const string &op, const double beta,
+                Matrix &C, bool to_full)
+{
+    if (&C == &A || &C == &B) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dsyr2k(): output matrix cannot be one of "
+            "the input matrix.");
+    }
+    const string used_uplo = blas_uplo("mult_dsyr2k", uplo);
+    const string trans = blas_rank_k_trans("mult_dsyr2k", op);
+    if (A.row() != B.row() || A.col() != B.col()) {
+        throw exception::DimensionError(
+            A, B,
+            "Error in matrix::mult_dsyr2k(): dimension error between matrix "
+            "A and B.");
+    }
+    // op(A), op(B): N x K
+    blas_int N = to_blas_int(op == "N" ? A.row() : A.col());
+    blas_int K = to_blas_int(op == "N" ? A.col() : A.row());
+    if (!C.is_square() || (size_t)N != C.row()) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dsyr2k(): dimension error between matrix "
+            "op(A) op(B)^T and C.");
+    }
+    if (N == 0) {
+        return 0;
+    }
+    blas_int ld = A.col() > 0 ? to_blas_int(A.col()) : 1;
+    blas::dsyr2k_(used_uplo.c_str(), trans.c_str(), &N, &K, &alpha, A.data(),
+                  &ld, B.data(), &ld, &beta, C.data(), &N);
+    if (to_full) {
+        C.to_symmetric(uplo);
+    }
+    return 0;
+}
+
+/**
+ * @note A * B of the row-wise matrices is calculated by blas as B^T * A^T,
+ * which swaps the side and the triangular part referred.
+ */
+int mult_dsymm(const string &side, const string &uplo, const double alpha,
+               const Matrix &A, const Matrix &B, const double beta, Matrix &C)
 {
     if (&C == &A || &C == &B) {
         throw exception::MatrixException(
-            "Error in matrix::mult_dgemm_ATBA(): output matrix is one of the "
+            "Error in matrix::mult_dsymm(): output matrix cannot be one of the "
             "input matrix.");
     }
-    Matrix AB(A.col(), B.col());
-    mult_dgemm(1.0, A, "T", B, "N", 0.0, AB);
-    mult_dgemm(1.0, AB, "N", A, "N", 0.0, C);
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dsymm(): symmetric matrix A is not square.");
+    }
+    const string used_uplo = blas_uplo("mult_dsymm", uplo);
+    string used_side;
+    if (side == "L") {
+        used_side = "R";
+        if (A.col() != B.row()) {
+            throw exception::DimensionError(
+                A, B,
+                "Error in matrix::mult_dsymm(): dimension error between matrix "
+                "A and B.");
+        }
+    } else if (side == "R") {
+        used_side = "L";
+        if (B.col() != A.row()) {
+            throw exception::DimensionError(
+                A, B,
+                "Error in matrix::mult_dsymm(): dimension error between matrix "
+                "B and A.");
+        }
+    } else {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dsymm(): unknown side label: " + side);
+    }
+    if (B.row() != C.row() || B.col() != C.col()) {
+        throw exception::DimensionError(
+            B, C,
+            "Error in matrix::mult_dsymm(): dimension error between the "
+            "product and matrix C.");
+    }
+    if (C.size() == 0) {
+        return 0;
+    }
+    blas_int M = to_blas_int(C.col());
+    blas_int N = to_blas_int(C.row());
+    blas_int lda = to_blas_int(A.col());
+    blas::dsymm_(used_side.c_str(), used_uplo.c_str(), &M, &N, &alpha,
+                 A.data(), &lda, B.data(), &M, &beta, C.data(), &M);
+    return 0;
+}
+
+/**
+ * @brief Signature shared by blas `dtrmm` and `dtrsm`.
+ */
+typedef void (*blas_tri_func)(const char *, const char *, const char *,
+                              const char *, const blas_int *, const blas_int *,
+                              const double *, const double *,
+                              const blas_int *, double *, const blas_int *);
+
+/**
+ * @brief Call blas `dtrmm` or `dtrsm` for row-wise stored matrices.
+ *
+ * @details The row-wise matrix A (B) is seen by blas as the column-wise
+ * matrix A^T (B^T). So op(A) * B is calculated as B^T * op(A)^T, which
+ * swaps the side and the triangular part referred, while the operation on A
+ * stays the same.
+ *
+ * @param [in] func: blas `dtrmm` or `dtrsm` function.
+ * @param [in] func_name: name of the caller used in error messages.
+ */
+static int call_blas_tri(blas_tri_func func, const char *func_name,
+                         const string &side, const string &uplo,
+                         const string &op_A, const string &diag,
+                         const double alpha, const Matrix &A, Matrix &B)
+{
+    if (&A == &B) {
+        throw exception::MatrixException(
+            string("Error in matrix::") + func_name +
+            "(): matrix B cannot be the triangular matrix A.");
+    }
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            string("Error in matrix::") + func_name +
+            "(): triangular matrix A is not square.");
+    }
+
+    string used_side;
+    if (side == "L") {
+        used_side = "R";
+        if (A.col() != B.row()) {
+            throw exception::DimensionError(
+                A, B,
+                string("Error in matrix::") + func_name +
+                    "(): dimension error between matrix op(A) and B.");
+        }
+    } else if (side == "R") {
+        used_side = "L";
+        if (A.row() != B.col()) {
+            throw exception::DimensionError(
+                A, B,
+                string("Error in matrix::") + func_name +
+                    "(): dimension error between matrix B and op(A).");
+        }
+    } else {
+        throw exception::MatrixException(string("Error in matrix::") +
+                                         func_name +
+                                         "(): unknown side label: " + side);
+    }
+
+    const string used_uplo = blas_uplo(func_name, uplo);
+    if (op_A != "N" && op_A != "T") {
+        throw exception::MatrixException(string("Error in matrix::") +
+                                         func_name +
+                                         "(): unknown operation on matrix. "
+                                         "op_A=" +
+                                         op_A);
+    }
+    if (diag != "N" && diag != "U") {
+        throw exception::MatrixException(string("Error in matrix::") +
+                                         func_name +
+                                         "(): unknown diagonal label: " + diag);
+    }
+
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int M = to_blas_int(B.col());
+    blas_int N = to_blas_int(B.row());
+    blas_int lda = to_blas_int(A.col());
+    func(used_side.c_str(), used_uplo.c_str(), op_A.c_str(), diag.c_str(), &M,
+         &N, &alpha, A.data(), &lda, B.data(), &M);
+    return 0;
+}
+
+int mult_dtrmm(const string &side, const string &uplo, const string &op_A,
+               const string &diag, const double alpha, const Matrix &A,
+               Matrix &B)
+{
+    return call_blas_tri(blas::dtrmm_, "mult_dtrmm", side, uplo, op_A, diag,
+                         alpha, A, B);
+}
+
+int solve_tri_matrix_dtrsm(const string &side, const string &uplo,
+                           const string &op_A, const string &diag,
+                           const double alpha, const Matrix &A, Matrix &B)
+{
+    return call_blas_tri(blas::dtrsm_, "solve_tri_matrix_dtrsm", side, uplo,
+                         op_A, diag, alpha, A, B);
 }
 
 int mult_dscal_to(const double alpha, const Matrix &A, Matrix &B)
@@ -5,31 +5,162 @@
 #ifndef _MATRIX_SRC_BLAS_BASE_H_
 #define _MATRIX_SRC_BLAS_BASE_H_
 
+#include <matrix/details/exception.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
 namespace matrix {
 
+/**
+ * @brief Integer type of blas and lapack.
+ *
+ * @details It is 64-bit when the library is built against ILP64 blas and
+ * lapack libraries (cmake option `ILP64`), otherwise it is 32-bit.
+ */
+#ifdef MATRIX_BLAS_ILP64
+typedef int64_t blas_int;
+#else
+typedef int blas_int;
+#endif
+
+/**
+ * @brief Convert a matrix dimension to the blas integer type.
+ *
+ * @note An exception is thrown if the dimension does not fit in the blas
+ * integer type.
+ */
+inline blas_int to_blas_int(size_t n)
+{
+    if (n > (size_t)std::numeric_limits<blas_int>::max()) {
+        throw exception::MatrixException(
+            "Matrix dimension " + std::to_string(n) +
+            " exceeds the range of the blas integer type. Build the matrix "
+            "library with ILP64 blas and lapack for larger matrices.");
+    }
+    return (blas_int)n;
+}
+
 namespace blas {
 
-static int izero[] = {0};
-static int ione[] = {1};
+static blas_int izero[] = {0};
+static blas_int ione[] = {1};
 static double dzero[] = {0.0};
 static double done[] = {1.0};
 
-extern "C" void drot_(const int *N, double *x, const int *incx, double *y,
-                      const int *incy, const double *c, const double *s);
-extern "C" void dgemm_(const char *transa, const char *transb, const int *m,
-                       const int *n, const int *k, const double *alpha,
-                       const double *a, const int *lda, const double *b,
-                       const int *ldb, const double *beta, double *c,
-                       const int *ldc);
-extern "C" void dsyev_(const char *jobz, const char *uplo, const int *N,
-                       double *A, const int *lda, double *eig, double *work,
-                       const int *lwork, int *info);
-extern "C" void dscal_(const int *N, const double *alpha, double *a,
-                       const int *lda);
-extern "C" void dcopy_(const int *N, const double *x, const int *incx,
-                       double *y, const int *incy);
-extern "C" double ddot_(const int *N, const double *x, const int *incx,
-                        const double *y, const int *incy);
+/**
+ * @brief blas symbols linked at build time.
+ */
+namespace linked {
+
+extern "C" void drot_(const blas_int *N, double *x, const blas_int *incx,
+                      double *y, const blas_int *incy, const double *c,
+                      const double *s);
+extern "C" void dgemm_(const char *transa, const char *transb,
+                       const blas_int *m, const blas_int *n, const blas_int *k,
+                       const double *alpha, const double *a,
+                       const blas_int *lda, const double *b,
+                       const blas_int *ldb, const double *beta, double *c,
+                       const blas_int *ldc);
+extern "C" void dsymm_(const char *side, const char *uplo, const blas_int *m,
+                       const blas_int *n, const double *alpha, const double *a,
+                       const blas_int *lda, const double *b,
+                       const blas_int *ldb, const double *beta, double *c,
+                       const blas_int *ldc);
+extern "C" void dsyrk_(const char *uplo, const char *trans, const blas_int *n,
+                       const blas_int *k, const double *alpha, const double *a,
+                       const blas_int *lda, const double *beta, double *c,
+                       const blas_int *ldc);
+extern "C" void dsyr2k_(const char *uplo, const char *trans, const blas_int *n,
+                        const blas_int *k, const double *alpha, const double *a,
+                        const blas_int *lda, const double *b,
+                        const blas_int *ldb, const double *beta, double *c,
+                        const blas_int *ldc);
+extern "C" void dscal_(const blas_int *N, const double *alpha, double *a,
+                       const blas_int *lda);
+extern "C" void dcopy_(const blas_int *N, const double *x, const blas_int *incx,
+                       double *y, const blas_int *incy);
+extern "C" double ddot_(const blas_int *N, const double *x,
+                        const blas_int *incx, const double *y,
+                        const blas_int *incy);
+extern "C" void dtrsm_(const char *side, const char *uplo, const char *transa,
+                       const char *diag, const blas_int *m, const blas_int *n,
+                       const double *alpha, const double *a,
+                       const blas_int *lda, double *b, const blas_int *ldb);
+extern "C" void dtrmm_(const char *side, const char *uplo, const char *transa,
+                       const char *diag, const blas_int *m, const blas_int *n,
+                       const double *alpha, const double *a,
+                       const blas_int *lda, double *b, const blas_int *ldb);
+
+} // namespace linked
+
+// clang-format off
+#define MATRIX_BLAS_SYMBOLS(X) \
+    X(drot_) \
+    X(dgemm_) \
+    X(dsymm_) \
+    X(dsyrk_) \
+    X(dsyr2k_) \
+    X(dscal_) \
+    X(dcopy_) \
+    X(ddot_) \
+    X(dtrsm_) \
+    X(dtrmm_)
+// clang-format on
+
+/**
+ * @brief Dispatch table of the blas functions used by the library.
+ */
+struct Table {
+#define MATRIX_BLAS_TABLE_ENTRY(name) decltype(&linked::name) name;
+    MATRIX_BLAS_SYMBOLS(MATRIX_BLAS_TABLE_ENTRY)
+#undef MATRIX_BLAS_TABLE_ENTRY
+};
+
+/**
+ * @brief Get the dispatch table of the active blas backend.
+ * @details It is defined in backend.cpp.
+ */
+const Table &table();
+
+// The blas functions called by the library, e.g. `blas::dgemm_(...)`, are
+// forwarded to the active backend.
+#define MATRIX_BLAS_WRAPPER(name)                                              \
+    template <typename... Args>                                                \
+    inline auto name(Args... args)->decltype(linked::name(args...))            \
+    {                                                                          \
+        return table().name(args...);                                          \
+    }
+MATRIX_BLAS_SYMBOLS(MATRIX_BLAS_WRAPPER)
+#undef MATRIX_BLAS_WRAPPER
+
+/**
+ * @brief Copy `n` elements from x to y by `dcopy`, in chunks that fit in the
+ * blas integer type.
+ */
+inline void dcopy_chunked(size_t n, const double *x, double *y)
+{
+    const size_t chunk = std::numeric_limits<blas_int>::max();
+    for (size_t i = 0; i < n; i += chunk) {
+        blas_int len = (blas_int)std::min(chunk, n - i);
+        dcopy_(&len, x + i, ione, y + i, ione);
+    }
+}
+
+/**
+ * @brief Scale `n` elements of x by `dscal`, in chunks that fit in the blas
+ * integer type.
+ */
+inline void dscal_chunked(size_t n, double alpha, double *x)
+{
+    const size_t chunk = std::numeric_limits<blas_int>::max();
+    for (size_t i = 0; i < n; i += chunk) {
+        blas_int len = (blas_int)std::min(chunk, n - i);
+        dscal_(&len, &alpha, x + i, ione);
+    }
+}
 
 } // namespace blas
 } // namespace matrix
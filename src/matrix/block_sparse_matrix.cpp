@@ -0,0 +1,378 @@
+#include <matrix/details/block_sparse_matrix.h>
+#include <matrix/details/exception.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <utility>
+
+#include "blas_base.h"
+#include "gemm.h"
+
+namespace matrix {
+
+/**
+ * @brief Get the Frobenius norm of a tile.
+ */
+static double frobenius_norm(const double *a, size_t size)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < size; i++) {
+        s += a[i] * a[i];
+    }
+    return std::sqrt(s);
+}
+
+static void check_tile_size(size_t tile)
+{
+    if (tile == 0) {
+        throw exception::MatrixException(
+            "Error in matrix::BlockSparseMatrix: the tile size cannot be 0.");
+    }
+}
+
+BlockSparseMatrix::BlockSparseMatrix(size_t row, size_t col, size_t tile)
+    : row_(row), col_(col), tile_(tile)
+{
+    check_tile_size(tile);
+    tile_row_ptr_.assign(num_tile_rows() + 1, 0);
+    offset_.assign(1, 0);
+}
+
+BlockSparseMatrix::BlockSparseMatrix(size_t row, size_t col, size_t tile,
+                                     vector<size_t> tile_row_ptr,
+                                     vector<size_t> tile_col,
+                                     vector<double> data)
+    : row_(row), col_(col), tile_(tile),
+      tile_row_ptr_(std::move(tile_row_ptr)), tile_col_(std::move(tile_col)),
+      data_(std::move(data))
+{
+    check_tile_size(tile);
+    const size_t nbr = num_tile_rows();
+    bool valid = tile_row_ptr_.size() == nbr + 1 && tile_row_ptr_[0] == 0 &&
+                 tile_row_ptr_[nbr] == tile_col_.size();
+    size_t size = 0;
+    for (size_t I = 0; valid && I < nbr; I++) {
+        const size_t first = tile_row_ptr_[I];
+        const size_t last = tile_row_ptr_[I + 1];
+        if (first > last || last > tile_col_.size()) {
+            valid = false;
+            break;
+        }
+        for (size_t k = first; k < last; k++) {
+            const size_t J = tile_col_[k];
+            if (J >= num_tile_cols() || (k > first && J <= tile_col_[k - 1])) {
+                valid = false;
+                break;
+            }
+            size += tile_height(I) * tile_width(J);
+        }
+    }
+    if (!valid || size != data_.size()) {
+        throw exception::MatrixException(
+            "Error in matrix::BlockSparseMatrix: the tile columns are out of "
+            "range or not strictly increasing, or the size of the arrays is "
+            "unmatched.");
+    }
+    update_offsets_and_norms();
+}
+
+/**
+ * @details The norms of all the tiles are calculated by tile rows in
+ * parallel, and the tiles kept are copied in parallel.
+ */
+BlockSparseMatrix::BlockSparseMatrix(const Matrix &A, size_t tile,
+                                     double threshold)
+    : BlockSparseMatrix(A.row(), A.col(), tile)
+{
+    const size_t nbr = num_tile_rows();
+    const size_t nbc = num_tile_cols();
+    vector<double> norms(nbr * nbc, 0.0);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t I = 0; I < nbr; I++) {
+        for (size_t i = I * tile_; i < I * tile_ + tile_height(I); i++) {
+            const double *a = A.data() + i * col_;
+            for (size_t J = 0; J < nbc; J++) {
+                double s = 0.0;
+                for (size_t j = J * tile_; j < J * tile_ + tile_width(J); j++) {
+                    s += a[j] * a[j];
+                }
+                norms[I * nbc + J] += s;
+            }
+        }
+    }
+
+    for (size_t I = 0; I < nbr; I++) {
+        for (size_t J = 0; J < nbc; J++) {
+            // keep the tiles that are not finite, whose norms are NaN.
+            if (!(std::sqrt(norms[I * nbc + J]) <= threshold)) {
+                tile_col_.push_back(J);
+            }
+        }
+        tile_row_ptr_[I + 1] = tile_col_.size();
+    }
+    update_offsets_and_norms();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t I = 0; I < nbr; I++) {
+        const size_t m = tile_height(I);
+        for (size_t k = tile_row_ptr_[I]; k < tile_row_ptr_[I + 1]; k++) {
+            const size_t J = tile_col_[k];
+            const size_t n = tile_width(J);
+            double *t = data_.data() + offset_[k];
+            for (size_t i = 0; i < m; i++) {
+                std::copy_n(A.data() + (I * tile_ + i) * col_ + J * tile_, n,
+                            t + i * n);
+            }
+            norms_[k] = frobenius_norm(t, m * n);
+        }
+    }
+}
+
+/**
+ * @brief Update the offsets of the tiles from the tile columns, and the
+ * norms of the tiles. The data is allocated if it is not yet.
+ */
+void BlockSparseMatrix::update_offsets_and_norms()
+{
+    const size_t nbr = num_tile_rows();
+    offset_.assign(num_tiles() + 1, 0);
+    for (size_t I = 0; I < nbr; I++) {
+        for (size_t k = tile_row_ptr_[I]; k < tile_row_ptr_[I + 1]; k++) {
+            offset_[k + 1] =
+                offset_[k] + tile_height(I) * tile_width(tile_col_[k]);
+        }
+    }
+    data_.resize(offset_.back(), 0.0);
+    norms_.assign(num_tiles(), 0.0);
+    const size_t ntiles = num_tiles();
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (size_t k = 0; k < ntiles; k++) {
+        norms_[k] = frobenius_norm(data_.data() + offset_[k],
+                                   offset_[k + 1] - offset_[k]);
+    }
+}
+
+Matrix BlockSparseMatrix::to_matrix() const
+{
+    Matrix A(row_, col_);
+    A.fill_all(0.0);
+    const size_t nbr = num_tile_rows();
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t I = 0; I < nbr; I++) {
+        const size_t m = tile_height(I);
+        for (size_t k = tile_row_ptr_[I]; k < tile_row_ptr_[I + 1]; k++) {
+            const size_t J = tile_col_[k];
+            const size_t n = tile_width(J);
+            const double *t = tile_data(k);
+            for (size_t i = 0; i < m; i++) {
+                std::copy_n(t + i * n, n,
+                            A.data() + (I * tile_ + i) * col_ + J * tile_);
+            }
+        }
+    }
+    return A;
+}
+
+/**
+ * @brief Get the index of the tile (I, J) in the stored tiles, or
+ * num_tiles() if it is not stored.
+ */
+size_t BlockSparseMatrix::find(size_t I, size_t J) const
+{
+    auto first = tile_col_.begin() + tile_row_ptr_[I];
+    auto last = tile_col_.begin() + tile_row_ptr_[I + 1];
+    auto p = std::lower_bound(first, last, J);
+    return p != last && *p == J ? p - tile_col_.begin() : num_tiles();
+}
+
+void BlockSparseMatrix::set_tile(size_t I, size_t J, const Matrix &T)
+{
+    if (I >= num_tile_rows() || J >= num_tile_cols()) {
+        std::stringstream msg;
+        msg << "Error in matrix::BlockSparseMatrix::set_tile(): tile (" << I
+            << ", " << J << ") is out of range.";
+        throw exception::MatrixException(msg.str());
+    } else if (T.row() != tile_height(I) || T.col() != tile_width(J)) {
+        throw exception::DimensionError(
+            "Error in matrix::BlockSparseMatrix::set_tile(): dimension error "
+            "of the tile.");
+    }
+
+    size_t k = find(I, J);
+    if (k == num_tiles()) {
+        auto first = tile_col_.begin() + tile_row_ptr_[I];
+        auto last = tile_col_.begin() + tile_row_ptr_[I + 1];
+        k = std::lower_bound(first, last, J) - tile_col_.begin();
+        tile_col_.insert(tile_col_.begin() + k, J);
+        data_.insert(data_.begin() + offset_[k], T.size(), 0.0);
+        offset_.insert(offset_.begin() + k + 1, offset_[k] + T.size());
+        for (size_t p = k + 2; p < offset_.size(); p++) {
+            offset_[p] += T.size();
+        }
+        norms_.insert(norms_.begin() + k, 0.0);
+        for (size_t p = I + 1; p < tile_row_ptr_.size(); p++) {
+            tile_row_ptr_[p]++;
+        }
+    }
+    std::copy_n(T.data(), T.size(), data_.data() + offset_[k]);
+    norms_[k] = frobenius_norm(T.data(), T.size());
+}
+
+const double *BlockSparseMatrix::tile(size_t I, size_t J) const
+{
+    const size_t k = find(I, J);
+    return k == num_tiles() ? nullptr : tile_data(k);
+}
+
+double BlockSparseMatrix::tile_norm(size_t I, size_t J) const
+{
+    const size_t k = find(I, J);
+    return k == num_tiles() ? 0.0 : norms_[k];
+}
+
+namespace block_sparse {
+
+/**
+ * @brief A tile product A(I, K) * B(K, J) contributing to the tile (I, J)
+ * of C, given by the indices of the stored tiles of A and B.
+ */
+struct TileProduct {
+    size_t J;
+    size_t a;
+    size_t b;
+
+    bool operator<(const TileProduct &other) const
+    {
+        return J < other.J || (J == other.J && a < other.a);
+    }
+};
+
+/**
+ * @brief A tile of C, with its tile products in [first, last) of the tile
+ * products of its tile row.
+ */
+struct OutputTile {
+    size_t I;
+    size_t first;
+    size_t last;
+};
+
+} // namespace block_sparse
+
+/**
+ * @details The tile products that pass the screening are collected and
+ * sorted for each tile row of C in parallel, which gives the tiles of C.
+ * Then the tiles of C are computed in parallel, each by the dgemm engine
+ * over its tile products in a fixed order, so that the result does not
+ * depend on the number of threads.
+ */
+int mult_block_sparse_dgemm(const double alpha, const BlockSparseMatrix &A,
+                            const BlockSparseMatrix &B, const double threshold,
+                            BlockSparseMatrix &C)
+{
+    using block_sparse::OutputTile;
+    using block_sparse::TileProduct;
+    if (&C == &A || &C == &B) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_block_sparse_dgemm(): output matrix cannot "
+            "be one of the input matrices.");
+    } else if (A.tile_size() != B.tile_size()) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_block_sparse_dgemm(): unmatched tile size "
+            "of matrix A and B.");
+    } else if (A.col() != B.row()) {
+        throw exception::DimensionError(
+            A.col(), B.row(),
+            "Error in matrix::mult_block_sparse_dgemm(): dimension error "
+            "between matrix A and B.");
+    }
+
+    const size_t tile = A.tile_size();
+    const size_t nbr = A.num_tile_rows();
+    const vector<size_t> &a_ptr = A.tile_row_ptr();
+    const vector<size_t> &b_ptr = B.tile_row_ptr();
+    const vector<size_t> &a_col = A.tile_col();
+    const vector<size_t> &b_col = B.tile_col();
+
+    // screening of the tile products.
+    vector<vector<TileProduct>> products(nbr);
+    vector<size_t> row_ptr(nbr + 1, 0);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t I = 0; I < nbr; I++) {
+        vector<TileProduct> &p = products[I];
+        for (size_t a = a_ptr[I]; a < a_ptr[I + 1]; a++) {
+            const size_t K = a_col[a];
+            for (size_t b = b_ptr[K]; b < b_ptr[K + 1]; b++) {
+                // the products with the non-finite tiles are always computed.
+                if (!(A.norms()[a] * B.norms()[b] < threshold)) {
+                    p.push_back(TileProduct{b_col[b], a, b});
+                }
+            }
+        }
+        std::sort(p.begin(), p.end());
+        size_t count = 0;
+        for (size_t k = 0; k < p.size(); k++) {
+            count += k == 0 || p[k].J != p[k - 1].J;
+        }
+        row_ptr[I + 1] = count;
+    }
+
+    // the tiles of C.
+    for (size_t I = 0; I < nbr; I++) {
+        row_ptr[I + 1] += row_ptr[I];
+    }
+    vector<size_t> tile_col(row_ptr[nbr]);
+    vector<OutputTile> tiles(row_ptr[nbr]);
+    vector<size_t> offset(row_ptr[nbr] + 1, 0);
+    for (size_t I = 0; I < nbr; I++) {
+        const vector<TileProduct> &p = products[I];
+        size_t k = row_ptr[I];
+        for (size_t first = 0; first < p.size(); k++) {
+            size_t last = first + 1;
+            while (last < p.size() && p[last].J == p[first].J) {
+                last++;
+            }
+            tile_col[k] = p[first].J;
+            tiles[k] = OutputTile{I, first, last};
+            offset[k + 1] =
+                offset[k] + A.tile_height(I) * B.tile_width(p[first].J);
+            first = last;
+        }
+    }
+
+    vector<double> data(offset.back());
+    const size_t ntiles = tiles.size();
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t k = 0; k < ntiles; k++) {
+        const OutputTile &t = tiles[k];
+        const vector<TileProduct> &p = products[t.I];
+        // the tiles are row-wise, C^T = B^T * A^T is computed.
+        blas_int m = to_blas_int(A.tile_height(t.I));
+        blas_int n = to_blas_int(B.tile_width(tile_col[k]));
+        for (size_t q = t.first; q < t.last; q++) {
+            blas_int kk = to_blas_int(A.tile_width(a_col[p[q].a]));
+            const double beta = q == t.first ? 0.0 : 1.0;
+            gemm::dgemm("N", "N", &n, &m, &kk, &alpha, B.tile_data(p[q].b),
+                        &n, A.tile_data(p[q].a), &kk, &beta,
+                        data.data() + offset[k], &n);
+        }
+    }
+
+    C = BlockSparseMatrix(A.row(), B.col(), tile, std::move(row_ptr),
+                          std::move(tile_col), std::move(data));
+    return 0;
+}
+
+} // namespace matrix
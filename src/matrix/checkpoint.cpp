@@ -0,0 +1,537 @@
+#include <matrix/details/checkpoint.h>
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix_io.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "container_format.h"
+#include "crc32c.h"
+#include "parallel_io.h"
+
+namespace matrix {
+
+namespace checkpoint {
+
+static const char kMagic[8] = {'M', 'T', 'X', 'C', 'K', 'P', 'T', '\0'};
+static const uint32_t kVersion = 1;
+static const uint32_t kRecordMagic = 0x54504b43;  /* "CKPT". */
+static const uint32_t kTrailerMagic = 0x444e4543; /* "CEND". */
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t tile_size;
+};
+
+/**
+ * @brief The beginning of a checkpoint record, followed by the dimensions of
+ * the matrices, the table of the tiles, the tile data and the trailer.
+ */
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t nmatrix;
+    uint64_t ntile;
+};
+
+struct RecordDim {
+    uint64_t row;
+    uint64_t col;
+};
+
+struct RecordTile {
+    uint64_t matrix;
+    uint64_t tile;
+    uint64_t hash;
+};
+
+struct RecordTrailer {
+    uint32_t magic;
+    uint32_t checksum; /* CRC32C of the header, the dimensions and the table. */
+    uint64_t size;     /* size of the record before the trailer. */
+};
+
+static const uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+static const uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t kPrime3 = 0x165667b19e3779f9ULL;
+
+static uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t mix(uint64_t acc, uint64_t x)
+{
+    return rotl(acc + x * kPrime2, 31) * kPrime1;
+}
+
+/**
+ * @brief Get the 64-bit hash of a tile by four independent lanes of the
+ * xxHash64 round, so that the hash runs at the memory bandwidth.
+ */
+static uint64_t tile_hash(const double *x, size_t n)
+{
+    uint64_t lane[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    uint64_t w[4];
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        std::memcpy(w, x + i, sizeof(w));
+        for (int k = 0; k < 4; k++) {
+            lane[k] = mix(lane[k], w[k]);
+        }
+    }
+    uint64_t h = rotl(lane[0], 1) + rotl(lane[1], 7) + rotl(lane[2], 12) +
+                 rotl(lane[3], 18) + n;
+    for (; i < n; i++) {
+        std::memcpy(w, x + i, sizeof(w[0]));
+        h = rotl(h ^ mix(0, w[0]), 27) * kPrime1 + kPrime3;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief Get the number of tiles of a matrix.
+ */
+static size_t num_tiles(uint64_t size, size_t tile_size)
+{
+    return (size + tile_size - 1) / tile_size;
+}
+
+/**
+ * @brief Get the number of elements of the \p t -th tile of a matrix.
+ */
+static size_t tile_elements(uint64_t size, size_t tile_size, size_t t)
+{
+    return std::min<uint64_t>(tile_size, size - t * tile_size);
+}
+
+} // namespace checkpoint
+
+CheckpointStore::CheckpointStore(const string &fname, size_t tile_size)
+    : fname_(fname), fd_(-1), tile_size_(tile_size), offset_(0), count_(0)
+{
+    if (tile_size == 0) {
+        throw exception::MatrixException(
+            "Error in matrix::CheckpointStore: the tile size is 0.");
+    }
+    fd_ = open(fname.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(
+            fname, string("Cannot open checkpoint file: ") +
+                       std::strerror(errno));
+    }
+    try {
+        load();
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+CheckpointStore::~CheckpointStore()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+/**
+ * @details The records are scanned from the beginning of the file without
+ * reading the tile data. The scan stops at the first incomplete or corrupted
+ * record, which is left by an interrupted checkpoint, and the file is
+ * truncated there.
+ */
+void CheckpointStore::load()
+{
+    using namespace checkpoint;
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        throw exception::MatrixIOException(
+            fname_, "Cannot get checkpoint file size.");
+    }
+    const uint64_t length = st.st_size;
+    FileHeader header;
+    if (length == 0) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.tile_size = tile_size_;
+        container::pwrite_all(fd_, &header, sizeof(header), 0, fname_);
+        offset_ = sizeof(header);
+        return;
+    }
+    if (length < sizeof(header)) {
+        throw exception::MatrixIOException(fname_,
+                                           "Not a matrix checkpoint file.");
+    }
+    container::pread_all(fd_, &header, sizeof(header), 0, fname_);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.tile_size == 0) {
+        throw exception::MatrixIOException(fname_,
+                                           "Not a matrix checkpoint file.");
+    } else if (header.version != kVersion) {
+        throw exception::MatrixIOException(
+            fname_, "Unsupported matrix checkpoint file version.");
+    }
+    tile_size_ = header.tile_size;
+
+    uint64_t pos = sizeof(header);
+    vector<char> meta;
+    while (length - pos >= sizeof(RecordHeader)) {
+        RecordHeader record;
+        container::pread_all(fd_, &record, sizeof(record), pos, fname_);
+        const uint64_t remain = length - pos - sizeof(record);
+        if (record.magic != kRecordMagic ||
+            record.nmatrix > remain / sizeof(RecordDim) ||
+            record.ntile > remain / sizeof(RecordTile)) {
+            break;
+        }
+        const uint64_t meta_size = record.nmatrix * sizeof(RecordDim) +
+                                   record.ntile * sizeof(RecordTile);
+        if (meta_size > remain) {
+            break;
+        }
+        meta.resize(sizeof(record) + meta_size);
+        std::memcpy(meta.data(), &record, sizeof(record));
+        container::pread_all(fd_, meta.data() + sizeof(record), meta_size,
+                             pos + sizeof(record), fname_);
+        const RecordDim *dims =
+            reinterpret_cast<const RecordDim *>(meta.data() + sizeof(record));
+        const RecordTile *tiles = reinterpret_cast<const RecordTile *>(
+            dims + record.nmatrix);
+
+        // locate the tile data, and check the table.
+        bool valid = true;
+        uint64_t data_size = 0;
+        vector<uint64_t> data_offset(record.ntile);
+        for (uint64_t k = 0; k < record.ntile && valid; k++) {
+            const RecordTile &t = tiles[k];
+            valid = t.matrix < record.nmatrix;
+            if (valid) {
+                const RecordDim &d = dims[t.matrix];
+                const uint64_t size = d.row * d.col;
+                valid = (d.col == 0 || d.row <= length / d.col) &&
+                        t.tile < num_tiles(size, tile_size_);
+                if (valid) {
+                    data_offset[k] = data_size;
+                    data_size += tile_elements(size, tile_size_, t.tile) *
+                                 sizeof(double);
+                    valid = data_size <= length;
+                }
+            }
+        }
+        const uint64_t record_size = meta.size() + data_size;
+        RecordTrailer trailer;
+        if (!valid || length - pos < record_size + sizeof(trailer)) {
+            break;
+        }
+        container::pread_all(fd_, &trailer, sizeof(trailer),
+                             pos + record_size, fname_);
+        if (trailer.magic != kTrailerMagic || trailer.size != record_size ||
+            trailer.checksum != crc32c::extend(meta.data(), meta.size())) {
+            break;
+        }
+
+        // the matrices whose dimension is changed are written completely.
+        state_.resize(record.nmatrix);
+        for (uint64_t i = 0; i < record.nmatrix; i++) {
+            MatrixState &m = state_[i];
+            if (m.row != dims[i].row || m.col != dims[i].col) {
+                m.row = dims[i].row;
+                m.col = dims[i].col;
+                m.tiles.assign(num_tiles(m.row * m.col, tile_size_),
+                               Tile{0, 0});
+            }
+        }
+        for (uint64_t k = 0; k < record.ntile; k++) {
+            Tile &t = state_[tiles[k].matrix].tiles[tiles[k].tile];
+            t.hash = tiles[k].hash;
+            t.offset = pos + meta.size() + data_offset[k];
+        }
+        pos += record_size + sizeof(trailer);
+        count_++;
+    }
+    offset_ = pos;
+    if (offset_ < length && ftruncate(fd_, offset_) != 0) {
+        throw exception::MatrixIOException(
+            fname_, "Cannot discard the incomplete checkpoint.");
+    }
+}
+
+/**
+ * @details With \p sync, the record is flushed before its trailer is
+ * written, so that a valid trailer is never persisted before the data.
+ */
+uint64_t
+CheckpointStore::checkpoint(const vector<std::shared_ptr<const Matrix>> &Mat,
+                            bool sync)
+{
+    using namespace checkpoint;
+    const size_t nmatrix = Mat.size();
+    vector<size_t> first(nmatrix + 1, 0);
+    for (size_t i = 0; i < nmatrix; i++) {
+        first[i + 1] = first[i] + num_tiles(Mat[i]->size(), tile_size_);
+    }
+
+    // hash all the tiles, and find the changed ones.
+    const size_t ntile = first[nmatrix];
+    vector<uint64_t> hash(ntile);
+    vector<char> dirty(ntile);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (size_t k = 0; k < ntile; k++) {
+        const size_t i = std::upper_bound(first.begin(), first.end(), k) -
+                         first.begin() - 1;
+        const size_t t = k - first[i];
+        const Matrix &A = *Mat[i];
+        hash[k] = tile_hash(A.data() + t * tile_size_,
+                            tile_elements(A.size(), tile_size_, t));
+        dirty[k] = i >= state_.size() || state_[i].row != A.row() ||
+                   state_[i].col != A.col() ||
+                   state_[i].tiles[t].hash != hash[k];
+    }
+
+    RecordHeader record;
+    std::memset(&record, 0, sizeof(record));
+    record.magic = kRecordMagic;
+    record.nmatrix = nmatrix;
+    record.ntile = std::count(dirty.begin(), dirty.end(), 1);
+    vector<char> meta(sizeof(record) + nmatrix * sizeof(RecordDim) +
+                      record.ntile * sizeof(RecordTile));
+    std::memcpy(meta.data(), &record, sizeof(record));
+    RecordDim *dims = reinterpret_cast<RecordDim *>(meta.data() +
+                                                    sizeof(record));
+    RecordTile *tiles = reinterpret_cast<RecordTile *>(dims + nmatrix);
+    vector<struct iovec> iov(1);
+    iov[0].iov_base = meta.data();
+    iov[0].iov_len = meta.size();
+    uint64_t data_size = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < nmatrix; i++) {
+        const Matrix &A = *Mat[i];
+        dims[i].row = A.row();
+        dims[i].col = A.col();
+        for (size_t k = first[i]; k < first[i + 1]; k++) {
+            if (!dirty[k]) {
+                continue;
+            }
+            const size_t t = k - first[i];
+            tiles[n].matrix = i;
+            tiles[n].tile = t;
+            tiles[n].hash = hash[k];
+            n++;
+            char *data = reinterpret_cast<char *>(
+                const_cast<double *>(A.data() + t * tile_size_));
+            const size_t size =
+                tile_elements(A.size(), tile_size_, t) * sizeof(double);
+            // the neighbouring tiles are contiguous in the matrix.
+            struct iovec &last = iov.back();
+            if (static_cast<char *>(last.iov_base) + last.iov_len == data &&
+                iov.size() > 1) {
+                last.iov_len += size;
+            } else {
+                iov.push_back({data, size});
+            }
+            data_size += size;
+        }
+    }
+    RecordTrailer trailer;
+    trailer.magic = kTrailerMagic;
+    trailer.size = meta.size() + data_size;
+    trailer.checksum = crc32c::extend(meta.data(), meta.size());
+    if (sync) {
+        container::pwritev_all(fd_, iov, offset_, fname_);
+        if (fdatasync(fd_) != 0) {
+            throw exception::MatrixIOException(
+                fname_, string("Fail to sync file: ") + std::strerror(errno));
+        }
+        container::pwrite_all(fd_, &trailer, sizeof(trailer),
+                              offset_ + trailer.size, fname_);
+        if (fdatasync(fd_) != 0) {
+            throw exception::MatrixIOException(
+                fname_, string("Fail to sync file: ") + std::strerror(errno));
+        }
+    } else {
+        iov.push_back({&trailer, sizeof(trailer)});
+        container::pwritev_all(fd_, iov, offset_, fname_);
+    }
+
+    // the record is written, update the latest versions.
+    const uint64_t data_offset = offset_ + meta.size();
+    state_.resize(nmatrix);
+    for (size_t i = 0; i < nmatrix; i++) {
+        MatrixState &m = state_[i];
+        if (m.row != Mat[i]->row() || m.col != Mat[i]->col() ||
+            m.tiles.size() != first[i + 1] - first[i]) {
+            m.row = Mat[i]->row();
+            m.col = Mat[i]->col();
+            m.tiles.assign(first[i + 1] - first[i], Tile{0, 0});
+        }
+    }
+    uint64_t offset = data_offset;
+    for (size_t k = 0; k < record.ntile; k++) {
+        Tile &t = state_[tiles[k].matrix].tiles[tiles[k].tile];
+        t.hash = tiles[k].hash;
+        t.offset = offset;
+        offset += tile_elements(Mat[tiles[k].matrix]->size(), tile_size_,
+                                tiles[k].tile) *
+                  sizeof(double);
+    }
+    const uint64_t size = trailer.size + sizeof(trailer);
+    offset_ += size;
+    count_++;
+    return size;
+}
+
+/**
+ * @details The tiles are sorted by their file offsets, and the tiles that
+ * are contiguous both in the file and in the matrix are read together. The
+ * large reads are split by the parallel I/O engine, and the small ones are
+ * issued in parallel when matrix is built with OpenMP.
+ */
+std::vector<std::shared_ptr<Matrix>> CheckpointStore::restore(bool verify) const
+{
+    using namespace checkpoint;
+    struct Read {
+        uint64_t offset;
+        char *data;
+        size_t size;
+    };
+    std::vector<std::shared_ptr<Matrix>> rst;
+    vector<Read> reads;
+    for (const auto &m : state_) {
+        auto A = std::make_shared<Matrix>(m.row, m.col);
+        for (size_t t = 0; t < m.tiles.size(); t++) {
+            reads.push_back(
+                {m.tiles[t].offset,
+                 reinterpret_cast<char *>(A->data() + t * tile_size_),
+                 tile_elements(A->size(), tile_size_, t) * sizeof(double)});
+        }
+        rst.push_back(A);
+    }
+    std::sort(reads.begin(), reads.end(), [](const Read &a, const Read &b) {
+        return a.offset < b.offset;
+    });
+    vector<Read> merged;
+    for (const auto &r : reads) {
+        if (!merged.empty() &&
+            merged.back().offset + merged.back().size == r.offset &&
+            merged.back().data + merged.back().size == r.data) {
+            merged.back().size += r.size;
+        } else {
+            merged.push_back(r);
+        }
+    }
+
+    vector<Read> small;
+    for (const auto &r : merged) {
+        if (r.size >= 2 * get_io_chunk_size()) {
+            pio::read(fd_, fname_, r.data, r.size, r.offset);
+        } else {
+            small.push_back(r);
+        }
+    }
+    std::exception_ptr error;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t k = 0; k < small.size(); k++) {
+        try {
+            container::pread_all(fd_, small[k].data, small[k].size,
+                                 small[k].offset, fname_);
+        } catch (...) {
+#ifdef USE_OPENMP
+#pragma omp critical
+#endif
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (verify) {
+        for (size_t i = 0; i < state_.size(); i++) {
+            const MatrixState &m = state_[i];
+            const Matrix &A = *rst[i];
+            bool corrupted = false;
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(|| : corrupted)
+#endif
+            for (size_t t = 0; t < m.tiles.size(); t++) {
+                corrupted = corrupted ||
+                            tile_hash(A.data() + t * tile_size_,
+                                      tile_elements(A.size(), tile_size_,
+                                                    t)) != m.tiles[t].hash;
+            }
+            if (corrupted) {
+                std::stringstream msg;
+                msg << "Hash mismatch of the " << i
+                    << "-th matrix, the checkpoint is corrupted.";
+                throw exception::MatrixIOException(fname_, msg.str());
+            }
+        }
+    }
+    return rst;
+}
+
+/**
+ * @details The latest checkpoint is written into a temporary file next to
+ * the checkpoint file, which then replaces the checkpoint file. The store is
+ * not changed if an error occurs.
+ */
+void CheckpointStore::compact()
+{
+    auto restored = restore();
+    const vector<std::shared_ptr<const Matrix>> mat(restored.begin(),
+                                                    restored.end());
+    const string tmp = fname_ + ".tmp";
+    int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            tmp, string("Cannot open checkpoint file: ") +
+                     std::strerror(errno));
+    }
+
+    int old_fd = fd_;
+    uint64_t old_offset = offset_;
+    size_t old_count = count_;
+    vector<MatrixState> old_state;
+    old_state.swap(state_);
+    fd_ = fd;
+    count_ = 0;
+    try {
+        load();
+        checkpoint(mat, true);
+        if (rename(tmp.c_str(), fname_.c_str()) != 0) {
+            throw exception::MatrixIOException(
+                fname_, string("Cannot replace checkpoint file: ") +
+                            std::strerror(errno));
+        }
+    } catch (...) {
+        ::close(fd_);
+        unlink(tmp.c_str());
+        fd_ = old_fd;
+        offset_ = old_offset;
+        count_ = old_count;
+        state_.swap(old_state);
+        throw;
+    }
+    ::close(old_fd);
+}
+
+} // namespace matrix
@@ -0,0 +1,331 @@
+#include <matrix/details/container.h>
+#include <algorithm>
+#include <cstring>
+
+#include "codec.h"
+
+#ifdef MATRIX_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef MATRIX_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace matrix {
+
+namespace codec {
+
+static const uint32_t kFilterMask = 0xff;
+static const uint32_t kCompressorMask = 0xff00;
+
+bool is_valid(uint32_t codec)
+{
+    const uint32_t filter = codec & kFilterMask;
+    const uint32_t compressor = codec & kCompressorMask;
+    return (codec & ~(kFilterMask | kCompressorMask)) == 0 &&
+           (filter == kCodecNone || filter == kCodecShuffle ||
+            filter == kCodecXorDelta) &&
+           (compressor == kCodecNone || compressor == kCodecRle ||
+            compressor == kCodecDeflate || compressor == kCodecZstd);
+}
+
+bool is_supported(uint32_t codec)
+{
+    if (!is_valid(codec)) {
+        return false;
+    }
+    switch (codec & kCompressorMask) {
+#ifndef MATRIX_HAS_ZLIB
+    case kCodecDeflate:
+        return false;
+#endif
+#ifndef MATRIX_HAS_ZSTD
+    case kCodecZstd:
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Apply a filter to n elements. The shuffle stores the k-th byte of
+ * all the elements before the (k+1)-th byte, so that the similar exponent
+ * and high mantissa bytes of the elements are put together.
+ */
+static void filter_forward(const double *x, size_t n, uint32_t filter,
+                           unsigned char *out)
+{
+    if (filter == kCodecNone) {
+        std::memcpy(out, x, n * sizeof(double));
+        return;
+    }
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t w;
+        std::memcpy(&w, x + i, sizeof(w));
+        if (filter == kCodecXorDelta) {
+            const uint64_t delta = w ^ prev;
+            prev = w;
+            w = delta;
+        }
+        for (size_t b = 0; b < sizeof(w); b++) {
+            out[b * n + i] = static_cast<unsigned char>(w >> (8 * b));
+        }
+    }
+}
+
+static void filter_inverse(const unsigned char *in, size_t n, uint32_t filter,
+                           double *x)
+{
+    if (filter == kCodecNone) {
+        std::memcpy(x, in, n * sizeof(double));
+        return;
+    }
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t w = 0;
+        for (size_t b = 0; b < sizeof(w); b++) {
+            w |= static_cast<uint64_t>(in[b * n + i]) << (8 * b);
+        }
+        if (filter == kCodecXorDelta) {
+            w ^= prev;
+            prev = w;
+        }
+        std::memcpy(x + i, &w, sizeof(w));
+    }
+}
+
+/**
+ * @brief Byte-wise run-length encoding. A control byte c < 128 is followed by
+ * c + 1 literal bytes, and a control byte c >= 128 is followed by one byte
+ * repeated c - 125 times.
+ */
+static void rle_compress(const unsigned char *in, size_t n,
+                         std::vector<char> &out)
+{
+    const size_t max_literal = 128;
+    const size_t min_run = 3;
+    const size_t max_run = 130;
+    size_t literal = 0;
+    size_t i = 0;
+    auto flush_literal = [&](size_t end) {
+        while (literal < end) {
+            const size_t len = std::min(end - literal, max_literal);
+            out.push_back(static_cast<char>(len - 1));
+            out.insert(out.end(), in + literal, in + literal + len);
+            literal += len;
+        }
+    };
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < max_run && in[i + run] == in[i]) {
+            run++;
+        }
+        if (run >= min_run) {
+            flush_literal(i);
+            out.push_back(static_cast<char>(run + 125));
+            out.push_back(static_cast<char>(in[i]));
+            i += run;
+            literal = i;
+        } else {
+            i += run;
+        }
+    }
+    flush_literal(n);
+}
+
+static bool rle_decompress(const unsigned char *in, size_t size,
+                           unsigned char *out, size_t n)
+{
+    const unsigned char *end = in + size;
+    size_t o = 0;
+    while (in < end) {
+        const size_t c = *in++;
+        if (c < 128) {
+            const size_t len = c + 1;
+            if (len > static_cast<size_t>(end - in) || len > n - o) {
+                return false;
+            }
+            std::memcpy(out + o, in, len);
+            in += len;
+            o += len;
+        } else {
+            const size_t run = c - 125;
+            if (in == end || run > n - o) {
+                return false;
+            }
+            std::memset(out + o, *in++, run);
+            o += run;
+        }
+    }
+    return o == n;
+}
+
+/**
+ * @brief Compress n bytes by a compressor. The output is not used if it is
+ * not smaller than the input.
+ */
+static void compress(const unsigned char *in, size_t n, uint32_t compressor,
+                     std::vector<char> &out)
+{
+    out.clear();
+    switch (compressor) {
+    case kCodecRle:
+        rle_compress(in, n, out);
+        break;
+#ifdef MATRIX_HAS_ZLIB
+    case kCodecDeflate: {
+        uLongf len = compressBound(n);
+        out.resize(len);
+        if (compress2(reinterpret_cast<Bytef *>(out.data()), &len, in, n,
+                      Z_BEST_SPEED) != Z_OK) {
+            len = n;
+        }
+        out.resize(len);
+        break;
+    }
+#endif
+#ifdef MATRIX_HAS_ZSTD
+    case kCodecZstd: {
+        out.resize(ZSTD_compressBound(n));
+        size_t len = ZSTD_compress(out.data(), out.size(), in, n, 1);
+        out.resize(ZSTD_isError(len) ? n : len);
+        break;
+    }
+#endif
+    default:
+        out.resize(n);
+        break;
+    }
+}
+
+static bool decompress(const unsigned char *in, size_t size,
+                       uint32_t compressor, unsigned char *out, size_t n)
+{
+    switch (compressor) {
+    case kCodecRle:
+        return rle_decompress(in, size, out, n);
+#ifdef MATRIX_HAS_ZLIB
+    case kCodecDeflate: {
+        uLongf len = n;
+        return uncompress(out, &len, in, size) == Z_OK && len == n;
+    }
+#endif
+#ifdef MATRIX_HAS_ZSTD
+    case kCodecZstd: {
+        const size_t len = ZSTD_decompress(out, n, in, size);
+        return !ZSTD_isError(len) && len == n;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Encode a chunk of n elements.
+ */
+static void encode_chunk(const double *x, size_t n, uint32_t codec,
+                         std::vector<char> &out)
+{
+    const size_t raw_size = n * sizeof(double);
+    std::vector<unsigned char> filtered(raw_size);
+    filter_forward(x, n, codec & kFilterMask, filtered.data());
+    compress(filtered.data(), raw_size, codec & kCompressorMask, out);
+    if (out.size() >= raw_size) {
+        out.assign(filtered.begin(), filtered.end());
+    }
+}
+
+static bool decode_chunk(const unsigned char *in, size_t size, uint32_t codec,
+                         double *x, size_t n)
+{
+    const size_t raw_size = n * sizeof(double);
+    if (size == raw_size) {
+        filter_inverse(in, n, codec & kFilterMask, x);
+        return true;
+    }
+    std::vector<unsigned char> filtered(raw_size);
+    if (!decompress(in, size, codec & kCompressorMask, filtered.data(),
+                    raw_size)) {
+        return false;
+    }
+    filter_inverse(filtered.data(), n, codec & kFilterMask, x);
+    return true;
+}
+
+void encode(const double *x, size_t n, uint32_t codec, std::vector<char> &out)
+{
+    const size_t nchunk = (n + kChunkElements - 1) / kChunkElements;
+    std::vector<std::vector<char>> chunks(nchunk);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t i = 0; i < nchunk; i++) {
+        const size_t first = i * kChunkElements;
+        encode_chunk(x + first, std::min(kChunkElements, n - first), codec,
+                     chunks[i]);
+    }
+
+    size_t size = nchunk * sizeof(uint64_t);
+    for (const auto &chunk : chunks) {
+        size += chunk.size();
+    }
+    out.resize(size);
+    char *p = out.data();
+    for (const auto &chunk : chunks) {
+        const uint64_t chunk_size = chunk.size();
+        std::memcpy(p, &chunk_size, sizeof(chunk_size));
+        p += sizeof(chunk_size);
+    }
+    for (const auto &chunk : chunks) {
+        std::memcpy(p, chunk.data(), chunk.size());
+        p += chunk.size();
+    }
+}
+
+bool decode(const char *in, size_t size, uint32_t codec, double *x, size_t n)
+{
+    const size_t nchunk = (n + kChunkElements - 1) / kChunkElements;
+    if (size / sizeof(uint64_t) < nchunk) {
+        return false;
+    }
+    // the offsets of the chunks.
+    std::vector<uint64_t> offset(nchunk + 1);
+    offset[0] = nchunk * sizeof(uint64_t);
+    for (size_t i = 0; i < nchunk; i++) {
+        uint64_t chunk_size;
+        std::memcpy(&chunk_size, in + i * sizeof(chunk_size),
+                    sizeof(chunk_size));
+        if (chunk_size > size - offset[i]) {
+            return false;
+        }
+        offset[i + 1] = offset[i] + chunk_size;
+    }
+    if (offset[nchunk] != size) {
+        return false;
+    }
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(in);
+    std::vector<char> ok(nchunk, 0);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t i = 0; i < nchunk; i++) {
+        const size_t first = i * kChunkElements;
+        ok[i] = decode_chunk(bytes + offset[i], offset[i + 1] - offset[i],
+                             codec, x + first,
+                             std::min(kChunkElements, n - first));
+    }
+    for (size_t i = 0; i < nchunk; i++) {
+        if (!ok[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace codec
+} // namespace matrix
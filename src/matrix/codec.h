@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief lossless codecs of the matrix data in the container files.
+ *
+ * @details A codec is a filter, which reorders the bytes of the elements so
+ * that they compress better, combined with a compressor, see
+ * matrix::ContainerCodec. The data is split into chunks of kChunkElements
+ * elements, which are encoded independently and in parallel. The encoded
+ * data starts with the number of bytes of each chunk as an array of
+ * uint64_t, followed by the chunks. A chunk of the same size as the raw
+ * chunk is stored without the compressor, since it does not compress.
+ */
+#ifndef _MATRIX_SRC_CODEC_H_
+#define _MATRIX_SRC_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace matrix {
+
+namespace codec {
+
+/**
+ * @brief Number of elements in a chunk.
+ */
+static const size_t kChunkElements = 1 << 16;
+
+/**
+ * @brief Check if a codec is a combination of a known filter and a known
+ * compressor.
+ */
+bool is_valid(uint32_t codec);
+
+/**
+ * @brief Check if a codec is valid and its compressor is available in this
+ * build.
+ */
+bool is_supported(uint32_t codec);
+
+/**
+ * @brief Encode an array of doubles.
+ *
+ * @param [in] x: the array.
+ * @param [in] n: number of elements.
+ * @param [in] codec: a supported codec.
+ * @param [out] out: the encoded bytes.
+ */
+void encode(const double *x, size_t n, uint32_t codec, std::vector<char> &out);
+
+/**
+ * @brief Decode an array of doubles.
+ *
+ * @param [in] in: the encoded bytes.
+ * @param [in] size: number of encoded bytes.
+ * @param [in] codec: a supported codec.
+ * @param [out] x: the array.
+ * @param [in] n: number of elements.
+ * @return bool: false if the encoded bytes are corrupted.
+ */
+bool decode(const char *in, size_t size, uint32_t codec, double *x, size_t n);
+
+} // namespace codec
+} // namespace matrix
+
+#endif // _MATRIX_SRC_CODEC_H_
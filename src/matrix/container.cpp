@@ -0,0 +1,442 @@
+#include <matrix/details/container.h>
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "codec.h"
+#include "container_format.h"
+#include "crc32c.h"
+#include "parallel_io.h"
+
+namespace matrix {
+
+namespace container {
+
+void pwrite_all(int fd, const void *buf, size_t size, uint64_t offset,
+                const std::string &fname)
+{
+    const char *p = static_cast<const char *>(buf);
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            throw exception::MatrixIOException(
+                fname, string("Fail to write file: ") + std::strerror(errno));
+        }
+        p += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+void pwritev_all(int fd, std::vector<struct iovec> &iov, uint64_t offset,
+                 const std::string &fname)
+{
+    size_t first = 0;
+    while (true) {
+        // skip the buffers written.
+        while (first < iov.size() && iov[first].iov_len == 0) {
+            first++;
+        }
+        if (first == iov.size()) {
+            break;
+        }
+        const int count = std::min<size_t>(iov.size() - first, IOV_MAX);
+        ssize_t n = pwritev(fd, &iov[first], count, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            throw exception::MatrixIOException(
+                fname, string("Fail to write file: ") + std::strerror(errno));
+        }
+        offset += n;
+        for (size_t i = first; n > 0; i++) {
+            const size_t len = std::min<size_t>(n, iov[i].iov_len);
+            iov[i].iov_base = static_cast<char *>(iov[i].iov_base) + len;
+            iov[i].iov_len -= len;
+            n -= len;
+        }
+    }
+}
+
+void pread_all(int fd, void *buf, size_t size, uint64_t offset,
+               const std::string &fname)
+{
+    char *p = static_cast<char *>(buf);
+    while (size > 0) {
+        ssize_t n = pread(fd, p, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0) {
+            throw exception::MatrixIOException(
+                fname, string("Fail to read file: ") + std::strerror(errno));
+        } else if (n == 0) {
+            throw exception::MatrixIOException(
+                fname, "Fail to read file, unexpected end of file.");
+        }
+        p += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+/**
+ * @brief Get the number of bytes of the raw data of a [row, col] matrix, or
+ * throw if it overflows.
+ */
+static uint64_t raw_size(uint64_t row, uint64_t col, const string &fname)
+{
+    const uint64_t max_size = std::numeric_limits<uint64_t>::max();
+    if (col != 0 && row > max_size / sizeof(double) / col) {
+        throw exception::MatrixIOException(
+            fname, "Fail to read matrix container, invalid matrix dimension.");
+    }
+    return row * col * sizeof(double);
+}
+
+/**
+ * @note Raw data is read into \p data directly, and encoded data is read into
+ * \p buffer before it is decoded.
+ */
+void read_entry(int fd, const ContainerEntry &e, size_t index, double *data,
+                std::vector<char> &buffer, bool verify, const string &fname)
+{
+    const bool raw = e.codec == kCodecNone;
+    if (!raw && !codec::is_supported(e.codec)) {
+        std::stringstream msg;
+        msg << "The encoding of the " << index
+            << "-th matrix is not supported by this build.";
+        throw exception::MatrixIOException(fname, msg.str());
+    }
+    char *p = reinterpret_cast<char *>(data);
+    if (!raw) {
+        if (buffer.size() < e.size) {
+            buffer.resize(e.size);
+        }
+        p = buffer.data();
+    }
+    pio::read(fd, fname, p, e.size, e.offset);
+    if (verify && crc32c::extend(p, e.size) != e.checksum) {
+        std::stringstream msg;
+        msg << "Checksum mismatch of the " << index
+            << "-th matrix, the data is corrupted.";
+        throw exception::MatrixIOException(fname, msg.str());
+    }
+    if (!raw && !codec::decode(p, e.size, e.codec, data, e.row * e.col)) {
+        std::stringstream msg;
+        msg << "Fail to decode the " << index
+            << "-th matrix, the data is corrupted.";
+        throw exception::MatrixIOException(fname, msg.str());
+    }
+}
+
+} // namespace container
+
+ContainerWriter::ContainerWriter(const string &fname, int codec)
+    : fname_(fname), fd_(-1), codec_(codec),
+      offset_(sizeof(container::FileHeader))
+{
+    if (!codec::is_supported(codec)) {
+        throw exception::MatrixIOException(
+            fname, "The matrix container encoding is not supported.");
+    }
+    fd_ = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(
+            fname, "Cannot create matrix container file.");
+    }
+}
+
+ContainerWriter::~ContainerWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+/**
+ * @note The padding before the aligned data is left as a hole in the file,
+ * which is read as zeros.
+ */
+size_t ContainerWriter::append(const Matrix &A, const string &name)
+{
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(
+            fname_, "Cannot append a matrix to a closed container.");
+    } else if (!name.empty() && names_.count(name) != 0) {
+        throw exception::MatrixIOException(
+            fname_, "Duplicated matrix name in container: " + name);
+    }
+
+    ContainerEntry entry;
+    entry.name = name;
+    entry.row = A.row();
+    entry.col = A.col();
+    entry.offset = container::align_up(offset_);
+    entry.dtype = kDtypeFloat64;
+    entry.codec = codec_;
+    const void *data = A.data();
+    std::vector<char> encoded;
+    if (codec_ == kCodecNone) {
+        entry.size = A.size() * sizeof(double);
+    } else {
+        codec::encode(A.data(), A.size(), codec_, encoded);
+        entry.size = encoded.size();
+        data = encoded.data();
+    }
+    entry.checksum = crc32c::extend(data, entry.size);
+    pio::write(fd_, fname_, data, entry.size, entry.offset);
+
+    offset_ = entry.offset + entry.size;
+    if (!name.empty()) {
+        names_[name] = entries_.size();
+    }
+    entries_.push_back(entry);
+    return entries_.size() - 1;
+}
+
+void ContainerWriter::close()
+{
+    if (fd_ < 0) {
+        return;
+    }
+    const int fd = fd_;
+    fd_ = -1;
+
+    // table of contents: the entries followed by the names.
+    const size_t n = entries_.size();
+    string names;
+    vector<container::TocEntry> toc(n);
+    for (size_t i = 0; i < n; ++i) {
+        const ContainerEntry &e = entries_[i];
+        container::TocEntry &t = toc[i];
+        std::memset(&t, 0, sizeof(t));
+        t.offset = e.offset;
+        t.row = e.row;
+        t.col = e.col;
+        t.size = e.size;
+        t.dtype = e.dtype;
+        t.codec = e.codec;
+        t.checksum = e.checksum;
+        t.name_size = e.name.size();
+        t.name_offset = names.size();
+        names += e.name;
+    }
+    string toc_bytes(reinterpret_cast<const char *>(toc.data()),
+                     n * sizeof(container::TocEntry));
+    toc_bytes += names;
+
+    container::FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, container::kMagic, sizeof(header.magic));
+    header.version = container::kVersion;
+    header.header_size = sizeof(header);
+    header.byte_order = container::kByteOrder;
+    header.toc_offset = container::align_up(offset_);
+    header.toc_size = toc_bytes.size();
+    header.count = n;
+    header.toc_crc = crc32c::extend(toc_bytes.data(), toc_bytes.size());
+    header.header_crc =
+        crc32c::extend(&header, offsetof(container::FileHeader, header_crc));
+
+    try {
+        container::pwrite_all(fd, toc_bytes.data(), toc_bytes.size(),
+                              header.toc_offset, fname_);
+        container::pwrite_all(fd, &header, sizeof(header), 0, fname_);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw exception::MatrixIOException(
+            fname_, "Fail to close matrix container file.");
+    }
+}
+
+ContainerReader::ContainerReader(const string &fname) : fname_(fname), fd_(-1)
+{
+    fd_ = open(fname.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(
+            fname, "Cannot open matrix container file.");
+    }
+    try {
+        container::FileHeader header;
+        container::pread_all(fd_, &header, sizeof(header), 0, fname_);
+        if (std::memcmp(header.magic, container::kMagic,
+                        sizeof(header.magic)) != 0) {
+            throw exception::MatrixIOException(
+                fname, "The file is not a matrix container.");
+        } else if (header.byte_order != container::kByteOrder) {
+            throw exception::MatrixIOException(
+                fname, "The byte order of the matrix container is not "
+                       "supported.");
+        } else if (header.version != container::kVersion ||
+                   header.header_size != sizeof(header)) {
+            std::stringstream msg;
+            msg << "Unsupported matrix container version " << header.version
+                << ".";
+            throw exception::MatrixIOException(fname, msg.str());
+        } else if (header.header_crc !=
+                   crc32c::extend(&header, offsetof(container::FileHeader,
+                                                    header_crc))) {
+            throw exception::MatrixIOException(
+                fname, "The matrix container header is corrupted.");
+        }
+
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            throw exception::MatrixIOException(
+                fname, "Cannot get matrix container file size.");
+        }
+        // the regions are checked against the file before any allocation.
+        const uint64_t length = st.st_size;
+        const uint64_t n = header.count;
+        if (header.toc_size > length ||
+            header.toc_offset > length - header.toc_size ||
+            n > header.toc_size / sizeof(container::TocEntry)) {
+            throw exception::MatrixIOException(
+                fname, "The matrix container index is corrupted.");
+        }
+        string toc_bytes(header.toc_size, '\0');
+        container::pread_all(fd_, &toc_bytes[0], toc_bytes.size(),
+                             header.toc_offset, fname_);
+        if (header.toc_crc !=
+            crc32c::extend(toc_bytes.data(), toc_bytes.size())) {
+            throw exception::MatrixIOException(
+                fname, "The matrix container index is corrupted.");
+        }
+
+        const uint64_t entries_size = n * sizeof(container::TocEntry);
+        const char *names = toc_bytes.data() + entries_size;
+        const uint64_t names_size = toc_bytes.size() - entries_size;
+        entries_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            container::TocEntry t;
+            std::memcpy(&t, toc_bytes.data() + i * sizeof(t), sizeof(t));
+            if (t.name_offset > names_size ||
+                t.name_size > names_size - t.name_offset) {
+                throw exception::MatrixIOException(
+                    fname, "The matrix container index is corrupted.");
+            }
+            const uint64_t raw_size = container::raw_size(t.row, t.col, fname);
+            if (t.dtype != kDtypeFloat64 || !codec::is_valid(t.codec) ||
+                (t.codec == kCodecNone && t.size != raw_size)) {
+                throw exception::MatrixIOException(
+                    fname, "Unsupported matrix data type or encoding in the "
+                           "matrix container.");
+            } else if (t.size > length || t.offset > length - t.size) {
+                throw exception::MatrixIOException(
+                    fname, "The matrix container index is corrupted.");
+            }
+            ContainerEntry &e = entries_[i];
+            e.name.assign(names + t.name_offset, t.name_size);
+            e.row = t.row;
+            e.col = t.col;
+            e.offset = t.offset;
+            e.size = t.size;
+            e.dtype = t.dtype;
+            e.codec = t.codec;
+            e.checksum = t.checksum;
+            if (!e.name.empty()) {
+                names_[e.name] = i;
+            }
+        }
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+ContainerReader::~ContainerReader()
+{
+    ::close(fd_);
+}
+
+size_t ContainerReader::index_of(const string &name) const
+{
+    auto p = names_.find(name);
+    if (p == names_.end()) {
+        throw exception::MatrixIOException(
+            fname_, "Matrix is not found in the container: " + name);
+    }
+    return p->second;
+}
+
+std::shared_ptr<Matrix> ContainerReader::read_matrix_at(size_t index,
+                                                        bool verify) const
+{
+    auto rst = std::make_shared<Matrix>();
+    read_matrix_at(index, *rst, verify);
+    return rst;
+}
+
+std::shared_ptr<Matrix> ContainerReader::read_matrix_at(const string &name,
+                                                        bool verify) const
+{
+    return read_matrix_at(index_of(name), verify);
+}
+
+void ContainerReader::read_matrix_at(size_t index, Matrix &A,
+                                     bool verify) const
+{
+    if (index >= entries_.size()) {
+        std::stringstream msg;
+        msg << "Matrix index " << index << " is out of range, the container "
+            << "has " << entries_.size() << " matrices.";
+        throw exception::MatrixIOException(fname_, msg.str());
+    }
+    const ContainerEntry &e = entries_[index];
+    if (A.row() != e.row || A.col() != e.col) {
+        A.resize(e.row, e.col);
+    }
+    std::vector<char> buffer;
+    container::read_entry(fd_, e, index, A.data(), buffer, verify, fname_);
+}
+
+bool is_container_codec_supported(int codec)
+{
+    return codec::is_supported(codec);
+}
+
+bool is_matrix_container(const string &fname)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    char magic[sizeof(container::kMagic)];
+    const bool rst = pread(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+                     std::memcmp(magic, container::kMagic, sizeof(magic)) == 0;
+    ::close(fd);
+    return rst;
+}
+
+void write_matrices_to_container(
+    const vector<std::shared_ptr<const Matrix>> &Mat, const string &fname,
+    const vector<string> &names, int codec)
+{
+    if (!names.empty() && names.size() != Mat.size()) {
+        throw exception::DimensionError(
+            Mat.size(), names.size(),
+            "Error in matrix::write_matrices_to_container(): unmatched number "
+            "of names.");
+    }
+    ContainerWriter writer(fname, codec);
+    for (size_t i = 0; i < Mat.size(); ++i) {
+        writer.append(*Mat[i], names.empty() ? "" : names[i]);
+    }
+    writer.close();
+}
+
+} // namespace matrix
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief on-disk layout of the version 2 binary container of matrices.
+ *
+ * @details The file starts with a FileHeader, followed by the data of the
+ * matrices, each aligned to kAlignment bytes, and ends with the table of
+ * contents: an array of TocEntry followed by the names of the matrices.
+ * All the integers are stored in the byte order of the writer, which is
+ * recorded by FileHeader::byte_order.
+ */
+#ifndef _MATRIX_SRC_CONTAINER_FORMAT_H_
+#define _MATRIX_SRC_CONTAINER_FORMAT_H_
+
+#include <matrix/details/container.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+namespace matrix {
+
+namespace container {
+
+/**
+ * @brief Magic number at the beginning of a container file. The non-ASCII
+ * byte and the line endings detect transfers in text mode.
+ */
+static const char kMagic[8] = {'\x89', 'M', 'T', 'X', '\r', '\n', '\x1a',
+                               '\n'};
+
+static const uint32_t kVersion = 2;
+
+static const uint64_t kByteOrder = 0x0102030405060708ULL;
+
+/**
+ * @brief Alignment of the data of each matrix in bytes.
+ */
+static const uint64_t kAlignment = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size; /* sizeof(FileHeader). */
+    uint64_t byte_order;  /* kByteOrder. */
+    uint64_t toc_offset;  /* file offset of the table of contents. */
+    uint64_t toc_size;    /* number of bytes of the table of contents. */
+    uint64_t count;       /* number of matrices. */
+    uint32_t toc_crc;     /* CRC32C of the table of contents. */
+    uint32_t flags;
+    uint32_t reserved;
+    uint32_t header_crc; /* CRC32C of the bytes before it. */
+};
+static_assert(sizeof(FileHeader) == 64, "unexpected container header size");
+
+struct TocEntry {
+    uint64_t offset;      /* file offset of the data. */
+    uint64_t row;
+    uint64_t col;
+    uint64_t size;        /* number of bytes of the data. */
+    uint32_t dtype;
+    uint32_t codec;
+    uint32_t checksum;    /* CRC32C of the data. */
+    uint32_t name_size;
+    uint64_t name_offset; /* offset of the name after the entries. */
+    uint64_t reserved;
+};
+static_assert(sizeof(TocEntry) == 64, "unexpected container entry size");
+
+/**
+ * @brief Round up an offset to a multiple of kAlignment.
+ */
+inline uint64_t align_up(uint64_t offset)
+{
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+/**
+ * @brief Write all the bytes at a file offset by `pwrite`, or throw
+ * exception::MatrixIOException.
+ */
+void pwrite_all(int fd, const void *buf, size_t size, uint64_t offset,
+                const std::string &fname);
+
+/**
+ * @brief Write all the buffers of an iovec array at a file offset by
+ * `pwritev`, or throw exception::MatrixIOException. The buffers are
+ * consumed.
+ */
+void pwritev_all(int fd, std::vector<struct iovec> &iov, uint64_t offset,
+                 const std::string &fname);
+
+/**
+ * @brief Read all the bytes at a file offset by `pread`, or throw
+ * exception::MatrixIOException.
+ */
+void pread_all(int fd, void *buf, size_t size, uint64_t offset,
+               const std::string &fname);
+
+/**
+ * @brief Read the data of the \p index -th matrix in a container, verify its
+ * checksum and decode it, or throw exception::MatrixIOException.
+ *
+ * @param [out] data: the matrix data of e.row * e.col elements.
+ * @param [in, out] buffer: buffer of the encoded data, which can be reused by
+ * the following calls.
+ */
+void read_entry(int fd, const ContainerEntry &e, size_t index, double *data,
+                std::vector<char> &buffer, bool verify,
+                const std::string &fname);
+
+} // namespace container
+} // namespace matrix
+
+#endif // _MATRIX_SRC_CONTAINER_FORMAT_H_
@@ -0,0 +1,98 @@
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MATRIX_CRC32C_X86
+#include <nmmintrin.h>
+#endif
+
+#include "crc32c.h"
+
+namespace matrix {
+
+namespace crc32c {
+
+/**
+ * @brief Reversed polynomial of CRC32C.
+ */
+static const uint32_t kPolynomial = 0x82f63b78;
+
+/**
+ * @brief Lookup tables of slicing-by-8: table[k][b] is the CRC of byte b
+ * followed by k zero bytes.
+ */
+struct Tables {
+    uint32_t table[8][256];
+
+    Tables()
+    {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; i++) {
+                crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                const uint32_t prev = table[k - 1][b];
+                table[k][b] = (prev >> 8) ^ table[0][prev & 0xff];
+            }
+        }
+    }
+};
+
+static uint32_t extend_table(const unsigned char *p, size_t size, uint32_t crc)
+{
+    static const Tables tables;
+    const uint32_t(*t)[256] = tables.table;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^ t[3][hi & 0xff] ^
+              t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; p++, size--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+    }
+    return crc;
+}
+
+#ifdef MATRIX_CRC32C_X86
+__attribute__((target("sse4.2"))) static uint32_t
+extend_sse42(const unsigned char *p, size_t size, uint32_t crc)
+{
+    uint64_t crc64 = crc;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t v = 0;
+        std::memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = (uint32_t)crc64;
+    for (; size > 0; p++, size--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+uint32_t extend(const void *data, size_t size, uint32_t crc)
+{
+    typedef uint32_t (*extend_func)(const unsigned char *, size_t, uint32_t);
+    static const extend_func func = []() -> extend_func {
+#ifdef MATRIX_CRC32C_X86
+        if (__builtin_cpu_supports("sse4.2")) {
+            return extend_sse42;
+        }
+#endif
+        return extend_table;
+    }();
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    return ~func(p, size, ~crc);
+}
+
+} // namespace crc32c
+} // namespace matrix
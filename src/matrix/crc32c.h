@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief CRC32C (Castagnoli) checksum used by the matrix container files.
+ */
+#ifndef _MATRIX_SRC_CRC32C_H_
+#define _MATRIX_SRC_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace matrix {
+
+namespace crc32c {
+
+/**
+ * @brief Calculate the CRC32C checksum of a byte array.
+ *
+ * @details The SSE4.2 `crc32` instruction is used if the CPU supports it,
+ * otherwise a table-driven implementation (slicing-by-8) is used. Both give
+ * the same result.
+ *
+ * @param [in] data: the byte array.
+ * @param [in] size: number of bytes.
+ * @param [in] crc: the checksum of the preceding bytes, so that the checksum
+ * of a long array can be calculated piece by piece. 0 for the first piece.
+ * @return uint32_t: the checksum of all the bytes so far.
+ */
+uint32_t extend(const void *data, size_t size, uint32_t crc = 0);
+
+} // namespace crc32c
+} // namespace matrix
+
+#endif // _MATRIX_SRC_CRC32C_H_
@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <matrix/details/exception.h>
+#include <matrix/details/factorization.h>
+#include <matrix/details/matrix.h>
+#include <sstream>
+#include <string>
+
+#include "lapack_base.h"
+#include "lapack_utils.h"
+#include "workspace.h"
+
+namespace matrix {
+
+/**
+ * @brief Calculate the 1-norm of a general matrix.
+ */
+static double gen_norm1(const Matrix &A)
+{
+    vector<double> col_sum(A.col(), 0.0);
+    for (size_t i = 0; i < A.row(); ++i) {
+        for (size_t j = 0; j < A.col(); ++j) {
+            col_sum[j] += std::fabs(A(i, j));
+        }
+    }
+    double rst = 0.0;
+    for (size_t j = 0; j < col_sum.size(); ++j) {
+        rst = std::max(rst, col_sum[j]);
+    }
+    return rst;
+}
+
+/**
+ * @brief Calculate the 1-norm of a symmetric matrix, of which only the
+ * triangular part specified by `uplo` is referred.
+ */
+static double sym_norm1(const string &uplo, const Matrix &A)
+{
+    const bool upper = (uplo == "U");
+    vector<double> col_sum(A.col(), 0.0);
+    for (size_t i = 0; i < A.row(); ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            const double a = std::fabs(upper ? A(j, i) : A(i, j));
+            col_sum[j] += a;
+            if (i != j) {
+                col_sum[i] += a;
+            }
+        }
+    }
+    double rst = 0.0;
+    for (size_t j = 0; j < col_sum.size(); ++j) {
+        rst = std::max(rst, col_sum[j]);
+    }
+    return rst;
+}
+
+/**
+ * @brief Throw an exception when lapack reports an illegal argument.
+ */
+static void check_illegal_argument(blas_int info, const char *func_name)
+{
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+std::shared_ptr<Factorization>
+Factorization::create(Type type, const string &uplo, const Matrix &factor,
+                      const vector<int> &ipiv, double anorm)
+{
+    if (!factor.is_square()) {
+        throw exception::DimensionError(
+            "Cannot create a factorization from a matrix that is not square.");
+    }
+
+    std::shared_ptr<Factorization> rst;
+    if (type == kLU) {
+        rst = std::make_shared<LUFactorization>();
+    } else if (type == kCholesky) {
+        rst = std::make_shared<CholeskyFactorization>();
+    } else if (type == kLDLT) {
+        rst = std::make_shared<LDLTFactorization>();
+    } else {
+        throw exception::MatrixException(
+            "Fail to create a factorization: unknown factorization type.");
+    }
+
+    if (type != kLU) {
+        lapack_uplo(uplo); // check the label.
+        rst->uplo_ = uplo;
+    }
+    if (type != kCholesky) {
+        if (ipiv.size() != factor.row()) {
+            throw exception::DimensionError(
+                factor.row(), ipiv.size(),
+                "Fail to create a factorization: unmatched pivot size.");
+        }
+        // a 2x2 pivot block of dsytrf is labeled by negative pivots.
+        const long n = (long)factor.row();
+        for (size_t i = 0; i < ipiv.size(); i++) {
+            const long p = type == kLDLT ? std::labs(ipiv[i]) : ipiv[i];
+            if (p < 1 || p > n) {
+                throw exception::MatrixException(
+                    "Fail to create a factorization: pivot out of range.");
+            }
+        }
+        rst->ipiv_ = ipiv;
+    }
+    rst->factor_ = factor;
+    rst->anorm_ = anorm;
+    return rst;
+}
+
+void Factorization::check_rhs(const Matrix &B) const
+{
+    if (B.row() != this->dim()) {
+        throw exception::DimensionError(
+            factor_, B,
+            "Error in matrix::Factorization::solve(): dimension error between "
+            "the factorized matrix A and B.");
+    }
+}
+
+/**
+ * @details The row-wise matrix A is seen by lapack as A^T, so the factors
+ * stored are the LU factors of A^T.
+ */
+void LUFactorization::factorize(const Matrix &A)
+{
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Cannot factorize a matrix that is not square.");
+    }
+    factor_ = A;
+    ipiv_.assign(A.row(), 0);
+    uplo_.clear();
+    anorm_ = gen_norm1(A);
+    if (A.size() == 0) {
+        return;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    vector<blas_int> pivots;
+    lapack::dgetrf_(&n, &n, factor_.data(), &n, blas_pivots(ipiv_, pivots),
+                    &info);
+    restore_pivots(pivots, ipiv_);
+    check_illegal_argument(info, __FUNCTION__);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "U(" << info << "," << info << ") is exactly zero; the matrix "
+            << "is singular.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+}
+
+int LUFactorization::solve(Matrix &B) const
+{
+    check_rhs(B);
+    if (B.size() == 0) {
+        return 0;
+    }
+    blas_int n = to_blas_int(this->dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    vector<blas_int> pivots;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dgetrs_("T", &n, &nrhs, factor_.data(), &n,
+                    blas_pivots(ipiv_, pivots), b, &n, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+/**
+ * @details The inverse of A^T calculated by lapack `dgetri` is the inverse of
+ * A when it is read row-wise.
+ */
+Matrix LUFactorization::inverse() const
+{
+    Matrix rst = factor_;
+    if (rst.size() == 0) {
+        return rst;
+    }
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int *ipiv = ws.iwork(n);
+    std::copy(ipiv_.begin(), ipiv_.end(), ipiv);
+    // query and allocate the optimal workspace.
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDgetri, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dgetri_(&n, rst.data(), &n, ipiv, wkopt, lwork, &info);
+        });
+    double *work = ws.work(lwork);
+    lapack::dgetri_(&n, rst.data(), &n, ipiv, work, &lwork, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    return rst;
+}
+
+double LUFactorization::log_det() const
+{
+    double rst = 0.0;
+    for (size_t i = 0; i < this->dim(); ++i) {
+        rst += std::log(std::fabs(factor_(i, i)));
+    }
+    return rst;
+}
+
+int LUFactorization::det_sign() const
+{
+    int sign = 1;
+    for (size_t i = 0; i < this->dim(); ++i) {
+        if (factor_(i, i) < 0) {
+            sign = -sign;
+        }
+        if (ipiv_[i] != (int)(i + 1)) {
+            sign = -sign;
+        }
+    }
+    return sign;
+}
+
+/**
+ * @details The 1-norm of A is the infinity-norm of A^T seen by lapack.
+ */
+double LUFactorization::rcond() const
+{
+    if (this->dim() == 0) {
+        return 1.0;
+    }
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    double rst = 0.0;
+    auto &ws = workspace::LapackWorkspace::local();
+    double *work = ws.work(4 * n);
+    blas_int *iwork = ws.iwork(n);
+    lapack::dgecon_("I", &n, factor_.data(), &n, &anorm_, &rst, work,
+                    iwork, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    return rst;
+}
+
+/**
+ * @note The positive definite propoty (spd) of the input matrix is checked
+ * by the Cholesky factorization.
+ */
+void CholeskyFactorization::factorize(const string &uplo, const Matrix &A)
+{
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Cannot factorize a matrix that is not square.");
+    }
+    const string used_uplo = lapack_uplo(uplo);
+    factor_ = A;
+    ipiv_.clear();
+    uplo_ = uplo;
+    anorm_ = sym_norm1(uplo, A);
+    if (A.size() == 0) {
+        return;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    lapack::dpotrf_(used_uplo.c_str(), &n, factor_.data(), &n, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "The leading minor of order " << info
+            << " is not positive definite, and the factorization could not "
+               "be completed.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+}
+
+int CholeskyFactorization::solve(Matrix &B) const
+{
+    check_rhs(B);
+    if (B.size() == 0) {
+        return 0;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dpotrs_(used_uplo.c_str(), &n, &nrhs, factor_.data(), &n, b, &n,
+                    &info);
+    check_illegal_argument(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+Matrix CholeskyFactorization::inverse() const
+{
+    Matrix rst = factor_;
+    if (rst.size() == 0) {
+        return rst;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    lapack::dpotri_(used_uplo.c_str(), &n, rst.data(), &n, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    // make inverse matrix full. `dpotri` only update half of the matrix.
+    rst.to_symmetric(uplo_);
+    return rst;
+}
+
+double CholeskyFactorization::log_det() const
+{
+    double rst = 0.0;
+    for (size_t i = 0; i < this->dim(); ++i) {
+        rst += std::log(factor_(i, i));
+    }
+    return 2.0 * rst;
+}
+
+double CholeskyFactorization::rcond() const
+{
+    if (this->dim() == 0) {
+        return 1.0;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    double rst = 0.0;
+    auto &ws = workspace::LapackWorkspace::local();
+    double *work = ws.work(3 * n);
+    blas_int *iwork = ws.iwork(n);
+    lapack::dpocon_(used_uplo.c_str(), &n, factor_.data(), &n, &anorm_, &rst,
+                    work, iwork, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    return rst;
+}
+
+void LDLTFactorization::factorize(const string &uplo, const Matrix &A)
+{
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Cannot factorize a matrix that is not square.");
+    }
+    const string used_uplo = lapack_uplo(uplo);
+    factor_ = A;
+    ipiv_.assign(A.row(), 0);
+    uplo_ = uplo;
+    anorm_ = sym_norm1(uplo, A);
+    if (A.size() == 0) {
+        return;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    vector<blas_int> pivots;
+    blas_int *ipiv = blas_pivots(ipiv_, pivots);
+    // query and allocate the optimal workspace.
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDsytrf, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dsytrf_(used_uplo.c_str(), &n, factor_.data(), &n, ipiv,
+                            wkopt, lwork, &info);
+        });
+    double *work = ws.work(lwork);
+    lapack::dsytrf_(used_uplo.c_str(), &n, factor_.data(), &n, ipiv, work,
+                    &lwork, &info);
+    restore_pivots(pivots, ipiv_);
+    check_illegal_argument(info, __FUNCTION__);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "D(" << info << "," << info << ") = zero; the matrix is "
+            << "singular.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+}
+
+int LDLTFactorization::solve(Matrix &B) const
+{
+    check_rhs(B);
+    if (B.size() == 0) {
+        return 0;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    vector<blas_int> pivots;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dsytrs_(used_uplo.c_str(), &n, &nrhs, factor_.data(), &n,
+                    blas_pivots(ipiv_, pivots), b, &n, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+Matrix LDLTFactorization::inverse() const
+{
+    Matrix rst = factor_;
+    if (rst.size() == 0) {
+        return rst;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    vector<blas_int> pivots;
+    double *work = workspace::LapackWorkspace::local().work(n);
+    lapack::dsytri_(used_uplo.c_str(), &n, rst.data(), &n,
+                    blas_pivots(ipiv_, pivots), work, &info);
+    check_illegal_argument(info, __FUNCTION__);
+    // make inverse matrix full.
+    rst.to_symmetric(uplo_);
+    return rst;
+}
+
+/**
+ * @brief Loop over the 1x1 and 2x2 diagonal blocks of D in the LDL^T
+ * factorization and calculate the determinant of each block.
+ *
+ * @details The element D(k, k+1) of a 2x2 block is stored in the triangular
+ * part of the factors that is used by lapack.
+ */
+static void ldlt_block_dets(const Matrix &factor, const vector<int> &ipiv,
+                            const string &uplo, vector<double> &dets)
+{
+    const size_t n = factor.row();
+    const double *a = factor.data();
+    const bool lapack_upper = (lapack_uplo(uplo) == "U");
+    dets.clear();
+    for (size_t k = 0; k < n; ++k) {
+        if (ipiv[k] > 0 || k + 1 == n) {
+            dets.push_back(a[k * n + k]);
+        } else {
+            // column-wise D(k, k+1) for "U", D(k+1, k) for "L".
+            const double off = lapack_upper ? a[(k + 1) * n + k]
+                                            : a[k * n + k + 1];
+            dets.push_back(a[k * n + k] * a[(k + 1) * n + k + 1] - off * off);
+            ++k;
+        }
+    }
+}
+
+double LDLTFactorization::log_det() const
+{
+    vector<double> dets;
+    ldlt_block_dets(factor_, ipiv_, uplo_, dets);
+    double rst = 0.0;
+    for (size_t i = 0; i < dets.size(); ++i) {
+        rst += std::log(std::fabs(dets[i]));
+    }
+    return rst;
+}
+
+int LDLTFactorization::det_sign() const
+{
+    vector<double> dets;
+    ldlt_block_dets(factor_, ipiv_, uplo_, dets);
+    int sign = 1;
+    for (size_t i = 0; i < dets.size(); ++i) {
+        if (dets[i] < 0) {
+            sign = -sign;
+        }
+    }
+    return sign;
+}
+
+double LDLTFactorization::rcond() const
+{
+    if (this->dim() == 0) {
+        return 1.0;
+    }
+    const string used_uplo = lapack_uplo(uplo_);
+    blas_int n = to_blas_int(this->dim());
+    blas_int info = 0;
+    double rst = 0.0;
+    auto &ws = workspace::LapackWorkspace::local();
+    double *work = ws.work(2 * n);
+    blas_int *iwork = ws.iwork(n);
+    vector<blas_int> pivots;
+    lapack::dsycon_(used_uplo.c_str(), &n, factor_.data(), &n,
+                    blas_pivots(ipiv_, pivots), &anorm_, &rst, work, iwork,
+                    &info);
+    check_illegal_argument(info, __FUNCTION__);
+    return rst;
+}
+
+} // namespace matrix
@@ -0,0 +1,502 @@
+#include <matrix/details/blas.h>
+#include <matrix/details/exception.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MATRIX_GEMM_X86
+#include <immintrin.h>
+#endif
+
+#include "blas_base.h"
+#include "gemm.h"
+
+namespace matrix {
+
+namespace gemm {
+
+/**
+ * @brief Cache blocking sizes: a packed panel of op(B) has dimension
+ * [kKC, kNC], and a packed block of op(A) has dimension [kMC, kKC].
+ *
+ * @details kMC and kNC are multiples of the MR and NR of all the
+ * microkernels.
+ */
+static const int kKC = 256;
+static const int kMC = 144;
+static const int kNC = 3072;
+
+/**
+ * @brief The largest MR * NR of the microkernels.
+ */
+static const int kMaxTile = 24 * 8;
+
+/**
+ * @brief Microkernel computing a MR x NR tile of C:
+ * C = alpha * A_p * B_p + beta * C.
+ *
+ * @details A_p stores MR elements for each k continuously, and B_p stores NR
+ * elements for each k continuously. C is column-wise with leading dimension
+ * ldc. C is not read if beta is 0.
+ */
+typedef void (*micro_kernel)(int kc, double alpha, const double *a,
+                             const double *b, double beta, double *c,
+                             blas_int ldc);
+
+/**
+ * @brief Microkernel and its register block size.
+ */
+struct Kernel {
+    const char *name;
+    int mr;
+    int nr;
+    micro_kernel func;
+};
+
+/**
+ * @brief Generic 4 x 4 microkernel written in plain C++.
+ */
+static void kernel_generic_4x4(int kc, double alpha, const double *a,
+                               const double *b, double beta, double *c,
+                               blas_int ldc)
+{
+    double ab[4][4] = {{0.0}};
+    for (int p = 0; p < kc; p++) {
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+                ab[j][i] += a[i] * b[j];
+            }
+        }
+        a += 4;
+        b += 4;
+    }
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            if (beta == 0.0) {
+                c[i + j * ldc] = alpha * ab[j][i];
+            } else {
+                c[i + j * ldc] = alpha * ab[j][i] + beta * c[i + j * ldc];
+            }
+        }
+    }
+}
+
+#ifdef MATRIX_GEMM_X86
+
+// AVX2 8 x 6 microkernel: 12 ymm registers of C, 2 of A and 1 of B.
+#define AVX2_DECLARE_COL(j)                                                    \
+    __m256d c##j##0 = _mm256_setzero_pd();                                     \
+    __m256d c##j##1 = _mm256_setzero_pd();
+#define AVX2_UPDATE_COL(j)                                                     \
+    bj = _mm256_broadcast_sd(b + j);                                           \
+    c##j##0 = _mm256_fmadd_pd(a0, bj, c##j##0);                                \
+    c##j##1 = _mm256_fmadd_pd(a1, bj, c##j##1);
+#define AVX2_STORE(ptr, ab)                                                    \
+    if (beta == 0.0) {                                                         \
+        _mm256_storeu_pd(ptr, _mm256_mul_pd(va, ab));                          \
+    } else {                                                                   \
+        _mm256_storeu_pd(ptr, _mm256_fmadd_pd(vb, _mm256_loadu_pd(ptr),        \
+                                              _mm256_mul_pd(va, ab)));         \
+    }
+#define AVX2_STORE_COL(j)                                                      \
+    AVX2_STORE(c + j * ldc, c##j##0)                                           \
+    AVX2_STORE(c + j * ldc + 4, c##j##1)
+
+__attribute__((target("avx2,fma"))) static void
+kernel_avx2_8x6(int kc, double alpha, const double *a, const double *b,
+                double beta, double *c, blas_int ldc)
+{
+    AVX2_DECLARE_COL(0)
+    AVX2_DECLARE_COL(1)
+    AVX2_DECLARE_COL(2)
+    AVX2_DECLARE_COL(3)
+    AVX2_DECLARE_COL(4)
+    AVX2_DECLARE_COL(5)
+    for (int p = 0; p < kc; p++) {
+        const __m256d a0 = _mm256_loadu_pd(a);
+        const __m256d a1 = _mm256_loadu_pd(a + 4);
+        __m256d bj;
+        AVX2_UPDATE_COL(0)
+        AVX2_UPDATE_COL(1)
+        AVX2_UPDATE_COL(2)
+        AVX2_UPDATE_COL(3)
+        AVX2_UPDATE_COL(4)
+        AVX2_UPDATE_COL(5)
+        a += 8;
+        b += 6;
+    }
+    const __m256d va = _mm256_set1_pd(alpha);
+    const __m256d vb = _mm256_set1_pd(beta);
+    AVX2_STORE_COL(0)
+    AVX2_STORE_COL(1)
+    AVX2_STORE_COL(2)
+    AVX2_STORE_COL(3)
+    AVX2_STORE_COL(4)
+    AVX2_STORE_COL(5)
+}
+
+// AVX-512 24 x 8 microkernel: 24 zmm registers of C, 3 of A and 1 of B.
+#define AVX512_DECLARE_COL(j)                                                  \
+    __m512d c##j##0 = _mm512_setzero_pd();                                     \
+    __m512d c##j##1 = _mm512_setzero_pd();                                     \
+    __m512d c##j##2 = _mm512_setzero_pd();
+#define AVX512_UPDATE_COL(j)                                                   \
+    bj = _mm512_set1_pd(b[j]);                                                 \
+    c##j##0 = _mm512_fmadd_pd(a0, bj, c##j##0);                                \
+    c##j##1 = _mm512_fmadd_pd(a1, bj, c##j##1);                                \
+    c##j##2 = _mm512_fmadd_pd(a2, bj, c##j##2);
+#define AVX512_STORE(ptr, ab)                                                  \
+    if (beta == 0.0) {                                                         \
+        _mm512_storeu_pd(ptr, _mm512_mul_pd(va, ab));                          \
+    } else {                                                                   \
+        _mm512_storeu_pd(ptr, _mm512_fmadd_pd(vb, _mm512_loadu_pd(ptr),        \
+                                              _mm512_mul_pd(va, ab)));         \
+    }
+#define AVX512_STORE_COL(j)                                                    \
+    AVX512_STORE(c + j * ldc, c##j##0)                                         \
+    AVX512_STORE(c + j * ldc + 8, c##j##1)                                     \
+    AVX512_STORE(c + j * ldc + 16, c##j##2)
+
+__attribute__((target("avx512f"))) static void
+kernel_avx512_24x8(int kc, double alpha, const double *a, const double *b,
+                   double beta, double *c, blas_int ldc)
+{
+    AVX512_DECLARE_COL(0)
+    AVX512_DECLARE_COL(1)
+    AVX512_DECLARE_COL(2)
+    AVX512_DECLARE_COL(3)
+    AVX512_DECLARE_COL(4)
+    AVX512_DECLARE_COL(5)
+    AVX512_DECLARE_COL(6)
+    AVX512_DECLARE_COL(7)
+    for (int p = 0; p < kc; p++) {
+        const __m512d a0 = _mm512_loadu_pd(a);
+        const __m512d a1 = _mm512_loadu_pd(a + 8);
+        const __m512d a2 = _mm512_loadu_pd(a + 16);
+        __m512d bj;
+        AVX512_UPDATE_COL(0)
+        AVX512_UPDATE_COL(1)
+        AVX512_UPDATE_COL(2)
+        AVX512_UPDATE_COL(3)
+        AVX512_UPDATE_COL(4)
+        AVX512_UPDATE_COL(5)
+        AVX512_UPDATE_COL(6)
+        AVX512_UPDATE_COL(7)
+        a += 24;
+        b += 8;
+    }
+    const __m512d va = _mm512_set1_pd(alpha);
+    const __m512d vb = _mm512_set1_pd(beta);
+    AVX512_STORE_COL(0)
+    AVX512_STORE_COL(1)
+    AVX512_STORE_COL(2)
+    AVX512_STORE_COL(3)
+    AVX512_STORE_COL(4)
+    AVX512_STORE_COL(5)
+    AVX512_STORE_COL(6)
+    AVX512_STORE_COL(7)
+}
+
+#endif // MATRIX_GEMM_X86
+
+static const Kernel kGenericKernel = {"generic", 4, 4, kernel_generic_4x4};
+#ifdef MATRIX_GEMM_X86
+static const Kernel kAvx2Kernel = {"avx2", 8, 6, kernel_avx2_8x6};
+static const Kernel kAvx512Kernel = {"avx512", 24, 8, kernel_avx512_24x8};
+#endif
+
+/**
+ * @brief Check if a microkernel can run on the CPU.
+ */
+static bool is_kernel_supported(const Kernel *kernel)
+{
+#ifdef MATRIX_GEMM_X86
+    __builtin_cpu_init();
+    if (kernel == &kAvx512Kernel) {
+        return __builtin_cpu_supports("avx512f");
+    } else if (kernel == &kAvx2Kernel) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+#endif
+    return kernel == &kGenericKernel;
+}
+
+/**
+ * @brief Get the fastest microkernel supported by the CPU.
+ */
+static const Kernel *best_kernel()
+{
+#ifdef MATRIX_GEMM_X86
+    if (is_kernel_supported(&kAvx512Kernel)) {
+        return &kAvx512Kernel;
+    } else if (is_kernel_supported(&kAvx2Kernel)) {
+        return &kAvx2Kernel;
+    }
+#endif
+    return &kGenericKernel;
+}
+
+/**
+ * @brief The engine selected at build time, see engine().
+ */
+static const Kernel *default_engine()
+{
+#ifdef MATRIX_USE_INTERNAL_GEMM
+    return best_kernel();
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * @brief The engine used by dgemm(): nullptr for blas `dgemm`, otherwise the
+ * microkernel used by the built-in engine.
+ */
+static std::atomic<const Kernel *> &engine()
+{
+    static std::atomic<const Kernel *> kernel(default_engine());
+    return kernel;
+}
+
+/**
+ * @brief Pack a [mc, kc] block of op(A) starting at (i0, p0) into slivers of
+ * `mr` rows. Each sliver stores `mr` elements for each k continuously, and
+ * the rows out of the block are padded by zeros.
+ */
+static void pack_a(bool trans, int mc, int kc, const double *a, blas_int lda,
+                   blas_int i0, blas_int p0, int mr, double *buf)
+{
+    for (int ir = 0; ir < mc; ir += mr) {
+        const int mrr = std::min(mr, mc - ir);
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < mrr; i++) {
+                const size_t row = i0 + ir + i;
+                const size_t col = p0 + p;
+                buf[i] = trans ? a[col + row * lda] : a[row + col * lda];
+            }
+            std::fill(buf + mrr, buf + mr, 0.0);
+            buf += mr;
+        }
+    }
+}
+
+/**
+ * @brief Pack the `s`-th sliver of `nr` columns of a [kc, nc] panel of
+ * op(B) starting at (p0, j0). The sliver stores `nr` elements for each k
+ * continuously, and the columns out of the panel are padded by zeros.
+ */
+static void pack_b_sliver(bool trans, int s, int kc, int nc, const double *b,
+                          blas_int ldb, blas_int p0, blas_int j0, int nr,
+                          double *buf)
+{
+    const int jr = s * nr;
+    const int nrr = std::min(nr, nc - jr);
+    buf += (size_t)jr * kc;
+    for (int p = 0; p < kc; p++) {
+        for (int j = 0; j < nrr; j++) {
+            const size_t row = p0 + p;
+            const size_t col = j0 + jr + j;
+            buf[j] = trans ? b[col + row * ldb] : b[row + col * ldb];
+        }
+        std::fill(buf + nrr, buf + nr, 0.0);
+        buf += nr;
+    }
+}
+
+/**
+ * @brief C = beta * C, where C is not read if beta is 0.
+ */
+static void scale_c(blas_int m, blas_int n, double beta, double *c,
+                    blas_int ldc)
+{
+    if (beta == 1.0) {
+        return;
+    }
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (blas_int j = 0; j < n; j++) {
+        double *cj = c + (size_t)j * ldc;
+        for (blas_int i = 0; i < m; i++) {
+            cj[i] = (beta == 0.0 ? 0.0 : beta * cj[i]);
+        }
+    }
+}
+
+/**
+ * @brief Packing buffers of the calling thread. They only grow.
+ */
+static double *thread_buffer(std::vector<double> &buf, size_t size)
+{
+    if (buf.size() < size) {
+        buf.resize(size);
+    }
+    return buf.data();
+}
+
+static bool is_trans(const char *trans)
+{
+    return trans[0] == 'T' || trans[0] == 't' || trans[0] == 'C' ||
+           trans[0] == 'c';
+}
+
+/**
+ * @brief The built-in engine with a given microkernel.
+ *
+ * @details The loops follow the Goto algorithm: for each [kc, nc] panel of
+ * op(B), which is packed once and shared by the threads, the [mc, kc] blocks
+ * of op(A) are packed and multiplied with the panel by the microkernel. The
+ * macro-tiles (a block of op(A) times a range of the panel slivers) are
+ * distributed over the OpenMP threads.
+ */
+static void dgemm_kernel(const Kernel &kernel, bool trans_a, bool trans_b,
+                         blas_int m, blas_int n, blas_int k, double alpha,
+                         const double *a, blas_int lda, const double *b,
+                         blas_int ldb, double beta, double *c, blas_int ldc)
+{
+    if (m <= 0 || n <= 0) {
+        return;
+    }
+    if (alpha == 0.0 || k <= 0) {
+        scale_c(m, n, beta, c, ldc);
+        return;
+    }
+    const int mr = kernel.mr;
+    const int nr = kernel.nr;
+    static thread_local std::vector<double> b_buf;
+    double *b_pack = thread_buffer(b_buf, (size_t)kKC * kNC);
+
+    int nthreads = 1;
+#ifdef USE_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+
+    for (blas_int jc = 0; jc < n; jc += kNC) {
+        const int nc = (int)std::min<blas_int>(kNC, n - jc);
+        const int n_sliver = (nc + nr - 1) / nr;
+        for (blas_int pc = 0; pc < k; pc += kKC) {
+            const int kc = (int)std::min<blas_int>(kKC, k - pc);
+            const double beta_used = (pc == 0 ? beta : 1.0);
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+            for (int s = 0; s < n_sliver; s++) {
+                pack_b_sliver(trans_b, s, kc, nc, b, ldb, pc, jc, nr, b_pack);
+            }
+
+            // split the slivers of the panel if there are not enough blocks
+            // of op(A) to feed all the threads.
+            const blas_int n_block = (m + kMC - 1) / kMC;
+            const int n_split = (int)std::max<blas_int>(
+                1, std::min<blas_int>(n_sliver, nthreads / n_block));
+            const blas_int n_task = n_block * n_split;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (blas_int task = 0; task < n_task; task++) {
+                static thread_local std::vector<double> a_buf;
+                double *a_pack = thread_buffer(a_buf, (size_t)kMC * kKC);
+                double tile[kMaxTile];
+                const blas_int ic = (task / n_split) * kMC;
+                const int mc = (int)std::min<blas_int>(kMC, m - ic);
+                const int split = (int)(task % n_split);
+                const int s_begin = split * n_sliver / n_split;
+                const int s_end = (split + 1) * n_sliver / n_split;
+                pack_a(trans_a, mc, kc, a, lda, ic, pc, mr, a_pack);
+                for (int s = s_begin; s < s_end; s++) {
+                    const int jr = s * nr;
+                    const int nrr = std::min(nr, nc - jr);
+                    const double *bp = b_pack + (size_t)jr * kc;
+                    for (int ir = 0; ir < mc; ir += mr) {
+                        const int mrr = std::min(mr, mc - ir);
+                        const double *ap = a_pack + (size_t)ir * kc;
+                        double *cp = c + (ic + ir) + (size_t)(jc + jr) * ldc;
+                        if (mrr == mr && nrr == nr) {
+                            kernel.func(kc, alpha, ap, bp, beta_used, cp, ldc);
+                            continue;
+                        }
+                        // edge tile: computed in a local tile first.
+                        kernel.func(kc, alpha, ap, bp, 0.0, tile, mr);
+                        for (int j = 0; j < nrr; j++) {
+                            for (int i = 0; i < mrr; i++) {
+                                double &cij = cp[i + (size_t)j * ldc];
+                                const double ab = tile[i + j * mr];
+                                cij = (beta_used == 0.0 ? ab
+                                                        : ab + beta_used * cij);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void dgemm(const char *transa, const char *transb, const blas_int *m,
+           const blas_int *n, const blas_int *k, const double *alpha,
+           const double *a, const blas_int *lda, const double *b,
+           const blas_int *ldb, const double *beta, double *c,
+           const blas_int *ldc)
+{
+    const Kernel *kernel = engine().load();
+    if (kernel == nullptr) {
+        blas::dgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c,
+                     ldc);
+    } else {
+        dgemm_kernel(*kernel, is_trans(transa), is_trans(transb), *m, *n, *k,
+                     *alpha, a, *lda, b, *ldb, *beta, c, *ldc);
+    }
+}
+
+void reset_engine()
+{
+    engine().store(default_engine());
+}
+
+} // namespace gemm
+
+void set_dgemm_engine(const string &engine)
+{
+    const gemm::Kernel *kernel = nullptr;
+    if (engine == "blas") {
+        kernel = nullptr;
+    } else if (engine == "internal") {
+        kernel = gemm::best_kernel();
+    } else if (engine == "internal-generic") {
+        kernel = &gemm::kGenericKernel;
+#ifdef MATRIX_GEMM_X86
+    } else if (engine == "internal-avx2") {
+        kernel = &gemm::kAvx2Kernel;
+    } else if (engine == "internal-avx512") {
+        kernel = &gemm::kAvx512Kernel;
+#endif
+    } else {
+        throw exception::MatrixException(
+            "Error in matrix::set_dgemm_engine(): unknown dgemm engine: " +
+            engine);
+    }
+    if (kernel != nullptr && !gemm::is_kernel_supported(kernel)) {
+        throw exception::MatrixException(
+            "Error in matrix::set_dgemm_engine(): dgemm engine is not "
+            "supported by the CPU: " +
+            engine);
+    }
+    gemm::engine().store(kernel);
+}
+
+string get_dgemm_engine()
+{
+    const gemm::Kernel *kernel = gemm::engine().load();
+    if (kernel == nullptr) {
+        return "blas";
+    }
+    return string("internal-") + kernel->name;
+}
+
+} // namespace matrix
@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief built-in dgemm engine and the dgemm dispatch used by the library.
+ */
+#ifndef _MATRIX_SRC_GEMM_H_
+#define _MATRIX_SRC_GEMM_H_
+
+#include "blas_base.h"
+
+namespace matrix {
+
+namespace gemm {
+
+/**
+ * @brief dgemm used by the library. It calls blas `dgemm` or the built-in
+ * engine, according to the engine selected by set_dgemm_engine().
+ *
+ * @details The arguments are the same as blas `dgemm`.
+ */
+void dgemm(const char *transa, const char *transb, const blas_int *m,
+           const blas_int *n, const blas_int *k, const double *alpha,
+           const double *a, const blas_int *lda, const double *b,
+           const blas_int *ldb, const double *beta, double *c,
+           const blas_int *ldc);
+
+/**
+ * @brief Reset the engine used by dgemm() to the one selected at build time.
+ */
+void reset_engine();
+
+} // namespace gemm
+} // namespace matrix
+
+#endif // _MATRIX_SRC_GEMM_H_
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <matrix/details/exception.h>
 #include <matrix/details/lapack.h>
 #include <matrix/details/matrix.h>
@@ -6,6 +7,8 @@
 #include <string>
 
 #include "lapack_base.h"
+#include "lapack_utils.h"
+#include "workspace.h"
 
 namespace matrix {
 
@@ -26,21 +29,31 @@ int set_matrix_random_orthogonal(Matrix &Q, bool using_fixed_seed)
     else
         Q.randomize(0, 1);
 
+    if (Q.size() == 0) {
+        return 0;
+    }
+
     // QR factorization to get Q matrix.
-    int n = Q.col();
-    int lwork = -1;
-    int info = 0;
-    double work_opt = 0;
-    vector<int> jpvt(n);
-    vector<double> tau(n);
+    blas_int n = to_blas_int(Q.col());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    // all columns are free columns for pivoting.
+    blas_int *jpvt = ws.iwork(n);
+    std::fill(jpvt, jpvt + n, 0);
+    double *tau = ws.aux(n);
     // query work space.
-    lapack::dgeqp3_(&n, &n, Q.data(), &n, jpvt.data(), tau.data(), &work_opt,
-                    &lwork, &info);
-    lwork = (int)work_opt;
-    vector<double> work(lwork);
+    blas_int lwork_qr = ws.optimal_lwork(
+        workspace::kDgeqp3, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dgeqp3_(&n, &n, Q.data(), &n, jpvt, tau, wkopt, lwork,
+                            &info);
+        });
+    blas_int lwork_q = ws.optimal_lwork(
+        workspace::kDorgqr, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dorgqr_(&n, &n, &n, Q.data(), &n, tau, wkopt, lwork, &info);
+        });
+    double *work = ws.work(std::max(lwork_qr, lwork_q));
     // do qr factorization.
-    lapack::dgeqp3_(&n, &n, Q.data(), &n, jpvt.data(), tau.data(), work.data(),
-                    &lwork, &info);
+    lapack::dgeqp3_(&n, &n, Q.data(), &n, jpvt, tau, work, &lwork_qr, &info);
     if (info < 0) {
         std::stringstream msg;
         msg << "QR factorization failed. "
@@ -48,8 +61,7 @@ int set_matrix_random_orthogonal(Matrix &Q, bool using_fixed_seed)
         throw matrix::exception::MatrixOperationError(__FUNCTION__, msg.str());
     }
     // retrieve Q matrix from dgeqp3
-    lapack::dorgqr_(&n, &n, &n, Q.data(), &n, tau.data(), work.data(), &lwork,
-                    &info);
+    lapack::dorgqr_(&n, &n, &n, Q.data(), &n, tau, work, &lwork_q, &info);
     if (info < 0) {
         std::stringstream msg;
         msg << "Retrieve Q matrix failed. "
@@ -84,21 +96,22 @@ int diagonalize_sym_matrix_dsyev(const string &uplo, Matrix &A,
             "Unkown label to access a symmetric matrix data: label=" + uplo);
     }
 
-    int row = A.row();
-    int n = row;
-    int lda = row;
-    int info = 0;
-    double wkopt = 0.0;
+    blas_int row = to_blas_int(A.row());
+    blas_int n = row;
+    blas_int lda = row;
+    blas_int info = 0;
     // Query and allocate the optimal workspace
-    int lwork = -1;
-    lapack::dsyev_("V", used_uplo.c_str(), &n, A.data(), &lda, eig.data(),
-                   &wkopt, &lwork, &info);
-    lwork = (int)wkopt;
-    vector<double> work(lwork);
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDsyev, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dsyev_("V", used_uplo.c_str(), &n, A.data(), &lda,
+                           eig.data(), wkopt, lwork, &info);
+        });
+    double *work = ws.work(lwork);
 
     // Solve eigenvalue decomposition.
-    lapack::dsyev_("V", used_uplo.c_str(), &n, A.data(), &lda, eig.data(),
-                   work.data(), &lwork, &info);
+    lapack::dsyev_("V", used_uplo.c_str(), &n, A.data(), &lda, eig.data(), work,
+                   &lwork, &info);
 
     // Check exit status
     if (info > 0) {
@@ -123,13 +136,20 @@ int invert_gen_matrix_dgetri(Matrix &A)
             "Cannot invert a matrix that is not square.");
     }
 
-    int n = A.row();
-    int lwork = n;
-    int info = 0;
-    vector<double> work(lwork);
-    vector<int> ipiv(n);
-    lapack::dgetrf_(&n, &n, A.data(), &n, ipiv.data(), &info);
-    lapack::dgetri_(&n, A.data(), &n, ipiv.data(), work.data(), &lwork, &info);
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int *ipiv = ws.iwork(n);
+    // query and allocate the optimal workspace.
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDgetri, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dgetri_(&n, A.data(), &n, ipiv, wkopt, lwork, &info);
+        });
+    double *work = ws.work(lwork);
+    lapack::dgetrf_(&n, &n, A.data(), &n, ipiv, &info);
+    if (info == 0) {
+        lapack::dgetri_(&n, A.data(), &n, ipiv, work, &lwork, &info);
+    }
 
     if (info < 0) {
         std::stringstream msg;
@@ -137,11 +157,12 @@ int invert_gen_matrix_dgetri(Matrix &A)
         throw matrix::exception::MatrixOperationError(__FUNCTION__, msg.str());
     } else if (info > 0) {
         std::stringstream msg;
-        msg << "U(" << -info << "," << -info
+        msg << "U(" << info << "," << info
             << ") is exactly zero; the matrix is"
             << " singular and its inverse could not be computed.\n";
         throw matrix::exception::MatrixOperationError(__FUNCTION__, msg.str());
     }
+    return 0;
 }
 
 /**
@@ -167,8 +188,8 @@ int invert_spd_matrix_dpotri(const string &uplo, Matrix &A)
             "Unkown label to access a symmetric matrix data: label=" + uplo);
     }
 
-    int n = A.row();
-    int info = 0;
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
     // call LAPACK to invert the matrix
     lapack::dpotrf_(used_uplo.c_str(), &n, A.data(), &n, &info);
     lapack::dpotri_(used_uplo.c_str(), &n, A.data(), &n, &info);
@@ -207,21 +228,24 @@ int invert_sym_matrix_dsytri(const string &uplo, Matrix &A)
             "Unknown label to access a symmetric matrix data: label=" + uplo);
     }
 
-    int n = A.row();
-    int info = 0;
-    double workopt = 0;
-    vector<int> ipiv(n);
-    // query and allocate the optimal workspace.
-    int lwork = -1;
-    lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(), &workopt,
-                    &lwork, &info);
-    lwork = (int)workopt;
-    vector<double> work(lwork);
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int *ipiv = ws.iwork(n);
+    // query and allocate the optimal workspace. `dsytri` needs n elements.
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDsytrf, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv,
+                            wkopt, lwork, &info);
+        });
+    double *work = ws.work(std::max(lwork, n));
     // call LAPACK to invert the matrix
-    lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(),
-                    work.data(), &lwork, &info);
-    lapack::dsytri_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(),
-                    work.data(), &info);
+    lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv, work, &lwork,
+                    &info);
+    if (info == 0) {
+        lapack::dsytri_(used_uplo.c_str(), &n, A.data(), &n, ipiv, work,
+                        &info);
+    }
     if (info < 0) {
         std::stringstream msg;
         msg << "The " << -info << "-th arguments had an illegal value.";
@@ -256,21 +280,24 @@ int invert_sym_matrix_dsytri_rook(const string &uplo, Matrix &A)
             "Unknown label to access a symmetric matrix data: label=" + uplo);
     }
 
-    int n = A.row();
-    int info = 0;
-    double workopt = 0;
-    vector<int> ipiv(n);
-    // query and allocate the optimal workspace.
-    int lwork = -1;
-    lapack::dsytrf_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(),
-                         &workopt, &lwork, &info);
-    lwork = (int)workopt;
-    vector<double> work(lwork);
+    blas_int n = to_blas_int(A.row());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int *ipiv = ws.iwork(n);
+    // query and allocate the optimal workspace. `dsytri_rook` needs n elements.
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDsytrfRook, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dsytrf_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv,
+                                 wkopt, lwork, &info);
+        });
+    double *work = ws.work(std::max(lwork, n));
     // call LAPACK to invert the matrix
-    lapack::dsytrf_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(),
-                         work.data(), &lwork, &info);
-    lapack::dsytri_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv.data(),
-                         work.data(), &info);
+    lapack::dsytrf_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv, work,
+                         &lwork, &info);
+    if (info == 0) {
+        lapack::dsytri_rook_(used_uplo.c_str(), &n, A.data(), &n, ipiv, work,
+                             &info);
+    }
     if (info < 0) {
         std::stringstream msg;
         msg << "The " << -info << "-th arguments had an illegal value.";
@@ -286,4 +313,153 @@ int invert_sym_matrix_dsytri_rook(const string &uplo, Matrix &A)
     return 0;
 }
 
+/**
+ * @brief Check the dimension of linear system A * X = B.
+ */
+static void check_linear_system(const Matrix &A, const Matrix &B,
+                                const char *func_name)
+{
+    if (&A == &B) {
+        throw exception::MatrixException(
+            string("Error in matrix::") + func_name +
+            "(): the right-hand sides cannot be the coefficient matrix.");
+    } else if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Cannot solve a linear system whose matrix is not square.");
+    } else if (A.row() != B.row()) {
+        throw exception::DimensionError(
+            A, B,
+            string("Error in matrix::") + func_name +
+                "(): dimension error between matrix A and B.");
+    }
+}
+
+/**
+ * @note The general matrix A is seen by lapack as A^T, so A * X = B is solved
+ * with the transposed LU factors.
+ */
+int solve_gen_matrix_dgetrs(Matrix &A, Matrix &B)
+{
+    check_linear_system(A, B, "solve_gen_matrix_dgetrs");
+    if (B.size() == 0) {
+        return 0;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    blas_int *ipiv = workspace::LapackWorkspace::local().iwork(n);
+    lapack::dgetrf_(&n, &n, A.data(), &n, ipiv, &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    } else if (info > 0) {
+        std::stringstream msg;
+        msg << "U(" << info << "," << info << ") is exactly zero; the matrix "
+            << "is singular and the solution could not be computed.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dgetrs_("T", &n, &nrhs, A.data(), &n, ipiv, b, &n, &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+/**
+ * @note The positive definite propoty (spd) of the input matrix is checked
+ * by the Cholesky factorization.
+ */
+int solve_spd_matrix_dpotrs(const string &uplo, Matrix &A, Matrix &B)
+{
+    check_linear_system(A, B, "solve_spd_matrix_dpotrs");
+
+    const string used_uplo = lapack_uplo(uplo);
+    if (B.size() == 0) {
+        return 0;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    lapack::dpotrf_(used_uplo.c_str(), &n, A.data(), &n, &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    } else if (info > 0) {
+        std::stringstream msg;
+        msg << "The leading minor of order " << info
+            << " is not positive definite, and the factorization could not "
+               "be completed.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dpotrs_(used_uplo.c_str(), &n, &nrhs, A.data(), &n, b, &n, &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+int solve_sym_matrix_dsytrs(const string &uplo, Matrix &A, Matrix &B)
+{
+    check_linear_system(A, B, "solve_sym_matrix_dsytrs");
+
+    const string used_uplo = lapack_uplo(uplo);
+    if (B.size() == 0) {
+        return 0;
+    }
+
+    blas_int n = to_blas_int(A.row());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int *ipiv = ws.iwork(n);
+    // query and allocate the optimal workspace.
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDsytrf, n, [&](double *wkopt, blas_int *lwork) {
+            lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv, wkopt,
+                            lwork, &info);
+        });
+    double *work = ws.work(lwork);
+    // call LAPACK to factorize the matrix
+    lapack::dsytrf_(used_uplo.c_str(), &n, A.data(), &n, ipiv, work, &lwork,
+                    &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    } else if (info > 0) {
+        std::stringstream msg;
+        msg << "D(" << info << "," << info << ") = zero; the matrix is "
+            << "singular and the solution could not be computed.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    lapack::dsytrs_(used_uplo.c_str(), &n, &nrhs, A.data(), &n, ipiv, b, &n,
+                    &info);
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
 } // namespace matrix
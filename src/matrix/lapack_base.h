@@ -5,38 +5,215 @@
 #ifndef _MATRIX_SRC_LAPACK_BASE_H_
 #define _MATRIX_SRC_LAPACK_BASE_H_
 
+#include "blas_base.h"
+
 namespace matrix {
 
 namespace lapack {
 
-extern "C" void dsyev_(const char *jobz, const char *uplo, const int *N,
-                       double *A, const int *lda, double *eig, double *work,
-                       const int *lwork, int *info);
-extern "C" void dgeqp3_(const int *M, const int *N, double *A, const int *lda,
-                        int *jpvt, double *tau, double *work, int *lwork,
-                        int *info);
-extern "C" void dorgqr_(const int *M, const int *N, const int *K, double *A,
-                        const int *lda, double *tau, double *work, int *lwork,
-                        int *info);
-extern "C" void dgetrf_(const int *m, const int *n, double *a, const int *lda,
-                        int *ipiv, int *info);
-extern "C" void dgetri_(const int *n, double *a, const int *lda, int *ipiv,
-                        double *work, int *lwork, int *info);
-extern "C" void dpotrf_(const char *uplo, const int *n, double *a,
-                        const int *lda, int *info);
-extern "C" void dpotri_(const char *uplo, const int *n, double *a,
-                        const int *lda, int *info);
-extern "C" void dsytrf_(const char *uplo, const int *n, double *a,
-                        const int *lda, int *ipiv, double *work, int *lwork,
-                        int *info);
-extern "C" void dsytri_(const char *uplo, const int *n, double *a,
-                        const int *lda, int *ipiv, double *work, int *info);
-extern "C" void dsytrf_rook_(const char *uplo, const int *n, double *a,
-                             const int *lda, int *ipiv, double *work,
-                             int *lwork, int *info);
-extern "C" void dsytri_rook_(const char *uplo, const int *n, double *a,
-                             const int *lda, int *ipiv, double *work,
-                             int *info);
+/**
+ * @brief lapack symbols linked at build time.
+ */
+namespace linked {
+
+extern "C" void dsyev_(const char *jobz, const char *uplo, const blas_int *N,
+                       double *A, const blas_int *lda, double *eig,
+                       double *work, const blas_int *lwork, blas_int *info);
+extern "C" void dgeqp3_(const blas_int *M, const blas_int *N, double *A,
+                        const blas_int *lda, blas_int *jpvt, double *tau,
+                        double *work, blas_int *lwork, blas_int *info);
+extern "C" void dorgqr_(const blas_int *M, const blas_int *N, const blas_int *K,
+                        double *A, const blas_int *lda, double *tau,
+                        double *work, blas_int *lwork, blas_int *info);
+extern "C" void dgetrf_(const blas_int *m, const blas_int *n, double *a,
+                        const blas_int *lda, blas_int *ipiv, blas_int *info);
+extern "C" void dgetri_(const blas_int *n, double *a, const blas_int *lda,
+                        blas_int *ipiv, double *work, blas_int *lwork,
+                        blas_int *info);
+extern "C" void dpotrf_(const char *uplo, const blas_int *n, double *a,
+                        const blas_int *lda, blas_int *info);
+extern "C" void dpotri_(const char *uplo, const blas_int *n, double *a,
+                        const blas_int *lda, blas_int *info);
+extern "C" void dsytrf_(const char *uplo, const blas_int *n, double *a,
+                        const blas_int *lda, blas_int *ipiv, double *work,
+                        blas_int *lwork, blas_int *info);
+extern "C" void dsytri_(const char *uplo, const blas_int *n, double *a,
+                        const blas_int *lda, const blas_int *ipiv, double *work,
+                        blas_int *info);
+extern "C" void dgetrs_(const char *trans, const blas_int *n,
+                        const blas_int *nrhs, const double *a,
+                        const blas_int *lda, const blas_int *ipiv, double *b,
+                        const blas_int *ldb, blas_int *info);
+extern "C" void dpotrs_(const char *uplo, const blas_int *n,
+                        const blas_int *nrhs, const double *a,
+                        const blas_int *lda, double *b, const blas_int *ldb,
+                        blas_int *info);
+extern "C" void dsytrs_(const char *uplo, const blas_int *n,
+                        const blas_int *nrhs, const double *a,
+                        const blas_int *lda, const blas_int *ipiv, double *b,
+                        const blas_int *ldb, blas_int *info);
+extern "C" void dgecon_(const char *norm, const blas_int *n, const double *a,
+                        const blas_int *lda, const double *anorm, double *rcond,
+                        double *work, blas_int *iwork, blas_int *info);
+extern "C" void dpocon_(const char *uplo, const blas_int *n, const double *a,
+                        const blas_int *lda, const double *anorm, double *rcond,
+                        double *work, blas_int *iwork, blas_int *info);
+extern "C" void dsycon_(const char *uplo, const blas_int *n, const double *a,
+                        const blas_int *lda, const blas_int *ipiv,
+                        const double *anorm, double *rcond, double *work,
+                        blas_int *iwork, blas_int *info);
+extern "C" void dsytrf_rook_(const char *uplo, const blas_int *n, double *a,
+                             const blas_int *lda, blas_int *ipiv, double *work,
+                             blas_int *lwork, blas_int *info);
+extern "C" void dsytri_rook_(const char *uplo, const blas_int *n, double *a,
+                             const blas_int *lda, blas_int *ipiv, double *work,
+                             blas_int *info);
+
+extern "C" void dpftrf_(const char *transr, const char *uplo, const blas_int *n,
+                        double *a, blas_int *info);
+extern "C" void dpftri_(const char *transr, const char *uplo, const blas_int *n,
+                        double *a, blas_int *info);
+extern "C" void dpftrs_(const char *transr, const char *uplo, const blas_int *n,
+                        const blas_int *nrhs, const double *a, double *b,
+                        const blas_int *ldb, blas_int *info);
+extern "C" void dsfrk_(const char *transr, const char *uplo, const char *trans,
+                       const blas_int *n, const blas_int *k,
+                       const double *alpha, const double *a,
+                       const blas_int *lda, const double *beta, double *c);
+extern "C" void dtrttf_(const char *transr, const char *uplo, const blas_int *n,
+                        const double *a, const blas_int *lda, double *arf,
+                        blas_int *info);
+extern "C" void dtfttr_(const char *transr, const char *uplo, const blas_int *n,
+                        const double *arf, double *a, const blas_int *lda,
+                        blas_int *info);
+extern "C" void dtpttf_(const char *transr, const char *uplo, const blas_int *n,
+                        const double *ap, double *arf, blas_int *info);
+extern "C" void dtfttp_(const char *transr, const char *uplo, const blas_int *n,
+                        const double *arf, double *ap, blas_int *info);
+extern "C" void dtrttp_(const char *uplo, const blas_int *n, const double *a,
+                        const blas_int *lda, double *ap, blas_int *info);
+extern "C" void dtpttr_(const char *uplo, const blas_int *n, const double *ap,
+                        double *a, const blas_int *lda, blas_int *info);
+extern "C" void dpptrf_(const char *uplo, const blas_int *n, double *ap,
+                        blas_int *info);
+extern "C" void dpptri_(const char *uplo, const blas_int *n, double *ap,
+                        blas_int *info);
+extern "C" void dpptrs_(const char *uplo, const blas_int *n,
+                        const blas_int *nrhs, const double *ap, double *b,
+                        const blas_int *ldb, blas_int *info);
+extern "C" void dspevd_(const char *jobz, const char *uplo, const blas_int *n,
+                        double *ap, double *w, double *z, const blas_int *ldz,
+                        double *work, const blas_int *lwork, blas_int *iwork,
+                        const blas_int *liwork, blas_int *info);
+
+extern "C" void dgbsv_(const blas_int *n, const blas_int *kl,
+                       const blas_int *ku, const blas_int *nrhs, double *ab,
+                       const blas_int *ldab, blas_int *ipiv, double *b,
+                       const blas_int *ldb, blas_int *info);
+extern "C" void dgbtrf_(const blas_int *m, const blas_int *n,
+                        const blas_int *kl, const blas_int *ku, double *ab,
+                        const blas_int *ldab, blas_int *ipiv, blas_int *info);
+extern "C" void dgbtrs_(const char *trans, const blas_int *n,
+                        const blas_int *kl, const blas_int *ku,
+                        const blas_int *nrhs, const double *ab,
+                        const blas_int *ldab, const blas_int *ipiv, double *b,
+                        const blas_int *ldb, blas_int *info);
+extern "C" void dpbsv_(const char *uplo, const blas_int *n, const blas_int *kd,
+                       const blas_int *nrhs, double *ab, const blas_int *ldab,
+                       double *b, const blas_int *ldb, blas_int *info);
+extern "C" void dgtsv_(const blas_int *n, const blas_int *nrhs, double *dl,
+                       double *d, double *du, double *b, const blas_int *ldb,
+                       blas_int *info);
+extern "C" void dptsv_(const blas_int *n, const blas_int *nrhs, double *d,
+                       double *e, double *b, const blas_int *ldb,
+                       blas_int *info);
+extern "C" void dstevr_(const char *jobz, const char *range, const blas_int *n,
+                        double *d, double *e, const double *vl,
+                        const double *vu, const blas_int *il,
+                        const blas_int *iu, const double *abstol, blas_int *m,
+                        double *w, double *z, const blas_int *ldz,
+                        blas_int *isuppz, double *work, const blas_int *lwork,
+                        blas_int *iwork, const blas_int *liwork,
+                        blas_int *info);
+extern "C" void dstemr_(const char *jobz, const char *range, const blas_int *n,
+                        double *d, double *e, const double *vl,
+                        const double *vu, const blas_int *il,
+                        const blas_int *iu, blas_int *m, double *w, double *z,
+                        const blas_int *ldz, const blas_int *nzc,
+                        blas_int *isuppz, blas_int *tryrac, double *work,
+                        const blas_int *lwork, blas_int *iwork,
+                        const blas_int *liwork, blas_int *info);
+
+} // namespace linked
+
+// clang-format off
+#define MATRIX_LAPACK_SYMBOLS(X) \
+    X(dsyev_) \
+    X(dgeqp3_) \
+    X(dorgqr_) \
+    X(dgetrf_) \
+    X(dgetri_) \
+    X(dpotrf_) \
+    X(dpotri_) \
+    X(dsytrf_) \
+    X(dsytri_) \
+    X(dgetrs_) \
+    X(dpotrs_) \
+    X(dsytrs_) \
+    X(dgecon_) \
+    X(dpocon_) \
+    X(dsycon_) \
+    X(dsytrf_rook_) \
+    X(dsytri_rook_) \
+    X(dpftrf_) \
+    X(dpftri_) \
+    X(dpftrs_) \
+    X(dsfrk_) \
+    X(dtrttf_) \
+    X(dtfttr_) \
+    X(dtpttf_) \
+    X(dtfttp_) \
+    X(dtrttp_) \
+    X(dtpttr_) \
+    X(dpptrf_) \
+    X(dpptri_) \
+    X(dpptrs_) \
+    X(dspevd_) \
+    X(dgbsv_) \
+    X(dgbtrf_) \
+    X(dgbtrs_) \
+    X(dpbsv_) \
+    X(dgtsv_) \
+    X(dptsv_) \
+    X(dstevr_) \
+    X(dstemr_)
+// clang-format on
+
+/**
+ * @brief Dispatch table of the lapack functions used by the library.
+ */
+struct Table {
+#define MATRIX_LAPACK_TABLE_ENTRY(name) decltype(&linked::name) name;
+    MATRIX_LAPACK_SYMBOLS(MATRIX_LAPACK_TABLE_ENTRY)
+#undef MATRIX_LAPACK_TABLE_ENTRY
+};
+
+/**
+ * @brief Get the dispatch table of the active lapack backend.
+ * @details It is defined in backend.cpp.
+ */
+const Table &table();
+
+// The lapack functions called by the library, e.g. `lapack::dgeqp3_(...)`, are
+// forwarded to the active backend.
+#define MATRIX_LAPACK_WRAPPER(name)                                            \
+    template <typename... Args>                                                \
+    inline auto name(Args... args)->decltype(linked::name(args...))            \
+    {                                                                          \
+        return table().name(args...);                                          \
+    }
+MATRIX_LAPACK_SYMBOLS(MATRIX_LAPACK_WRAPPER)
+#undef MATRIX_LAPACK_WRAPPER
 
 } // namespace lapack
 } // namespace matrix
@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief helper functions shared by the lapack wrappers.
+ */
+#ifndef _MATRIX_SRC_LAPACK_UTILS_H_
+#define _MATRIX_SRC_LAPACK_UTILS_H_
+
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix.h>
+#include <string>
+#include <vector>
+
+#include "blas_base.h"
+
+namespace matrix {
+
+/**
+ * @brief Get the lapack label of the triangular part of a row-wise stored
+ * symmetric matrix.
+ *
+ * @details The upper triangular part of a row-wise matrix is the lower
+ * triangular part seen by lapack, and vice versa.
+ *
+ * @param [in] uplo: "U" or "L" for the row-wise matrix.
+ * @return string: "L" or "U" used by lapack.
+ */
+inline string lapack_uplo(const string &uplo)
+{
+    if (uplo == "U") {
+        return "L";
+    } else if (uplo == "L") {
+        return "U";
+    } else {
+        throw exception::MatrixException(
+            "Unknown label to access a symmetric matrix data: label=" + uplo);
+    }
+}
+
+/**
+ * @brief Get the column-wise storage of the right-hand sides B used by lapack.
+ *
+ * @details Matrix B is stored row-wise, while lapack expects each right-hand
+ * side to be stored continuously. When B has a single column, no copy is
+ * needed and the data of B is used directly.
+ *
+ * @param [in] B: The right-hand sides.
+ * @param [out] buf: Buffer that stores the column-wise copy of B if needed.
+ * @return double *: pointer to the column-wise right-hand sides.
+ */
+inline double *column_wise_rhs(Matrix &B, vector<double> &buf)
+{
+    const size_t n = B.row();
+    const size_t nrhs = B.col();
+    if (nrhs == 1) {
+        buf.clear();
+        return B.data();
+    }
+    buf.resize(B.size());
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < nrhs; ++j) {
+            buf[j * n + i] = B(i, j);
+        }
+    }
+    return buf.data();
+}
+
+/**
+ * @brief Copy the column-wise solution back into the row-wise matrix B.
+ * @see column_wise_rhs()
+ */
+inline void restore_row_wise_rhs(const vector<double> &buf, Matrix &B)
+{
+    if (buf.empty()) {
+        return;
+    }
+    const size_t n = B.row();
+    const size_t nrhs = B.col();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < nrhs; ++j) {
+            B(i, j) = buf[j * n + i];
+        }
+    }
+}
+
+/**
+ * @brief Get the pivots in the integer type used by lapack.
+ *
+ * @details The pivots are stored as `int`, which is the integer type of
+ * lapack unless the library is built with ILP64 lapack. In that case, the
+ * pivots are copied into \p buf, otherwise the data of \p ipiv is used
+ * directly.
+ *
+ * @param [in] ipiv: the pivots.
+ * @param [out] buf: Buffer that stores the converted pivots if needed.
+ * @return blas_int *: pointer to the pivots used by lapack.
+ */
+inline blas_int *blas_pivots(vector<int> &ipiv, vector<blas_int> &buf)
+{
+#ifdef MATRIX_BLAS_ILP64
+    buf.assign(ipiv.begin(), ipiv.end());
+    return buf.data();
+#else
+    buf.clear();
+    return ipiv.data();
+#endif
+}
+
+/**
+ * @brief Get the read-only pivots in the integer type used by lapack.
+ * @see blas_pivots()
+ */
+inline const blas_int *blas_pivots(const vector<int> &ipiv,
+                                   vector<blas_int> &buf)
+{
+#ifdef MATRIX_BLAS_ILP64
+    buf.assign(ipiv.begin(), ipiv.end());
+    return buf.data();
+#else
+    buf.clear();
+    return ipiv.data();
+#endif
+}
+
+/**
+ * @brief Copy the pivots computed by lapack back into \p ipiv.
+ * @see blas_pivots()
+ */
+inline void restore_pivots(const vector<blas_int> &buf, vector<int> &ipiv)
+{
+    if (buf.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < ipiv.size(); ++i) {
+        ipiv[i] = (int)buf[i];
+    }
+}
+
+} // namespace matrix
+
+#endif // _MATRIX_SRC_LAPACK_UTILS_H_
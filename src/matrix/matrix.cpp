@@ -36,8 +36,7 @@ Matrix::Matrix(size_t row, size_t col, double *inp_data_ptr, CopyType copy_type)
     if (copy_type == kDeepCopy) {
         data_vec_.resize(size_);
         data_ptr_ = data_vec_.data();
-        int dim = size_;
-        blas::dcopy_(&dim, inp_data_ptr, blas::ione, data_ptr_, blas::ione);
+        blas::dcopy_chunked(size_, inp_data_ptr, data_ptr_);
     } else if (copy_type == kShallowCopy) {
         data_ptr_ = inp_data_ptr;
     } else {
@@ -46,6 +45,13 @@ Matrix::Matrix(size_t row, size_t col, double *inp_data_ptr, CopyType copy_type)
     }
 }
 
+Matrix::Matrix(size_t row, size_t col, double *inp_data_ptr,
+               std::shared_ptr<void> owner)
+    : row_(row), col_(col), size_(row * col), data_vec_(0),
+      data_ptr_(inp_data_ptr), data_owner_(std::move(owner))
+{
+}
+
 /**
  * @note This will always do the deep copy.
  */
@@ -53,8 +59,7 @@ Matrix::Matrix(const Matrix &other)
     : row_{other.row()}, col_{other.col()}, size_{other.size()},
       data_vec_(size_), data_ptr_{data_vec_.data()}
 {
-    int dim = size_;
-    blas::dcopy_(&dim, other.data(), blas::ione, data_ptr_, blas::ione);
+    blas::dcopy_chunked(size_, other.data(), data_ptr_);
 }
 
 /**
@@ -71,8 +76,8 @@ Matrix &Matrix::operator=(const Matrix &other)
     size_ = other.size();
     data_vec_.resize(size_);
     data_ptr_ = data_vec_.data();
-    int dim = size_;
-    blas::dcopy_(&dim, other.data(), blas::ione, data_ptr_, blas::ione);
+    blas::dcopy_chunked(size_, other.data(), data_ptr_);
+    data_owner_.reset();
     return *this;
 }
 
@@ -88,6 +93,7 @@ const Matrix &Matrix::operator=(std::initializer_list<double> init_list)
         this->data()[i] = *p;
         i++;
     }
+    return *this;
 }
 
 const double &Matrix::at(size_t i, size_t j) const
@@ -111,7 +117,7 @@ void Matrix::show_full(size_t elements_per_line) const
     size_t k = 0;
     for (size_t i = 0; i < row_; i++) {
         printf(" %5zu:\n", i + 1);
-        for (int j = 1; j <= col_; j++) {
+        for (size_t j = 1; j <= col_; j++) {
             printf(" %15.8e,", this->data()[k]);
             if (j % elements_per_line == 0 && j != col_) {
                 printf("\n");
@@ -129,8 +135,8 @@ void Matrix::show_lower(size_t elements_per_line) const
            col_);
     for (size_t i = 0; i < row_; i++) {
         printf(" %5zu:\n", i + 1);
-        for (int j = 0; j <= i; j++) {
-            int ij = i * col_ + j;
+        for (size_t j = 0; j <= i; j++) {
+            size_t ij = i * col_ + j;
             printf(" %15.8e,", this->data()[ij]);
             if ((j + 1) % elements_per_line == 0 && j != i) {
                 printf("\n");
@@ -269,6 +275,7 @@ void Matrix::resize(size_t row, size_t col)
     col_ = col;
     size_ = row * col;
     data_ptr_ = data_vec_.data();
+    data_owner_.reset();
 }
 
 void Matrix::to_symmetric(const string &uplo)
@@ -317,8 +324,7 @@ void Matrix::randomize_seed_fixed(double a, double b)
 
 void Matrix::scale(const double alpha)
 {
-    int size = size_;
-    blas::dscal_(&size, &alpha, this->data(), blas::ione);
+    blas::dscal_chunked(size_, alpha, this->data());
 }
 
 void Matrix::fill_all(double a)
@@ -1,14 +1,40 @@
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <matrix/details/container.h>
 #include <matrix/details/exception.h>
+#include <matrix/details/factorization.h>
 #include <matrix/details/matrix.h>
 #include <matrix/details/matrix_io.h>
+#include <matrix/details/sparse_matrix.h>
 #include <sstream>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include "container_format.h"
+#include "parallel_io.h"
+#include "text_format.h"
+#include "text_parser.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace matrix {
+
+/**
+ * @brief Size in bytes of the [row, col] header of a matrix in a binary file.
+ */
+static const size_t kBinaryHeaderSize = 2 * sizeof(size_t);
+
 void write_matrices_to_binary(vector<std::shared_ptr<const Matrix>> &Mat,
                               const char *fname)
 {
@@ -20,15 +46,73 @@ void write_matrices_to_binary(vector<std::shared_ptr<const Matrix>> &Mat,
         }
     }
 
-    FILE *f = fopen(fname, "wb");
-    for (size_t i = 0; i < Mat.size(); i++) {
-        size_t row = Mat[i]->row();
-        size_t col = Mat[i]->col();
-        fwrite(&row, sizeof(row), 1, f);
-        fwrite(&col, sizeof(col), 1, f);
-        fwrite(Mat[i]->data(), sizeof(double), row * col, f);
+    int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot write matrix binary file.");
+    }
+    try {
+        uint64_t offset = 0;
+        for (size_t i = 0; i < Mat.size(); i++) {
+            const size_t header[2] = {Mat[i]->row(), Mat[i]->col()};
+            const size_t size = Mat[i]->size() * sizeof(double);
+            container::pwrite_all(fd, header, kBinaryHeaderSize, offset,
+                                  fname);
+            offset += kBinaryHeaderSize;
+            pio::write(fd, fname, Mat[i]->data(), size, offset);
+            offset += size;
+        }
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    if (close(fd) != 0) {
+        throw exception::MatrixIOException(
+            fname, string("Fail to write file: ") + std::strerror(errno));
     }
-    fclose(f);
+}
+
+/**
+ * @brief Open a plain binary matrix file for reading, and get its size.
+ */
+static int open_binary(const char *fname, uint64_t &file_size)
+{
+    int fd = open(fname, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot read matrix binary file.");
+    }
+    file_size = st.st_size;
+    return fd;
+}
+
+/**
+ * @brief Read the header of the matrix at \p offset of a plain binary
+ * matrix file, and check that the data is inside the file.
+ *
+ * @return bool: false if there is no complete header at \p offset.
+ */
+static bool read_binary_header(int fd, const char *fname, uint64_t offset,
+                               uint64_t file_size, size_t &row, size_t &col)
+{
+    if (offset + kBinaryHeaderSize > file_size) {
+        return false;
+    }
+    size_t header[2];
+    container::pread_all(fd, header, kBinaryHeaderSize, offset, fname);
+    row = header[0];
+    col = header[1];
+    const uint64_t remain = file_size - offset - kBinaryHeaderSize;
+    if (col != 0 && row > remain / sizeof(double) / col) {
+        throw exception::MatrixIOException(
+            fname, "Fail to read matrix binary file, detect unmatched size.");
+    }
+    return true;
 }
 
 void read_matrices_from_binary(vector<std::shared_ptr<Matrix>> &Mat,
@@ -38,184 +122,656 @@ void read_matrices_from_binary(vector<std::shared_ptr<Matrix>> &Mat,
         throw exception::MatrixIOException(fname, "No file name.");
     } else if (access(fname, R_OK) != 0) {
         throw exception::MatrixIOException(fname, "No readding access.");
+    } else if (is_matrix_container(fname)) {
+        ContainerReader reader(fname);
+        for (size_t i = 0; i < Mat.size(); i++) {
+            if (i >= reader.size() ||
+                reader.entries()[i].row != Mat[i]->row() ||
+                reader.entries()[i].col != Mat[i]->col()) {
+                std::stringstream msg;
+                msg << "Error in read " << i << "-th matrix from binary file"
+                    << fname << ". Dimension is not matched.";
+                throw exception::MatrixIOException(fname, msg.str());
+            }
+            reader.read_matrix_at(i, *Mat[i]);
+        }
+        return;
     }
 
-    FILE *f = fopen(fname, "rb");
-    for (size_t i = 0; i < Mat.size(); i++) {
-        size_t read_row = 0;
-        size_t read_col = 0;
-        fread(&read_row, sizeof(read_row), 1, f);
-        fread(&read_col, sizeof(read_col), 1, f);
-        if (read_row != Mat[i]->row() || read_col != Mat[i]->col()) {
-            std::stringstream msg;
-            msg << "Error in read " << i << "-th matrix from binary file"
-                << fname << ". Dimension is not matched.";
-            throw exception::MatrixIOException(fname, msg.str());
+    uint64_t file_size = 0;
+    int fd = open_binary(fname, file_size);
+    try {
+        uint64_t offset = 0;
+        for (size_t i = 0; i < Mat.size(); i++) {
+            size_t read_row = 0;
+            size_t read_col = 0;
+            if (!read_binary_header(fd, fname, offset, file_size, read_row,
+                                    read_col) ||
+                read_row != Mat[i]->row() || read_col != Mat[i]->col()) {
+                std::stringstream msg;
+                msg << "Error in read " << i << "-th matrix from binary file"
+                    << fname << ". Dimension is not matched.";
+                throw exception::MatrixIOException(fname, msg.str());
+            }
+            offset += kBinaryHeaderSize;
+            const size_t size = Mat[i]->size() * sizeof(double);
+            pio::read(fd, fname, Mat[i]->data(), size, offset);
+            offset += size;
         }
-        fread(Mat[i]->data(), sizeof(double), read_row * read_col, f);
+    } catch (...) {
+        close(fd);
+        throw;
     }
-    fclose(f);
+    close(fd);
 }
 
 std::vector<std::shared_ptr<Matrix>>
 read_matrices_from_binary(const char *fname)
 {
     std::vector<std::shared_ptr<Matrix>> rst;
-    std::fstream fin(fname, std::ios::in | std::ios::binary);
-    if (!fin) {
-        throw exception::MatrixIOException(fname,
-                                           "Cannot read matrix binary file.");
+    if (is_matrix_container(fname)) {
+        ContainerReader reader(fname);
+        for (size_t i = 0; i < reader.size(); i++) {
+            rst.push_back(reader.read_matrix_at(i));
+        }
+        return rst;
     }
 
-    size_t read_row = 0;
-    size_t read_col = 0;
-    while (fin.read(reinterpret_cast<char *>(&read_row), sizeof(read_row)) &&
-           fin.read(reinterpret_cast<char *>(&read_col), sizeof(read_row))) {
-        auto mat = std::make_shared<Matrix>(read_row, read_col);
-        // use fstream::operator bool() function to check if read is successful.
-        if (!(fin.read(reinterpret_cast<char *>(mat->data()),
-                       sizeof(double) * read_row * read_col))) {
-            throw exception::MatrixIOException(
-                fname,
-                "Fail to read matrix binary file, detect unmatched size.");
+    uint64_t file_size = 0;
+    int fd = open_binary(fname, file_size);
+    try {
+        uint64_t offset = 0;
+        size_t read_row = 0;
+        size_t read_col = 0;
+        // the size is checked before the matrix is allocated.
+        while (read_binary_header(fd, fname, offset, file_size, read_row,
+                                  read_col)) {
+            offset += kBinaryHeaderSize;
+            auto mat = std::make_shared<Matrix>(read_row, read_col);
+            const size_t size = mat->size() * sizeof(double);
+            pio::read(fd, fname, mat->data(), size, offset);
+            offset += size;
+            rst.push_back(mat);
         }
-        rst.push_back(mat);
+    } catch (...) {
+        close(fd);
+        throw;
     }
-    fin.close();
+    close(fd);
 
     return rst;
-} // namespace matrix
+}
 
 std::vector<std::shared_ptr<Matrix>> read_matrices_from_binary(string &fname)
 {
     return read_matrices_from_binary(fname.c_str());
 }
 
+/**
+ * @brief Pass the access pattern hints to `madvise`. The hints are only
+ * advisory, so the errors are ignored.
+ */
+static void advise_mapping(void *addr, size_t length, int advice)
+{
+    if (advice & kMapSequential) {
+        madvise(addr, length, MADV_SEQUENTIAL);
+    }
+    if (advice & kMapRandom) {
+        madvise(addr, length, MADV_RANDOM);
+    }
+    if (advice & kMapWillNeed) {
+        madvise(addr, length, MADV_WILLNEED);
+    }
+#ifdef MADV_HUGEPAGE
+    if (advice & kMapHugePage) {
+        madvise(addr, length, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+/**
+ * @brief Map a binary matrix file into memory and create the matrices on the
+ * mapping. Both the plain binary files and the version 2 containers are
+ * supported.
+ *
+ * @param [in] fname: binary file name.
+ * @param [in] writable: map the file copy-on-write if true, otherwise
+ * read-only.
+ * @param [in] advice: access pattern hints.
+ */
+static std::vector<std::shared_ptr<Matrix>>
+map_binary(const char *fname, bool writable, int advice)
+{
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot open matrix binary file.");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw exception::MatrixIOException(
+            fname, "Cannot get matrix binary file size.");
+    }
+    std::vector<std::shared_ptr<Matrix>> rst;
+    const size_t length = st.st_size;
+    if (length == 0) {
+        close(fd);
+        return rst;
+    }
+    // the mapping stays valid after the file is closed.
+    void *addr = mmap(nullptr, length, PROT_READ | (writable ? PROT_WRITE : 0),
+                      writable ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot map matrix binary file.");
+    }
+    std::shared_ptr<void> mapping(
+        addr, [length](void *p) { munmap(p, length); });
+    advise_mapping(addr, length, advice);
+
+    char *base = static_cast<char *>(addr);
+    if (is_matrix_container(fname)) {
+        // the data of the matrices in a container is located by its index.
+        ContainerReader reader(fname);
+        for (const auto &e : reader.entries()) {
+            if (e.codec != kCodecNone || e.offset > length ||
+                e.size > length - e.offset) {
+                throw exception::MatrixIOException(
+                    fname, "Fail to map matrix container, the data is "
+                           "encoded or truncated.");
+            }
+            double *data = reinterpret_cast<double *>(base + e.offset);
+            rst.push_back(
+                std::make_shared<Matrix>(e.row, e.col, data, mapping));
+        }
+        return rst;
+    }
+
+    size_t offset = 0;
+    while (offset < length) {
+        size_t read_row = 0;
+        size_t read_col = 0;
+        if (length - offset < sizeof(read_row) + sizeof(read_col)) {
+            throw exception::MatrixIOException(
+                fname,
+                "Fail to map matrix binary file, detect unmatched size.");
+        }
+        std::memcpy(&read_row, base + offset, sizeof(read_row));
+        std::memcpy(&read_col, base + offset + sizeof(read_row),
+                    sizeof(read_col));
+        offset += sizeof(read_row) + sizeof(read_col);
+        const size_t max_size = (length - offset) / sizeof(double);
+        if ((read_col != 0 && read_row > max_size / read_col) ||
+            read_row * read_col > max_size) {
+            throw exception::MatrixIOException(
+                fname,
+                "Fail to map matrix binary file, detect unmatched size.");
+        }
+        double *data = reinterpret_cast<double *>(base + offset);
+        rst.push_back(
+            std::make_shared<Matrix>(read_row, read_col, data, mapping));
+        offset += sizeof(double) * read_row * read_col;
+    }
+    return rst;
+}
+
+std::vector<std::shared_ptr<const Matrix>>
+map_matrices_from_binary(const char *fname, int advice)
+{
+    auto mat = map_binary(fname, false, advice);
+    return std::vector<std::shared_ptr<const Matrix>>(mat.begin(), mat.end());
+}
+
+std::vector<std::shared_ptr<Matrix>>
+map_matrices_from_binary_cow(const char *fname, int advice)
+{
+    return map_binary(fname, true, advice);
+}
+
+/**
+ * @brief Write all the bytes to a file, or throw exception::MatrixIOException.
+ */
+static void write_all(int fd, const char *buf, size_t size, const string &fname)
+{
+    while (size > 0) {
+        ssize_t n = write(fd, buf, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            close(fd);
+            throw exception::MatrixIOException(
+                fname, string("Fail to write file: ") + std::strerror(errno));
+        }
+        buf += n;
+        size -= n;
+    }
+}
+
 /**
  * @note The txt file `fname` will always be overwritten if `Mat` is not empty.
+ *
+ * The elements are formatted in chunks, in parallel when matrix is built with
+ * OpenMP, into buffers that are reused by the following chunks and released
+ * on return, and each chunk is written by a single `write`.
  */
 void write_matrices_to_txt(vector<std::shared_ptr<Matrix>> &Mat,
-                           const string &fname, size_t num_per_line)
+                           const string &fname, size_t num_per_line,
+                           TxtFormat format)
 {
     if (Mat.size() == 0)
         return;
 
-    FILE *f = fopen(fname.c_str(), "w");
-    if (f == NULL)
+    int fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
         throw exception::MatrixIOException(
             fname, "Cannot open file to write matrices.");
+    size_t (*format_number)(double, char *) =
+        format == kTxtShortest ? text::format_shortest
+                               : text::format_scientific;
+
+    const size_t chunk_size = 1 << 16;
+    int nthreads = 1;
+#ifdef USE_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<char>> buffers(nthreads);
+    std::vector<size_t> used(nthreads);
+
     for (size_t i = 0; i < Mat.size(); ++i) {
         const Matrix &A = *(Mat[i]);
-        if (i == 0)
-            fprintf(f, "Dimension,%zu,%zu\n", A.row(), A.col());
-        else
-            fprintf(f, "\nDimension,%zu,%zu\n", A.row(), A.col());
+        char header[64];
+        const int header_size =
+            snprintf(header, sizeof(header), "%sDimension,%zu,%zu\n",
+                     i == 0 ? "" : "\n", A.row(), A.col());
+        write_all(fd, header, header_size, fname);
 
-        // loop over each elements.
-        size_t n = 0;
+        // each element is followed by a comma, except the last one of each
+        // line and the last one of the matrix.
         const size_t size = A.size();
-        for (size_t ii = 0; ii < A.size(); ++ii) {
-            const auto val = A.data()[ii];
-            if (n != num_per_line && ii != size - 1) {
-                fprintf(f, "%.16e,", val);
-                ++n;
-            } else if (n == num_per_line && ii != size - 1) {
-                fprintf(f, "%.16e\n", val);
-                n = 0;
-            } else {
-                fprintf(f, "%.16e", val);
+        const size_t nchunk = (size + chunk_size - 1) / chunk_size;
+        for (size_t first = 0; first < nchunk; first += nthreads) {
+            const size_t count = std::min<size_t>(nthreads, nchunk - first);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (size_t k = 0; k < count; k++) {
+                const size_t begin = (first + k) * chunk_size;
+                const size_t end = std::min(begin + chunk_size, size);
+                std::vector<char> &buffer = buffers[k];
+                const size_t max_size =
+                    (end - begin) * (text::kMaxFormatSize + 1);
+                if (buffer.size() < max_size) {
+                    buffer.resize(max_size);
+                }
+                char *p = buffer.data();
+                for (size_t ii = begin; ii < end; ++ii) {
+                    p += format_number(A.data()[ii], p);
+                    if (ii != size - 1) {
+                        // SIZE_MAX never breaks the line.
+                        *p++ = num_per_line != SIZE_MAX &&
+                                       ii % (num_per_line + 1) == num_per_line
+                                   ? '\n'
+                                   : ',';
+                    }
+                }
+                used[k] = p - buffer.data();
+            }
+            for (size_t k = 0; k < count; k++) {
+                write_all(fd, buffers[k].data(), used[k], fname);
             }
         }
     }
-    fclose(f);
+    if (close(fd) != 0)
+        throw exception::MatrixIOException(
+            fname, "Fail to close the file of matrices.");
+}
+
+/**
+ * @brief Get the error message of a txt file at a position, with the line
+ * and the column numbers.
+ */
+static string txt_error(const char *text, const char *p, const char *end,
+                        const string &msg)
+{
+    size_t line = 1;
+    const char *line_start = text;
+    for (const char *q = text; q != p; q++) {
+        if (*q == '\n') {
+            line++;
+            line_start = q + 1;
+        }
+    }
+    const char *token_end = p;
+    while (token_end != end && *token_end != ',' && *token_end != '\n') {
+        token_end++;
+    }
+    std::stringstream rst;
+    rst << msg << " at line:" << line << ", column:" << p - line_start + 1
+        << std::endl;
+    rst << "Failed element value: " << string(p, token_end) << std::endl;
+    return rst.str();
+}
+
+static bool is_txt_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
 }
 
 /**
- * @brief split string with given delimeter.
- * @param [in] str: input string to be splitted.
- * @param [in] delim: delimeter.
- * @param [in, out] str_split: On exit, it stores the splitted string.
+ * @brief Parse the elements of a matrix in a txt file, which are separated by
+ * commas and line breaks.
+ *
+ * @param [in] p: the beginning of the elements.
+ * @param [in] end: the end of the elements.
+ * @param [out] A: the matrix.
+ * @return const char *: nullptr on success, \p end if the number of elements
+ * is not matched, otherwise the position of the invalid element.
  */
-static void str_split(std::string &str, const char delim,
-                      std::vector<std::string> &str_split)
+static const char *parse_txt_elements(const char *p, const char *end,
+                                      Matrix &A)
 {
-    str_split.clear();
-    std::stringstream str_stream(str + std::string(1, delim));
-    std::string word;
-    while (std::getline(str_stream, word, delim)) {
-        str_split.push_back(word);
+    double *data = A.data();
+    const size_t size = A.size();
+    size_t count = 0;
+    while (true) {
+        while (p != end && (is_txt_space(*p) || *p == '\n')) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        } else if (count == size) {
+            return end;
+        }
+        const char *next = text::parse_double(p, end, data[count]);
+        if (next == nullptr) {
+            return p;
+        }
+        p = next;
+        count++;
+        while (p != end && is_txt_space(*p)) {
+            p++;
+        }
+        if (p != end && *p == ',') {
+            p++;
+        } else if (p != end && *p != '\n') {
+            return p;
+        }
     }
+    return count == size ? nullptr : end;
 }
 
+/**
+ * @details The file is mapped into memory and split into matrices at the
+ * "Dimension" lines. The matrices are parsed in parallel when matrix is built
+ * with OpenMP.
+ */
 std::vector<std::shared_ptr<Matrix>> read_matrices_from_txt(const string &fname)
 {
-    std::ifstream fin;
-    fin.open(fname);
-    if (!fin)
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
         throw exception::MatrixIOException(
             fname, "Cannot open file to read matrices.");
-
-    bool is_first_line = true;
-    std::string line;
-    std::vector<std::string> line_split;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw exception::MatrixIOException(
+            fname, "Cannot open file to read matrices.");
+    }
     std::vector<std::shared_ptr<Matrix>> rst;
-    std::shared_ptr<Matrix> current_matrix;
-    std::size_t n_row = 0;
-    std::size_t n_col = 0;
-    std::size_t count = 0;
-
-    // loop over each line in the txt file
-    std::size_t line_num = 0;
-    while (std::getline(fin, line)) {
-        str_split(line, ',', line_split);
-        auto p_data = line_split.begin();
-        if (line_split[0] == "Dimension") {
-            // now it starts to read a new matrix.
-            // Before that, check if the last matrix is read successfully or
-            // not.
-            if (!is_first_line) {
-                if (count != current_matrix->size()) {
-                    throw exception::MatrixIOException(
-                        fname, "Error in read matrix, unmatched element size.");
-                }
-            }
-            // read dimension information for the new matrix.
-            if (line_split.size() < 3) {
-                throw exception::MatrixIOException(
-                    fname, "Cannot read matrix dimension.");
-            }
-            try {
-                n_row = std::stoi(line_split[1]);
-                n_col = std::stoi(line_split[2]);
-            } catch (...) {
-                throw exception::MatrixIOException(
-                    fname, "Failed to read matrix dimension.");
-            }
-            // create a new matrix and push it back to matrix vector.
-            current_matrix = std::make_shared<Matrix>(n_row, n_col);
-            rst.push_back(current_matrix);
-            p_data += 3;
-            count = 0; // set matrix element count as zero.
-        }
-        // put matrix element in current line into the matrix object.
-        for (; p_data != line_split.end(); ++p_data) {
-            try {
-                current_matrix->data()[count] = std::stod(*p_data);
-                ++count;
-            } catch (...) {
-                std::stringstream msg;
-                msg << "Failed to read matrix element at line:" << line_num + 1
-                    << ", column:" << p_data - line_split.begin() + 1
-                    << std::endl;
-                msg << "Failed element value: " << *p_data << std::endl;
-                throw exception::MatrixIOException(fname, msg.str());
-            }
+    const size_t length = st.st_size;
+    if (length == 0) {
+        close(fd);
+        return rst;
+    }
+    void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw exception::MatrixIOException(
+            fname, "Cannot open file to read matrices.");
+    }
+    std::shared_ptr<void> mapping(
+        addr, [length](void *p) { munmap(p, length); });
+    madvise(addr, length, MADV_SEQUENTIAL);
+    const char *text = static_cast<const char *>(addr);
+    const char *end = text + length;
+
+    // split the file at the lines starting with "Dimension".
+    const char marker[] = "Dimension";
+    const size_t marker_size = sizeof(marker) - 1;
+    std::vector<const char *> first;
+    if (length < marker_size || std::memcmp(text, marker, marker_size) != 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot read matrix dimension.");
+    }
+    for (const char *p = text; p != nullptr;) {
+        first.push_back(p);
+        p = static_cast<const char *>(
+            memmem(p + marker_size, end - p - marker_size, "\nDimension",
+                   marker_size + 1));
+        p = p == nullptr ? p : p + 1;
+    }
+
+    // read the dimensions, and skip the end of the dimension line.
+    std::vector<const char *> data_first(first.size());
+    for (size_t i = 0; i < first.size(); i++) {
+        const char *last = i + 1 < first.size() ? first[i + 1] : end;
+        const char *p = first[i] + marker_size;
+        size_t n_row = 0;
+        size_t n_col = 0;
+        if (p == last || *p++ != ',' ||
+            (p = text::parse_size(p, last, n_row)) == nullptr ||
+            p == last || *p++ != ',' ||
+            (p = text::parse_size(p, last, n_col)) == nullptr) {
+            throw exception::MatrixIOException(
+                fname, txt_error(text, first[i], last,
+                                 "Failed to read matrix dimension"));
+        }
+        while (p != last && is_txt_space(*p)) {
+            p++;
+        }
+        if (p != last && *p != ',' && *p != '\n') {
+            throw exception::MatrixIOException(
+                fname, txt_error(text, p, last,
+                                 "Failed to read matrix dimension"));
+        }
+        data_first[i] = p == last ? p : p + 1;
+        rst.push_back(std::make_shared<Matrix>(n_row, n_col));
+    }
+
+    // the exceptions are thrown out of the parallel region.
+    std::vector<const char *> error(first.size(), nullptr);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t i = 0; i < first.size(); i++) {
+        const char *last = i + 1 < first.size() ? first[i + 1] : end;
+        error[i] = parse_txt_elements(data_first[i], last, *rst[i]);
+    }
+    for (size_t i = 0; i < first.size(); i++) {
+        const char *last = i + 1 < first.size() ? first[i + 1] : end;
+        if (error[i] == last) {
+            throw exception::MatrixIOException(
+                fname, "Error in read matrix, unmatched element size.");
+        } else if (error[i] != nullptr) {
+            throw exception::MatrixIOException(
+                fname, txt_error(text, error[i], last,
+                                 "Failed to read matrix element"));
+        }
+    }
+    return rst;
+}
+
+/**
+ * @note The pivots are stored as double numbers, which is exact for any
+ * integer that can be used as a matrix index.
+ */
+void write_factorization_to_binary(const Factorization &F, const char *fname)
+{
+    auto header = std::make_shared<Matrix>(1, 3);
+    (*header)(0, 0) = F.type();
+    (*header)(0, 1) = F.uplo() == "U" ? 1 : (F.uplo() == "L" ? 2 : 0);
+    (*header)(0, 2) = F.norm();
+
+    auto pivots = std::make_shared<Matrix>(1, F.pivots().size());
+    for (size_t i = 0; i < F.pivots().size(); ++i) {
+        pivots->data()[i] = F.pivots()[i];
+    }
+
+    // the factors are written without copy.
+    std::shared_ptr<const Matrix> factor(&F.factor(), [](const Matrix *) {});
+    vector<std::shared_ptr<const Matrix>> mat{header, factor, pivots};
+    write_matrices_to_binary(mat, fname);
+}
+
+std::shared_ptr<Factorization> read_factorization_from_binary(const char *fname)
+{
+    auto mat = read_matrices_from_binary(fname);
+    if (mat.size() != 3 || mat[0]->size() != 3) {
+        throw exception::MatrixIOException(
+            fname, "Fail to read factorization, detect unmatched data.");
+    }
+
+    // the numbers are checked before the conversion to integers.
+    const Matrix &header = *mat[0];
+    const double type = header(0, 0);
+    const double uplo_code = header(0, 1);
+    if (!(type == Factorization::kLU || type == Factorization::kCholesky ||
+          type == Factorization::kLDLT) ||
+        !(uplo_code == 0 || uplo_code == 1 || uplo_code == 2)) {
+        throw exception::MatrixIOException(
+            fname, "Fail to read factorization, detect invalid header.");
+    }
+    const string uplo = uplo_code == 1 ? "U" : (uplo_code == 2 ? "L" : "");
+    const double n = (double)mat[1]->row();
+    vector<int> ipiv(mat[2]->size());
+    for (size_t i = 0; i < ipiv.size(); ++i) {
+        const double p = mat[2]->data()[i];
+        if (!(std::fabs(p) >= 1 && std::fabs(p) <= n) || p != std::floor(p)) {
+            throw exception::MatrixIOException(
+                fname, "Fail to read factorization, detect invalid pivots.");
+        }
+        ipiv[i] = (int)p;
+    }
+    try {
+        return Factorization::create((Factorization::Type)(int)type, uplo,
+                                     *mat[1], ipiv, header(0, 2));
+    } catch (const exception::MatrixException &) {
+        throw exception::MatrixIOException(
+            fname, "Fail to read factorization, detect unmatched data.");
+    }
+}
+
+/**
+ * @brief Magic string of a sparse matrix binary file.
+ */
+static const char kSparseMagic[8] = {'M', 'T', 'X', 'C', 'S', 'R', 0, 0};
+
+/**
+ * @brief Size in bytes of the [magic, row, col, nnz] header of a sparse
+ * matrix binary file.
+ */
+static const size_t kSparseHeaderSize = sizeof(kSparseMagic) + 3 * 8;
+
+static_assert(sizeof(size_t) == 8,
+              "the sparse matrix binary file stores 64-bit indices.");
+
+void write_sparse_matrix_to_binary(const SparseMatrix &A, const char *fname)
+{
+    if (fname == NULL) {
+        throw exception::MatrixIOException(fname, "No file name.");
+    }
+    int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            fname, "Cannot write sparse matrix binary file.");
+    }
+    try {
+        char header[kSparseHeaderSize];
+        const uint64_t dims[3] = {A.row(), A.col(), A.nnz()};
+        std::memcpy(header, kSparseMagic, sizeof(kSparseMagic));
+        std::memcpy(header + sizeof(kSparseMagic), dims, sizeof(dims));
+        container::pwrite_all(fd, header, kSparseHeaderSize, 0, fname);
+        uint64_t offset = kSparseHeaderSize;
+        const size_t ptr_size = A.row_ptr().size() * sizeof(size_t);
+        const size_t index_size = A.nnz() * sizeof(size_t);
+        const size_t value_size = A.nnz() * sizeof(double);
+        pio::write(fd, fname, A.row_ptr().data(), ptr_size, offset);
+        offset += ptr_size;
+        pio::write(fd, fname, A.col_index().data(), index_size, offset);
+        offset += index_size;
+        pio::write(fd, fname, A.values().data(), value_size, offset);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    if (close(fd) != 0) {
+        throw exception::MatrixIOException(
+            fname, string("Fail to write file: ") + std::strerror(errno));
+    }
+}
+
+/**
+ * @details The dimensions in the header are checked against the file size
+ * before any memory is allocated, and the CSR arrays are validated by the
+ * constructor of matrix::SparseMatrix. Any failure is reported as
+ * matrix::exception::MatrixIOException.
+ */
+std::shared_ptr<SparseMatrix> read_sparse_matrix_from_binary(const char *fname)
+{
+    uint64_t file_size = 0;
+    int fd = open_binary(fname, file_size);
+    std::shared_ptr<SparseMatrix> rst;
+    try {
+        char header[kSparseHeaderSize];
+        uint64_t dims[3] = {0, 0, 0};
+        if (file_size >= kSparseHeaderSize) {
+            container::pread_all(fd, header, kSparseHeaderSize, 0, fname);
+            std::memcpy(dims, header + sizeof(kSparseMagic), sizeof(dims));
+        }
+        if (file_size < kSparseHeaderSize ||
+            std::memcmp(header, kSparseMagic, sizeof(kSparseMagic)) != 0) {
+            throw exception::MatrixIOException(
+                fname, "Not a sparse matrix binary file.");
+        }
+        const uint64_t row = dims[0];
+        const uint64_t col = dims[1];
+        const uint64_t nnz = dims[2];
+        // each element takes an index and a value.
+        const uint64_t remain = (file_size - kSparseHeaderSize) / 8;
+        if ((file_size - kSparseHeaderSize) % 8 != 0 || row >= remain ||
+            nnz > (remain - row - 1) / 2 || remain != row + 1 + 2 * nnz) {
+            throw exception::MatrixIOException(
+                fname,
+                "Fail to read sparse matrix binary file, detect unmatched "
+                "size.");
+        }
+
+        vector<size_t> row_ptr(row + 1);
+        vector<size_t> col_index(nnz);
+        vector<double> values(nnz);
+        uint64_t offset = kSparseHeaderSize;
+        pio::read(fd, fname, row_ptr.data(), row_ptr.size() * 8, offset);
+        offset += row_ptr.size() * 8;
+        pio::read(fd, fname, col_index.data(), nnz * 8, offset);
+        offset += nnz * 8;
+        pio::read(fd, fname, values.data(), nnz * 8, offset);
+        try {
+            rst = std::make_shared<SparseMatrix>(row, col, std::move(row_ptr),
+                                                 std::move(col_index),
+                                                 std::move(values));
+        } catch (const exception::MatrixException &) {
+            throw exception::MatrixIOException(
+                fname, "Fail to read sparse matrix binary file, detect "
+                       "invalid CSR storage.");
         }
-        // at this point, the first line has been parsed.
-        is_first_line = false;
-        line_num++;
+    } catch (...) {
+        close(fd);
+        throw;
     }
-    fin.close();
+    close(fd);
     return rst;
 }
 
@@ -0,0 +1,794 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix.h>
+#include <matrix/details/matrix_io.h>
+#include <matrix/details/sparse_matrix.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "container_format.h"
+#include "text_format.h"
+#include "text_parser.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace matrix {
+
+namespace mtx {
+
+/**
+ * @brief Number of bytes read from the file at a time.
+ */
+static const size_t kBlockSize = 16 << 20;
+
+/**
+ * @brief Number of matrix elements formatted by a thread at a time.
+ */
+static const size_t kChunkElements = 1 << 16;
+
+/**
+ * @brief A chunk of the elements written in column-major order, which
+ * starts from the element (i, j) and has `count` elements.
+ */
+struct Chunk {
+    size_t j;
+    size_t i;
+    size_t count;
+};
+
+enum Symmetry {
+    kGeneral = 0,
+    kSymmetric = 1,
+    kSkewSymmetric = 2,
+};
+
+/**
+ * @brief The banner and the size line of a Matrix Market file.
+ */
+struct Header {
+    bool coordinate; /* coordinate or array format. */
+    bool pattern;    /* the entries have no values. */
+    int symmetry;
+    size_t row;
+    size_t col;
+    size_t nnz; /* number of entries stored in the file. */
+};
+
+/**
+ * @brief Read a text file block by block, and keep the bytes that are not
+ * consumed yet.
+ */
+class BlockReader {
+  public:
+    explicit BlockReader(const string &fname)
+        : fname_(fname), begin_(0), end_(0), eof_(false)
+    {
+        fd_ = open(fname.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd_ >= 0 && fstat(fd_, &st) != 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        if (fd_ < 0) {
+            throw exception::MatrixIOException(
+                fname, "Cannot open Matrix Market file.");
+        }
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        // one more byte to detect the end of a small file by one read.
+        buffer_.resize(std::min<size_t>(kBlockSize, st.st_size + 1));
+    }
+
+    ~BlockReader() { close(fd_); }
+
+    const char *begin() const { return buffer_.data() + begin_; }
+    const char *end() const { return buffer_.data() + end_; }
+    void consume(const char *p) { begin_ = p - buffer_.data(); }
+
+    /**
+     * @brief Read the next block after the bytes not consumed yet.
+     * @return bool: false at the end of the file.
+     */
+    bool fill()
+    {
+        if (eof_) {
+            return false;
+        }
+        std::memmove(buffer_.data(), begin(), end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (end_ == buffer_.size()) {
+            // a line is longer than the buffer.
+            buffer_.resize(2 * buffer_.size());
+        }
+        ssize_t n;
+        do {
+            n = read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            throw exception::MatrixIOException(
+                fname_, string("Fail to read file: ") + std::strerror(errno));
+        }
+        end_ += n;
+        eof_ = n == 0;
+        return !eof_;
+    }
+
+    /**
+     * @brief Get the next line without the line break.
+     * @return bool: false at the end of the file.
+     */
+    bool get_line(string &line)
+    {
+        const char *p;
+        while ((p = static_cast<const char *>(
+                    std::memchr(begin(), '\n', end() - begin()))) == nullptr) {
+            if (!fill()) {
+                if (begin() == end()) {
+                    return false;
+                }
+                p = end();
+                break;
+            }
+        }
+        line.assign(begin(), p);
+        consume(p == end() ? p : p + 1);
+        return true;
+    }
+
+  private:
+    string fname_;
+    int fd_;
+    std::vector<char> buffer_;
+    size_t begin_; /* the bytes not consumed are [begin_, end_). */
+    size_t end_;
+    bool eof_;
+};
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *skip_space(const char *p, const char *end)
+{
+    while (p != end && is_space(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const char *line_end(const char *p, const char *end)
+{
+    const char *q =
+        static_cast<const char *>(std::memchr(p, '\n', end - p));
+    return q == nullptr ? end : q;
+}
+
+/**
+ * @brief Get the error message with the line of a position.
+ */
+static string error_at(const char *p, const char *end, const string &msg)
+{
+    std::stringstream rst;
+    rst << msg << std::endl
+        << "Failed line: " << string(p, line_end(p, end)) << std::endl;
+    return rst.str();
+}
+
+/**
+ * @brief Read the banner, the comments and the size line.
+ */
+static Header read_header(BlockReader &reader, const string &fname)
+{
+    string line;
+    if (!reader.get_line(line)) {
+        throw exception::MatrixIOException(fname, "Empty Matrix Market file.");
+    }
+    std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+    std::stringstream banner(line);
+    string magic, object, format, field, symmetry;
+    banner >> magic >> object >> format >> field >> symmetry;
+    Header h;
+    h.coordinate = format == "coordinate";
+    h.pattern = field == "pattern";
+    h.symmetry = symmetry == "symmetric"        ? kSymmetric
+                 : symmetry == "skew-symmetric" ? kSkewSymmetric
+                                                : kGeneral;
+    if (magic != "%%matrixmarket" || object != "matrix" ||
+        (format != "coordinate" && format != "array") ||
+        (symmetry != "general" && h.symmetry == kGeneral) ||
+        (h.pattern && !h.coordinate)) {
+        throw exception::MatrixIOException(
+            fname, "Invalid Matrix Market banner: " + line);
+    }
+    if (field != "real" && field != "double" && field != "integer" &&
+        !h.pattern) {
+        throw exception::MatrixIOException(
+            fname, "Unsupported Matrix Market field, only real, integer and "
+                   "pattern matrices are supported: " + field);
+    }
+
+    while (reader.get_line(line)) {
+        const char *p = skip_space(line.c_str(), line.c_str() + line.size());
+        const char *end = line.c_str() + line.size();
+        if (p == end || *p == '%') {
+            continue;
+        }
+        p = text::parse_size(p, end, h.row);
+        p = p ? text::parse_size(skip_space(p, end), end, h.col) : p;
+        if (p && h.coordinate) {
+            p = text::parse_size(skip_space(p, end), end, h.nnz);
+        }
+        if (p == nullptr || skip_space(p, end) != end) {
+            throw exception::MatrixIOException(
+                fname, "Invalid Matrix Market size line: " + line);
+        }
+        if (h.col != 0 &&
+            h.row > std::numeric_limits<size_t>::max() / sizeof(double) /
+                        h.col) {
+            throw exception::MatrixIOException(
+                fname, "Invalid Matrix Market size line: " + line);
+        }
+        if (h.symmetry != kGeneral && h.row != h.col) {
+            throw exception::MatrixIOException(
+                fname, "A symmetric Matrix Market matrix is not square.");
+        }
+        if (!h.coordinate) {
+            const size_t n = h.row;
+            if (h.symmetry == kGeneral) {
+                h.nnz = h.row * h.col;
+            } else if (h.symmetry == kSymmetric) {
+                h.nnz = n * (n + 1) / 2;
+            } else {
+                h.nnz = n == 0 ? 0 : n * (n - 1) / 2;
+            }
+        }
+        return h;
+    }
+    throw exception::MatrixIOException(fname,
+                                       "Cannot read Matrix Market size line.");
+}
+
+/**
+ * @brief Get the first row stored in a column of the array format.
+ */
+static size_t first_row(const Header &h, size_t j)
+{
+    return h.symmetry == kGeneral ? 0 : j + (h.symmetry == kSkewSymmetric);
+}
+
+/**
+ * @brief Move to the next position of the array format, column by column.
+ */
+static void next_position(const Header &h, size_t &i, size_t &j)
+{
+    i++;
+    while (i >= h.row && j < h.col) {
+        j++;
+        i = first_row(h, j);
+    }
+}
+
+/**
+ * @brief Get the position of the k-th value of the array format.
+ */
+static void array_position(const Header &h, size_t k, size_t &i, size_t &j)
+{
+    j = 0;
+    i = first_row(h, 0);
+    if (i >= h.row) {
+        next_position(h, i, j);
+    }
+    while (j < h.col) {
+        const size_t n = h.row - i;
+        if (k < n) {
+            i += k;
+            return;
+        }
+        k -= n;
+        i = h.row - 1;
+        next_position(h, i, j);
+    }
+}
+
+/**
+ * @brief Store a value and its symmetric counterpart.
+ */
+static void store(const Header &h, double *data, size_t i, size_t j, double x)
+{
+    data[i * h.col + j] = x;
+    if (i != j && h.symmetry != kGeneral) {
+        data[j * h.col + i] = h.symmetry == kSkewSymmetric ? -x : x;
+    }
+}
+
+/**
+ * @brief Entries of the coordinate format collected as triplets, together
+ * with their symmetric counterparts.
+ */
+struct TripletEntries {
+    const Header *h = nullptr;
+    std::vector<size_t> rows;
+    std::vector<size_t> cols;
+    std::vector<double> values;
+
+    void add(size_t i, size_t j, double x)
+    {
+        push(i, j, x);
+        if (i != j && h->symmetry != kGeneral) {
+            push(j, i, h->symmetry == kSkewSymmetric ? -x : x);
+        }
+    }
+
+    void push(size_t i, size_t j, double x)
+    {
+        rows.push_back(i);
+        cols.push_back(j);
+        values.push_back(x);
+    }
+
+    /**
+     * @brief Add the entries to a dense matrix, and clear them.
+     */
+    void scatter(double *data)
+    {
+        for (size_t k = 0; k < values.size(); k++) {
+            data[rows[k] * h->col + cols[k]] += values[k];
+        }
+        rows.clear();
+        cols.clear();
+        values.clear();
+    }
+};
+
+/**
+ * @brief Parse the lines of the coordinate format in [p, end), and add the
+ * entries to \p entries.
+ *
+ * @param [out] count: number of entries.
+ * @return const char *: nullptr on success, otherwise the line of the error.
+ */
+template <class Entries>
+static const char *parse_coordinate(const Header &h, const char *p,
+                                    const char *end, Entries &entries,
+                                    size_t &count, string &msg)
+{
+    count = 0;
+    while (p != end) {
+        const char *line = p;
+        p = skip_space(p, end);
+        if (p == end || *p == '\n' || *p == '%') {
+            p = line_end(p, end);
+            p = p == end ? p : p + 1;
+            continue;
+        }
+        size_t i = 0;
+        size_t j = 0;
+        double x = 1.0;
+        p = text::parse_size(p, end, i);
+        p = p ? text::parse_size(skip_space(p, end), end, j) : p;
+        if (p && !h.pattern) {
+            p = text::parse_double(skip_space(p, end), end, x);
+        }
+        if (p == nullptr || (p = skip_space(p, end), p != end && *p != '\n')) {
+            msg = "Invalid Matrix Market entry.";
+            return line;
+        } else if (i == 0 || i > h.row || j == 0 || j > h.col) {
+            msg = "Matrix Market entry out of range.";
+            return line;
+        }
+        entries.add(i - 1, j - 1, x);
+        count++;
+        p = p == end ? p : p + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Count the values of the array format in [p, end).
+ */
+static size_t count_values(const char *p, const char *end)
+{
+    size_t count = 0;
+    while (p != end) {
+        p = skip_space(p, end);
+        if (p == end) {
+            break;
+        } else if (*p == '\n') {
+            p++;
+        } else if (*p == '%') {
+            p = line_end(p, end);
+        } else {
+            count++;
+            while (p != end && !is_space(*p) && *p != '\n') {
+                p++;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Parse the values of the array format in [p, end), the first of
+ * which is the k-th value of the matrix.
+ *
+ * @return const char *: nullptr on success, otherwise the position of the
+ * error.
+ */
+static const char *parse_array(const Header &h, const char *p,
+                               const char *end, double *data, size_t k,
+                               string &msg)
+{
+    size_t i = 0;
+    size_t j = 0;
+    array_position(h, k, i, j);
+    while (p != end) {
+        p = skip_space(p, end);
+        if (p == end) {
+            break;
+        } else if (*p == '\n') {
+            p++;
+            continue;
+        } else if (*p == '%') {
+            p = line_end(p, end);
+            continue;
+        }
+        double x = 0.0;
+        const char *next = text::parse_double(p, end, x);
+        if (next == nullptr || (next != end && !is_space(*next) &&
+                                *next != '\n')) {
+            msg = "Invalid Matrix Market value.";
+            return p;
+        } else if (j >= h.col) {
+            msg = "Too many Matrix Market values.";
+            return p;
+        }
+        store(h, data, i, j, x);
+        next_position(h, i, j);
+        p = next;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Split [p, end) into pieces at line breaks, one for each thread.
+ */
+static std::vector<const char *> split_lines(const char *p, const char *end,
+                                             size_t npiece)
+{
+    std::vector<const char *> first(npiece + 1, end);
+    first[0] = p;
+    for (size_t t = 1; t < npiece; t++) {
+        const char *q = std::max(first[t - 1], p + (end - p) / npiece * t);
+        q = line_end(q, end);
+        first[t] = q == end ? q : q + 1;
+    }
+    return first;
+}
+
+/**
+ * @brief Append the decimal digits of an integer, and return the number of
+ * characters.
+ */
+static size_t format_index(size_t n, char *out)
+{
+    char digits[20];
+    size_t size = 0;
+    do {
+        digits[size++] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n != 0);
+    for (size_t k = 0; k < size; k++) {
+        out[k] = digits[size - 1 - k];
+    }
+    return size;
+}
+
+/**
+ * @brief Get the number of the pieces parsed in parallel.
+ */
+static int num_threads()
+{
+#ifdef USE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Read the entries after the header block by block, and check their
+ * number against the size line.
+ *
+ * @param [in] parse: parser of the t-th piece [p, end) of a block, as
+ * `parse(t, p, end, k, count, msg)`, where k is the position of the first
+ * value of the array format. It returns nullptr on success, otherwise the
+ * position of the error with \p msg, and sets \p count for the coordinate
+ * format.
+ * @param [in] flush: called after each block is parsed.
+ */
+template <class Parse, class Flush>
+static void read_entries(BlockReader &reader, const Header &h,
+                         const string &fname, int nthreads, Parse parse,
+                         Flush flush)
+{
+    std::vector<size_t> count(nthreads);
+    std::vector<const char *> error(nthreads);
+    std::vector<string> msg(nthreads);
+    size_t total = 0;
+    bool more = true;
+    while (more) {
+        more = reader.fill();
+        const char *p = reader.begin();
+        const char *end = reader.end();
+        if (more) {
+            // parse the complete lines only.
+            const char *last = static_cast<const char *>(
+                memrchr(p, '\n', end - p));
+            if (last == nullptr) {
+                continue;
+            }
+            end = last + 1;
+        }
+        const auto first = split_lines(p, end, nthreads);
+
+        if (!h.coordinate) {
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (int t = 0; t < nthreads; t++) {
+                count[t] = count_values(first[t], first[t + 1]);
+            }
+        }
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (int t = 0; t < nthreads; t++) {
+            size_t k = total;
+            for (int s = 0; s < t && !h.coordinate; s++) {
+                k += count[s];
+            }
+            error[t] = parse(t, first[t], first[t + 1], k, count[t], msg[t]);
+        }
+        for (int t = 0; t < nthreads; t++) {
+            if (error[t] != nullptr) {
+                throw exception::MatrixIOException(
+                    fname, error_at(error[t], end, msg[t]));
+            }
+            total += count[t];
+        }
+        if (total > h.nnz) {
+            throw exception::MatrixIOException(
+                fname, "Fail to read Matrix Market file, detect more entries "
+                       "than the size line.");
+        }
+        flush();
+        reader.consume(end);
+    }
+    if (total != h.nnz) {
+        std::stringstream rst;
+        rst << "Fail to read Matrix Market file, detect unmatched number of "
+               "entries. Expected: "
+            << h.nnz << ", actual: " << total;
+        throw exception::MatrixIOException(fname, rst.str());
+    }
+}
+
+} // namespace mtx
+
+/**
+ * @details The file is read block by block, and each block is split at line
+ * breaks into one piece per thread, which are parsed in parallel when matrix
+ * is built with OpenMP. The values of the array format are counted in a
+ * first pass so that each piece knows the position of its first value. The
+ * entries of the coordinate format are collected by each thread and added
+ * to the matrix serially after each block, so that the duplicated entries
+ * are summed up as by read_sparse_matrix_from_mtx().
+ */
+std::shared_ptr<Matrix> read_matrix_from_mtx(const string &fname)
+{
+    mtx::BlockReader reader(fname);
+    const mtx::Header h = mtx::read_header(reader, fname);
+    auto A = std::make_shared<Matrix>(h.row, h.col);
+    A->fill_all(0.0);
+    double *data = A->data();
+
+    const int nthreads = mtx::num_threads();
+    std::vector<mtx::TripletEntries> entries(nthreads);
+    for (auto &e : entries) {
+        e.h = &h;
+    }
+    mtx::read_entries(
+        reader, h, fname, nthreads,
+        [&](int t, const char *p, const char *end, size_t k, size_t &count,
+            string &msg) {
+            return h.coordinate ? mtx::parse_coordinate(h, p, end, entries[t],
+                                                        count, msg)
+                                : mtx::parse_array(h, p, end, data, k, msg);
+        },
+        [&] {
+            // the duplicated entries are summed up in the order of the file.
+            for (auto &e : entries) {
+                e.scatter(data);
+            }
+        });
+    return A;
+}
+
+/**
+ * @details The entries of the coordinate format are collected by each thread
+ * as triplets, which are assembled into the compressed sparse row storage at
+ * the end. A file of the array format is read as a dense matrix and
+ * converted, keeping its nonzero values.
+ */
+std::shared_ptr<SparseMatrix> read_sparse_matrix_from_mtx(const string &fname)
+{
+    mtx::BlockReader reader(fname);
+    const mtx::Header h = mtx::read_header(reader, fname);
+    if (!h.coordinate) {
+        return std::make_shared<SparseMatrix>(*read_matrix_from_mtx(fname));
+    }
+
+    const int nthreads = mtx::num_threads();
+    std::vector<mtx::TripletEntries> entries(nthreads);
+    for (auto &e : entries) {
+        e.h = &h;
+    }
+    mtx::read_entries(reader, h, fname, nthreads,
+                      [&](int t, const char *p, const char *end, size_t,
+                          size_t &count, string &msg) {
+                          return mtx::parse_coordinate(h, p, end, entries[t],
+                                                       count, msg);
+                      },
+                      [] {});
+
+    mtx::TripletEntries &all = entries[0];
+    for (int t = 1; t < nthreads; t++) {
+        all.rows.insert(all.rows.end(), entries[t].rows.begin(),
+                        entries[t].rows.end());
+        all.cols.insert(all.cols.end(), entries[t].cols.begin(),
+                        entries[t].cols.end());
+        all.values.insert(all.values.end(), entries[t].values.begin(),
+                          entries[t].values.end());
+    }
+    return std::make_shared<SparseMatrix>(SparseMatrix::from_triplets(
+        h.row, h.col, all.rows, all.cols, all.values));
+}
+
+/**
+ * @details The elements are formatted column by column in chunks of 64Ki
+ * elements in parallel when matrix is built with OpenMP, and each chunk is
+ * written by a single system call. A chunk can span several short columns or
+ * a part of a long column, so that the buffers are bounded for any shape.
+ */
+void write_matrix_to_mtx(const Matrix &A, const string &fname, int format,
+                         bool symmetric)
+{
+    if (symmetric && !A.is_square()) {
+        throw exception::DimensionError(
+            "Error in matrix::write_matrix_to_mtx(): symmetric matrix is not "
+            "square.");
+    }
+    const bool coordinate = format == kMtxCoordinate;
+    const size_t row = A.row();
+    const size_t col = A.col();
+    const double *data = A.data();
+    auto first_row = [&](size_t j) { return symmetric ? j : 0; };
+
+    size_t nnz = 0;
+    if (coordinate) {
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+ : nnz)
+#endif
+        for (size_t j = 0; j < col; j++) {
+            for (size_t i = first_row(j); i < row; i++) {
+                nnz += data[i * col + j] != 0.0;
+            }
+        }
+    }
+
+    int fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            fname, "Cannot open file to write Matrix Market matrix.");
+    }
+    std::stringstream header;
+    header << "%%MatrixMarket matrix " << (coordinate ? "coordinate" : "array")
+           << " real " << (symmetric ? "symmetric" : "general") << "\n"
+           << row << " " << col;
+    if (coordinate) {
+        header << " " << nnz;
+    }
+    header << "\n";
+    const string head = header.str();
+
+    int nthreads = 1;
+#ifdef USE_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    // the longest entry: two indices, a value and three separators.
+    const size_t max_entry = 2 * 20 + text::kMaxFormatSize + 3;
+    std::vector<std::vector<char>> buffers(nthreads);
+    std::vector<size_t> used(nthreads);
+
+    // split the elements in column-major order into chunks.
+    std::vector<mtx::Chunk> chunks;
+    for (size_t j = 0, i = first_row(0); j < col;) {
+        mtx::Chunk chunk = {j, i, 0};
+        while (j < col && chunk.count < mtx::kChunkElements) {
+            const size_t n =
+                std::min(mtx::kChunkElements - chunk.count, row - i);
+            chunk.count += n;
+            i += n;
+            if (i == row) {
+                j++;
+                i = first_row(j);
+            }
+        }
+        chunks.push_back(chunk);
+    }
+    const size_t nchunk = chunks.size();
+
+    try {
+        uint64_t offset = 0;
+        container::pwrite_all(fd, head.data(), head.size(), offset, fname);
+        offset += head.size();
+        for (size_t first = 0; first < nchunk; first += nthreads) {
+            const size_t count = std::min<size_t>(nthreads, nchunk - first);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (size_t k = 0; k < count; k++) {
+                const mtx::Chunk &chunk = chunks[first + k];
+                std::vector<char> &buffer = buffers[k];
+                buffer.resize(chunk.count * max_entry);
+                char *p = buffer.data();
+                size_t j = chunk.j;
+                size_t i_begin = chunk.i;
+                for (size_t remain = chunk.count; remain > 0; j++) {
+                    const size_t i_end = std::min(row, i_begin + remain);
+                    for (size_t i = i_begin; i < i_end; i++) {
+                        const double x = data[i * col + j];
+                        if (coordinate) {
+                            if (x == 0.0) {
+                                continue;
+                            }
+                            p += mtx::format_index(i + 1, p);
+                            *p++ = ' ';
+                            p += mtx::format_index(j + 1, p);
+                            *p++ = ' ';
+                        }
+                        p += text::format_shortest(x, p);
+                        *p++ = '\n';
+                    }
+                    remain -= i_end - i_begin;
+                    i_begin = first_row(j + 1);
+                }
+                used[k] = p - buffer.data();
+            }
+            for (size_t k = 0; k < count; k++) {
+                container::pwrite_all(fd, buffers[k].data(), used[k], offset,
+                                      fname);
+                offset += used[k];
+            }
+        }
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    if (close(fd) != 0) {
+        throw exception::MatrixIOException(
+            fname, "Fail to close the Matrix Market file.");
+    }
+}
+
+} // namespace matrix
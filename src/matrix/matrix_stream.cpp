@@ -0,0 +1,361 @@
+#include <matrix/details/container.h>
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix_stream.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "container_format.h"
+
+namespace matrix {
+
+MatrixStreamReader::MatrixStreamReader(const string &fname, size_t buffers)
+    : fname_(fname), fd_(-1), is_container_(false), offset_(0),
+      next_index_(0), slots_(buffers), head_(0),
+      filled_(0), holding_(false), finished_(false), stop_(false), count_(0)
+{
+    if (buffers < 2) {
+        throw exception::MatrixException(
+            "Error in matrix::MatrixStreamReader: at least 2 buffers are "
+            "needed.");
+    }
+    if (is_matrix_container(fname)) {
+        is_container_ = true;
+        entries_ = ContainerReader(fname).entries();
+    }
+    fd_ = open(fname.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot read matrix binary file.");
+    }
+    if (!is_container_) {
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    try {
+        thread_ = std::thread(&MatrixStreamReader::read_ahead, this);
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+}
+
+MatrixStreamReader::~MatrixStreamReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+    close(fd_);
+}
+
+/**
+ * @brief Read the next matrix in the file into a slot.
+ * @return bool: false at the end of the file.
+ */
+bool MatrixStreamReader::read_matrix(Slot &slot)
+{
+    size_t row = 0;
+    size_t col = 0;
+    if (is_container_) {
+        if (next_index_ == entries_.size()) {
+            return false;
+        }
+        const ContainerEntry &e = entries_[next_index_];
+        row = e.row;
+        col = e.col;
+    } else {
+        // the end of the file is only allowed before a matrix.
+        size_t header[2];
+        const ssize_t n = pread(fd_, header, sizeof(header), offset_);
+        if (n == 0) {
+            return false;
+        } else if (n != sizeof(header)) {
+            throw exception::MatrixIOException(
+                fname_,
+                "Fail to read matrix binary file, detect unmatched size.");
+        }
+        row = header[0];
+        col = header[1];
+        offset_ += sizeof(header);
+    }
+
+    const size_t size = row * col;
+    if (col != 0 && row > slot.data.max_size() / col) {
+        throw exception::MatrixIOException(
+            fname_, "Fail to read matrix binary file, detect unmatched size.");
+    }
+    if (slot.data.size() < size) {
+        slot.data.resize(size);
+    }
+    if (is_container_) {
+        container::read_entry(fd_, entries_[next_index_], next_index_,
+                              slot.data.data(), slot.buffer, true, fname_);
+    } else {
+        container::pread_all(fd_, slot.data.data(), size * sizeof(double),
+                             offset_, fname_);
+        offset_ += size * sizeof(double);
+    }
+    slot.matrix.reset(
+        new Matrix(row, col, slot.data.data(), Matrix::kShallowCopy));
+    next_index_++;
+    return true;
+}
+
+/**
+ * @details The background thread fills the free slots in order, and waits
+ * when all the slots are filled.
+ */
+void MatrixStreamReader::read_ahead()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this]() { return stop_ || filled_ < slots_.size(); });
+        if (stop_) {
+            break;
+        }
+        Slot &slot = slots_[(head_ + filled_) % slots_.size()];
+        lock.unlock();
+        bool has_matrix = false;
+        std::exception_ptr error;
+        try {
+            has_matrix = read_matrix(slot);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (has_matrix) {
+            filled_++;
+        } else {
+            error_ = error;
+            finished_ = true;
+        }
+        cond_.notify_all();
+        if (finished_) {
+            break;
+        }
+    }
+}
+
+Matrix *MatrixStreamReader::next()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (holding_) {
+        // release the slot of the last matrix.
+        holding_ = false;
+        head_ = (head_ + 1) % slots_.size();
+        filled_--;
+        cond_.notify_all();
+    }
+    cond_.wait(lock, [this]() { return filled_ > 0 || finished_; });
+    if (filled_ > 0) {
+        holding_ = true;
+        count_++;
+        return slots_[head_].matrix.get();
+    } else if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+    return nullptr;
+}
+
+/* the buffer index of a matrix written without a snapshot. */
+static const size_t kNoBuffer = static_cast<size_t>(-1);
+
+MatrixStreamWriter::MatrixStreamWriter(const string &fname, size_t buffers)
+    : fname_(fname), fd_(-1), offset_(0), buffers_(buffers), writing_(false),
+      stop_(false)
+{
+    if (buffers < 2) {
+        throw exception::MatrixException(
+            "Error in matrix::MatrixStreamWriter: at least 2 buffers are "
+            "needed.");
+    }
+    fd_ = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(fname,
+                                           "Cannot create matrix binary file.");
+    }
+    try {
+        for (size_t i = buffers; i-- > 0;) {
+            free_.push_back(i);
+        }
+        thread_ = std::thread(&MatrixStreamWriter::write_behind, this);
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+MatrixStreamWriter::~MatrixStreamWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void MatrixStreamWriter::push(Job &job)
+{
+    // the lock is held by the caller.
+    if (fd_ < 0) {
+        throw exception::MatrixIOException(
+            fname_, "Cannot write a matrix to a closed file.");
+    } else if (error_) {
+        std::rethrow_exception(error_);
+    }
+    queue_.push_back(job);
+    cond_.notify_all();
+}
+
+void MatrixStreamWriter::write(const Matrix &A)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return !free_.empty() || error_; });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    Job job;
+    job.buffer = free_.back();
+    free_.pop_back();
+    lock.unlock();
+
+    // the buffer is owned by this call until it is queued.
+    vector<double> &buffer = buffers_[job.buffer];
+    if (buffer.size() < A.size()) {
+        buffer.resize(A.size());
+    }
+    std::memcpy(buffer.data(), A.data(), A.size() * sizeof(double));
+    job.header[0] = A.row();
+    job.header[1] = A.col();
+    job.data = buffer.data();
+
+    lock.lock();
+    try {
+        push(job);
+    } catch (...) {
+        free_.push_back(job.buffer);
+        throw;
+    }
+}
+
+void MatrixStreamWriter::write(std::shared_ptr<const Matrix> A)
+{
+    Job job;
+    job.header[0] = A->row();
+    job.header[1] = A->col();
+    job.data = A->data();
+    job.buffer = kNoBuffer;
+    job.owner = std::move(A);
+    std::lock_guard<std::mutex> lock(mutex_);
+    push(job);
+}
+
+/**
+ * @brief Write a batch of matrices by vectored writes.
+ */
+void MatrixStreamWriter::write_batch(vector<Job> &batch)
+{
+    vector<struct iovec> iov;
+    iov.reserve(batch.size() * 2);
+    uint64_t size = 0;
+    for (Job &job : batch) {
+        struct iovec v;
+        v.iov_base = job.header;
+        v.iov_len = sizeof(job.header);
+        iov.push_back(v);
+        v.iov_base = const_cast<double *>(job.data);
+        v.iov_len = job.header[0] * job.header[1] * sizeof(double);
+        iov.push_back(v);
+        size += sizeof(job.header) + v.iov_len;
+    }
+    container::pwritev_all(fd_, iov, offset_, fname_);
+    offset_ += size;
+}
+
+/**
+ * @details The background thread takes all the queued matrices at once, so
+ * that the caller can fill the free buffers while they are written.
+ */
+void MatrixStreamWriter::write_behind()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    vector<Job> batch;
+    while (true) {
+        cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;
+        }
+        batch.assign(queue_.begin(), queue_.end());
+        queue_.clear();
+        writing_ = true;
+        const bool failed = static_cast<bool>(error_);
+        lock.unlock();
+
+        // the matrices queued after an error are discarded.
+        std::exception_ptr error;
+        if (!failed) {
+            try {
+                write_batch(batch);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        lock.lock();
+        for (const Job &job : batch) {
+            if (job.buffer != kNoBuffer) {
+                free_.push_back(job.buffer);
+            }
+        }
+        batch.clear();
+        if (error) {
+            error_ = error;
+        }
+        writing_ = false;
+        cond_.notify_all();
+    }
+}
+
+void MatrixStreamWriter::flush(bool sync)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return queue_.empty() && !writing_; });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    if (sync && fd_ >= 0 && fdatasync(fd_) != 0) {
+        throw exception::MatrixIOException(
+            fname_, string("Fail to sync file: ") + std::strerror(errno));
+    }
+}
+
+void MatrixStreamWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0) {
+            return;
+        }
+        stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+
+    const int fd = fd_;
+    fd_ = -1;
+    if (error_) {
+        ::close(fd);
+        std::rethrow_exception(error_);
+    } else if (::close(fd) != 0) {
+        throw exception::MatrixIOException(fname_,
+                                           "Fail to close matrix binary file.");
+    }
+}
+
+} // namespace matrix
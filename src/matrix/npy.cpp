@@ -0,0 +1,788 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix.h>
+#include <matrix/details/matrix_io.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <set>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef MATRIX_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#include "container_format.h"
+#include "parallel_io.h"
+#include "text_parser.h"
+
+namespace matrix {
+
+namespace npy {
+
+static const char kMagic[] = "\x93NUMPY";
+static const size_t kMagicSize = 6;
+
+/**
+ * @brief Alignment of the npy header and of the data in the files written by
+ * this library, which is also used by numpy.
+ */
+static const size_t kAlignment = 64;
+
+static const uint32_t kZipLocalHeader = 0x04034b50;
+static const uint32_t kZipCentralHeader = 0x02014b50;
+static const uint32_t kZipEndOfDirectory = 0x06054b50;
+static const uint32_t kZip64EndOfDirectory = 0x06064b50;
+static const uint32_t kZip64Locator = 0x07064b50;
+static const uint16_t kZip64ExtraId = 0x0001;
+/**
+ * @brief Id of the extra field that pads the data of a zip entry to
+ * kAlignment. Unknown extra fields are skipped by zip readers.
+ */
+static const uint16_t kZipPaddingExtraId = 0x4d4c;
+static const uint32_t kZipMax32 = 0xffffffff;
+static const uint32_t kZipMax16 = 0xffff;
+/**
+ * @brief Zip date 1980-01-01 in MS-DOS format.
+ */
+static const uint16_t kZipDate = 0x21;
+
+/**
+ * @brief An array in a npy file.
+ */
+struct Array {
+    size_t row;
+    size_t col;
+    char kind;       /* 'f': float, 'i': signed int, 'u': unsigned int, 'b':
+                        bool. */
+    size_t itemsize; /* bytes of an element. */
+    bool swap;       /* the byte order is not the native one. */
+    bool fortran;    /* the elements are stored column by column. */
+    const char *data;
+};
+
+static bool is_little_endian()
+{
+    const uint16_t one = 1;
+    unsigned char byte;
+    std::memcpy(&byte, &one, 1);
+    return byte == 1;
+}
+
+/**
+ * @brief Get a little-endian unsigned integer of \p bytes bytes.
+ */
+static uint64_t get(const char *p, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | static_cast<unsigned char>(p[i]);
+    }
+    return value;
+}
+
+/**
+ * @brief Append a little-endian unsigned integer of \p bytes bytes.
+ */
+static void put(string &out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+/**
+ * @brief Find the value of a key in the header dictionary of a npy file,
+ * e.g. `{'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }`.
+ *
+ * @return const char *: the first non-space character of the value, or
+ * nullptr if the key is not found.
+ */
+static const char *find_value(const string &header, const string &key)
+{
+    for (const char quote : {'\'', '"'}) {
+        size_t pos = header.find(quote + key + quote);
+        if (pos == string::npos) {
+            continue;
+        }
+        pos = header.find_first_not_of(" ", pos + key.size() + 2);
+        if (pos == string::npos || header[pos] != ':') {
+            return nullptr;
+        }
+        pos = header.find_first_not_of(" ", pos + 1);
+        return pos == string::npos ? nullptr : header.c_str() + pos;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Parse the dtype string, e.g. `<f8`.
+ */
+static bool parse_descr(const char *p, const char *end, Array &a)
+{
+    if (p == nullptr || (*p != '\'' && *p != '"')) {
+        return false;
+    }
+    const char quote = *p++;
+    const char *last = std::find(p, end, quote);
+    if (last - p < 3 || std::strchr("<>|=", *p) == nullptr) {
+        return false;
+    }
+    const char order = *p++;
+    a.kind = *p++;
+    const char *q = text::parse_size(p, last, a.itemsize);
+    if (q != last) {
+        return false;
+    }
+    bool valid = false;
+    switch (a.kind) {
+    case 'f':
+        valid = a.itemsize == 4 || a.itemsize == 8;
+        break;
+    case 'i':
+    case 'u':
+        valid = a.itemsize == 1 || a.itemsize == 2 || a.itemsize == 4 ||
+                a.itemsize == 8;
+        break;
+    case 'b':
+        valid = a.itemsize == 1;
+        break;
+    }
+    const bool little = is_little_endian();
+    a.swap = a.itemsize > 1 &&
+             ((order == '<' && !little) || (order == '>' && little));
+    return valid;
+}
+
+/**
+ * @brief Parse the shape tuple, e.g. `(3, 4)`. A 0-d array is a [1, 1]
+ * matrix, and a 1-d array of n elements is a [1, n] matrix.
+ */
+static bool parse_shape(const char *p, const char *end, Array &a)
+{
+    if (p == nullptr || *p != '(') {
+        return false;
+    }
+    p++;
+    size_t dims[2];
+    size_t ndim = 0;
+    while (true) {
+        while (p < end && *p == ' ') {
+            p++;
+        }
+        if (p < end && *p == ')') {
+            break;
+        }
+        size_t n = 0;
+        const char *q = text::parse_size(p, end, n);
+        if (q == nullptr || ndim == 2) {
+            return false;
+        }
+        dims[ndim++] = n;
+        p = q;
+        while (p < end && *p == ' ') {
+            p++;
+        }
+        if (p < end && *p == ',') {
+            p++;
+        } else if (p >= end || *p != ')') {
+            return false;
+        }
+    }
+    a.row = ndim == 2 ? dims[0] : 1;
+    a.col = ndim == 0 ? 1 : dims[ndim - 1];
+    return true;
+}
+
+/**
+ * @brief Parse a npy file in the bytes [p, p + size), and check that the
+ * data is inside the bytes.
+ */
+static Array parse_npy(const char *p, size_t size, const string &fname)
+{
+    const string error = "Fail to read npy file, ";
+    if (size < kMagicSize + 4 || std::memcmp(p, kMagic, kMagicSize) != 0) {
+        throw exception::MatrixIOException(fname, error + "invalid magic.");
+    }
+    const int major = static_cast<unsigned char>(p[kMagicSize]);
+    size_t offset = kMagicSize + 2;
+    size_t header_size = 0;
+    if (major == 1) {
+        header_size = get(p + offset, 2);
+        offset += 2;
+    } else if (major == 2 || major == 3) {
+        if (size < offset + 4) {
+            throw exception::MatrixIOException(fname, error + "truncated.");
+        }
+        header_size = get(p + offset, 4);
+        offset += 4;
+    } else {
+        throw exception::MatrixIOException(
+            fname, error + "unsupported format version.");
+    }
+    if (header_size > size - offset) {
+        throw exception::MatrixIOException(fname, error + "truncated.");
+    }
+    const string header(p + offset, header_size);
+    const char *end = header.c_str() + header.size();
+    offset += header_size;
+
+    Array a;
+    if (!parse_descr(find_value(header, "descr"), end, a)) {
+        throw exception::MatrixIOException(
+            fname, error + "unsupported dtype, only float, int and bool "
+                           "arrays are supported.");
+    }
+    const char *order = find_value(header, "fortran_order");
+    if (order == nullptr || (std::strncmp(order, "True", 4) != 0 &&
+                             std::strncmp(order, "False", 5) != 0)) {
+        throw exception::MatrixIOException(fname,
+                                           error + "invalid fortran_order.");
+    }
+    a.fortran = order[0] == 'T';
+    if (!parse_shape(find_value(header, "shape"), end, a)) {
+        throw exception::MatrixIOException(
+            fname, error + "invalid shape, only arrays of up to 2 dimensions "
+                           "are supported.");
+    }
+    const size_t max_size = (size - offset) / a.itemsize;
+    if ((a.col != 0 && a.row > max_size / a.col) ||
+        a.row * a.col > max_size) {
+        throw exception::MatrixIOException(
+            fname, error + "detect unmatched size.");
+    }
+    a.data = p + offset;
+    return a;
+}
+
+/**
+ * @brief Convert the elements of an array into a row-major matrix.
+ */
+template <typename T>
+static void convert(const Array &a, double *out)
+{
+    const size_t row = a.row;
+    const size_t col = a.col;
+    const size_t n = row * col;
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t k = 0; k < n; k++) {
+        const size_t i = a.fortran ? k % col * row + k / col : k;
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, a.data + i * sizeof(T), sizeof(T));
+        if (a.swap) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        out[k] = static_cast<double>(value);
+    }
+}
+
+/**
+ * @brief Create a matrix of an array. The matrix shares the memory of the
+ * mapping if the array is made of native float64 in row-major order,
+ * otherwise the elements are converted into a new matrix.
+ */
+static std::shared_ptr<Matrix> to_matrix(const Array &a,
+                                         const std::shared_ptr<void> &mapping)
+{
+    const bool row_major = !a.fortran || a.row <= 1 || a.col <= 1;
+    if (a.kind == 'f' && a.itemsize == sizeof(double) && !a.swap &&
+        row_major &&
+        reinterpret_cast<uintptr_t>(a.data) % alignof(double) == 0) {
+        double *data = reinterpret_cast<double *>(const_cast<char *>(a.data));
+        return std::make_shared<Matrix>(a.row, a.col, data, mapping);
+    }
+    auto A = std::make_shared<Matrix>(a.row, a.col);
+    double *out = A->data();
+    if (a.kind == 'f') {
+        a.itemsize == 8 ? convert<double>(a, out) : convert<float>(a, out);
+    } else if (a.kind == 'i') {
+        switch (a.itemsize) {
+        case 1:
+            convert<int8_t>(a, out);
+            break;
+        case 2:
+            convert<int16_t>(a, out);
+            break;
+        case 4:
+            convert<int32_t>(a, out);
+            break;
+        default:
+            convert<int64_t>(a, out);
+            break;
+        }
+    } else {
+        // bool is stored as a byte of 0 or 1.
+        switch (a.itemsize) {
+        case 1:
+            convert<uint8_t>(a, out);
+            break;
+        case 2:
+            convert<uint16_t>(a, out);
+            break;
+        case 4:
+            convert<uint32_t>(a, out);
+            break;
+        default:
+            convert<uint64_t>(a, out);
+            break;
+        }
+    }
+    return A;
+}
+
+/**
+ * @brief Map a file into memory copy-on-write.
+ */
+static std::shared_ptr<void> map_file(const string &fname, size_t &length)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw exception::MatrixIOException(fname, "Cannot open file.");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw exception::MatrixIOException(fname,
+                                           "Cannot read file, empty file.");
+    }
+    length = st.st_size;
+    void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw exception::MatrixIOException(fname, "Cannot map file.");
+    }
+    const size_t size = length;
+    return std::shared_ptr<void>(addr, [size](void *p) { munmap(p, size); });
+}
+
+/**
+ * @brief Get the npy header of a matrix, padded so that the data is aligned
+ * to kAlignment.
+ */
+static string npy_header(const Matrix &A)
+{
+    std::stringstream dict;
+    dict << "{'descr': '" << (is_little_endian() ? '<' : '>')
+         << "f8', 'fortran_order': False, 'shape': (" << A.row() << ", "
+         << A.col() << "), }";
+    string header = dict.str();
+    const size_t prefix = kMagicSize + 4;
+    const size_t size = (prefix + header.size() + 1 + kAlignment - 1) /
+                        kAlignment * kAlignment;
+    header.resize(size - prefix - 1, ' ');
+    header += '\n';
+
+    string out(kMagic, kMagicSize);
+    out += '\x01';
+    out += '\x00';
+    put(out, header.size(), 2);
+    return out + header;
+}
+
+/**
+ * @brief Calculate the CRC-32 checksum of zip files.
+ */
+static uint32_t zip_crc32(const void *data, size_t size, uint32_t crc)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+#ifdef MATRIX_HAS_ZLIB
+    while (size > 0) {
+        const uInt n = static_cast<uInt>(std::min<size_t>(size, 1 << 30));
+        crc = static_cast<uint32_t>(::crc32(crc, p, n));
+        p += n;
+        size -= n;
+    }
+    return crc;
+#else
+    struct Table {
+        uint32_t table[256];
+        Table()
+        {
+            for (uint32_t b = 0; b < 256; b++) {
+                uint32_t c = b;
+                for (int i = 0; i < 8; i++) {
+                    c = (c >> 1) ^ (0xedb88320 & (0u - (c & 1)));
+                }
+                table[b] = c;
+            }
+        }
+    };
+    static const Table t;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = t.table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+#endif
+}
+
+/**
+ * @brief Open a file for writing, or throw exception::MatrixIOException.
+ */
+static int open_for_write(const string &fname)
+{
+    int fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            fname, string("Cannot write file: ") + std::strerror(errno));
+    }
+    return fd;
+}
+
+static void close_after_write(int fd, const string &fname)
+{
+    if (close(fd) != 0) {
+        throw exception::MatrixIOException(
+            fname, string("Fail to write file: ") + std::strerror(errno));
+    }
+}
+
+/**
+ * @brief An entry of the zip central directory.
+ */
+struct ZipEntry {
+    string name;
+    uint32_t crc;
+    uint64_t size;
+    uint64_t offset;
+};
+
+/**
+ * @brief Write a matrix as a stored (uncompressed) zip entry at \p offset,
+ * and return the end of the entry.
+ */
+static uint64_t write_zip_entry(int fd, const string &fname, const Matrix &A,
+                                ZipEntry &e)
+{
+    const string header = npy_header(A);
+    const size_t data_size = A.size() * sizeof(double);
+    e.size = header.size() + data_size;
+    e.crc = zip_crc32(header.data(), header.size(), 0);
+    e.crc = zip_crc32(A.data(), data_size, e.crc);
+    const bool zip64 = e.size >= kZipMax32;
+
+    string local;
+    put(local, kZipLocalHeader, 4);
+    put(local, zip64 ? 45 : 20, 2); /* version needed to extract. */
+    put(local, 0, 2);               /* flags. */
+    put(local, 0, 2);               /* stored. */
+    put(local, 0, 2);               /* time. */
+    put(local, kZipDate, 2);
+    put(local, e.crc, 4);
+    put(local, zip64 ? kZipMax32 : e.size, 4);
+    put(local, zip64 ? kZipMax32 : e.size, 4);
+    put(local, e.name.size(), 2);
+    const size_t extra_size_pos = local.size();
+    put(local, 0, 2);
+    local += e.name;
+    if (zip64) {
+        put(local, kZip64ExtraId, 2);
+        put(local, 16, 2);
+        put(local, e.size, 8);
+        put(local, e.size, 8);
+    }
+    // the padding field has a 4-byte header.
+    const size_t pad = (kAlignment - (e.offset + local.size() + 4) %
+                                         kAlignment) % kAlignment;
+    put(local, kZipPaddingExtraId, 2);
+    put(local, pad, 2);
+    local.append(pad, '\0');
+    const size_t extra_size = local.size() - 30 - e.name.size();
+    local[extra_size_pos] = static_cast<char>(extra_size & 0xff);
+    local[extra_size_pos + 1] = static_cast<char>(extra_size >> 8);
+
+    uint64_t offset = e.offset;
+    container::pwrite_all(fd, local.data(), local.size(), offset, fname);
+    offset += local.size();
+    container::pwrite_all(fd, header.data(), header.size(), offset, fname);
+    offset += header.size();
+    pio::write(fd, fname, A.data(), data_size, offset);
+    return offset + data_size;
+}
+
+/**
+ * @brief Get the central directory and the end of central directory records
+ * of a zip file.
+ */
+static string zip_directory(const std::vector<ZipEntry> &entries,
+                            uint64_t offset)
+{
+    string out;
+    for (const auto &e : entries) {
+        const bool zip64 = e.size >= kZipMax32 || e.offset >= kZipMax32;
+        put(out, kZipCentralHeader, 4);
+        put(out, (3 << 8) | (zip64 ? 45 : 20), 2); /* made by unix. */
+        put(out, zip64 ? 45 : 20, 2);
+        put(out, 0, 2);
+        put(out, 0, 2);
+        put(out, 0, 2);
+        put(out, kZipDate, 2);
+        put(out, e.crc, 4);
+        put(out, zip64 ? kZipMax32 : e.size, 4);
+        put(out, zip64 ? kZipMax32 : e.size, 4);
+        put(out, e.name.size(), 2);
+        put(out, zip64 ? 28 : 0, 2); /* extra field. */
+        put(out, 0, 2);              /* comment. */
+        put(out, 0, 2);              /* disk. */
+        put(out, 0, 2);              /* internal attributes. */
+        put(out, 0644u << 16, 4);    /* external attributes. */
+        put(out, zip64 ? kZipMax32 : e.offset, 4);
+        out += e.name;
+        if (zip64) {
+            put(out, kZip64ExtraId, 2);
+            put(out, 24, 2);
+            put(out, e.size, 8);
+            put(out, e.size, 8);
+            put(out, e.offset, 8);
+        }
+    }
+
+    const uint64_t n = entries.size();
+    const uint64_t size = out.size();
+    const bool zip64 = n >= kZipMax16 || size >= kZipMax32 ||
+                       offset >= kZipMax32;
+    if (zip64) {
+        const uint64_t end_offset = offset + size;
+        put(out, kZip64EndOfDirectory, 4);
+        put(out, 44, 8); /* size of the remaining record. */
+        put(out, (3 << 8) | 45, 2);
+        put(out, 45, 2);
+        put(out, 0, 4);
+        put(out, 0, 4);
+        put(out, n, 8);
+        put(out, n, 8);
+        put(out, size, 8);
+        put(out, offset, 8);
+        put(out, kZip64Locator, 4);
+        put(out, 0, 4);
+        put(out, end_offset, 8);
+        put(out, 1, 4);
+    }
+    put(out, kZipEndOfDirectory, 4);
+    put(out, 0, 2);
+    put(out, 0, 2);
+    put(out, zip64 ? kZipMax16 : n, 2);
+    put(out, zip64 ? kZipMax16 : n, 2);
+    put(out, zip64 ? kZipMax32 : size, 4);
+    put(out, zip64 ? kZipMax32 : offset, 4);
+    put(out, 0, 2);
+    return out;
+}
+
+/**
+ * @brief Find the zip64 extra field of a zip header, and replace the values
+ * that are saturated to the maximum 32-bit value by the 64-bit ones.
+ */
+static bool read_zip64_extra(const char *extra, size_t extra_size,
+                             uint64_t *values[], size_t nvalue)
+{
+    size_t pos = 0;
+    while (pos + 4 <= extra_size) {
+        const uint64_t id = get(extra + pos, 2);
+        const uint64_t size = get(extra + pos + 2, 2);
+        pos += 4;
+        if (size > extra_size - pos) {
+            return false;
+        }
+        if (id == kZip64ExtraId) {
+            size_t k = 0;
+            for (size_t i = 0; i < nvalue; i++) {
+                if (*values[i] == kZipMax32) {
+                    if (k + 8 > size) {
+                        return false;
+                    }
+                    *values[i] = get(extra + pos + k, 8);
+                    k += 8;
+                }
+            }
+            return true;
+        }
+        pos += size;
+    }
+    return true;
+}
+
+} // namespace npy
+
+void write_matrix_to_npy(const Matrix &A, const string &fname)
+{
+    const string header = npy::npy_header(A);
+    int fd = npy::open_for_write(fname);
+    try {
+        container::pwrite_all(fd, header.data(), header.size(), 0, fname);
+        pio::write(fd, fname, A.data(), A.size() * sizeof(double),
+                   header.size());
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    npy::close_after_write(fd, fname);
+}
+
+std::shared_ptr<Matrix> read_matrix_from_npy(const string &fname)
+{
+    size_t length = 0;
+    auto mapping = npy::map_file(fname, length);
+    auto a = npy::parse_npy(static_cast<const char *>(mapping.get()), length,
+                            fname);
+    return npy::to_matrix(a, mapping);
+}
+
+void write_matrices_to_npz(const vector<std::shared_ptr<const Matrix>> &Mat,
+                           const string &fname, const vector<string> &names)
+{
+    if (!names.empty() && names.size() != Mat.size()) {
+        throw exception::DimensionError(
+            Mat.size(), names.size(),
+            "Error in matrix::write_matrices_to_npz(): unmatched number of "
+            "names.");
+    }
+    std::vector<npy::ZipEntry> entries(Mat.size());
+    std::set<string> used;
+    for (size_t i = 0; i < Mat.size(); i++) {
+        const string name = names.empty() ? "arr_" + std::to_string(i)
+                                          : names[i];
+        if (name.empty() || !used.insert(name).second) {
+            throw exception::MatrixIOException(
+                fname, "Empty or duplicated matrix name in npz file: " + name);
+        }
+        entries[i].name = name + ".npy";
+        if (entries[i].name.size() >= npy::kZipMax16) {
+            throw exception::MatrixIOException(
+                fname, "Too long matrix name in npz file: " + name);
+        }
+    }
+
+    int fd = npy::open_for_write(fname);
+    try {
+        uint64_t offset = 0;
+        for (size_t i = 0; i < Mat.size(); i++) {
+            entries[i].offset = offset;
+            offset = npy::write_zip_entry(fd, fname, *Mat[i], entries[i]);
+        }
+        const string directory = npy::zip_directory(entries, offset);
+        container::pwrite_all(fd, directory.data(), directory.size(), offset,
+                              fname);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    npy::close_after_write(fd, fname);
+}
+
+std::vector<std::shared_ptr<Matrix>>
+read_matrices_from_npz(const string &fname, vector<string> *names)
+{
+    size_t length = 0;
+    auto mapping = npy::map_file(fname, length);
+    const char *base = static_cast<const char *>(mapping.get());
+    const string error = "Fail to read npz file, ";
+
+    // the end of central directory record is followed by a comment of up to
+    // 65535 bytes.
+    const size_t kEndSize = 22;
+    size_t end = length;
+    for (size_t pos = length >= kEndSize ? length - kEndSize + 1 : 0;
+         pos > 0 && length - pos < kEndSize + npy::kZipMax16;) {
+        pos--;
+        if (npy::get(base + pos, 4) == npy::kZipEndOfDirectory) {
+            end = pos;
+            break;
+        }
+    }
+    if (end == length) {
+        throw exception::MatrixIOException(fname, error + "not a zip file.");
+    }
+    uint64_t n = npy::get(base + end + 10, 2);
+    uint64_t directory = npy::get(base + end + 16, 4);
+    if (n == npy::kZipMax16 || directory == npy::kZipMax32) {
+        const size_t kLocatorSize = 20;
+        if (end < kLocatorSize ||
+            npy::get(base + end - kLocatorSize, 4) != npy::kZip64Locator) {
+            throw exception::MatrixIOException(fname,
+                                               error + "invalid zip64 file.");
+        }
+        const uint64_t pos = npy::get(base + end - kLocatorSize + 8, 8);
+        if (length < 56 || pos > length - 56 ||
+            npy::get(base + pos, 4) != npy::kZip64EndOfDirectory) {
+            throw exception::MatrixIOException(fname,
+                                               error + "invalid zip64 file.");
+        }
+        n = npy::get(base + pos + 32, 8);
+        directory = npy::get(base + pos + 48, 8);
+    }
+
+    std::vector<std::shared_ptr<Matrix>> rst;
+    vector<string> rst_names;
+    uint64_t pos = directory;
+    for (uint64_t i = 0; i < n; i++) {
+        const size_t kCentralSize = 46;
+        if (pos > length || length - pos < kCentralSize ||
+            npy::get(base + pos, 4) != npy::kZipCentralHeader) {
+            throw exception::MatrixIOException(
+                fname, error + "invalid central directory.");
+        }
+        const char *h = base + pos;
+        const uint64_t flags = npy::get(h + 8, 2);
+        const uint64_t method = npy::get(h + 10, 2);
+        uint64_t size = npy::get(h + 20, 4);
+        uint64_t usize = npy::get(h + 24, 4);
+        const uint64_t name_size = npy::get(h + 28, 2);
+        const uint64_t extra_size = npy::get(h + 30, 2);
+        const uint64_t comment_size = npy::get(h + 32, 2);
+        uint64_t offset = npy::get(h + 42, 4);
+        pos += kCentralSize + name_size + extra_size + comment_size;
+        uint64_t *values[] = {&usize, &size, &offset};
+        if (pos > length ||
+            !npy::read_zip64_extra(h + kCentralSize + name_size, extra_size,
+                                   values, 3)) {
+            throw exception::MatrixIOException(
+                fname, error + "invalid central directory.");
+        }
+        string name(h + kCentralSize, name_size);
+        if (method != 0 || (flags & 1) != 0) {
+            throw exception::MatrixIOException(
+                fname, error + "the entry " + name +
+                           " is compressed or encrypted, only the files "
+                           "written by numpy.savez() are supported.");
+        }
+
+        const size_t kLocalSize = 30;
+        if (offset > length || length - offset < kLocalSize ||
+            npy::get(base + offset, 4) != npy::kZipLocalHeader) {
+            throw exception::MatrixIOException(
+                fname, error + "invalid local header of " + name);
+        }
+        const uint64_t data = offset + kLocalSize +
+                              npy::get(base + offset + 26, 2) +
+                              npy::get(base + offset + 28, 2);
+        if (data > length || size > length - data) {
+            throw exception::MatrixIOException(fname,
+                                               error + "truncated " + name);
+        }
+        auto a = npy::parse_npy(base + data, size, fname);
+        rst.push_back(npy::to_matrix(a, mapping));
+        const string suffix = ".npy";
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(),
+                         suffix) == 0) {
+            name.resize(name.size() - suffix.size());
+        }
+        rst_names.push_back(name);
+    }
+    if (names != nullptr) {
+        names->swap(rst_names);
+    }
+    return rst;
+}
+
+} // namespace matrix
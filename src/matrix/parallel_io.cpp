@@ -0,0 +1,391 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix_io.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "container_format.h"
+#include "parallel_io.h"
+
+namespace matrix {
+
+namespace pio {
+
+/**
+ * @brief Alignment of the buffers, the offsets and the sizes of direct I/O.
+ */
+static const size_t kDirectAlignment = 4096;
+
+static const size_t kDefaultChunkSize = 8 << 20;
+
+static std::atomic<int> io_num_threads(0);
+static std::atomic<size_t> io_chunk_size(kDefaultChunkSize);
+static std::atomic<bool> io_direct(false);
+
+/**
+ * @brief A pool of threads that run the tasks of one job at a time. The
+ * calling thread also runs the tasks.
+ */
+class ThreadPool {
+  public:
+    static ThreadPool &instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (auto &t : workers_) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Run task(0), ..., task(ntask - 1) on nthreads threads, and
+     * rethrow the first exception raised by the tasks.
+     */
+    void run(size_t nthreads, size_t ntask,
+             const std::function<void(size_t)> &task)
+    {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (workers_.size() + 1 < nthreads) {
+                workers_.emplace_back(&ThreadPool::work, this,
+                                      workers_.size());
+            }
+            task_ = &task;
+            ntask_ = ntask;
+            next_ = 0;
+            error_ = nullptr;
+            nworkers_ = std::min(nthreads - 1, workers_.size());
+            active_ = nworkers_;
+            generation_++;
+        }
+        start_.notify_all();
+        run_tasks();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return active_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+  private:
+    ThreadPool() : task_(nullptr), ntask_(0), next_(0), nworkers_(0),
+                   active_(0), generation_(0), stop_(false)
+    {
+    }
+
+    void run_tasks()
+    {
+        size_t i;
+        while ((i = next_++) < ntask_) {
+            try {
+                (*task_)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void work(size_t id)
+    {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&]() {
+                    return stop_ || (generation_ != seen && id < nworkers_);
+                });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            run_tasks();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    std::mutex run_mutex_; /* one job at a time. */
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::vector<std::thread> workers_;
+    const std::function<void(size_t)> *task_;
+    size_t ntask_;
+    std::atomic<size_t> next_;
+    size_t nworkers_; /* number of workers of the current job. */
+    size_t active_;   /* number of workers running the current job. */
+    uint64_t generation_;
+    std::exception_ptr error_;
+    bool stop_;
+};
+
+/**
+ * @brief A page-aligned buffer of each thread for direct I/O.
+ */
+static char *bounce_buffer(size_t size)
+{
+    struct Buffer {
+        void *data = nullptr;
+        size_t size = 0;
+        ~Buffer() { std::free(data); }
+    };
+    static thread_local Buffer buffer;
+    if (buffer.size < size) {
+        std::free(buffer.data);
+        buffer.data = nullptr;
+        buffer.size = 0;
+        if (posix_memalign(&buffer.data, kDirectAlignment, size) != 0) {
+            throw std::bad_alloc();
+        }
+        buffer.size = size;
+    }
+    return static_cast<char *>(buffer.data);
+}
+
+static uint64_t align_down(uint64_t offset)
+{
+    return offset / kDirectAlignment * kDirectAlignment;
+}
+
+static uint64_t align_up(uint64_t offset)
+{
+    return align_down(offset + kDirectAlignment - 1);
+}
+
+/**
+ * @brief Read the bytes [first, last) of the file by direct I/O.
+ * @return bool: false if direct I/O is not supported.
+ */
+static bool direct_read(int direct_fd, char *buf, uint64_t first,
+                        uint64_t last, const std::string &fname)
+{
+    const uint64_t begin = align_down(first);
+    const uint64_t end = align_up(last);
+    char *bounce = bounce_buffer(end - begin);
+    uint64_t done = 0;
+    // the read stops early at the end of the file.
+    while (begin + done < last) {
+        ssize_t n = pread(direct_fd, bounce + done, end - begin - done,
+                          begin + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EINVAL && done == 0) {
+            return false;
+        } else if (n < 0) {
+            throw exception::MatrixIOException(
+                fname, std::string("Fail to read file: ") +
+                           std::strerror(errno));
+        } else if (n == 0) {
+            throw exception::MatrixIOException(
+                fname, "Fail to read file, unexpected end of file.");
+        }
+        done += n;
+    }
+    std::memcpy(buf, bounce + (first - begin), last - first);
+    return true;
+}
+
+/**
+ * @brief Write the whole blocks in the bytes [first, last) of the file by
+ * direct I/O, and the partial blocks at both ends by buffered I/O.
+ */
+static void direct_write(int fd, int direct_fd, const char *buf,
+                         uint64_t first, uint64_t last,
+                         const std::string &fname)
+{
+    const uint64_t begin = std::min(align_up(first), last);
+    const uint64_t end = std::max(align_down(last), begin);
+    if (begin > first) {
+        container::pwrite_all(fd, buf, begin - first, first, fname);
+    }
+    if (last > end) {
+        container::pwrite_all(fd, buf + (end - first), last - end, end,
+                              fname);
+    }
+    if (end == begin) {
+        return;
+    }
+    char *bounce = bounce_buffer(end - begin);
+    std::memcpy(bounce, buf + (begin - first), end - begin);
+    uint64_t done = 0;
+    while (begin + done < end) {
+        ssize_t n = pwrite(direct_fd, bounce + done, end - begin - done,
+                           begin + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EINVAL && done == 0) {
+            container::pwrite_all(fd, bounce, end - begin, begin, fname);
+            return;
+        } else if (n <= 0) {
+            throw exception::MatrixIOException(
+                fname, std::string("Fail to write file: ") +
+                           std::strerror(errno));
+        }
+        done += n;
+    }
+}
+
+/**
+ * @brief Get the number of I/O threads.
+ */
+static size_t num_threads()
+{
+    const int n = io_num_threads;
+    if (n > 0) {
+        return n;
+    }
+    // storage devices are saturated by a few outstanding requests each.
+    const size_t hardware = std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min<size_t>(hardware, 8));
+}
+
+/**
+ * @brief Split the bytes at [offset, offset + size) of the file at the
+ * multiples of the chunk size, and run io(first, last) on each chunk in
+ * parallel.
+ */
+static void for_each_chunk(
+    uint64_t offset, size_t size,
+    const std::function<void(uint64_t, uint64_t)> &io)
+{
+    const uint64_t chunk = io_chunk_size;
+    const uint64_t begin = offset / chunk * chunk;
+    const size_t nchunk = (offset + size - begin + chunk - 1) / chunk;
+    const size_t nthreads = std::min(num_threads(), nchunk);
+    ThreadPool::instance().run(nthreads, nchunk, [&](size_t i) {
+        const uint64_t first = std::max(offset, begin + i * chunk);
+        const uint64_t last = std::min(offset + size, begin + (i + 1) * chunk);
+        io(first, last);
+    });
+}
+
+/**
+ * @brief Check if a payload is large enough for parallel I/O.
+ */
+static bool use_parallel_io(size_t size)
+{
+    return size >= 2 * io_chunk_size && (num_threads() > 1 || io_direct);
+}
+
+void read(int fd, const std::string &fname, void *buf, size_t size,
+          uint64_t offset)
+{
+    if (!use_parallel_io(size)) {
+        container::pread_all(fd, buf, size, offset, fname);
+        return;
+    }
+    const int direct_fd = io_direct ? open(fname.c_str(), O_RDONLY | O_DIRECT)
+                                    : -1;
+    char *data = static_cast<char *>(buf);
+    try {
+        for_each_chunk(offset, size, [&](uint64_t first, uint64_t last) {
+            char *p = data + (first - offset);
+            if (direct_fd < 0 ||
+                !direct_read(direct_fd, p, first, last, fname)) {
+                container::pread_all(fd, p, last - first, first, fname);
+            }
+        });
+    } catch (...) {
+        if (direct_fd >= 0) {
+            close(direct_fd);
+        }
+        throw;
+    }
+    if (direct_fd >= 0) {
+        close(direct_fd);
+    }
+}
+
+void write(int fd, const std::string &fname, const void *buf, size_t size,
+           uint64_t offset)
+{
+    if (!use_parallel_io(size)) {
+        container::pwrite_all(fd, buf, size, offset, fname);
+        return;
+    }
+    const int direct_fd = io_direct ? open(fname.c_str(), O_WRONLY | O_DIRECT)
+                                    : -1;
+    const char *data = static_cast<const char *>(buf);
+    try {
+        for_each_chunk(offset, size, [&](uint64_t first, uint64_t last) {
+            const char *p = data + (first - offset);
+            if (direct_fd < 0) {
+                container::pwrite_all(fd, p, last - first, first, fname);
+            } else {
+                direct_write(fd, direct_fd, p, first, last, fname);
+            }
+        });
+    } catch (...) {
+        if (direct_fd >= 0) {
+            close(direct_fd);
+        }
+        throw;
+    }
+    if (direct_fd >= 0) {
+        close(direct_fd);
+    }
+}
+
+} // namespace pio
+
+void set_io_num_threads(int num_threads)
+{
+    pio::io_num_threads = std::max(num_threads, 0);
+}
+
+int get_io_num_threads()
+{
+    return static_cast<int>(pio::num_threads());
+}
+
+void set_io_chunk_size(size_t chunk_size)
+{
+    pio::io_chunk_size =
+        std::max(pio::align_up(chunk_size), (uint64_t)pio::kDirectAlignment);
+}
+
+size_t get_io_chunk_size()
+{
+    return pio::io_chunk_size;
+}
+
+void set_io_direct(bool direct)
+{
+    pio::io_direct = direct;
+}
+
+bool get_io_direct()
+{
+    return pio::io_direct;
+}
+
+} // namespace matrix
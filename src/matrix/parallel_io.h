@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief parallel positioned I/O of large payloads in binary matrix files.
+ *
+ * @details A payload larger than two chunks is split at the multiples of the
+ * chunk size in the file, and the chunks are read or written by `pread` or
+ * `pwrite` on a pool of I/O threads, straight from or into the memory of the
+ * matrix. With direct I/O, the file is also opened with `O_DIRECT` and the
+ * blocks inside a chunk bypass the page cache through aligned bounce
+ * buffers. Direct I/O is only a hint: the buffered I/O is used if the file
+ * system does not support it. The settings are changed by
+ * matrix::set_io_num_threads(), matrix::set_io_chunk_size() and
+ * matrix::set_io_direct().
+ */
+#ifndef _MATRIX_SRC_PARALLEL_IO_H_
+#define _MATRIX_SRC_PARALLEL_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace matrix {
+
+namespace pio {
+
+/**
+ * @brief Read all the bytes at a file offset, or throw
+ * exception::MatrixIOException.
+ *
+ * @param [in] fd: the file descriptor opened for reading.
+ * @param [in] fname: the file name, which is opened again for direct I/O.
+ */
+void read(int fd, const std::string &fname, void *buf, size_t size,
+          uint64_t offset);
+
+/**
+ * @brief Write all the bytes at a file offset, or throw
+ * exception::MatrixIOException.
+ *
+ * @param [in] fd: the file descriptor opened for writing.
+ * @param [in] fname: the file name, which is opened again for direct I/O.
+ */
+void write(int fd, const std::string &fname, const void *buf, size_t size,
+           uint64_t offset);
+
+} // namespace pio
+} // namespace matrix
+
+#endif // _MATRIX_SRC_PARALLEL_IO_H_
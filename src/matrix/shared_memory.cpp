@@ -0,0 +1,376 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/shared_memory.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "blas_base.h"
+
+// the reference count is updated by the processes sharing the segment, which
+// needs the atomics to be address-free.
+#if ATOMIC_LLONG_LOCK_FREE != 2 || ATOMIC_INT_LOCK_FREE != 2
+#error "lock-free atomics are required by the shared-memory store."
+#endif
+
+namespace matrix {
+
+namespace shm {
+
+static const char kMagic[8] = {'M', 'T', 'X', 'S', 'H', 'M', '\0', '\0'};
+static const uint32_t kVersion = 1;
+static const uint32_t kPersistent = 1;
+
+/* states of a segment. */
+static const uint32_t kPublishing = 0;
+static const uint32_t kReady = 1;
+
+/**
+ * @brief The header at the beginning of a segment, which occupies the first
+ * page. The matrix data starts at the second page.
+ */
+struct SegmentHeader {
+    std::atomic<uint32_t> state;
+    uint32_t flags;
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t row;
+    uint64_t col;
+    uint64_t offset; /* offset of the data, which is the page size. */
+    std::atomic<uint64_t> refs;
+};
+
+static size_t page_size()
+{
+    static const size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+static string error_message(const string &what)
+{
+    return what + ": " + std::strerror(errno);
+}
+
+static void check_name(const string &name)
+{
+    if (name.empty() || name.find('/') != string::npos) {
+        throw exception::MatrixException(
+            "invalid name of shared memory: \"" + name + "\"");
+    }
+}
+
+/**
+ * @brief A mapped segment, which is the owner of the data of the matrices on
+ * it. It holds one reference to the matrix if `referenced` is set.
+ */
+struct Segment {
+    string name;
+    SegmentHeader *header = nullptr;
+    void *data = nullptr;
+    size_t data_size = 0;
+    bool referenced = false;
+    dev_t dev = 0;
+    ino_t ino = 0;
+
+    Segment(const string &sname) : name(sname) {}
+    Segment(const Segment &) = delete;
+    Segment &operator=(const Segment &) = delete;
+
+    ~Segment()
+    {
+        if (data != nullptr) {
+            munmap(data, data_size);
+        }
+        if (header == nullptr) {
+            return;
+        }
+        if (referenced &&
+            header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+            !(header->flags & kPersistent)) {
+            unlink_if_same();
+        }
+        munmap(header, page_size());
+    }
+
+    /**
+     * @brief Unlink the name if it still refers to this segment, instead of a
+     * new one published after the segment is removed.
+     */
+    void unlink_if_same() const
+    {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        const bool same =
+            fstat(fd, &st) == 0 && st.st_dev == dev && st.st_ino == ino;
+        close(fd);
+        if (same) {
+            shm_unlink(name.c_str());
+        }
+    }
+
+    /**
+     * @brief Map the header page of the segment and record its identity.
+     *
+     * @return size_t: size of the segment.
+     */
+    size_t map_header(int fd, bool writable)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            throw exception::MatrixIOException(name, error_message("fstat"));
+        }
+        dev = st.st_dev;
+        ino = st.st_ino;
+        if ((size_t)st.st_size < page_size()) {
+            return st.st_size;
+        }
+        const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *addr = mmap(nullptr, page_size(), prot, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            throw exception::MatrixIOException(name, error_message("mmap"));
+        }
+        header = static_cast<SegmentHeader *>(addr);
+        return st.st_size;
+    }
+
+    /**
+     * @brief Check if the header is of a matrix that is ready to attach.
+     */
+    bool is_ready() const
+    {
+        return header != nullptr &&
+               header->state.load(std::memory_order_acquire) == kReady &&
+               std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+               header->version == kVersion;
+    }
+
+    /**
+     * @brief Check if the matrix can be attached to, i.e. it is persistent or
+     * not released by all the processes.
+     */
+    bool is_alive(uint64_t refs) const
+    {
+        return refs > 0 || (header->flags & kPersistent);
+    }
+
+    /**
+     * @brief Take a reference to the matrix if it is alive.
+     */
+    bool acquire()
+    {
+        uint64_t refs = header->refs.load(std::memory_order_relaxed);
+        do {
+            if (!is_alive(refs)) {
+                return false;
+            }
+        } while (!header->refs.compare_exchange_weak(
+            refs, refs + 1, std::memory_order_acq_rel));
+        referenced = true;
+        return true;
+    }
+};
+
+/**
+ * @brief Open a segment and map its header.
+ *
+ * @return std::shared_ptr<Segment>: the segment, or nullptr if it does not
+ * exist.
+ */
+static std::shared_ptr<Segment> open_segment(const string &sname,
+                                             bool writable, size_t *size)
+{
+    int fd = shm_open(sname.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return nullptr;
+        }
+        throw exception::MatrixIOException(sname, error_message("shm_open"));
+    }
+    auto seg = std::make_shared<Segment>(sname);
+    try {
+        *size = seg->map_header(fd, writable);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    return seg;
+}
+
+} // namespace shm
+
+SharedMatrixStore::SharedMatrixStore(const string &prefix) : prefix_(prefix)
+{
+    shm::check_name(prefix);
+}
+
+string SharedMatrixStore::segment_name(const string &name) const
+{
+    shm::check_name(name);
+    string sname = "/" + prefix_ + "." + name;
+    if (sname.size() > NAME_MAX) {
+        throw exception::MatrixException(
+            "name of shared memory is too long: \"" + sname + "\"");
+    }
+    return sname;
+}
+
+std::shared_ptr<const Matrix> SharedMatrixStore::publish(const string &name,
+                                                         const Matrix &A,
+                                                         bool persistent) const
+{
+    const string sname = segment_name(name);
+    if (A.size() > std::numeric_limits<size_t>::max() / sizeof(double) -
+                       shm::page_size()) {
+        throw exception::MatrixIOException(sname, "matrix is too large.");
+    }
+    int fd = shm_open(sname.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            sname, errno == EEXIST ? "matrix is already published."
+                                   : shm::error_message("shm_open"));
+    }
+
+    auto seg = std::make_shared<shm::Segment>(sname);
+    seg->data_size = A.size() * sizeof(double);
+    try {
+        // reserve the memory, so that a full /dev/shm fails here instead of
+        // by SIGBUS on the copy.
+        const size_t size = shm::page_size() + seg->data_size;
+        int err = posix_fallocate(fd, 0, size);
+        if (err != 0) {
+            errno = err;
+            throw exception::MatrixIOException(
+                sname, shm::error_message("posix_fallocate"));
+        }
+        seg->map_header(fd, true);
+        shm::SegmentHeader *header = new (seg->header) shm::SegmentHeader;
+        header->state.store(shm::kPublishing, std::memory_order_relaxed);
+        header->flags = persistent ? shm::kPersistent : 0;
+        std::memcpy(header->magic, shm::kMagic, sizeof(shm::kMagic));
+        header->version = shm::kVersion;
+        header->reserved = 0;
+        header->row = A.row();
+        header->col = A.col();
+        header->offset = shm::page_size();
+        header->refs.store(1, std::memory_order_relaxed);
+        seg->referenced = true;
+
+        if (seg->data_size > 0) {
+            void *addr = mmap(nullptr, seg->data_size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, header->offset);
+            if (addr == MAP_FAILED) {
+                throw exception::MatrixIOException(sname,
+                                                   shm::error_message("mmap"));
+            }
+            seg->data = addr;
+            blas::dcopy_chunked(A.size(), A.data(),
+                                static_cast<double *>(seg->data));
+            mprotect(seg->data, seg->data_size, PROT_READ);
+        }
+        header->state.store(shm::kReady, std::memory_order_release);
+    } catch (...) {
+        close(fd);
+        shm_unlink(sname.c_str());
+        throw;
+    }
+    close(fd);
+    return std::make_shared<Matrix>(A.row(), A.col(),
+                                    static_cast<double *>(seg->data), seg);
+}
+
+std::shared_ptr<const Matrix>
+SharedMatrixStore::attach(const string &name) const
+{
+    const string sname = segment_name(name);
+    int fd = shm_open(sname.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw exception::MatrixIOException(
+            sname, errno == ENOENT ? "matrix is not published."
+                                   : shm::error_message("shm_open"));
+    }
+
+    auto seg = std::make_shared<shm::Segment>(sname);
+    try {
+        const size_t size = seg->map_header(fd, true);
+        if (!seg->is_ready()) {
+            throw exception::MatrixIOException(
+                sname, "matrix is being published, or not a matrix segment.");
+        }
+        const shm::SegmentHeader *header = seg->header;
+        // the data starts at the second page, see publish().
+        if (header->offset != shm::page_size() || header->offset > size) {
+            throw exception::MatrixIOException(sname, "corrupted segment.");
+        }
+        if (header->col != 0 &&
+            header->row > (size - header->offset) / sizeof(double) /
+                              header->col) {
+            throw exception::MatrixIOException(sname, "corrupted segment.");
+        }
+        seg->data_size = header->row * header->col * sizeof(double);
+        if (size != header->offset + seg->data_size) {
+            throw exception::MatrixIOException(sname, "corrupted segment.");
+        }
+        if (!seg->acquire()) {
+            throw exception::MatrixIOException(sname, "matrix is removed.");
+        }
+        if (seg->data_size > 0) {
+            void *addr = mmap(nullptr, seg->data_size, PROT_READ, MAP_SHARED,
+                              fd, header->offset);
+            if (addr == MAP_FAILED) {
+                throw exception::MatrixIOException(sname,
+                                                   shm::error_message("mmap"));
+            }
+            seg->data = addr;
+        }
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    return std::make_shared<Matrix>(seg->header->row, seg->header->col,
+                                    static_cast<double *>(seg->data), seg);
+}
+
+bool SharedMatrixStore::contains(const string &name) const
+{
+    size_t size = 0;
+    auto seg = shm::open_segment(segment_name(name), false, &size);
+    return seg != nullptr && seg->is_ready() &&
+           seg->is_alive(seg->header->refs.load(std::memory_order_acquire));
+}
+
+size_t SharedMatrixStore::ref_count(const string &name) const
+{
+    size_t size = 0;
+    auto seg = shm::open_segment(segment_name(name), false, &size);
+    if (seg == nullptr || !seg->is_ready()) {
+        return 0;
+    }
+    return seg->header->refs.load(std::memory_order_acquire);
+}
+
+bool SharedMatrixStore::remove(const string &name) const
+{
+    const string sname = segment_name(name);
+    if (shm_unlink(sname.c_str()) == 0) {
+        return true;
+    }
+    if (errno == ENOENT) {
+        return false;
+    }
+    throw exception::MatrixIOException(sname,
+                                       shm::error_message("shm_unlink"));
+}
+
+} // namespace matrix
@@ -0,0 +1,544 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/sparse_matrix.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MATRIX_SPARSE_X86
+#include <immintrin.h>
+#endif
+
+namespace matrix {
+
+namespace sparse {
+
+/**
+ * @brief Number of the columns of C updated together by the SpMM kernels,
+ * whose partial sums are kept in registers over the elements of a row of A.
+ */
+static const size_t kColumnBlock = 16;
+
+/**
+ * @brief Kernel of SpMV: the dot product of a sparse row with x.
+ */
+typedef double (*row_dot_kernel)(size_t nnz, const double *val,
+                                 const size_t *idx, const double *x);
+
+/**
+ * @brief Kernel of SpMM: update a row of C with a sparse row of A,
+ * c = alpha * sum_k val[k] * B(idx[k], :) + beta * c. B is row-wise with n
+ * columns. c is not read if beta is 0.
+ */
+typedef void (*row_update_kernel)(size_t nnz, const double *val,
+                                  const size_t *idx, const double *b,
+                                  size_t n, double alpha, double beta,
+                                  double *c);
+
+static double row_dot_generic(size_t nnz, const double *val,
+                              const size_t *idx, const double *x)
+{
+    double s0 = 0.0;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double s3 = 0.0;
+    size_t k = 0;
+    for (; k + 4 <= nnz; k += 4) {
+        s0 += val[k] * x[idx[k]];
+        s1 += val[k + 1] * x[idx[k + 1]];
+        s2 += val[k + 2] * x[idx[k + 2]];
+        s3 += val[k + 3] * x[idx[k + 3]];
+    }
+    for (; k < nnz; k++) {
+        s0 += val[k] * x[idx[k]];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * @brief Update the columns [first, n) of a row of C, see row_update_kernel.
+ */
+static void row_update_columns(size_t nnz, const double *val,
+                               const size_t *idx, const double *b, size_t n,
+                               size_t first, double alpha, double beta,
+                               double *c)
+{
+    for (size_t j = first; j < n; j += kColumnBlock) {
+        const size_t nb = std::min(kColumnBlock, n - j);
+        double acc[kColumnBlock] = {0.0};
+        for (size_t k = 0; k < nnz; k++) {
+            const double v = val[k];
+            const double *bk = b + idx[k] * n + j;
+            for (size_t t = 0; t < nb; t++) {
+                acc[t] += v * bk[t];
+            }
+        }
+        for (size_t t = 0; t < nb; t++) {
+            c[j + t] = beta == 0.0 ? alpha * acc[t]
+                                   : alpha * acc[t] + beta * c[j + t];
+        }
+    }
+}
+
+static void row_update_generic(size_t nnz, const double *val,
+                               const size_t *idx, const double *b, size_t n,
+                               double alpha, double beta, double *c)
+{
+    row_update_columns(nnz, val, idx, b, n, 0, alpha, beta, c);
+}
+
+#ifdef MATRIX_SPARSE_X86
+
+__attribute__((target("avx2,fma"))) static double
+row_dot_avx2(size_t nnz, const double *val, const size_t *idx,
+             const double *x)
+{
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    size_t k = 0;
+    for (; k + 8 <= nnz; k += 8) {
+        const __m256i i0 =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + k));
+        const __m256i i1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(idx + k + 4));
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(val + k),
+                             _mm256_i64gather_pd(x, i0, 8), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(val + k + 4),
+                             _mm256_i64gather_pd(x, i1, 8), s1);
+    }
+    if (k + 4 <= nnz) {
+        const __m256i i0 =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + k));
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(val + k),
+                             _mm256_i64gather_pd(x, i0, 8), s0);
+        k += 4;
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(s0),
+                           _mm256_extractf128_pd(s0, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    for (; k < nnz; k++) {
+        sum += val[k] * x[idx[k]];
+    }
+    return sum;
+}
+
+#define AVX2_STORE(ptr, acc)                                                   \
+    if (beta == 0.0) {                                                         \
+        _mm256_storeu_pd(ptr, _mm256_mul_pd(va, acc));                         \
+    } else {                                                                   \
+        _mm256_storeu_pd(ptr, _mm256_fmadd_pd(vb, _mm256_loadu_pd(ptr),        \
+                                              _mm256_mul_pd(va, acc)));        \
+    }
+
+__attribute__((target("avx2,fma"))) static void
+row_update_avx2(size_t nnz, const double *val, const size_t *idx,
+                const double *b, size_t n, double alpha, double beta,
+                double *c)
+{
+    const __m256d va = _mm256_set1_pd(alpha);
+    const __m256d vb = _mm256_set1_pd(beta);
+    size_t j = 0;
+    for (; j + kColumnBlock <= n; j += kColumnBlock) {
+        __m256d c0 = _mm256_setzero_pd();
+        __m256d c1 = _mm256_setzero_pd();
+        __m256d c2 = _mm256_setzero_pd();
+        __m256d c3 = _mm256_setzero_pd();
+        for (size_t k = 0; k < nnz; k++) {
+            const __m256d v = _mm256_broadcast_sd(val + k);
+            const double *bk = b + idx[k] * n + j;
+            c0 = _mm256_fmadd_pd(v, _mm256_loadu_pd(bk), c0);
+            c1 = _mm256_fmadd_pd(v, _mm256_loadu_pd(bk + 4), c1);
+            c2 = _mm256_fmadd_pd(v, _mm256_loadu_pd(bk + 8), c2);
+            c3 = _mm256_fmadd_pd(v, _mm256_loadu_pd(bk + 12), c3);
+        }
+        AVX2_STORE(c + j, c0)
+        AVX2_STORE(c + j + 4, c1)
+        AVX2_STORE(c + j + 8, c2)
+        AVX2_STORE(c + j + 12, c3)
+    }
+    for (; j + 4 <= n; j += 4) {
+        __m256d c0 = _mm256_setzero_pd();
+        for (size_t k = 0; k < nnz; k++) {
+            c0 = _mm256_fmadd_pd(_mm256_broadcast_sd(val + k),
+                                 _mm256_loadu_pd(b + idx[k] * n + j), c0);
+        }
+        AVX2_STORE(c + j, c0)
+    }
+    row_update_columns(nnz, val, idx, b, n, j, alpha, beta, c);
+}
+
+#undef AVX2_STORE
+
+#endif // MATRIX_SPARSE_X86
+
+/**
+ * @brief The kernels supported by the CPU.
+ */
+struct Kernels {
+    row_dot_kernel dot;
+    row_update_kernel update;
+};
+
+static const Kernels &kernels()
+{
+    static const Kernels k = []() {
+        Kernels rst = {row_dot_generic, row_update_generic};
+#ifdef MATRIX_SPARSE_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            rst.dot = row_dot_avx2;
+            rst.update = row_update_avx2;
+        }
+#endif
+        return rst;
+    }();
+    return k;
+}
+
+/**
+ * @brief Split the rows into ranges with about the same cost for the
+ * threads, where the cost of row i is its number of elements plus one.
+ *
+ * @return vector<size_t>: the first row of each range, followed by the
+ * number of rows.
+ */
+static vector<size_t> partition_rows(const vector<size_t> &row_ptr,
+                                     size_t nparts)
+{
+    const size_t row = row_ptr.size() - 1;
+    const double total = (double)(row_ptr[row] + row);
+    vector<size_t> bounds(nparts + 1, row);
+    bounds[0] = 0;
+    for (size_t p = 1; p < nparts; p++) {
+        // the first row whose cumulative cost reaches the target.
+        const double target = total * p / nparts;
+        size_t lo = bounds[p - 1];
+        size_t hi = row;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if ((double)(row_ptr[mid] + mid) < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        bounds[p] = lo;
+    }
+    return bounds;
+}
+
+/**
+ * @brief Get the number of the row ranges of a product, several for each
+ * thread for the load balance.
+ */
+static size_t num_parts(const vector<size_t> &row_ptr, size_t work)
+{
+#ifdef USE_OPENMP
+    // small products are not worth the threads.
+    if (work >= (1 << 15)) {
+        return std::min(row_ptr.size() - 1, (size_t)omp_get_max_threads() * 4);
+    }
+#endif
+    (void)work;
+    return std::min(row_ptr.size() - 1, (size_t)1);
+}
+
+} // namespace sparse
+
+SparseMatrix::SparseMatrix(size_t row, size_t col)
+    : row_(row), col_(col), row_ptr_(row + 1, 0)
+{
+}
+
+SparseMatrix::SparseMatrix(size_t row, size_t col, vector<size_t> row_ptr,
+                           vector<size_t> col_index, vector<double> values)
+    : row_(row), col_(col), row_ptr_(std::move(row_ptr)),
+      col_index_(std::move(col_index)), values_(std::move(values))
+{
+    const size_t nnz = values_.size();
+    if (row_ptr_.size() != row_ + 1 || row_ptr_[0] != 0 ||
+        row_ptr_[row_] != nnz || col_index_.size() != nnz) {
+        throw exception::MatrixException(
+            "Invalid CSR storage of a sparse matrix: unmatched size of the "
+            "arrays.");
+    }
+    bool valid = true;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1024) reduction(&& : valid)
+#endif
+    for (size_t i = 0; i < row_; i++) {
+        const size_t first = row_ptr_[i];
+        const size_t last = row_ptr_[i + 1];
+        if (first > last || last > nnz) {
+            valid = false;
+            continue;
+        }
+        for (size_t k = first; k < last; k++) {
+            if (col_index_[k] >= col_ ||
+                (k > first && col_index_[k] <= col_index_[k - 1])) {
+                valid = false;
+                break;
+            }
+        }
+    }
+    if (!valid) {
+        throw exception::MatrixException(
+            "Invalid CSR storage of a sparse matrix: the rows are not ordered "
+            "or the column indices are out of range or not strictly "
+            "increasing.");
+    }
+}
+
+/**
+ * @details The elements are counted row by row in parallel, and then copied
+ * to their offsets in parallel.
+ */
+SparseMatrix::SparseMatrix(const Matrix &A, double threshold)
+    : row_(A.row()), col_(A.col()), row_ptr_(A.row() + 1, 0)
+{
+    const size_t row = row_;
+    const size_t col = col_;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < row; i++) {
+        const double *a = A.data() + i * col;
+        size_t count = 0;
+        for (size_t j = 0; j < col; j++) {
+            count += !(std::fabs(a[j]) <= threshold);
+        }
+        row_ptr_[i + 1] = count;
+    }
+    for (size_t i = 0; i < row; i++) {
+        row_ptr_[i + 1] += row_ptr_[i];
+    }
+    col_index_.resize(row_ptr_[row]);
+    values_.resize(row_ptr_[row]);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < row; i++) {
+        const double *a = A.data() + i * col;
+        size_t k = row_ptr_[i];
+        for (size_t j = 0; j < col; j++) {
+            if (!(std::fabs(a[j]) <= threshold)) {
+                col_index_[k] = j;
+                values_[k] = a[j];
+                k++;
+            }
+        }
+    }
+}
+
+SparseMatrix SparseMatrix::from_triplets(size_t row, size_t col,
+                                         const vector<size_t> &rows,
+                                         const vector<size_t> &cols,
+                                         const vector<double> &values)
+{
+    const size_t n = values.size();
+    if (rows.size() != n || cols.size() != n) {
+        throw exception::MatrixException(
+            "Error in matrix::SparseMatrix::from_triplets(): unmatched size of "
+            "the indices and the values.");
+    }
+    for (size_t k = 0; k < n; k++) {
+        if (rows[k] >= row || cols[k] >= col) {
+            std::stringstream msg;
+            msg << "Error in matrix::SparseMatrix::from_triplets(): element ("
+                << rows[k] << ", " << cols[k] << ") is out of range.";
+            throw exception::MatrixException(msg.str());
+        }
+    }
+
+    // bucket the elements by rows.
+    SparseMatrix A(row, col);
+    vector<size_t> &ptr = A.row_ptr_;
+    for (size_t k = 0; k < n; k++) {
+        ptr[rows[k] + 1]++;
+    }
+    for (size_t i = 0; i < row; i++) {
+        ptr[i + 1] += ptr[i];
+    }
+    vector<std::pair<size_t, double>> elements(n);
+    vector<size_t> next(ptr.begin(), ptr.end() - 1);
+    for (size_t k = 0; k < n; k++) {
+        elements[next[rows[k]]++] = std::make_pair(cols[k], values[k]);
+    }
+
+    // sort each row by the columns and sum up the duplicated elements.
+    A.col_index_.reserve(n);
+    A.values_.reserve(n);
+    size_t first = 0;
+    for (size_t i = 0; i < row; i++) {
+        const size_t last = ptr[i + 1];
+        std::sort(elements.begin() + first, elements.begin() + last,
+                  [](const std::pair<size_t, double> &a,
+                     const std::pair<size_t, double> &b) {
+                      return a.first < b.first;
+                  });
+        const size_t begin = A.values_.size();
+        for (size_t k = first; k < last; k++) {
+            if (A.values_.size() > begin &&
+                A.col_index_.back() == elements[k].first) {
+                A.values_.back() += elements[k].second;
+            } else {
+                A.col_index_.push_back(elements[k].first);
+                A.values_.push_back(elements[k].second);
+            }
+        }
+        first = last;
+        ptr[i + 1] = A.values_.size();
+    }
+    return A;
+}
+
+Matrix SparseMatrix::to_matrix() const
+{
+    Matrix A(row_, col_);
+    A.fill_all(0.0);
+    const size_t row = row_;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 256)
+#endif
+    for (size_t i = 0; i < row; i++) {
+        double *a = A.data() + i * col_;
+        for (size_t k = row_ptr_[i]; k < row_ptr_[i + 1]; k++) {
+            a[col_index_[k]] = values_[k];
+        }
+    }
+    return A;
+}
+
+/**
+ * @details The elements are counted by columns and scattered to the rows of
+ * the transpose. The rows of the matrix are visited in order, so that the
+ * column indices of the transpose are ordered.
+ */
+SparseMatrix SparseMatrix::transpose() const
+{
+    SparseMatrix T(col_, row_);
+    vector<size_t> &ptr = T.row_ptr_;
+    for (size_t k = 0; k < nnz(); k++) {
+        ptr[col_index_[k] + 1]++;
+    }
+    for (size_t j = 0; j < col_; j++) {
+        ptr[j + 1] += ptr[j];
+    }
+    T.col_index_.resize(nnz());
+    T.values_.resize(nnz());
+    vector<size_t> next(ptr.begin(), ptr.end() - 1);
+    for (size_t i = 0; i < row_; i++) {
+        for (size_t k = row_ptr_[i]; k < row_ptr_[i + 1]; k++) {
+            const size_t pos = next[col_index_[k]]++;
+            T.col_index_[pos] = i;
+            T.values_[pos] = values_[k];
+        }
+    }
+    return T;
+}
+
+double SparseMatrix::operator()(size_t i, size_t j) const
+{
+    auto first = col_index_.begin() + row_ptr_[i];
+    auto last = col_index_.begin() + row_ptr_[i + 1];
+    auto p = std::lower_bound(first, last, j);
+    return p != last && *p == j ? values_[p - col_index_.begin()] : 0.0;
+}
+
+/**
+ * @details The rows are split into ranges with about the same number of
+ * elements, which are scheduled dynamically over the threads.
+ */
+int mult_spmv(const double alpha, const SparseMatrix &A,
+              const vector<double> &x, const double beta, vector<double> &y)
+{
+    if (&x == &y) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_spmv(): output vector cannot be the input "
+            "vector.");
+    } else if (x.size() != A.col()) {
+        throw exception::DimensionError(
+            A.col(), x.size(),
+            "Error in matrix::mult_spmv(): dimension error between matrix A "
+            "and vector x.");
+    } else if (y.size() != A.row()) {
+        throw exception::DimensionError(
+            A.row(), y.size(),
+            "Error in matrix::mult_spmv(): dimension error between matrix A "
+            "and vector y.");
+    }
+
+    const sparse::row_dot_kernel dot = sparse::kernels().dot;
+    const vector<size_t> &ptr = A.row_ptr();
+    const size_t *idx = A.col_index().data();
+    const double *val = A.values().data();
+    const vector<size_t> bounds = sparse::partition_rows(
+        ptr, sparse::num_parts(ptr, A.nnz() + A.row()));
+    const size_t nparts = bounds.size() - 1;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t p = 0; p < nparts; p++) {
+        for (size_t i = bounds[p]; i < bounds[p + 1]; i++) {
+            const double s =
+                dot(ptr[i + 1] - ptr[i], val + ptr[i], idx + ptr[i], x.data());
+            y[i] = beta == 0.0 ? alpha * s : alpha * s + beta * y[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @details Each row of C is updated by the rows of B selected by the
+ * elements of the same row of A, with the partial sums of a block of columns
+ * kept in registers. The rows are split over the threads as mult_spmv().
+ */
+int mult_spmm(const double alpha, const SparseMatrix &A, const Matrix &B,
+              const double beta, Matrix &C)
+{
+    if (&B == &C) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_spmm(): output matrix cannot be the input "
+            "matrix.");
+    } else if (B.row() != A.col()) {
+        throw exception::DimensionError(
+            A.col(), B.row(),
+            "Error in matrix::mult_spmm(): dimension error between matrix A "
+            "and B.");
+    } else if (C.row() != A.row() || C.col() != B.col()) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_spmm(): dimension error between matrix "
+            "A * B and C.");
+    }
+    if (C.size() == 0) {
+        return 0;
+    }
+
+    const sparse::row_update_kernel update = sparse::kernels().update;
+    const vector<size_t> &ptr = A.row_ptr();
+    const size_t *idx = A.col_index().data();
+    const double *val = A.values().data();
+    const size_t n = B.col();
+    const vector<size_t> bounds = sparse::partition_rows(
+        ptr, sparse::num_parts(ptr, (A.nnz() + A.row()) * n));
+    const size_t nparts = bounds.size() - 1;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (size_t p = 0; p < nparts; p++) {
+        for (size_t i = bounds[p]; i < bounds[p + 1]; i++) {
+            update(ptr[i + 1] - ptr[i], val + ptr[i], idx + ptr[i], B.data(),
+                   n, alpha, beta, C.data() + i * n);
+        }
+    }
+    return 0;
+}
+
+} // namespace matrix
@@ -0,0 +1,256 @@
+#include <matrix/details/blas.h>
+#include <matrix/details/exception.h>
+#include <matrix/details/matrix.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "blas_base.h"
+#include "gemm.h"
+
+namespace matrix {
+
+namespace strassen {
+
+/**
+ * @brief A column-wise matrix op(X) seen by blas, where op(X) = X or X^T.
+ */
+struct Operand {
+    const double *data;
+    blas_int ld;
+    bool trans;
+
+    /**
+     * @brief Get the element (i, j) of op(X).
+     */
+    double operator()(blas_int i, blas_int j) const
+    {
+        return trans ? data[j + (size_t)i * ld] : data[i + (size_t)j * ld];
+    }
+
+    /**
+     * @brief Get the sub-matrix of op(X) starting at (i, j).
+     */
+    Operand block(blas_int i, blas_int j) const
+    {
+        return {trans ? data + j + (size_t)i * ld : data + i + (size_t)j * ld,
+                ld, trans};
+    }
+};
+
+/**
+ * @brief z = x + sign * y, where x, y and z are [m, n] matrices. z can be
+ * the same matrix as x or y.
+ */
+static void add(blas_int m, blas_int n, const Operand &x, double sign,
+                const Operand &y, double *z, blas_int ldz)
+{
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (blas_int j = 0; j < n; j++) {
+        double *zj = z + (size_t)j * ldz;
+        for (blas_int i = 0; i < m; i++) {
+            zj[i] = x(i, j) + sign * y(i, j);
+        }
+    }
+}
+
+/**
+ * @brief c = a * b + beta * c by the dgemm engine, where a is [m, k] and b
+ * is [k, n].
+ */
+static void dgemm(blas_int m, blas_int n, blas_int k, const Operand &a,
+                  const Operand &b, double beta, double *c, blas_int ldc)
+{
+    gemm::dgemm(a.trans ? "T" : "N", b.trans ? "T" : "N", &m, &n, &k,
+                blas::done, a.data, &a.ld, b.data, &b.ld, &beta, c, &ldc);
+}
+
+/**
+ * @brief Size of the scratch memory used by one level of recursion, which
+ * splits a [m, k] x [k, n] product.
+ */
+static size_t level_scratch(blas_int m, blas_int n, blas_int k)
+{
+    const size_t m2 = m / 2;
+    const size_t n2 = n / 2;
+    const size_t k2 = k / 2;
+    return m2 * std::max(k2, n2) + k2 * n2;
+}
+
+/**
+ * @brief c = a * b by the Strassen-Winograd algorithm with `levels` levels
+ * of recursion, where a is [m, k] and b is [k, n].
+ *
+ * @details The schedule of Douglas et al. (J. Comput. Phys. 110, 1, 1994)
+ * is used, which stores the intermediate products in the quadrants of c and
+ * needs two temporary matrices X: [m/2, max(k/2, n/2)] and Y: [k/2, n/2] for
+ * each level. The last row and column are peeled off for odd dimensions.
+ *
+ * @param [in] work: scratch memory of all the levels.
+ */
+static void multiply(int levels, blas_int m, blas_int n, blas_int k,
+                     const Operand &a, const Operand &b, double *c,
+                     blas_int ldc, double *work)
+{
+    if (levels == 0) {
+        dgemm(m, n, k, a, b, 0.0, c, ldc);
+        return;
+    }
+
+    const blas_int m2 = m / 2;
+    const blas_int n2 = n / 2;
+    const blas_int k2 = k / 2;
+    double *x = work;
+    double *y = x + (size_t)m2 * std::max(k2, n2);
+    double *next = y + (size_t)k2 * n2;
+    const Operand X = {x, m2, false};
+    const Operand Y = {y, k2, false};
+
+    const Operand A11 = a.block(0, 0);
+    const Operand A12 = a.block(0, k2);
+    const Operand A21 = a.block(m2, 0);
+    const Operand A22 = a.block(m2, k2);
+    const Operand B11 = b.block(0, 0);
+    const Operand B12 = b.block(0, n2);
+    const Operand B21 = b.block(k2, 0);
+    const Operand B22 = b.block(k2, n2);
+    double *c11 = c;
+    double *c12 = c + (size_t)n2 * ldc;
+    double *c21 = c + m2;
+    double *c22 = c + m2 + (size_t)n2 * ldc;
+    const Operand C11 = {c11, ldc, false};
+    const Operand C12 = {c12, ldc, false};
+    const Operand C21 = {c21, ldc, false};
+    const Operand C22 = {c22, ldc, false};
+
+    // P7 = (A11 - A21) * (B22 - B12) in C21.
+    add(m2, k2, A11, -1.0, A21, x, m2);
+    add(k2, n2, B22, -1.0, B12, y, k2);
+    multiply(levels - 1, m2, n2, k2, X, Y, c21, ldc, next);
+    // P5 = (A21 + A22) * (B12 - B11) in C22.
+    add(m2, k2, A21, 1.0, A22, x, m2);
+    add(k2, n2, B12, -1.0, B11, y, k2);
+    multiply(levels - 1, m2, n2, k2, X, Y, c22, ldc, next);
+    // P6 = (A21 + A22 - A11) * (B22 - B12 + B11) in C12.
+    add(m2, k2, X, -1.0, A11, x, m2);
+    add(k2, n2, B22, -1.0, Y, y, k2);
+    multiply(levels - 1, m2, n2, k2, X, Y, c12, ldc, next);
+    // P3 = (A12 - A21 - A22 + A11) * B22 in C11.
+    add(m2, k2, A12, -1.0, X, x, m2);
+    multiply(levels - 1, m2, n2, k2, X, B22, c11, ldc, next);
+    // P1 = A11 * B11 in X.
+    const Operand P1 = {x, m2, false};
+    multiply(levels - 1, m2, n2, k2, A11, B11, x, m2, next);
+    // U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5, U7 = U3 + P5 = C22 and
+    // U5 = U4 + P3 = C12.
+    add(m2, n2, P1, 1.0, C12, c12, ldc);
+    add(m2, n2, C12, 1.0, C21, c21, ldc);
+    add(m2, n2, C12, 1.0, C22, c12, ldc);
+    add(m2, n2, C21, 1.0, C22, c22, ldc);
+    add(m2, n2, C12, 1.0, C11, c12, ldc);
+    // P4 = A22 * (B22 - B12 + B11 - B21) in C11, and U6 = U3 - P4 = C21.
+    add(k2, n2, Y, -1.0, B21, y, k2);
+    multiply(levels - 1, m2, n2, k2, A22, Y, c11, ldc, next);
+    add(m2, n2, C21, -1.0, C11, c21, ldc);
+    // P2 = A12 * B21 in C11, and U1 = P1 + P2 = C11.
+    multiply(levels - 1, m2, n2, k2, A12, B21, c11, ldc, next);
+    add(m2, n2, P1, 1.0, C11, c11, ldc);
+
+    // peel off the last row and column for odd dimensions.
+    if (k % 2 != 0) {
+        dgemm(2 * m2, 2 * n2, 1, a.block(0, k - 1), b.block(k - 1, 0), 1.0, c,
+              ldc);
+    }
+    if (n % 2 != 0) {
+        dgemm(m, 1, k, a, b.block(0, n - 1), 0.0, c + (size_t)(n - 1) * ldc,
+              ldc);
+    }
+    if (m % 2 != 0) {
+        dgemm(1, 2 * n2, k, a.block(m - 1, 0), b, 0.0, c + m - 1, ldc);
+    }
+}
+
+} // namespace strassen
+
+/**
+ * @note The row-wise matrices are seen by blas as the transposed matrices,
+ * so C^T = alpha * op(B)^T * op(A)^T + beta * C^T is calculated.
+ */
+int mult_dgemm_fast(const double alpha, const Matrix &A, const string &op_A,
+                    const Matrix &B, const string &op_B, const double beta,
+                    Matrix &C, size_t cutoff, size_t max_scratch)
+{
+    if (&C == &A || &C == &B) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dgemm_fast(): output matrix cannot be one "
+            "of the input matrix.");
+    } else if ((op_A != "N" && op_A != "T") || (op_B != "N" && op_B != "T")) {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dgemm_fast(): unknown operation on matrix. "
+            "op_A=" +
+            op_A + ", op_B=" + op_B);
+    }
+    const bool trans_A = (op_A == "T");
+    const bool trans_B = (op_B == "T");
+    const size_t inner = trans_A ? A.row() : A.col();
+    if (inner != (trans_B ? B.col() : B.row())) {
+        throw exception::DimensionError(
+            A, B,
+            "Error in matrix::mult_dgemm_fast(): dimension error between "
+            "matrix op(A) and op(B).");
+    } else if (C.row() != (trans_A ? A.col() : A.row()) ||
+               C.col() != (trans_B ? B.row() : B.col())) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dgemm_fast(): dimension error between "
+            "matrix op(A) op(B) and C.");
+    }
+
+    blas_int m = to_blas_int(C.col());
+    blas_int n = to_blas_int(C.row());
+    blas_int k = to_blas_int(inner);
+
+    // find the number of levels of recursion within the scratch memory.
+    const size_t min_dim = std::max<size_t>(cutoff, 2);
+    size_t scratch = (beta == 0.0 ? 0 : C.size());
+    int levels = 0;
+    for (blas_int mi = m, ni = n, ki = k;
+         (size_t)std::min(std::min(mi, ni), ki) >= min_dim;
+         mi /= 2, ni /= 2, ki /= 2) {
+        const size_t need = scratch + strassen::level_scratch(mi, ni, ki);
+        if (max_scratch != 0 && need * sizeof(double) > max_scratch) {
+            break;
+        }
+        scratch = need;
+        levels++;
+    }
+    if (levels == 0 || alpha == 0.0) {
+        return mult_dgemm(alpha, A, op_A, B, op_B, beta, C);
+    }
+
+    const strassen::Operand a = {B.data(), to_blas_int(B.col()), trans_B};
+    const strassen::Operand b = {A.data(), to_blas_int(A.col()), trans_A};
+    vector<double> work(scratch);
+    if (beta == 0.0) {
+        strassen::multiply(levels, m, n, k, a, b, C.data(), m, work.data());
+        if (alpha != 1.0) {
+            blas::dscal_chunked(C.size(), alpha, C.data());
+        }
+        return 0;
+    }
+
+    // C = alpha * AB + beta * C with AB calculated in the scratch memory.
+    double *ab = work.data();
+    strassen::multiply(levels, m, n, k, a, b, ab, m, ab + C.size());
+    double *c = C.data();
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < C.size(); i++) {
+        c[i] = alpha * ab[i] + beta * c[i];
+    }
+    return 0;
+}
+
+} // namespace matrix
@@ -0,0 +1,308 @@
+#include <matrix/details/exception.h>
+#include <matrix/details/symmetric_matrix.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "lapack_base.h"
+#include "lapack_utils.h"
+#include "workspace.h"
+
+namespace matrix {
+
+/**
+ * @brief Throw an exception if a lapack routine reports an illegal argument.
+ */
+static void check_argument(blas_int info, const char *func_name)
+{
+    if (info < 0) {
+        std::stringstream msg;
+        msg << "The " << -info << "-th arguments had an illegal value.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+/**
+ * @brief Check the exit status of the Cholesky factorization by `dpftrf` or
+ * `dpptrf`.
+ */
+static void check_cholesky(blas_int info, const char *func_name)
+{
+    check_argument(info, func_name);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "The leading minor of order " << info
+            << " is not positive definite, and the factorization could not "
+               "be completed.";
+        throw exception::MatrixOperationError(func_name, msg.str());
+    }
+}
+
+/**
+ * @brief Cholesky factorization of an spd matrix in place.
+ */
+static void factorize_cholesky(SymmetricMatrix &A, const char *func_name)
+{
+    blas_int n = to_blas_int(A.dim());
+    blas_int info = 0;
+    if (A.storage() == SymmetricMatrix::kRFP) {
+        lapack::dpftrf_("N", A.uplo().c_str(), &n, A.data(), &info);
+    } else {
+        lapack::dpptrf_(A.uplo().c_str(), &n, A.data(), &info);
+    }
+    check_cholesky(info, func_name);
+}
+
+SymmetricMatrix::SymmetricMatrix(size_t n, Storage storage)
+    : n_(n), storage_(storage), uplo_("L"), data_(n * (n + 1) / 2)
+{
+}
+
+/**
+ * @details The row-wise triangle of \p A is the opposite triangle seen by
+ * lapack, which is converted by `dtrttf` or `dtrttp` without transposing.
+ */
+SymmetricMatrix::SymmetricMatrix(const Matrix &A, Storage storage,
+                                 const string &uplo)
+    : n_(A.row()), storage_(storage), uplo_(lapack_uplo(uplo)),
+      data_(n_ * (n_ + 1) / 2)
+{
+    if (!A.is_square()) {
+        throw exception::DimensionError(
+            "Cannot convert a non-square matrix to a symmetric matrix.");
+    }
+    if (n_ == 0) {
+        return;
+    }
+    blas_int n = to_blas_int(n_);
+    blas_int info = 0;
+    if (storage_ == kRFP) {
+        lapack::dtrttf_("N", uplo_.c_str(), &n, A.data(), &n, data_.data(),
+                        &info);
+    } else {
+        lapack::dtrttp_(uplo_.c_str(), &n, A.data(), &n, data_.data(), &info);
+    }
+    check_argument(info, __FUNCTION__);
+}
+
+Matrix SymmetricMatrix::to_matrix() const
+{
+    Matrix A(n_, n_);
+    if (n_ == 0) {
+        return A;
+    }
+    blas_int n = to_blas_int(n_);
+    blas_int info = 0;
+    if (storage_ == kRFP) {
+        lapack::dtfttr_("N", uplo_.c_str(), &n, data_.data(), A.data(), &n,
+                        &info);
+    } else {
+        lapack::dtpttr_(uplo_.c_str(), &n, data_.data(), A.data(), &n, &info);
+    }
+    check_argument(info, __FUNCTION__);
+    // the lapack label of the filled triangle is flipped for the row-wise
+    // matrix.
+    A.to_symmetric(lapack_uplo(uplo_));
+    return A;
+}
+
+SymmetricMatrix SymmetricMatrix::to_storage(Storage storage) const
+{
+    if (storage == storage_) {
+        return *this;
+    }
+    SymmetricMatrix B(n_, storage);
+    B.uplo_ = uplo_;
+    if (n_ == 0) {
+        return B;
+    }
+    blas_int n = to_blas_int(n_);
+    blas_int info = 0;
+    if (storage == kRFP) {
+        lapack::dtpttf_("N", uplo_.c_str(), &n, data_.data(), B.data(),
+                        &info);
+    } else {
+        lapack::dtfttp_("N", uplo_.c_str(), &n, data_.data(), B.data(),
+                        &info);
+    }
+    check_argument(info, __FUNCTION__);
+    return B;
+}
+
+void SymmetricMatrix::fill_all(double val)
+{
+    std::fill(data_.begin(), data_.end(), val);
+}
+
+/**
+ * @details The column-wise element (i, j) of the stored triangle, i.e.
+ * i >= j for "L" and i <= j for "U", is located by the layouts documented in
+ * lapack `dtrttf` and `dtrttp`. With k = n / 2, the RFP storage of an even n
+ * is a [n + 1, k] column-wise matrix, and of an odd n is [n, n - k].
+ */
+size_t SymmetricMatrix::index(size_t i, size_t j) const
+{
+    const bool lower = uplo_ == "L";
+    if (lower ? i < j : i > j) {
+        std::swap(i, j);
+    }
+    if (storage_ == kPacked) {
+        return lower ? i + (2 * n_ - j - 1) * j / 2 : i + j * (j + 1) / 2;
+    }
+    const size_t k = n_ / 2;
+    if (n_ % 2 == 0) {
+        const size_t ld = n_ + 1;
+        if (lower) {
+            return j < k ? i + 1 + j * ld : j - k + (i - k) * ld;
+        }
+        return j >= k ? i + (j - k) * ld : j + k + 1 + i * ld;
+    }
+    const size_t m = n_ - k;
+    if (lower) {
+        return j < m ? i + j * n_ : j - m + (i - m + 1) * n_;
+    }
+    return j >= k ? i + (j - k) * n_ : j + k + 1 + i * n_;
+}
+
+int invert_spd_matrix_dpftri(SymmetricMatrix &A)
+{
+    if (A.dim() == 0) {
+        return 0;
+    }
+    factorize_cholesky(A, __FUNCTION__);
+    blas_int n = to_blas_int(A.dim());
+    blas_int info = 0;
+    if (A.storage() == SymmetricMatrix::kRFP) {
+        lapack::dpftri_("N", A.uplo().c_str(), &n, A.data(), &info);
+    } else {
+        lapack::dpptri_(A.uplo().c_str(), &n, A.data(), &info);
+    }
+    check_argument(info, __FUNCTION__);
+    if (info > 0) {
+        std::stringstream msg;
+        msg << "The (" << info << "," << info
+            << ") element of the factor is zero,"
+            << " and the inverse cannot be computed.";
+        throw exception::MatrixOperationError(__FUNCTION__, msg.str());
+    }
+    return 0;
+}
+
+int solve_spd_matrix_dpftrs(SymmetricMatrix &A, Matrix &B)
+{
+    if (A.dim() != B.row()) {
+        throw exception::DimensionError(
+            A.dim(), B.row(),
+            "Error in matrix::solve_spd_matrix_dpftrs(): dimension error "
+            "between matrix A and B.");
+    }
+    if (B.size() == 0) {
+        return 0;
+    }
+    factorize_cholesky(A, __FUNCTION__);
+
+    blas_int n = to_blas_int(A.dim());
+    blas_int nrhs = to_blas_int(B.col());
+    blas_int info = 0;
+    vector<double> rhs;
+    double *b = column_wise_rhs(B, rhs);
+    if (A.storage() == SymmetricMatrix::kRFP) {
+        lapack::dpftrs_("N", A.uplo().c_str(), &n, &nrhs, A.data(), b, &n,
+                        &info);
+    } else {
+        lapack::dpptrs_(A.uplo().c_str(), &n, &nrhs, A.data(), b, &n, &info);
+    }
+    check_argument(info, __FUNCTION__);
+    restore_row_wise_rhs(rhs, B);
+    return 0;
+}
+
+/**
+ * @note Matrix A is seen by lapack as A^T, so op(A) * op(A)^T is calculated
+ * with the opposite transpose label.
+ */
+int mult_dsfrk(const double alpha, const Matrix &A, const string &op_A,
+               const double beta, SymmetricMatrix &C)
+{
+    string trans;
+    if (op_A == "N") {
+        trans = "T";
+    } else if (op_A == "T") {
+        trans = "N";
+    } else {
+        throw exception::MatrixException(
+            "Error in matrix::mult_dsfrk(): unknown operation on matrix A: " +
+            op_A);
+    }
+    // op(A): N x K
+    blas_int N = to_blas_int(op_A == "N" ? A.row() : A.col());
+    blas_int K = to_blas_int(op_A == "N" ? A.col() : A.row());
+    if ((size_t)N != C.dim()) {
+        throw exception::DimensionError(
+            "Error in matrix::mult_dsfrk(): dimension error between matrix "
+            "op(A) op(A)^T and C.");
+    }
+    if (N == 0) {
+        return 0;
+    }
+    blas_int lda = A.col() > 0 ? to_blas_int(A.col()) : 1;
+    if (C.storage() == SymmetricMatrix::kRFP) {
+        lapack::dsfrk_("N", C.uplo().c_str(), trans.c_str(), &N, &K, &alpha,
+                       A.data(), &lda, &beta, C.data());
+    } else {
+        SymmetricMatrix rfp = C.to_storage(SymmetricMatrix::kRFP);
+        lapack::dsfrk_("N", rfp.uplo().c_str(), trans.c_str(), &N, &K, &alpha,
+                       A.data(), &lda, &beta, rfp.data());
+        C = rfp.to_storage(SymmetricMatrix::kPacked);
+    }
+    return 0;
+}
+
+/**
+ * @note The eigenvectors are the columns of the column-wise matrix Z from
+ * lapack, which are the rows of the row-wise matrix Q.
+ */
+int diagonalize_sym_matrix_dspevd(const SymmetricMatrix &A,
+                                  vector<double> &eig, Matrix &Q)
+{
+    if (A.dim() > eig.size()) {
+        string msg{"Fail to diagonalize a symmetric matrix: eigenvector size "
+                   "is too small."};
+        throw exception::DimensionError(A.dim(), eig.size(), msg);
+    }
+    if (Q.row() != A.dim() || Q.col() != A.dim()) {
+        Q.resize(A.dim(), A.dim());
+    }
+    if (A.dim() == 0) {
+        return 0;
+    }
+
+    // dspevd overwrites the packed matrix.
+    SymmetricMatrix AP = A.to_storage(SymmetricMatrix::kPacked);
+    blas_int n = to_blas_int(A.dim());
+    blas_int info = 0;
+    blas_int liwork = 3 + 5 * n;
+    auto &ws = workspace::LapackWorkspace::local();
+    blas_int lwork = ws.optimal_lwork(
+        workspace::kDspevd, n, [&](double *wkopt, blas_int *lwork) {
+            blas_int iwkopt = 0;
+            blas_int liwkopt = -1;
+            lapack::dspevd_("V", AP.uplo().c_str(), &n, AP.data(), eig.data(),
+                            Q.data(), &n, wkopt, lwork, &iwkopt, &liwkopt,
+                            &info);
+        });
+    double *work = ws.work(lwork);
+    blas_int *iwork = ws.iwork(liwork);
+    lapack::dspevd_("V", AP.uplo().c_str(), &n, AP.data(), eig.data(),
+                    Q.data(), &n, work, &lwork, iwork, &liwork, &info);
+
+    if (info > 0) {
+        throw exception::MatrixOperationError(__FUNCTION__,
+                                              "convergence failure");
+    }
+    check_argument(info, __FUNCTION__);
+    return 0;
+}
+
+} // namespace matrix
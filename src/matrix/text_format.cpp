@@ -0,0 +1,316 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "ryu_table.h"
+#include "text_format.h"
+
+namespace matrix {
+
+namespace text {
+
+static const int kMantissaBits = 52;
+static const int kExponentBits = 11;
+static const int kExponentBias = 1023;
+
+/**
+ * @brief Get ceil(log2(5^e)), or 1 if e is 0. Valid for 0 <= e <= 3528.
+ */
+static int32_t pow5bits(int32_t e)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) +
+           1;
+}
+
+/**
+ * @brief Get floor(log10(2^e)). Valid for 0 <= e <= 1650.
+ */
+static uint32_t log10_pow2(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+/**
+ * @brief Get floor(log10(5^e)). Valid for 0 <= e <= 2620.
+ */
+static uint32_t log10_pow5(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+static uint32_t pow5_factor(uint64_t value)
+{
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+static bool multiple_of_pow5(uint64_t value, uint32_t p)
+{
+    return pow5_factor(value) >= p;
+}
+
+static bool multiple_of_pow2(uint64_t value, uint32_t p)
+{
+    return (value & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+#ifdef __SIZEOF_INT128__
+/**
+ * @brief Get (m * mul) >> j, where mul is a 125-bit number stored as the low
+ * and the high 64 bits, and j >= 64.
+ */
+static uint64_t mul_shift(uint64_t m, const uint64_t *mul, int32_t j)
+{
+    typedef unsigned __int128 uint128_t;
+    const uint128_t b0 = static_cast<uint128_t>(m) * mul[0];
+    const uint128_t b2 = static_cast<uint128_t>(m) * mul[1];
+    return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+}
+#else
+static uint64_t umul128(uint64_t a, uint64_t b, uint64_t &high)
+{
+    const uint64_t a_lo = static_cast<uint32_t>(a);
+    const uint64_t a_hi = a >> 32;
+    const uint64_t b_lo = static_cast<uint32_t>(b);
+    const uint64_t b_hi = b >> 32;
+    const uint64_t b00 = a_lo * b_lo;
+    const uint64_t b01 = a_lo * b_hi;
+    const uint64_t b10 = a_hi * b_lo;
+    const uint64_t b11 = a_hi * b_hi;
+    const uint64_t mid1 = b10 + (b00 >> 32);
+    const uint64_t mid2 = b01 + static_cast<uint32_t>(mid1);
+    high = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | static_cast<uint32_t>(b00);
+}
+
+static uint64_t mul_shift(uint64_t m, const uint64_t *mul, int32_t j)
+{
+    uint64_t high1;
+    const uint64_t low1 = umul128(m, mul[1], high1);
+    uint64_t high0;
+    umul128(m, mul[0], high0);
+    const uint64_t sum = high0 + low1;
+    if (sum < high0) {
+        high1++;
+    }
+    const int32_t shift = j - 64;
+    return shift == 0 ? sum : (high1 << (64 - shift)) | (sum >> shift);
+}
+#endif
+
+/**
+ * @brief Get the shortest decimal representation output * 10^exponent of a
+ * positive finite double by the Ryu algorithm.
+ * See U. Adams, Ryu: fast float-to-string conversion, PLDI 2018.
+ */
+static void shortest_decimal(uint64_t ieee_mantissa, uint32_t ieee_exponent,
+                             uint64_t &output, int32_t &exponent)
+{
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - kExponentBias - kMantissaBits - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = static_cast<int32_t>(ieee_exponent) - kExponentBias -
+             kMantissaBits - 2;
+        m2 = (uint64_t(1) << kMantissaBits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // the interval of the decimals rounding to the double, scaled by 4.
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    if (e2 >= 0) {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = kPow5InvBitCount + pow5bits(q) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mul_shift(4 * m2, kPow5InvSplit[q], i);
+        vp = mul_shift(4 * m2 + 2, kPow5InvSplit[q], i);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, kPow5InvSplit[q], i);
+        if (q <= 21) {
+            // only one of mp, mv and mm can be a multiple of 5.
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - kPow5BitCount;
+        const int32_t j = static_cast<int32_t>(q) - k;
+        vr = mul_shift(4 * m2, kPow5Split[i], j);
+        vp = mul_shift(4 * m2 + 2, kPow5Split[i], j);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, kPow5Split[i], j);
+        if (q <= 1) {
+            // mv has at least q trailing zero bits, since it is a multiple
+            // of 4.
+            vr_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // remove the digits shared by the interval bounds.
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            // round half to even.
+            last_removed_digit = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    } else {
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    exponent = e10 + removed;
+}
+
+/**
+ * @brief Write the decimal digits of a number, and return the number of
+ * digits.
+ */
+static int write_digits(uint64_t n, char *out)
+{
+    char buffer[20];
+    int size = 0;
+    do {
+        buffer[size++] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n != 0);
+    for (int i = 0; i < size; i++) {
+        out[i] = buffer[size - 1 - i];
+    }
+    return size;
+}
+
+size_t format_shortest(double x, char *out)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const bool negative = (bits >> 63) != 0;
+    const uint64_t ieee_mantissa = bits & ((uint64_t(1) << kMantissaBits) - 1);
+    const uint32_t ieee_exponent = static_cast<uint32_t>(
+        (bits >> kMantissaBits) & ((1u << kExponentBits) - 1));
+
+    char *p = out;
+    if (negative) {
+        *p++ = '-';
+    }
+    if (ieee_exponent == (1u << kExponentBits) - 1) {
+        const char *s = ieee_mantissa == 0 ? "inf" : "nan";
+        std::memcpy(p, s, 3);
+        return p + 3 - out;
+    } else if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        *p++ = '0';
+        return p - out;
+    }
+
+    uint64_t output;
+    int32_t exponent;
+    shortest_decimal(ieee_mantissa, ieee_exponent, output, exponent);
+    char digits[20];
+    const int size = write_digits(output, digits);
+    // the decimal exponent of the leading digit.
+    const int32_t leading = exponent + size - 1;
+
+    if (leading >= -5 && leading < 17) {
+        if (exponent >= 0) {
+            // an integer.
+            std::memcpy(p, digits, size);
+            p += size;
+            std::memset(p, '0', exponent);
+            p += exponent;
+        } else if (leading >= 0) {
+            std::memcpy(p, digits, leading + 1);
+            p += leading + 1;
+            *p++ = '.';
+            std::memcpy(p, digits + leading + 1, size - leading - 1);
+            p += size - leading - 1;
+        } else {
+            *p++ = '0';
+            *p++ = '.';
+            std::memset(p, '0', -leading - 1);
+            p += -leading - 1;
+            std::memcpy(p, digits, size);
+            p += size;
+        }
+        return p - out;
+    }
+
+    *p++ = digits[0];
+    if (size > 1) {
+        *p++ = '.';
+        std::memcpy(p, digits + 1, size - 1);
+        p += size - 1;
+    }
+    *p++ = 'e';
+    if (leading < 0) {
+        *p++ = '-';
+    }
+    p += write_digits(leading < 0 ? -leading : leading, p);
+    return p - out;
+}
+
+size_t format_scientific(double x, char *out)
+{
+    return std::snprintf(out, kMaxFormatSize, "%.16e", x);
+}
+
+} // namespace text
+} // namespace matrix
@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief number formatting of the matrix txt files.
+ */
+#ifndef _MATRIX_SRC_TEXT_FORMAT_H_
+#define _MATRIX_SRC_TEXT_FORMAT_H_
+
+#include <cstddef>
+
+namespace matrix {
+
+namespace text {
+
+/**
+ * @brief Maximum number of characters written by the formatting functions.
+ */
+static const size_t kMaxFormatSize = 32;
+
+/**
+ * @brief Format a double number by the shortest decimal representation that
+ * is read back exactly.
+ *
+ * @details The digits are generated by the Ryu algorithm: among the shortest
+ * decimal numbers that round to \p x, the closest one to \p x is chosen. The
+ * number is formatted in fixed-point notation if its decimal exponent is in
+ * [-5, 17), otherwise in scientific notation without the plus sign and
+ * leading zeros of the exponent, e.g. `0.1`, `-25`, `1.5e-7` and `1e300`.
+ * Infinities and NaN are formatted as `inf`, `-inf`, `nan` and `-nan`.
+ *
+ * @param [in] x: the number.
+ * @param [out] out: the output buffer of at least kMaxFormatSize characters.
+ * The string is not null-terminated.
+ * @return size_t: number of characters written.
+ */
+size_t format_shortest(double x, char *out);
+
+/**
+ * @brief Format a double number as `printf("%.16e", x)`.
+ * @see format_shortest()
+ */
+size_t format_scientific(double x, char *out);
+
+} // namespace text
+} // namespace matrix
+
+#endif // _MATRIX_SRC_TEXT_FORMAT_H_
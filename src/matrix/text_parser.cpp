@@ -0,0 +1,230 @@
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "pow5_table.h"
+#include "text_parser.h"
+
+namespace matrix {
+
+namespace text {
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Convert by `strtod` the longest prefix of a range that can be a
+ * number.
+ */
+static const char *parse_double_fallback(const char *first, const char *last,
+                                         double &x)
+{
+    const char *p = first;
+    while (p != last && (std::isalnum(static_cast<unsigned char>(*p)) ||
+                         *p == '.' || *p == '+' || *p == '-')) {
+        p++;
+    }
+    if (p == first) {
+        return nullptr;
+    }
+    // `strtod` needs a null-terminated string.
+    char buffer[64];
+    std::string long_token;
+    const size_t size = p - first;
+    char *token = buffer;
+    if (size < sizeof(buffer)) {
+        std::memcpy(buffer, first, size);
+        buffer[size] = '\0';
+    } else {
+        long_token.assign(first, size);
+        token = &long_token[0];
+    }
+    char *end = nullptr;
+    x = std::strtod(token, &end);
+    if (end == token) {
+        return nullptr;
+    }
+    return first + (end - token);
+}
+
+#ifdef __SIZEOF_INT128__
+/**
+ * @brief The Eisel-Lemire algorithm: convert w * 10^q to the nearest double
+ * by a 128-bit approximation of 5^q.
+ * See D. Lemire, Number parsing at a gigabyte per second, Software: Practice
+ * and Experience 51 (2021) 1700-1727.
+ *
+ * @return bool: false if the result can not be decided, in which case the
+ * caller falls back to `strtod`.
+ */
+static bool eisel_lemire(uint64_t w, int64_t q, bool negative, double &x)
+{
+    typedef unsigned __int128 uint128_t;
+    if (q < kPow5MinExponent || q > kPow5MaxExponent) {
+        return false;
+    }
+    const uint64_t *pow5 = kPow5Table[q - kPow5MinExponent];
+    // floor(log2(10^q)) + 1024 + 63, valid for |q| < 1650.
+    const int64_t exponent = (((152170 + 65536) * q) >> 16) + 1024 + 63;
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    uint128_t product = static_cast<uint128_t>(w) * pow5[0];
+    uint64_t lower = static_cast<uint64_t>(product);
+    uint64_t upper = static_cast<uint64_t>(product >> 64);
+    if ((upper & 0x1FF) == 0x1FF && lower + w < lower) {
+        // refine the product by the low 64 bits of 5^q.
+        product = static_cast<uint128_t>(w) * pow5[1];
+        const uint64_t product_low = static_cast<uint64_t>(product);
+        const uint64_t product_middle = lower + (product >> 64);
+        if (product_middle < lower) {
+            upper++;
+        }
+        if (product_middle + 1 == 0 && (upper & 0x1FF) == 0x1FF &&
+            product_low + w < product_low) {
+            return false;
+        }
+        lower = product_middle;
+    }
+
+    const uint64_t upper_bit = upper >> 63;
+    uint64_t mantissa = upper >> (upper_bit + 9);
+    lz += static_cast<int>(1 ^ upper_bit);
+    if (lower == 0 && (upper & 0x1FF) == 0 && (mantissa & 3) == 1) {
+        // possibly half-way between two doubles.
+        return false;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t(1) << 53)) {
+        mantissa = uint64_t(1) << 52;
+        lz--;
+    }
+    mantissa &= ~(uint64_t(1) << 52);
+    const int64_t real_exponent = exponent - lz;
+    if (real_exponent < 1 || real_exponent > 2046) {
+        // subnormal or overflow.
+        return false;
+    }
+    uint64_t bits = mantissa | static_cast<uint64_t>(real_exponent) << 52;
+    bits |= static_cast<uint64_t>(negative) << 63;
+    std::memcpy(&x, &bits, sizeof(x));
+    return true;
+}
+#else
+static bool eisel_lemire(uint64_t, int64_t, bool, double &)
+{
+    return false;
+}
+#endif
+
+/**
+ * @details The number is read as w * 10^q, where the integer w has at most
+ * 19 significant digits, so that it fits in uint64_t.
+ */
+const char *parse_double(const char *first, const char *last, double &x)
+{
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+    const int max_digits = 19;
+
+    const char *p = first;
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t w = 0;
+    int64_t q = 0;
+    int digits = 0;  /* number of significant digits. */
+    bool any = false; /* if any digit is read. */
+    for (; p != last && is_digit(*p); p++) {
+        any = true;
+        if (digits < max_digits) {
+            w = w * 10 + (*p - '0');
+            digits += w != 0;
+        } else {
+            return parse_double_fallback(first, last, x);
+        }
+    }
+    if (p != last && (*p == 'x' || *p == 'X')) {
+        return parse_double_fallback(first, last, x);
+    } else if (p != last && *p == '.') {
+        p++;
+        for (; p != last && is_digit(*p); p++) {
+            any = true;
+            if (digits < max_digits) {
+                w = w * 10 + (*p - '0');
+                digits += w != 0;
+                q--;
+            } else {
+                return parse_double_fallback(first, last, x);
+            }
+        }
+    }
+    if (!any) {
+        return parse_double_fallback(first, last, x);
+    }
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        bool exp_negative = false;
+        if (e != last && (*e == '-' || *e == '+')) {
+            exp_negative = *e == '-';
+            e++;
+        }
+        if (e == last || !is_digit(*e)) {
+            return parse_double_fallback(first, last, x);
+        }
+        int64_t exp = 0;
+        for (; e != last && is_digit(*e); e++) {
+            if (exp > 100000) {
+                return parse_double_fallback(first, last, x);
+            }
+            exp = exp * 10 + (*e - '0');
+        }
+        q += exp_negative ? -exp : exp;
+        p = e;
+    }
+
+    if (w == 0) {
+        x = negative ? -0.0 : 0.0;
+        return p;
+    }
+    // Clinger's fast path: both w and 10^|q| are exact doubles.
+    if (q >= -22 && q <= 22 && w <= (uint64_t(1) << 53)) {
+        x = static_cast<double>(w);
+        x = q < 0 ? x / kPow10[-q] : x * kPow10[q];
+        x = negative ? -x : x;
+        return p;
+    }
+    if (eisel_lemire(w, q, negative, x)) {
+        return p;
+    }
+    return parse_double_fallback(first, last, x);
+}
+
+const char *parse_size(const char *first, const char *last, size_t &n)
+{
+    const size_t max = std::numeric_limits<size_t>::max();
+    const char *p = first;
+    n = 0;
+    for (; p != last && is_digit(*p); p++) {
+        const size_t d = *p - '0';
+        if (n > (max - d) / 10) {
+            return nullptr;
+        }
+        n = n * 10 + d;
+    }
+    return p == first ? nullptr : p;
+}
+
+} // namespace text
+} // namespace matrix
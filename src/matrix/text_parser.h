@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief number parsing of the matrix txt files.
+ */
+#ifndef _MATRIX_SRC_TEXT_PARSER_H_
+#define _MATRIX_SRC_TEXT_PARSER_H_
+
+#include <cstddef>
+
+namespace matrix {
+
+namespace text {
+
+/**
+ * @brief Parse a double number at the beginning of a character range.
+ *
+ * @details The result is correctly rounded, the same as `strtod`, except
+ * that leading white spaces are not skipped. Decimal numbers with up to 19
+ * significant digits are converted by the Clinger fast path or the
+ * Eisel-Lemire algorithm without any memory allocation, other numbers
+ * (including inf, nan and hexadecimal numbers) by `strtod`.
+ *
+ * @param [in] first: the beginning of the range.
+ * @param [in] last: the end of the range, which is not dereferenced.
+ * @param [out] x: the number.
+ * @return const char *: the end of the number, or nullptr if no number is
+ * found.
+ */
+const char *parse_double(const char *first, const char *last, double &x);
+
+/**
+ * @brief Parse a non-negative decimal integer at the beginning of a
+ * character range.
+ *
+ * @return const char *: the end of the integer, or nullptr if no integer is
+ * found or it overflows.
+ */
+const char *parse_size(const char *first, const char *last, size_t &n);
+
+} // namespace text
+} // namespace matrix
+
+#endif // _MATRIX_SRC_TEXT_PARSER_H_
@@ -0,0 +1,22 @@
+#include <matrix/details/lapack.h>
+
+#include "workspace.h"
+
+namespace matrix {
+
+namespace workspace {
+
+LapackWorkspace &LapackWorkspace::local()
+{
+    static thread_local LapackWorkspace ws;
+    return ws;
+}
+
+} // namespace workspace
+
+void release_lapack_workspace()
+{
+    workspace::LapackWorkspace::local().release();
+}
+
+} // namespace matrix
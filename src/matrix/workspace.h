@@ -0,0 +1,135 @@
+/**
+ * @file
+ * @brief thread-local workspace shared by the lapack wrappers.
+ */
+#ifndef _MATRIX_SRC_WORKSPACE_H_
+#define _MATRIX_SRC_WORKSPACE_H_
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "blas_base.h"
+
+namespace matrix {
+
+namespace workspace {
+
+/**
+ * @brief lapack routines whose optimal workspace size is cached.
+ */
+enum Routine {
+    kDsyev,
+    kDgeqp3,
+    kDorgqr,
+    kDgetri,
+    kDsytrf,
+    kDsytrfRook,
+    kDspevd,
+};
+
+/**
+ * @brief Workspace used by the lapack wrappers in one thread.
+ *
+ * @details The optimal `lwork` of each lapack routine is queried once for each
+ * matrix dimension and cached afterwards. The work arrays only grow, so that
+ * no memory allocation happens when the same dimension is used again.
+ * Use LapackWorkspace::local() to get the workspace of the calling thread.
+ */
+class LapackWorkspace {
+  private:
+    std::map<std::pair<int, blas_int>, blas_int> lwork_;
+    std::vector<double> work_;
+    std::vector<double> aux_;
+    std::vector<blas_int> iwork_;
+
+  public:
+    /**
+     * @brief Get the workspace of the calling thread.
+     */
+    static LapackWorkspace &local();
+
+    /**
+     * @brief Get the optimal `lwork` of a lapack routine for dimension `n`.
+     *
+     * @details On the first call with (`routine`, `n`), `query(&wkopt, &lwork)`
+     * is called with `lwork = -1` to perform the lapack workspace query, and
+     * the result is cached.
+     *
+     * @param [in] routine: the lapack routine.
+     * @param [in] n: the matrix dimension.
+     * @param [in] query: callable that performs the workspace query.
+     * @return blas_int: the optimal `lwork`.
+     */
+    template <typename Query>
+    blas_int optimal_lwork(Routine routine, blas_int n, Query query)
+    {
+        const std::pair<int, blas_int> key(routine, n);
+        auto p = lwork_.find(key);
+        if (p != lwork_.end()) {
+            return p->second;
+        }
+        double wkopt = 0.0;
+        blas_int lwork = -1;
+        query(&wkopt, &lwork);
+        lwork = (blas_int)wkopt;
+        if (lwork < 1) {
+            lwork = 1;
+        }
+        lwork_[key] = lwork;
+        return lwork;
+    }
+
+    /**
+     * @brief Get the double work array with at least `size` elements.
+     */
+    double *work(size_t size)
+    {
+        if (work_.size() < size) {
+            work_.resize(size);
+        }
+        return work_.data();
+    }
+
+    /**
+     * @brief Get the auxiliary double array with at least `size` elements.
+     * @details It is used along with work() when a routine needs a second
+     * double array, e.g. `tau` in QR factorization.
+     */
+    double *aux(size_t size)
+    {
+        if (aux_.size() < size) {
+            aux_.resize(size);
+        }
+        return aux_.data();
+    }
+
+    /**
+     * @brief Get the integer work array with at least `size` elements, e.g.
+     * for pivots.
+     */
+    blas_int *iwork(size_t size)
+    {
+        if (iwork_.size() < size) {
+            iwork_.resize(size);
+        }
+        return iwork_.data();
+    }
+
+    /**
+     * @brief Release all the memory and the cached workspace sizes.
+     */
+    void release()
+    {
+        lwork_.clear();
+        std::vector<double>().swap(work_);
+        std::vector<double>().swap(aux_);
+        std::vector<blas_int>().swap(iwork_);
+    }
+};
+
+} // namespace workspace
+} // namespace matrix
+
+#endif // _MATRIX_SRC_WORKSPACE_H_
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <string>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+using std::string;
+
+/**
+ * test the runtime selection of blas and lapack backends.
+ */
+struct BackendTest: public ::testing::Test {
+    string default_backend;
+    string default_engine;
+
+    virtual void SetUp() override
+    {
+        default_backend = matrix::get_blas_backend();
+        default_engine = matrix::get_dgemm_engine();
+    }
+
+    virtual void TearDown() override
+    {
+        matrix::set_blas_backend(default_backend);
+        matrix::set_dgemm_engine(default_engine);
+    }
+};
+
+TEST_F(BackendTest, default_backend_test)
+{
+    matrix::set_blas_backend("default");
+    EXPECT_EQ(matrix::get_blas_backend(), "default");
+    EXPECT_GE(matrix::get_blas_num_threads(), 1);
+
+    // the dgemm engine is reset as well.
+    const string engine = matrix::get_dgemm_engine();
+    matrix::set_dgemm_engine(engine == "blas" ? "internal" : "blas");
+    matrix::set_blas_backend("default");
+    EXPECT_EQ(matrix::get_dgemm_engine(), engine);
+
+    EXPECT_THROW(matrix::set_blas_backend("/path/not/exist/libblas.so"),
+                 matrix::exception::MatrixException);
+    EXPECT_EQ(matrix::get_blas_backend(), "default");
+}
+
+TEST_F(BackendTest, openblas_backend_test)
+{
+    try {
+        matrix::set_blas_backend("openblas");
+    } catch (matrix::exception::MatrixException &) {
+        GTEST_SKIP();
+    }
+    EXPECT_EQ(matrix::get_blas_backend(), "openblas");
+    EXPECT_EQ(matrix::get_dgemm_engine(), "blas");
+    matrix::set_blas_num_threads(1);
+    EXPECT_EQ(matrix::get_blas_num_threads(), 1);
+
+    const size_t n = 40;
+    Matrix A(n, n);
+    A.randomize(-1, 1);
+    for (size_t i = 0; i < n; i++)
+        A(i, i) += n;
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+
+    Matrix C(n, n);
+    mult_dgemm(1.0, A, "N", A, "T", 0.0, C);
+    MatrixXd ref = A_mxd * A_mxd.transpose();
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    Matrix A_inv = A;
+    matrix::invert_gen_matrix_dgetri(A_inv);
+    ref = A_mxd.inverse();
+    EXPECT_TRUE(A_inv.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+}
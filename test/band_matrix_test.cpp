@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cmath>
+#include <vector>
+
+using matrix::BandMatrix;
+using matrix::Matrix;
+using matrix::TridiagonalMatrix;
+using std::vector;
+
+struct BandMatrixTest: public ::testing::Test {
+    /**
+     * @brief Get a random diagonally dominant matrix with the given band.
+     */
+    Matrix band_matrix(size_t n, size_t kl, size_t ku)
+    {
+        Matrix A(n, n);
+        A.randomize(-1, 1);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                if (i > j + kl || j > i + ku) {
+                    A(i, j) = 0.0;
+                }
+            }
+            A(i, i) += 2.0 * (kl + ku + 1);
+        }
+        return A;
+    }
+};
+
+TEST_F(BandMatrixTest, conversion_test)
+{
+    Matrix A = band_matrix(9, 2, 3);
+    A(8, 0) = 1e-14;
+    BandMatrix B(A, 1e-12);
+    EXPECT_EQ(B.kl(), 2);
+    EXPECT_EQ(B.ku(), 3);
+    A(8, 0) = 0.0;
+    EXPECT_TRUE(B.to_matrix().is_equal_to(A, 0.0));
+    const BandMatrix &cB = B;
+    EXPECT_EQ(cB(0, 3), A(0, 3));
+    EXPECT_EQ(cB(3, 0), 0.0);
+    EXPECT_THROW(B(3, 0) = 1.0, matrix::exception::MatrixException);
+
+    const BandMatrix C(A, 1, 1);
+    EXPECT_EQ(C(0, 1), A(0, 1));
+    EXPECT_EQ(C(0, 2), 0.0);
+    EXPECT_EQ(BandMatrix(Matrix(0, 0)).dim(), 0);
+
+    // non-finite elements are never dropped.
+    Matrix N = A;
+    N(7, 0) = std::nan("");
+    EXPECT_EQ(BandMatrix(N, 1.0).kl(), 7);
+    N(7, 0) = 0.0;
+    N(0, 8) = INFINITY;
+    EXPECT_EQ(BandMatrix(N, 1.0).ku(), 8);
+
+    Matrix T = band_matrix(6, 1, 1);
+    T(0, 5) = 1e-3;
+    EXPECT_THROW(TridiagonalMatrix(T, 1e-6),
+                 matrix::exception::MatrixException);
+    T(0, 5) = std::nan("");
+    EXPECT_THROW(TridiagonalMatrix(T, 1e-2),
+                 matrix::exception::MatrixException);
+    T(0, 5) = 1e-3;
+    TridiagonalMatrix S(T, 1e-2);
+    T(0, 5) = 0.0;
+    EXPECT_TRUE(S.to_matrix().is_equal_to(T, 0.0));
+    EXPECT_EQ(S(2, 1), T(2, 1));
+}
+
+TEST_F(BandMatrixTest, band_solve_test)
+{
+    const size_t n = 40;
+    Matrix A = band_matrix(n, 3, 2);
+    Matrix B(n, 3);
+    B.randomize(-1, 1);
+    Matrix X = B;
+    Matrix LU = A;
+    matrix::solve_gen_matrix_dgetrs(LU, X);
+
+    Matrix Y = B;
+    BandMatrix band(A);
+    matrix::solve_band_matrix_dgbsv(band, Y);
+    EXPECT_TRUE(Y.is_equal_to(X, 1e-10));
+
+    band = BandMatrix(A);
+    vector<int> ipiv;
+    matrix::factorize_band_matrix_dgbtrf(band, ipiv);
+    for (int k = 0; k < 2; k++) {
+        Y = B;
+        matrix::solve_band_matrix_dgbtrs(band, ipiv, Y);
+        EXPECT_TRUE(Y.is_equal_to(X, 1e-10));
+    }
+
+    // symmetric positive definite band.
+    Matrix S = band_matrix(n, 2, 2);
+    S.to_symmetric("U");
+    X = B;
+    LU = S;
+    matrix::solve_spd_matrix_dpotrs("U", LU, X);
+    Y = B;
+    matrix::solve_spd_band_matrix_dpbsv(BandMatrix(S), Y);
+    EXPECT_TRUE(Y.is_equal_to(X, 1e-10));
+    EXPECT_THROW(matrix::solve_spd_band_matrix_dpbsv(BandMatrix(A), Y),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(BandMatrixTest, tridiagonal_solve_test)
+{
+    // a large symmetric positive definite system.
+    const size_t n = 1000000;
+    TridiagonalMatrix T(n);
+    for (size_t i = 0; i < n; i++) {
+        T.diag()[i] = 4.0 + std::sin(i);
+        if (i + 1 < n) {
+            T.lower()[i] = T.upper()[i] = -1.0 + 0.5 * std::cos(i);
+        }
+    }
+    Matrix B(n, 1);
+    B.randomize(-1, 1);
+    for (int spd = 0; spd < 2; spd++) {
+        TridiagonalMatrix F = T;
+        Matrix X = B;
+        if (spd) {
+            matrix::solve_spd_tridiagonal_matrix_dptsv(F, X);
+        } else {
+            matrix::solve_tridiagonal_matrix_dgtsv(F, X);
+        }
+        double residual = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double ax = T.diag()[i] * X(i, 0);
+            if (i > 0) {
+                ax += T.lower()[i - 1] * X(i - 1, 0);
+            }
+            if (i + 1 < n) {
+                ax += T.upper()[i] * X(i + 1, 0);
+            }
+            residual = std::max(residual, std::fabs(ax - B(i, 0)));
+        }
+        EXPECT_LT(residual, 1e-12);
+    }
+}
+
+TEST_F(BandMatrixTest, tridiagonal_diagonalize_test)
+{
+    const size_t n = 15;
+    Matrix A = band_matrix(n, 1, 1);
+    A.to_symmetric("L");
+    TridiagonalMatrix T(A);
+    Matrix V = A;
+    vector<double> ref(n);
+    matrix::diagonalize_sym_matrix_dsyev("L", V, ref);
+
+    vector<double> eig(n);
+    Matrix Q;
+    matrix::diagonalize_sym_tridiagonal_matrix_dstevr(T, eig, Q);
+    for (size_t k = 0; k < n; k++) {
+        EXPECT_NEAR(eig[k], ref[k], 1e-10);
+    }
+
+    Matrix Z;
+    matrix::diagonalize_sym_tridiagonal_matrix_dstemr(T, 3, 6, eig, Z);
+    ASSERT_EQ(eig.size(), 4);
+    EXPECT_EQ(Z.row(), 4);
+    for (size_t k = 0; k < 4; k++) {
+        EXPECT_NEAR(eig[k], ref[k + 3], 1e-10);
+        // each row of Z is an eigenvector.
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_NEAR(std::fabs(Z(k, i)), std::fabs(Q(k + 3, i)), 1e-8);
+        }
+    }
+    EXPECT_THROW(
+        matrix::diagonalize_sym_tridiagonal_matrix_dstemr(T, 3, n, eig, Z),
+        matrix::exception::MatrixException);
+}
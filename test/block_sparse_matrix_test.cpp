@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cmath>
+#include <vector>
+
+using matrix::BlockSparseMatrix;
+using matrix::Matrix;
+
+struct BlockSparseMatrixTest: public ::testing::Test {
+    /**
+     * @brief Get a random matrix whose elements decay exponentially away
+     * from the diagonal.
+     */
+    Matrix decay_matrix(size_t row, size_t col, double decay)
+    {
+        Matrix A(row, col);
+        A.randomize(-1, 1);
+        for (size_t i = 0; i < row; i++) {
+            for (size_t j = 0; j < col; j++) {
+                A(i, j) *= std::exp(-decay * std::fabs((double)i - j));
+            }
+        }
+        return A;
+    }
+};
+
+TEST_F(BlockSparseMatrixTest, conversion_test)
+{
+    Matrix A(70, 50);
+    A.randomize(-1, 1);
+    // zero tiles (0, 1) and (4, 3), where the last tiles are [6, 2].
+    for (size_t i = 0; i < 16; i++) {
+        for (size_t j = 16; j < 32; j++) {
+            A(i, j) = 0.0;
+        }
+    }
+    for (size_t i = 64; i < 70; i++) {
+        for (size_t j = 48; j < 50; j++) {
+            A(i, j) = 0.0;
+        }
+    }
+    BlockSparseMatrix S(A, 16);
+    EXPECT_EQ(S.num_tile_rows(), 5);
+    EXPECT_EQ(S.num_tile_cols(), 4);
+    EXPECT_EQ(S.num_tiles(), 18);
+    EXPECT_EQ(S.tile(0, 1), nullptr);
+    EXPECT_EQ(S.tile_norm(4, 3), 0.0);
+    EXPECT_EQ(S.tile_height(4), 6);
+    EXPECT_EQ(S.tile_width(3), 2);
+    EXPECT_TRUE(S.to_matrix().is_equal_to(A, 0.0));
+
+    double norm = 0.0;
+    for (size_t i = 64; i < 70; i++) {
+        for (size_t j = 32; j < 48; j++) {
+            norm += A(i, j) * A(i, j);
+        }
+    }
+    EXPECT_NEAR(S.tile_norm(4, 2), std::sqrt(norm), 1e-12);
+    EXPECT_EQ(S.tile(4, 2)[17], A(65, 33));
+
+    // insert and replace tiles.
+    Matrix T(16, 16);
+    T.randomize(-1, 1);
+    S.set_tile(0, 1, T);
+    Matrix E(6, 2);
+    E.fill_all(1.0);
+    S.set_tile(4, 3, E);
+    T.fill_all(2.0);
+    S.set_tile(2, 2, T);
+    EXPECT_EQ(S.num_tiles(), 20);
+    EXPECT_EQ(S.tile_norm(2, 2), 32.0);
+    EXPECT_EQ(S.tile_norm(4, 3), std::sqrt(12.0));
+    Matrix B = S.to_matrix();
+    EXPECT_EQ(B(5, 20), S.tile(0, 1)[5 * 16 + 4]);
+    EXPECT_EQ(B(69, 49), 1.0);
+    EXPECT_EQ(B(40, 40), 2.0);
+    EXPECT_EQ(B(10, 10), A(10, 10));
+    EXPECT_THROW(S.set_tile(4, 3, T), matrix::exception::MatrixException);
+    EXPECT_THROW(S.set_tile(5, 0, T), matrix::exception::MatrixException);
+
+    BlockSparseMatrix C(S.row(), S.col(), 16, S.tile_row_ptr(), S.tile_col(),
+                        std::vector<double>(S.tile_data(0),
+                                            S.tile_data(0) + 70 * 50));
+    EXPECT_TRUE(C.to_matrix().is_equal_to(B, 0.0));
+    EXPECT_THROW(BlockSparseMatrix(S.row(), S.col(), 16, S.tile_row_ptr(),
+                                   S.tile_col(), std::vector<double>(10)),
+                 matrix::exception::MatrixException);
+
+    // the tiles that are not finite are kept whatever the threshold is.
+    Matrix N(32, 32);
+    N.fill_all(0.0);
+    N(3, 20) = std::nan("");
+    N(20, 3) = INFINITY;
+    BlockSparseMatrix SN(N, 16, 1.0);
+    EXPECT_EQ(SN.num_tiles(), 2);
+    EXPECT_TRUE(std::isnan(SN.to_matrix()(3, 20)));
+    EXPECT_TRUE(std::isinf(SN.to_matrix()(20, 3)));
+}
+
+TEST_F(BlockSparseMatrixTest, product_test)
+{
+    const size_t n = 300;
+    Matrix A = decay_matrix(n, n - 7, 0.5);
+    Matrix B = decay_matrix(n - 7, n + 11, 0.5);
+    Matrix ref(n, n + 11);
+    matrix::mult_dgemm(-1.5, A, "N", B, "N", 0.0, ref);
+
+    BlockSparseMatrix SA(A, 24, 1e-14);
+    BlockSparseMatrix SB(B, 24, 1e-14);
+    EXPECT_LT(SA.num_tiles(), SA.num_tile_rows() * SA.num_tile_cols());
+
+    // without screening.
+    BlockSparseMatrix SC(3, 3, 24);
+    matrix::mult_block_sparse_dgemm(-1.5, SA, SB, 0.0, SC);
+    EXPECT_EQ(SC.row(), n);
+    EXPECT_EQ(SC.col(), n + 11);
+    EXPECT_TRUE(SC.to_matrix().is_equal_to(ref, 1e-12));
+
+    // with screening the products, the error of each tile is bounded.
+    const double threshold = 1e-6;
+    BlockSparseMatrix SD;
+    matrix::mult_block_sparse_dgemm(-1.5, SA, SB, threshold, SD);
+    EXPECT_LT(SD.num_tiles(), SC.num_tiles());
+    EXPECT_TRUE(SD.to_matrix().is_equal_to(
+        ref, 1.5 * threshold * SA.num_tile_cols()));
+
+    // the products with the tiles that are not finite are not screened.
+    Matrix N(48, 48);
+    N.fill_all(0.0);
+    N(0, 0) = std::nan("");
+    N(30, 30) = 1e-10;
+    BlockSparseMatrix SN(N, 24, 0.0);
+    matrix::mult_block_sparse_dgemm(1.0, SN, SN, 1.0, SD);
+    EXPECT_TRUE(std::isnan(SD.to_matrix()(0, 0)));
+    EXPECT_EQ(SD.to_matrix()(30, 30), 0.0);
+
+    EXPECT_THROW(matrix::mult_block_sparse_dgemm(1.0, SA, SA, 0.0, SD),
+                 matrix::exception::MatrixException);
+    EXPECT_THROW(
+        matrix::mult_block_sparse_dgemm(1.0, SA, BlockSparseMatrix(B, 16),
+                                        0.0, SD),
+        matrix::exception::MatrixException);
+    EXPECT_THROW(matrix::mult_block_sparse_dgemm(1.0, SA, SB, 0.0, SA),
+                 matrix::exception::MatrixException);
+}
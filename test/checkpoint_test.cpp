@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using matrix::CheckpointStore;
+using matrix::Matrix;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct CheckpointTest: public ::testing::Test {
+    string ckpt_path;
+    vector<shared_ptr<Matrix>> mat;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        ckpt_path = file_path.substr(0, file_path.rfind("/")) +
+                    "/checkpoint.ckpt.tem";
+        std::remove(ckpt_path.c_str());
+        for (auto dim : {vector<size_t>{200, 300}, vector<size_t>{10, 10},
+                         vector<size_t>{0, 4}}) {
+            auto A = std::make_shared<Matrix>(dim[0], dim[1]);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+    }
+
+    virtual void TearDown() override { std::remove(ckpt_path.c_str()); }
+
+    vector<shared_ptr<const Matrix>> snapshot() const
+    {
+        return vector<shared_ptr<const Matrix>>(mat.begin(), mat.end());
+    }
+
+    void check_restore(const CheckpointStore &store)
+    {
+        auto rst = store.restore();
+        ASSERT_EQ(rst.size(), mat.size());
+        for (size_t i = 0; i < mat.size(); i++) {
+            EXPECT_EQ(rst[i]->row(), mat[i]->row());
+            EXPECT_EQ(rst[i]->col(), mat[i]->col());
+            EXPECT_TRUE(rst[i]->is_equal_to(*mat[i], 0.0));
+        }
+    }
+};
+
+TEST_F(CheckpointTest, incremental_test)
+{
+    const size_t data_size = (200 * 300 + 10 * 10) * sizeof(double);
+    CheckpointStore store(ckpt_path, 256);
+    EXPECT_TRUE(store.restore().empty());
+    EXPECT_GT(store.checkpoint(snapshot()), data_size);
+    check_restore(store);
+
+    // only the changed tiles are written.
+    (*mat[0])(100, 7) = 3.0;
+    (*mat[1])(0, 0) = 4.0;
+    const uint64_t size = store.checkpoint(snapshot(), false);
+    EXPECT_GT(size, 256 * sizeof(double));
+    EXPECT_LT(size, 4 * 256 * sizeof(double));
+    check_restore(store);
+    EXPECT_LT(store.checkpoint(snapshot()), 256 * sizeof(double));
+    EXPECT_EQ(store.count(), 3);
+
+    // the matrices can be resized, added and removed.
+    mat[1]->resize(12, 9);
+    mat[1]->randomize(-1, 1);
+    mat.pop_back();
+    store.checkpoint(snapshot());
+    check_restore(store);
+    mat.push_back(std::make_shared<Matrix>(3, 3));
+    mat.back()->randomize(-1, 1);
+    store.checkpoint(snapshot());
+    check_restore(store);
+}
+
+TEST_F(CheckpointTest, reopen_test)
+{
+    {
+        CheckpointStore store(ckpt_path, 1000);
+        store.checkpoint(snapshot());
+        mat[0]->scale(2.0);
+        store.checkpoint(snapshot());
+    }
+    CheckpointStore store(ckpt_path);
+    EXPECT_EQ(store.tile_size(), 1000);
+    EXPECT_EQ(store.count(), 2);
+    check_restore(store);
+    // the hashes are loaded, nothing is changed.
+    EXPECT_LT(store.checkpoint(snapshot()), 1000);
+
+    // an interrupted checkpoint is discarded.
+    const uint64_t size = store.file_size();
+    (*mat[1])(3, 3) = -1.0;
+    store.checkpoint(snapshot());
+    ASSERT_EQ(truncate(ckpt_path.c_str(), store.file_size() - 4), 0);
+    CheckpointStore reopened(ckpt_path);
+    EXPECT_EQ(reopened.count(), 3);
+    EXPECT_EQ(reopened.file_size(), size);
+}
+
+TEST_F(CheckpointTest, compact_test)
+{
+    CheckpointStore store(ckpt_path, 512);
+    for (int k = 0; k < 4; k++) {
+        mat[0]->scale(0.5);
+        store.checkpoint(snapshot());
+    }
+    const uint64_t size = store.file_size();
+    store.compact();
+    EXPECT_LT(store.file_size(), size / 3);
+    EXPECT_EQ(store.count(), 1);
+    check_restore(store);
+    check_restore(CheckpointStore(ckpt_path));
+
+    (*mat[0])(0, 0) = 1.0;
+    store.checkpoint(snapshot());
+    check_restore(CheckpointStore(ckpt_path));
+}
+
+TEST_F(CheckpointTest, corruption_test)
+{
+    uint64_t size = 0;
+    {
+        CheckpointStore store(ckpt_path, 512);
+        store.checkpoint(snapshot());
+        size = store.file_size();
+    }
+    // overwrite a byte in the middle of the tile data.
+    int fd = open(ckpt_path.c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0);
+    const char byte = 0x5a;
+    ASSERT_EQ(pwrite(fd, &byte, 1, size / 2), 1);
+    close(fd);
+    CheckpointStore store(ckpt_path);
+    EXPECT_THROW(store.restore(), matrix::exception::MatrixIOException);
+    EXPECT_NO_THROW(store.restore(false));
+}
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using matrix::ContainerReader;
+using matrix::ContainerWriter;
+using matrix::Matrix;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct ContainerTest: public ::testing::Test {
+    string bin_path;
+    vector<shared_ptr<const Matrix>> mat;
+    vector<string> names = {"overlap", "", "fock", "density"};
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        bin_path =
+            file_path.substr(0, file_path.rfind("/")) + "/container.bin.tem";
+        for (auto dim : {vector<size_t>{3, 5}, vector<size_t>{0, 4},
+                         vector<size_t>{7, 1}, vector<size_t>{30, 20}}) {
+            auto A = std::make_shared<Matrix>(dim[0], dim[1]);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+        matrix::write_matrices_to_container(mat, bin_path, names);
+    }
+
+    virtual void TearDown() override { std::remove(bin_path.c_str()); }
+
+    /**
+     * flip a byte of the file at an offset.
+     */
+    void corrupt(long offset)
+    {
+        FILE *f = fopen(bin_path.c_str(), "r+b");
+        fseek(f, offset, SEEK_SET);
+        int c = fgetc(f);
+        fseek(f, offset, SEEK_SET);
+        fputc(c ^ 0xff, f);
+        fclose(f);
+    }
+
+    /**
+     * CRC32C of a byte array, bit by bit.
+     */
+    static uint32_t crc32c(const char *p, size_t size)
+    {
+        uint32_t crc = 0xffffffff;
+        for (size_t i = 0; i < size; i++) {
+            crc ^= static_cast<unsigned char>(p[i]);
+            for (int k = 0; k < 8; k++) {
+                crc = crc & 1 ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+            }
+        }
+        return ~crc;
+    }
+
+    /**
+     * overwrite a field of the k-th index entry, and update the checksums of
+     * the index and the header, so that only the field is invalid.
+     */
+    void tamper_entry(size_t k, size_t field_offset, uint64_t value)
+    {
+        FILE *f = fopen(bin_path.c_str(), "r+b");
+        char header[64];
+        fread(header, 1, sizeof(header), f);
+        uint64_t toc_offset = 0;
+        uint64_t toc_size = 0;
+        memcpy(&toc_offset, header + 24, 8);
+        memcpy(&toc_size, header + 32, 8);
+        string toc(toc_size, '\0');
+        fseek(f, toc_offset, SEEK_SET);
+        fread(&toc[0], 1, toc_size, f);
+        memcpy(&toc[k * 64 + field_offset], &value, 8);
+        const uint32_t toc_crc = crc32c(toc.data(), toc.size());
+        memcpy(header + 48, &toc_crc, 4);
+        const uint32_t header_crc = crc32c(header, 60);
+        memcpy(header + 60, &header_crc, 4);
+        fseek(f, toc_offset, SEEK_SET);
+        fwrite(toc.data(), 1, toc_size, f);
+        fseek(f, 0, SEEK_SET);
+        fwrite(header, 1, sizeof(header), f);
+        fclose(f);
+    }
+};
+
+TEST_F(ContainerTest, index_test)
+{
+    EXPECT_TRUE(matrix::is_matrix_container(bin_path));
+    ContainerReader reader(bin_path);
+    ASSERT_EQ(reader.size(), mat.size());
+    for (size_t i = 0; i < mat.size(); i++) {
+        const auto &e = reader.entries()[i];
+        EXPECT_EQ(e.name, names[i]);
+        EXPECT_EQ(e.row, mat[i]->row());
+        EXPECT_EQ(e.col, mat[i]->col());
+        EXPECT_EQ(e.offset % 64, 0u);
+        EXPECT_EQ(e.dtype, matrix::kDtypeFloat64);
+    }
+    EXPECT_EQ(reader.index_of("fock"), 2u);
+    EXPECT_THROW(reader.index_of("unknown"),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, read_matrix_at_test)
+{
+    ContainerReader reader(bin_path);
+    // read in reversed order.
+    for (size_t i = mat.size(); i-- > 0;) {
+        EXPECT_TRUE(reader.read_matrix_at(i)->is_equal_to(*mat[i], 0.0));
+    }
+    EXPECT_TRUE(reader.read_matrix_at("density")->is_equal_to(*mat[3], 0.0));
+
+    // reuse the same matrix.
+    Matrix A;
+    for (size_t i = 0; i < mat.size(); i++) {
+        reader.read_matrix_at(i, A);
+        EXPECT_TRUE(A.is_equal_to(*mat[i], 0.0));
+    }
+    EXPECT_THROW(reader.read_matrix_at(mat.size()),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, binary_io_test)
+{
+    auto read = matrix::read_matrices_from_binary(bin_path.c_str());
+    auto mapped = matrix::map_matrices_from_binary(bin_path.c_str());
+    ASSERT_EQ(read.size(), mat.size());
+    ASSERT_EQ(mapped.size(), mat.size());
+    for (size_t i = 0; i < mat.size(); i++) {
+        EXPECT_TRUE(read[i]->is_equal_to(*mat[i], 0.0));
+        EXPECT_TRUE(mapped[i]->is_equal_to(*mat[i], 0.0));
+    }
+
+    // plain binary files are not containers.
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    EXPECT_FALSE(matrix::is_matrix_container(bin_path));
+    EXPECT_THROW(ContainerReader reader(bin_path),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, checksum_test)
+{
+    long offset = 0;
+    {
+        ContainerReader reader(bin_path);
+        offset = reader.entries()[3].offset + 8;
+    }
+    corrupt(offset);
+    ContainerReader reader(bin_path);
+    EXPECT_TRUE(reader.read_matrix_at(0)->is_equal_to(*mat[0], 0.0));
+    EXPECT_THROW(reader.read_matrix_at(3),
+                 matrix::exception::MatrixIOException);
+    EXPECT_NO_THROW(reader.read_matrix_at(3, false));
+
+    // corrupted header.
+    corrupt(20);
+    EXPECT_THROW(ContainerReader reader(bin_path),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, writer_test)
+{
+    ContainerWriter writer(bin_path);
+    EXPECT_EQ(writer.append(*mat[0], "A"), 0u);
+    EXPECT_THROW(writer.append(*mat[1], "A"),
+                 matrix::exception::MatrixIOException);
+    EXPECT_EQ(writer.append(*mat[1]), 1u);
+    writer.close();
+    EXPECT_THROW(writer.append(*mat[2]), matrix::exception::MatrixIOException);
+
+    ContainerReader reader(bin_path);
+    EXPECT_EQ(reader.size(), 2u);
+    EXPECT_TRUE(reader.read_matrix_at("A")->is_equal_to(*mat[0], 0.0));
+}
+
+TEST_F(ContainerTest, codec_test)
+{
+    // smooth, sparse and random matrices, larger than a chunk.
+    vector<shared_ptr<const Matrix>> data;
+    auto smooth = std::make_shared<Matrix>(300, 400);
+    auto sparse = std::make_shared<Matrix>(300, 400);
+    sparse->fill_all(0.0);
+    for (size_t i = 0; i < smooth->row(); i++) {
+        for (size_t j = 0; j < smooth->col(); j++) {
+            (*smooth)(i, j) = std::exp(-0.001 * (i * i + j));
+            if ((i + j) % 37 == 0) {
+                (*sparse)(i, j) = 1.0 / (1.0 + i + j);
+            }
+        }
+    }
+    data.push_back(smooth);
+    data.push_back(sparse);
+    data.push_back(mat[0]);
+    data.push_back(mat[1]);
+
+    const uint64_t raw_size = smooth->size() * sizeof(double);
+    for (int filter : {matrix::kCodecNone, matrix::kCodecShuffle,
+                       matrix::kCodecXorDelta}) {
+        for (int compressor : {matrix::kCodecNone, matrix::kCodecRle,
+                               matrix::kCodecDeflate, matrix::kCodecZstd}) {
+            const int codec = filter | compressor;
+            if (!matrix::is_container_codec_supported(codec)) {
+                EXPECT_THROW(
+                    matrix::write_matrices_to_container(data, bin_path, {},
+                                                        codec),
+                    matrix::exception::MatrixIOException);
+                continue;
+            }
+            matrix::write_matrices_to_container(data, bin_path, {}, codec);
+            ContainerReader reader(bin_path);
+            for (size_t i = 0; i < data.size(); i++) {
+                EXPECT_EQ(reader.entries()[i].codec, (uint32_t)codec);
+                EXPECT_TRUE(
+                    reader.read_matrix_at(i)->is_equal_to(*data[i], 0.0));
+            }
+            // run-length encoding only works for the sparse matrix.
+            if (filter != matrix::kCodecNone &&
+                compressor != matrix::kCodecNone) {
+                EXPECT_LT(reader.entries()[1].size * 2, raw_size);
+                if (compressor != matrix::kCodecRle) {
+                    EXPECT_LT(reader.entries()[0].size * 2, raw_size);
+                }
+            }
+
+            matrix::MatrixStreamReader stream(bin_path);
+            for (size_t i = 0; i < data.size(); i++) {
+                EXPECT_TRUE(stream.next()->is_equal_to(*data[i], 0.0));
+            }
+            if (codec != matrix::kCodecNone) {
+                EXPECT_THROW(
+                    matrix::map_matrices_from_binary(bin_path.c_str()),
+                    matrix::exception::MatrixIOException);
+            }
+        }
+    }
+    EXPECT_FALSE(matrix::is_container_codec_supported(0x4));
+    EXPECT_THROW(ContainerWriter writer(bin_path, 0x4),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, codec_corruption_test)
+{
+    const int codec = matrix::kCodecXorDelta | matrix::kCodecRle;
+    auto A = std::make_shared<Matrix>(200, 400);
+    A->fill_all(1.0);
+    matrix::write_matrices_to_container({A}, bin_path, {}, codec);
+    long offset = 0;
+    {
+        ContainerReader reader(bin_path);
+        // the size of the first chunk.
+        offset = reader.entries()[0].offset;
+    }
+    corrupt(offset);
+    ContainerReader reader(bin_path);
+    EXPECT_THROW(reader.read_matrix_at(0),
+                 matrix::exception::MatrixIOException);
+    EXPECT_THROW(reader.read_matrix_at(0, false),
+                 matrix::exception::MatrixIOException);
+}
+
+TEST_F(ContainerTest, index_bound_test)
+{
+    // the data size and the offset of the entries, at byte 24 and 0.
+    const int codec = matrix::kCodecXorDelta | matrix::kCodecRle;
+    for (size_t field_offset : {24, 0}) {
+        matrix::write_matrices_to_container(mat, bin_path, names, codec);
+        ContainerReader(bin_path).read_matrix_at(3);
+        tamper_entry(3, field_offset, uint64_t(1) << 60);
+        EXPECT_THROW(ContainerReader reader(bin_path),
+                     matrix::exception::MatrixIOException);
+    }
+}
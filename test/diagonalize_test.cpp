@@ -42,7 +42,7 @@ void verify(Matrix &A, Matrix &Q_ref, vector<double> &eig_ref, Matrix &Q_calc,
     // verify calculated EVD can restore the original input matrix.
     Matrix A2(n, n);
     Matrix D(n, n);
-    for (size_t i = 0; i < D.size(); ++i)
+    for (size_t i = 0; i < D.row(); ++i)
         D(i, i) = eig_calc[i];
     matrix::mult_dgemm_ATBA(Q_calc, D, A2);
     EXPECT_TRUE(A.is_equal_to(A2));
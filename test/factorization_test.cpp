@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+
+/**
+ * test reusable factorizations.
+ */
+struct FactorizationTest: public ::testing::Test {
+    Matrix A_gen;
+    Matrix A_sym;
+    Matrix A_spd;
+    Matrix B;
+
+    virtual void SetUp() override
+    {
+        const size_t n = 40;
+        A_gen.resize(n, n);
+        A_gen.randomize(-1, 1);
+        for (size_t i = 0; i < n; i++)
+            A_gen(i, i) += 5;
+
+        A_sym.resize(n, n);
+        A_sym.randomize(-1, 1);
+        A_sym.to_symmetric("L");
+
+        A_spd.resize(n, n);
+        mult_dgemm(1.0, A_gen, "N", A_gen, "T", 0.0, A_spd);
+
+        B.resize(n, 3);
+        B.randomize(-1, 1);
+    }
+
+    virtual void TearDown() override {}
+
+    /**
+     * Check the factorization results against Eigen.
+     */
+    void verify(const matrix::Factorization &F, Matrix &A)
+    {
+        MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+        MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+        MatrixXd X_mxd = A_mxd.fullPivLu().solve(B_mxd);
+        MatrixXd Ainv_mxd = A_mxd.inverse();
+        Matrix X_ref = MatrixXd_to_Matrix(X_mxd);
+        Matrix Ainv_ref = MatrixXd_to_Matrix(Ainv_mxd);
+
+        // solve the same matrix twice.
+        for (int i = 0; i < 2; i++) {
+            Matrix X = B;
+            F.solve(X);
+            EXPECT_TRUE(X.is_equal_to(X_ref, 1e-8));
+        }
+        EXPECT_TRUE(F.inverse().is_equal_to(Ainv_ref, 1e-8));
+
+        const double det = A_mxd.determinant();
+        EXPECT_NEAR(std::log(std::fabs(det)), F.log_det(), 1e-8);
+        EXPECT_EQ(det > 0 ? 1 : -1, F.det_sign());
+
+        // condition number estimation in 1-norm.
+        const double rcond_ref =
+            1.0 / (A_mxd.cwiseAbs().colwise().sum().maxCoeff() *
+                   Ainv_mxd.cwiseAbs().colwise().sum().maxCoeff());
+        EXPECT_GT(F.rcond(), rcond_ref / 10);
+        EXPECT_LT(F.rcond(), rcond_ref * 10);
+    }
+};
+
+TEST_F(FactorizationTest, lu_test)
+{
+    matrix::LUFactorization F(A_gen);
+    EXPECT_EQ(F.type(), matrix::Factorization::kLU);
+    verify(F, A_gen);
+}
+
+TEST_F(FactorizationTest, cholesky_test)
+{
+    Matrix A = A_spd;
+    A(0, 1) = 999;
+    matrix::CholeskyFactorization F_L("L", A);
+    verify(F_L, A_spd);
+
+    A = A_spd;
+    A(1, 0) = 999;
+    matrix::CholeskyFactorization F_U("U", A);
+    verify(F_U, A_spd);
+
+    A = A_spd;
+    A.scale(-1.0);
+    EXPECT_THROW(matrix::CholeskyFactorization("U", A),
+                 matrix::exception::MatrixOperationError);
+}
+
+TEST_F(FactorizationTest, ldlt_test)
+{
+    Matrix A = A_sym;
+    A(0, 1) = 999;
+    matrix::LDLTFactorization F_L("L", A);
+    verify(F_L, A_sym);
+
+    A = A_sym;
+    A(1, 0) = 999;
+    matrix::LDLTFactorization F_U("U", A);
+    verify(F_U, A_sym);
+}
+
+TEST_F(FactorizationTest, binary_io_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string bin_path =
+        file_path.substr(0, file_path.rfind("/")) + "/factorization.bin.tem";
+
+    matrix::LDLTFactorization F("U", A_sym);
+    matrix::write_factorization_to_binary(F, bin_path.c_str());
+    auto F_read = matrix::read_factorization_from_binary(bin_path.c_str());
+    std::remove(bin_path.c_str());
+
+    EXPECT_EQ(F_read->type(), matrix::Factorization::kLDLT);
+    EXPECT_EQ(F_read->uplo(), "U");
+    EXPECT_TRUE(F_read->factor().is_equal_to(F.factor(), 0.0));
+    EXPECT_EQ(F_read->pivots(), F.pivots());
+    verify(*F_read, A_sym);
+}
+
+TEST_F(FactorizationTest, binary_io_tampered_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string bin_path = file_path.substr(0, file_path.rfind("/")) +
+                           "/factorization_tampered.bin.tem";
+
+    matrix::LUFactorization F(A_gen);
+    matrix::write_factorization_to_binary(F, bin_path.c_str());
+    auto mat = matrix::read_matrices_from_binary(bin_path.c_str());
+    std::vector<std::shared_ptr<const Matrix>> tampered(mat.begin(), mat.end());
+
+    // pivots out of range, not integers or not finite, and unknown type.
+    const double pivots[] = {0.0, 41.0, -1.0, 1.5, std::nan(""), 1e300};
+    for (double p : pivots) {
+        const double old = mat[2]->data()[3];
+        mat[2]->data()[3] = p;
+        matrix::write_matrices_to_binary(tampered, bin_path.c_str());
+        EXPECT_THROW(matrix::read_factorization_from_binary(bin_path.c_str()),
+                     matrix::exception::MatrixIOException);
+        mat[2]->data()[3] = old;
+    }
+    (*mat[0])(0, 0) = 7;
+    matrix::write_matrices_to_binary(tampered, bin_path.c_str());
+    EXPECT_THROW(matrix::read_factorization_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+    std::remove(bin_path.c_str());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+using std::string;
+using std::vector;
+
+/**
+ * test the built-in dgemm engine against Eigen with all the microkernels
+ * supported by the CPU.
+ */
+struct GemmEngineTest: public ::testing::Test {
+    string default_engine;
+    vector<string> engines;
+
+    virtual void SetUp() override
+    {
+        default_engine = matrix::get_dgemm_engine();
+        for (auto e :
+             {"internal-generic", "internal-avx2", "internal-avx512"}) {
+            try {
+                matrix::set_dgemm_engine(e);
+                engines.push_back(e);
+            } catch (matrix::exception::MatrixException &) {
+            }
+        }
+    }
+
+    virtual void TearDown() override
+    {
+        matrix::set_dgemm_engine(default_engine);
+    }
+};
+
+/**
+ * C = alpha * op(A) * op(B) + beta * C with op(A): m x k, op(B): k x n.
+ */
+static void check_dgemm(size_t m, size_t n, size_t k, const string &op_A,
+                        const string &op_B, double alpha, double beta)
+{
+    Matrix A = (op_A == "N" ? Matrix(m, k) : Matrix(k, m));
+    Matrix B = (op_B == "N" ? Matrix(k, n) : Matrix(n, k));
+    Matrix C(m, n);
+    A.randomize(-1, 1);
+    B.randomize(-1, 1);
+    C.randomize(-1, 1);
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    if (op_A == "T")
+        A_mxd.transposeInPlace();
+    if (op_B == "T")
+        B_mxd.transposeInPlace();
+    MatrixXd ref = alpha * A_mxd * B_mxd + beta * Matrix_to_MatrixXd(C);
+
+    mult_dgemm(alpha, A, op_A, B, op_B, beta, C);
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10))
+        << matrix::get_dgemm_engine() << ": m=" << m << ", n=" << n
+        << ", k=" << k << ", op_A=" << op_A << ", op_B=" << op_B;
+}
+
+TEST_F(GemmEngineTest, engine_selection_test)
+{
+    EXPECT_FALSE(engines.empty());
+    matrix::set_dgemm_engine("blas");
+    EXPECT_EQ(matrix::get_dgemm_engine(), "blas");
+    matrix::set_dgemm_engine("internal");
+    EXPECT_EQ(matrix::get_dgemm_engine().substr(0, 9), "internal-");
+    EXPECT_THROW(matrix::set_dgemm_engine("unknown"),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(GemmEngineTest, dgemm_test)
+{
+    // dimensions across the register and cache blocking sizes.
+    const vector<vector<size_t>> dims = {
+        {1, 1, 1}, {7, 5, 3}, {24, 8, 16}, {33, 29, 300}, {150, 97, 270},
+        {5, 3100, 3}};
+    for (auto &e : engines) {
+        matrix::set_dgemm_engine(e);
+        for (auto &d : dims) {
+            for (auto op_A : {"N", "T"}) {
+                for (auto op_B : {"N", "T"}) {
+                    check_dgemm(d[0], d[1], d[2], op_A, op_B, 1.0, 0.0);
+                }
+            }
+            check_dgemm(d[0], d[1], d[2], "N", "T", -0.5, 2.0);
+        }
+    }
+}
+
+TEST_F(GemmEngineTest, zero_dimension_test)
+{
+    for (auto &e : engines) {
+        matrix::set_dgemm_engine(e);
+        Matrix A(4, 0);
+        Matrix B(0, 3);
+        Matrix C(4, 3);
+        C.fill_all(1.0);
+        mult_dgemm(1.0, A, "N", B, "N", 2.0, C);
+        for (size_t i = 0; i < C.size(); i++)
+            EXPECT_EQ(C.data()[i], 2.0);
+    }
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using matrix::Matrix;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct MatrixMapBinaryTest: public ::testing::Test {
+    string bin_path;
+    vector<shared_ptr<const Matrix>> mat;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        bin_path = file_path.substr(0, file_path.rfind("/")) + "/map.bin.tem";
+        for (auto dim : {vector<size_t>{3, 4}, vector<size_t>{0, 5},
+                         vector<size_t>{1, 1}, vector<size_t>{20, 30}}) {
+            auto A = std::make_shared<Matrix>(dim[0], dim[1]);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+        matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    }
+
+    virtual void TearDown() override { std::remove(bin_path.c_str()); }
+};
+
+TEST_F(MatrixMapBinaryTest, read_only_test)
+{
+    const vector<int> advices = {matrix::kMapNormal, matrix::kMapSequential,
+                                 matrix::kMapWillNeed | matrix::kMapHugePage};
+    for (int advice : advices) {
+        auto mapped =
+            matrix::map_matrices_from_binary(bin_path.c_str(), advice);
+        ASSERT_EQ(mapped.size(), mat.size());
+        for (size_t i = 0; i < mat.size(); i++) {
+            EXPECT_EQ(mapped[i]->row(), mat[i]->row());
+            EXPECT_EQ(mapped[i]->col(), mat[i]->col());
+            EXPECT_TRUE(mapped[i]->is_equal_to(*mat[i], 0.0));
+            if (mat[i]->size() != 0) {
+                EXPECT_TRUE(mapped[i]->is_data_stored_outside());
+            }
+        }
+    }
+}
+
+TEST_F(MatrixMapBinaryTest, lifetime_test)
+{
+    // the mapping is kept alive by the remaining matrix.
+    shared_ptr<const Matrix> last =
+        matrix::map_matrices_from_binary(bin_path.c_str()).back();
+    EXPECT_TRUE(last->is_equal_to(*mat.back(), 0.0));
+
+    // copies own their data.
+    Matrix copy = *last;
+    last.reset();
+    EXPECT_FALSE(copy.is_data_stored_outside());
+    EXPECT_TRUE(copy.is_equal_to(*mat.back(), 0.0));
+}
+
+TEST_F(MatrixMapBinaryTest, copy_on_write_test)
+{
+    auto mapped = matrix::map_matrices_from_binary_cow(bin_path.c_str());
+    ASSERT_EQ(mapped.size(), mat.size());
+    mapped[0]->fill_all(7.0);
+    mapped[3]->resize(2, 2);
+    EXPECT_FALSE(mapped[3]->is_data_stored_outside());
+
+    // the file is not changed.
+    auto reread = matrix::read_matrices_from_binary(bin_path.c_str());
+    for (size_t i = 0; i < mat.size(); i++) {
+        EXPECT_TRUE(reread[i]->is_equal_to(*mat[i], 0.0));
+    }
+}
+
+TEST_F(MatrixMapBinaryTest, exception_test)
+{
+    EXPECT_THROW(matrix::map_matrices_from_binary("not_exist.bin.tem"),
+                 matrix::exception::MatrixIOException);
+
+    // truncated file.
+    FILE *f = fopen(bin_path.c_str(), "wb");
+    size_t dim[2] = {100, 100};
+    fwrite(dim, sizeof(size_t), 2, f);
+    fclose(f);
+    EXPECT_THROW(matrix::map_matrices_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+}
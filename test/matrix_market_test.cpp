@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using matrix::Matrix;
+using std::string;
+
+struct MatrixMarketTest: public ::testing::Test {
+    string mtx_path;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        mtx_path =
+            file_path.substr(0, file_path.rfind("/")) + "/matrix.mtx.tem";
+    }
+
+    virtual void TearDown() override { std::remove(mtx_path.c_str()); }
+
+    void write_text(const string &text)
+    {
+        std::ofstream out(mtx_path);
+        out << text;
+    }
+};
+
+TEST_F(MatrixMarketTest, round_trip_test)
+{
+    Matrix A(7, 5);
+    A.randomize(-1, 1);
+    A(2, 3) = 0.0;
+    A(6, 0) = 0.0;
+    Matrix S(6, 6);
+    S.randomize(-1, 1);
+    S(4, 1) = 0.0;
+    for (size_t i = 0; i < S.row(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            S(j, i) = S(i, j);
+        }
+    }
+    for (int format : {matrix::kMtxArray, matrix::kMtxCoordinate}) {
+        matrix::write_matrix_to_mtx(A, mtx_path, format);
+        EXPECT_TRUE(
+            matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(A, 0.0));
+        matrix::write_matrix_to_mtx(S, mtx_path, format, true);
+        EXPECT_TRUE(
+            matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(S, 0.0));
+    }
+    EXPECT_THROW(matrix::write_matrix_to_mtx(A, mtx_path, matrix::kMtxArray,
+                                             true),
+                 matrix::exception::DimensionError);
+
+    Matrix E(0, 3);
+    matrix::write_matrix_to_mtx(E, mtx_path);
+    auto B = matrix::read_matrix_from_mtx(mtx_path);
+    EXPECT_EQ(B->row(), 0);
+    EXPECT_EQ(B->col(), 3);
+}
+
+TEST_F(MatrixMarketTest, chunk_test)
+{
+    // the chunks split the long columns and span the short ones.
+    Matrix T(150001, 2);
+    T.randomize(-1, 1);
+    T(70000, 1) = 0.0;
+    Matrix S(400, 400);
+    S.randomize(-1, 1);
+    S.to_symmetric("L");
+    for (int format : {matrix::kMtxCoordinate, matrix::kMtxArray}) {
+        matrix::write_matrix_to_mtx(T, mtx_path, format);
+        EXPECT_TRUE(
+            matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(T, 0.0));
+        matrix::write_matrix_to_mtx(S, mtx_path, format, true);
+        EXPECT_TRUE(
+            matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(S, 0.0));
+    }
+}
+
+TEST_F(MatrixMarketTest, format_test)
+{
+    write_text("%%MatrixMarket matrix coordinate integer skew-symmetric\n"
+               "% a comment\n"
+               "\n"
+               "3 3 2\n"
+               "2 1 4\n"
+               "3 2   -5\r\n");
+    auto A = matrix::read_matrix_from_mtx(mtx_path);
+    Matrix expected(3, 3);
+    expected.fill_all(0.0);
+    expected(1, 0) = 4;
+    expected(0, 1) = -4;
+    expected(2, 1) = -5;
+    expected(1, 2) = 5;
+    EXPECT_TRUE(A->is_equal_to(expected, 0.0));
+
+    write_text("%%MatrixMarket matrix coordinate pattern general\n"
+               "2 3 2\n"
+               "1 3\n"
+               "2 1\n");
+    A = matrix::read_matrix_from_mtx(mtx_path);
+    EXPECT_EQ((*A)(0, 2), 1.0);
+    EXPECT_EQ((*A)(1, 0), 1.0);
+    EXPECT_EQ((*A)(0, 0), 0.0);
+
+    // the lower triangle column by column.
+    write_text("%%MatrixMarket matrix array real symmetric\n"
+               "2 2\n"
+               "1.5\n2.5\n"
+               "3.5");
+    A = matrix::read_matrix_from_mtx(mtx_path);
+    EXPECT_EQ((*A)(0, 0), 1.5);
+    EXPECT_EQ((*A)(1, 0), 2.5);
+    EXPECT_EQ((*A)(0, 1), 2.5);
+    EXPECT_EQ((*A)(1, 1), 3.5);
+}
+
+TEST_F(MatrixMarketTest, invalid_test)
+{
+    const string texts[] = {
+        // out of range.
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1.0\n",
+        // unmatched number of entries.
+        "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n",
+        "%%MatrixMarket matrix array real general\n1 2\n1\n2\n3\n",
+        // invalid value.
+        "%%MatrixMarket matrix array real general\n1 2\n1\nx\n",
+        // unsupported field and invalid banner.
+        "%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n",
+        "%%MatrixMarket tensor array real general\n1 1\n1\n",
+        "1 1\n1\n",
+    };
+    for (const auto &text : texts) {
+        write_text(text);
+        EXPECT_THROW(matrix::read_matrix_from_mtx(mtx_path),
+                     matrix::exception::MatrixIOException);
+    }
+}
+
+TEST_F(MatrixMarketTest, sparse_test)
+{
+    Matrix S(300, 300);
+    S.randomize(-1, 1);
+    for (size_t i = 0; i < S.row(); i++) {
+        for (size_t j = 0; j < S.col(); j++) {
+            if ((i * 7 + j * 3) % 5 != 0) {
+                S(i, j) = 0.0;
+            }
+        }
+    }
+    S.to_symmetric("L");
+    for (int format : {matrix::kMtxCoordinate, matrix::kMtxArray}) {
+        matrix::write_matrix_to_mtx(S, mtx_path, format, true);
+        auto A = matrix::read_sparse_matrix_from_mtx(mtx_path);
+        EXPECT_EQ(A->nnz(), matrix::SparseMatrix(S).nnz());
+        EXPECT_TRUE(A->to_matrix().is_equal_to(S, 0.0));
+    }
+
+    // the explicit zeros are kept, and the duplicated entries are summed up.
+    write_text("%%MatrixMarket matrix coordinate real skew-symmetric\n"
+               "3 3 3\n"
+               "2 1 4\n"
+               "3 1 0\n"
+               "2 1 1\n");
+    auto A = matrix::read_sparse_matrix_from_mtx(mtx_path);
+    EXPECT_EQ(A->nnz(), 4);
+    Matrix expected(3, 3);
+    expected.fill_all(0.0);
+    expected(1, 0) = 5;
+    expected(0, 1) = -5;
+    EXPECT_TRUE(A->to_matrix().is_equal_to(expected, 0.0));
+    EXPECT_TRUE(matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(expected,
+                                                                    0.0));
+
+    // a symmetric file listing both (i, j) and (j, i) is read the same.
+    write_text("%%MatrixMarket matrix coordinate real symmetric\n"
+               "2 2 3\n"
+               "2 1 1.5\n"
+               "1 2 2\n"
+               "2 2 3\n");
+    expected = Matrix(2, 2);
+    expected(0, 0) = 0;
+    expected(1, 0) = 3.5;
+    expected(0, 1) = 3.5;
+    expected(1, 1) = 3;
+    EXPECT_TRUE(matrix::read_sparse_matrix_from_mtx(mtx_path)
+                    ->to_matrix()
+                    .is_equal_to(expected, 0.0));
+    EXPECT_TRUE(matrix::read_matrix_from_mtx(mtx_path)->is_equal_to(expected,
+                                                                    0.0));
+
+    const string texts[] = {
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1.0\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n",
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 x\n",
+    };
+    for (const auto &text : texts) {
+        write_text(text);
+        EXPECT_THROW(matrix::read_sparse_matrix_from_mtx(mtx_path),
+                     matrix::exception::MatrixIOException);
+    }
+}
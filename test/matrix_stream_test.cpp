@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using matrix::Matrix;
+using matrix::MatrixStreamReader;
+using matrix::MatrixStreamWriter;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct MatrixStreamTest: public ::testing::Test {
+    string bin_path;
+    vector<shared_ptr<const Matrix>> mat;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        bin_path = file_path.substr(0, file_path.rfind("/")) +
+                   "/matrix_stream.bin.tem";
+        for (size_t i = 0; i < 9; i++) {
+            auto A = std::make_shared<Matrix>(i * 7 % 5, i + 3);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+    }
+
+    virtual void TearDown() override { std::remove(bin_path.c_str()); }
+
+    void check_stream(size_t buffers)
+    {
+        MatrixStreamReader stream(bin_path, buffers);
+        size_t i = 0;
+        while (Matrix *A = stream.next()) {
+            ASSERT_LT(i, mat.size());
+            EXPECT_TRUE(A->is_equal_to(*mat[i], 0.0));
+            // the returned matrix can be modified.
+            A->scale(2.0);
+            i++;
+        }
+        EXPECT_EQ(i, mat.size());
+        EXPECT_EQ(stream.count(), mat.size());
+        EXPECT_EQ(stream.next(), nullptr);
+    }
+};
+
+TEST_F(MatrixStreamTest, binary_test)
+{
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    for (size_t buffers : {2, 3, 16}) {
+        check_stream(buffers);
+    }
+    EXPECT_THROW(MatrixStreamReader stream(bin_path, 1),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(MatrixStreamTest, container_test)
+{
+    matrix::write_matrices_to_container(mat, bin_path);
+    for (size_t buffers : {2, 5}) {
+        check_stream(buffers);
+    }
+}
+
+TEST_F(MatrixStreamTest, truncated_file_test)
+{
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    // cut the last matrix in half.
+    const size_t last = mat.back()->size() * sizeof(double);
+    FILE *f = fopen(bin_path.c_str(), "rb");
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fclose(f);
+    ASSERT_EQ(truncate(bin_path.c_str(), size - last / 2), 0);
+
+    MatrixStreamReader stream(bin_path);
+    for (size_t i = 0; i + 1 < mat.size(); i++) {
+        ASSERT_NE(stream.next(), nullptr);
+    }
+    EXPECT_THROW(stream.next(), matrix::exception::MatrixIOException);
+    EXPECT_EQ(stream.next(), nullptr);
+}
+
+TEST_F(MatrixStreamTest, early_destruction_test)
+{
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    // the background read is stopped when the reader is destroyed.
+    MatrixStreamReader stream(bin_path);
+    EXPECT_TRUE(stream.next()->is_equal_to(*mat[0], 0.0));
+}
+
+TEST_F(MatrixStreamTest, writer_test)
+{
+    for (size_t buffers : {2, 4}) {
+        MatrixStreamWriter writer(bin_path, buffers);
+        Matrix A;
+        for (size_t i = 0; i < mat.size(); i++) {
+            if (i % 3 == 0) {
+                writer.write(mat[i]);
+            } else {
+                // the snapshot is taken before the matrix is modified.
+                A = *mat[i];
+                writer.write(A);
+                A.randomize(-1, 1);
+            }
+            if (i == 4) {
+                writer.flush(true);
+            }
+        }
+        writer.close();
+        EXPECT_THROW(writer.write(A), matrix::exception::MatrixIOException);
+
+        auto read = matrix::read_matrices_from_binary(bin_path.c_str());
+        ASSERT_EQ(read.size(), mat.size());
+        for (size_t i = 0; i < mat.size(); i++) {
+            EXPECT_TRUE(read[i]->is_equal_to(*mat[i], 0.0));
+        }
+    }
+}
+
+TEST_F(MatrixStreamTest, writer_error_test)
+{
+    if (access("/dev/full", W_OK) != 0) {
+        return;
+    }
+    MatrixStreamWriter writer("/dev/full");
+    writer.write(*mat[1]);
+    EXPECT_THROW(writer.flush(), matrix::exception::MatrixIOException);
+    EXPECT_THROW(writer.write(*mat[2]), matrix::exception::MatrixIOException);
+    EXPECT_THROW(writer.close(), matrix::exception::MatrixIOException);
+}
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <matrix/matrix.h>
 #include <memory>
 #include <stdio.h>
@@ -43,3 +46,102 @@ TEST(MatrixWriteReadTxtTest, write_read_pair_test)
         EXPECT_TRUE(status);
     }
 }
+
+TEST(MatrixWriteReadTxtTest, round_trip_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string txt_path =
+        file_path.substr(0, file_path.rfind("/")) + "/round_trip.csv.tem";
+    std::vector<std::shared_ptr<Matrix>> mat;
+    for (size_t n : {0, 1, 7, 300}) {
+        mat.push_back(std::make_shared<Matrix>(n, 3));
+        mat.back()->randomize(-1, 1);
+    }
+    // values of all the magnitudes, including subnormal numbers.
+    double *data = mat[3]->data();
+    for (size_t i = 0; i < mat[3]->size(); i++) {
+        data[i] = std::ldexp(data[i], static_cast<int>(i * 7 % 2150) - 1075);
+    }
+    data[0] = 0.0;
+    data[1] = -0.0;
+    data[2] = std::numeric_limits<double>::max();
+    data[3] = std::numeric_limits<double>::denorm_min();
+    data[4] = std::numeric_limits<double>::infinity();
+
+    for (size_t num_per_line :
+         {size_t(0), size_t(1), size_t(5), size_t(1000), SIZE_MAX}) {
+        for (matrix::TxtFormat format :
+             {matrix::kTxtScientific, matrix::kTxtShortest}) {
+            matrix::write_matrices_to_txt(mat, txt_path, num_per_line, format);
+            if (num_per_line == SIZE_MAX) {
+                // each matrix is on a single line after its dimension.
+                FILE *f = fopen(txt_path.c_str(), "r");
+                size_t lines = 0;
+                for (int c = fgetc(f); c != EOF; c = fgetc(f)) {
+                    lines += c == '\n';
+                }
+                fclose(f);
+                EXPECT_EQ(lines, 2 * mat.size() - 1);
+            }
+            auto mat_read = matrix::read_matrices_from_txt(txt_path);
+            ASSERT_EQ(mat_read.size(), mat.size());
+            for (size_t i = 0; i < mat.size(); i++) {
+                ASSERT_EQ(mat_read[i]->row(), mat[i]->row());
+                ASSERT_EQ(mat_read[i]->col(), mat[i]->col());
+                EXPECT_EQ(memcmp(mat_read[i]->data(), mat[i]->data(),
+                                 mat[i]->size() * sizeof(double)),
+                          0);
+            }
+        }
+    }
+    remove(txt_path.c_str());
+}
+
+TEST(MatrixWriteReadTxtTest, shortest_format_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string txt_path =
+        file_path.substr(0, file_path.rfind("/")) + "/shortest.csv.tem";
+    std::vector<std::shared_ptr<Matrix>> mat;
+    mat.push_back(std::make_shared<Matrix>(2, 4));
+    *mat[0] = {0.1, -25.0, 1.5e-7, 1e300, 0.0, 123.456, 1e-5, 5e-324};
+    mat.push_back(std::make_shared<Matrix>(1, 1));
+    *mat[1] = {-0.0};
+    matrix::write_matrices_to_txt(mat, txt_path, 3, matrix::kTxtShortest);
+
+    FILE *f = fopen(txt_path.c_str(), "r");
+    char text[256] = {0};
+    fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    EXPECT_STREQ(text, "Dimension,2,4\n0.1,-25,1.5e-7,1e300\n0,123.456,"
+                       "0.00001,5e-324\nDimension,1,1\n-0");
+    remove(txt_path.c_str());
+}
+
+TEST(MatrixWriteReadTxtTest, invalid_txt_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string txt_path =
+        file_path.substr(0, file_path.rfind("/")) + "/invalid.csv.tem";
+    auto read = [&](const char *text) {
+        FILE *f = fopen(txt_path.c_str(), "w");
+        fputs(text, f);
+        fclose(f);
+        return matrix::read_matrices_from_txt(txt_path);
+    };
+    auto mat = read("Dimension,1,2\r\n1.5, -2e-3\n\nDimension,1,1\n4\n");
+    ASSERT_EQ(mat.size(), 2u);
+    EXPECT_EQ((*mat[0])(0, 1), -2e-3);
+    EXPECT_EQ((*mat[1])(0, 0), 4.0);
+    EXPECT_TRUE(read("").empty());
+
+    for (const char *text :
+         {"1,2\n", "Dimension,1\n1\n", "Dimension,-1,1\n1\n",
+          "Dimension,1,2\n1\n", "Dimension,1,2\n1,2,3\n",
+          "Dimension,1,2\n1,,2\n", "Dimension,1,2\n1,2x\n",
+          "Dimension,1,1\n1\nDimension,1,2\n1\n"}) {
+        EXPECT_THROW(read(text), matrix::exception::MatrixIOException)
+            << text;
+    }
+    remove(txt_path.c_str());
+}
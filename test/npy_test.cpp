@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using matrix::Matrix;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct NpyTest: public ::testing::Test {
+    string npy_path;
+    string npz_path;
+    vector<shared_ptr<const Matrix>> mat;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        string dir = file_path.substr(0, file_path.rfind("/"));
+        npy_path = dir + "/matrix.npy.tem";
+        npz_path = dir + "/matrix.npz.tem";
+        for (auto dim : {vector<size_t>{3, 4}, vector<size_t>{0, 5},
+                         vector<size_t>{1, 1}, vector<size_t>{20, 30}}) {
+            auto A = std::make_shared<Matrix>(dim[0], dim[1]);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+    }
+
+    virtual void TearDown() override
+    {
+        std::remove(npy_path.c_str());
+        std::remove(npz_path.c_str());
+    }
+
+    /**
+     * @brief Write a npy file with a given header dictionary and data.
+     */
+    void write_npy(const string &dict, const string &data)
+    {
+        string header = dict;
+        while ((10 + header.size() + 1) % 64 != 0) {
+            header += ' ';
+        }
+        header += '\n';
+        std::ofstream out(npy_path, std::ios::binary);
+        out.write("\x93NUMPY\x01\x00", 8);
+        const char size[2] = {static_cast<char>(header.size() & 0xff),
+                              static_cast<char>(header.size() >> 8)};
+        out.write(size, 2);
+        out << header << data;
+    }
+};
+
+TEST_F(NpyTest, npy_round_trip_test)
+{
+    for (auto &A : mat) {
+        matrix::write_matrix_to_npy(*A, npy_path);
+        auto B = matrix::read_matrix_from_npy(npy_path);
+        EXPECT_EQ(B->row(), A->row());
+        EXPECT_EQ(B->col(), A->col());
+        EXPECT_TRUE(B->is_equal_to(*A, 0.0));
+        if (A->size() != 0) {
+            // float64 in C order is not copied.
+            EXPECT_TRUE(B->is_data_stored_outside());
+        }
+        // the file is not changed by the matrix.
+        B->fill_all(1.0);
+        EXPECT_TRUE(matrix::read_matrix_from_npy(npy_path)->is_equal_to(
+            *A, 0.0));
+    }
+}
+
+TEST_F(NpyTest, npz_round_trip_test)
+{
+    vector<string> names;
+    matrix::write_matrices_to_npz(mat, npz_path);
+    auto rst = matrix::read_matrices_from_npz(npz_path, &names);
+    ASSERT_EQ(rst.size(), mat.size());
+    for (size_t i = 0; i < mat.size(); i++) {
+        EXPECT_EQ(names[i], "arr_" + std::to_string(i));
+        EXPECT_TRUE(rst[i]->is_equal_to(*mat[i], 0.0));
+        if (mat[i]->size() != 0) {
+            EXPECT_TRUE(rst[i]->is_data_stored_outside());
+        }
+    }
+
+    const vector<string> given = {"a", "b", "density", "fock"};
+    matrix::write_matrices_to_npz(mat, npz_path, given);
+    rst = matrix::read_matrices_from_npz(npz_path, &names);
+    EXPECT_EQ(names, given);
+    ASSERT_EQ(rst.size(), mat.size());
+    for (size_t i = 0; i < mat.size(); i++) {
+        EXPECT_TRUE(rst[i]->is_equal_to(*mat[i], 0.0));
+    }
+
+    EXPECT_THROW(matrix::write_matrices_to_npz(mat, npz_path, {"a"}),
+                 matrix::exception::DimensionError);
+    EXPECT_THROW(
+        matrix::write_matrices_to_npz(mat, npz_path, {"a", "b", "a", "c"}),
+        matrix::exception::MatrixIOException);
+}
+
+TEST_F(NpyTest, conversion_test)
+{
+    // int32 in Fortran order: [[1, 2, 3], [4, 5, 6]].
+    const int32_t ints[] = {1, 4, 2, 5, 3, 6};
+    write_npy("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 3), }",
+              string(reinterpret_cast<const char *>(ints), sizeof(ints)));
+    auto A = matrix::read_matrix_from_npy(npy_path);
+    ASSERT_EQ(A->row(), 2);
+    ASSERT_EQ(A->col(), 3);
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            EXPECT_EQ((*A)(i, j), i * 3 + j + 1);
+        }
+    }
+    EXPECT_FALSE(A->is_data_stored_outside());
+
+    // big-endian float64 vector.
+    const unsigned char big[] = {0x3f, 0xf8, 0, 0, 0, 0, 0, 0,
+                                 0xc0, 0x04, 0, 0, 0, 0, 0, 0};
+    write_npy("{'descr': '>f8', 'fortran_order': False, 'shape': (2,), }",
+              string(reinterpret_cast<const char *>(big), sizeof(big)));
+    A = matrix::read_matrix_from_npy(npy_path);
+    ASSERT_EQ(A->row(), 1);
+    ASSERT_EQ(A->col(), 2);
+    EXPECT_EQ((*A)(0, 0), 1.5);
+    EXPECT_EQ((*A)(0, 1), -2.5);
+
+    // float32 scalar and bool matrix.
+    const float f = 0.25f;
+    write_npy("{'descr': '<f4', 'fortran_order': False, 'shape': (), }",
+              string(reinterpret_cast<const char *>(&f), sizeof(f)));
+    A = matrix::read_matrix_from_npy(npy_path);
+    ASSERT_EQ(A->size(), 1);
+    EXPECT_EQ((*A)(0, 0), 0.25);
+    write_npy("{'descr': '|b1', 'fortran_order': False, 'shape': (2, 2), }",
+              string("\x01\x00\x00\x01", 4));
+    A = matrix::read_matrix_from_npy(npy_path);
+    EXPECT_EQ((*A)(0, 0), 1.0);
+    EXPECT_EQ((*A)(0, 1), 0.0);
+    EXPECT_EQ((*A)(1, 0), 0.0);
+    EXPECT_EQ((*A)(1, 1), 1.0);
+}
+
+TEST_F(NpyTest, invalid_npy_test)
+{
+    const string data(8 * 8, '\0');
+    write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (2, 2, 2), }",
+              data);
+    EXPECT_THROW(matrix::read_matrix_from_npy(npy_path),
+                 matrix::exception::MatrixIOException);
+    write_npy("{'descr': '<c16', 'fortran_order': False, 'shape': (2,), }",
+              data);
+    EXPECT_THROW(matrix::read_matrix_from_npy(npy_path),
+                 matrix::exception::MatrixIOException);
+    // the data is truncated.
+    write_npy("{'descr': '<f8', 'fortran_order': False, 'shape': (3, 3), }",
+              data);
+    EXPECT_THROW(matrix::read_matrix_from_npy(npy_path),
+                 matrix::exception::MatrixIOException);
+    // a npy file is not a npz file.
+    EXPECT_THROW(matrix::read_matrices_from_npz(npy_path),
+                 matrix::exception::MatrixIOException);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using matrix::Matrix;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+struct ParallelIOTest: public ::testing::Test {
+    string bin_path;
+    vector<shared_ptr<const Matrix>> mat;
+    int num_threads;
+    size_t chunk_size;
+    bool direct;
+
+    virtual void SetUp() override
+    {
+        string file_path = realpath(__FILE__, NULL);
+        bin_path = file_path.substr(0, file_path.rfind("/")) +
+                   "/parallel_io.bin.tem";
+        // sizes which are not multiples of the chunk size or the blocks.
+        const size_t dims[][2] = {{3, 5}, {301, 77}, {1, 1}, {513, 129}};
+        for (auto &dim : dims) {
+            auto A = std::make_shared<Matrix>(dim[0], dim[1]);
+            A->randomize(-1, 1);
+            mat.push_back(A);
+        }
+        num_threads = matrix::get_io_num_threads();
+        chunk_size = matrix::get_io_chunk_size();
+        direct = matrix::get_io_direct();
+    }
+
+    virtual void TearDown() override
+    {
+        std::remove(bin_path.c_str());
+        matrix::set_io_num_threads(0);
+        matrix::set_io_chunk_size(chunk_size);
+        matrix::set_io_direct(direct);
+    }
+
+    void check_equal(const vector<shared_ptr<Matrix>> &rst)
+    {
+        ASSERT_EQ(rst.size(), mat.size());
+        for (size_t i = 0; i < mat.size(); i++) {
+            EXPECT_TRUE(rst[i]->is_equal_to(*mat[i], 0.0));
+        }
+    }
+
+    void check_round_trip()
+    {
+        matrix::write_matrices_to_binary(mat, bin_path.c_str());
+        check_equal(matrix::read_matrices_from_binary(bin_path.c_str()));
+
+        vector<shared_ptr<Matrix>> rst;
+        for (auto &A : mat) {
+            rst.push_back(std::make_shared<Matrix>(A->row(), A->col()));
+        }
+        matrix::read_matrices_from_binary(rst, bin_path.c_str());
+        check_equal(rst);
+
+        matrix::write_matrices_to_container(mat, bin_path);
+        check_equal(matrix::read_matrices_from_binary(bin_path.c_str()));
+    }
+};
+
+TEST_F(ParallelIOTest, settings_test)
+{
+    matrix::set_io_chunk_size(5000);
+    EXPECT_EQ(matrix::get_io_chunk_size(), 8192);
+    matrix::set_io_chunk_size(0);
+    EXPECT_EQ(matrix::get_io_chunk_size(), 4096);
+    matrix::set_io_num_threads(3);
+    EXPECT_EQ(matrix::get_io_num_threads(), 3);
+    matrix::set_io_num_threads(0);
+    EXPECT_GE(matrix::get_io_num_threads(), 1);
+    matrix::set_io_direct(true);
+    EXPECT_TRUE(matrix::get_io_direct());
+}
+
+TEST_F(ParallelIOTest, round_trip_test)
+{
+    matrix::set_io_chunk_size(4096);
+    for (int threads : {1, 4}) {
+        for (bool direct : {false, true}) {
+            matrix::set_io_num_threads(threads);
+            matrix::set_io_direct(direct);
+            check_round_trip();
+        }
+    }
+}
+
+TEST_F(ParallelIOTest, truncated_file_test)
+{
+    matrix::set_io_chunk_size(4096);
+    matrix::set_io_num_threads(4);
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    ASSERT_EQ(truncate(bin_path.c_str(), 100000), 0);
+    EXPECT_THROW(matrix::read_matrices_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+}
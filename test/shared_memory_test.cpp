@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using matrix::Matrix;
+using matrix::SharedMatrixStore;
+using std::string;
+
+struct SharedMemoryTest: public ::testing::Test {
+    std::unique_ptr<SharedMatrixStore> store;
+    string prefix;
+
+    virtual void SetUp() override
+    {
+        prefix = "matrix_test_" + std::to_string(getpid());
+        store.reset(new SharedMatrixStore(prefix));
+    }
+
+    virtual void TearDown() override
+    {
+        for (auto name : {"A", "B", "E"}) {
+            store->remove(name);
+        }
+    }
+};
+
+TEST_F(SharedMemoryTest, publish_attach_test)
+{
+    Matrix A(300, 200);
+    A.randomize(-1, 1);
+    auto P = store->publish("A", A);
+    EXPECT_TRUE(P->is_data_stored_outside());
+    EXPECT_TRUE(P->is_equal_to(A, 0.0));
+    EXPECT_TRUE(store->contains("A"));
+    EXPECT_EQ(store->ref_count("A"), 1);
+    EXPECT_THROW(store->publish("A", A), matrix::exception::MatrixIOException);
+
+    {
+        auto B = store->attach("A");
+        EXPECT_EQ(store->ref_count("A"), 2);
+        EXPECT_EQ(B->row(), 300);
+        EXPECT_EQ(B->col(), 200);
+        EXPECT_TRUE(B->is_equal_to(A, 0.0));
+    }
+    EXPECT_EQ(store->ref_count("A"), 1);
+
+    // the segment is unlinked with the last reference.
+    P.reset();
+    EXPECT_FALSE(store->contains("A"));
+    EXPECT_EQ(store->ref_count("A"), 0);
+    EXPECT_THROW(store->attach("A"), matrix::exception::MatrixIOException);
+
+    Matrix E(0, 5);
+    auto Q = store->publish("E", E);
+    EXPECT_EQ(store->attach("E")->col(), 5);
+}
+
+TEST_F(SharedMemoryTest, persistent_test)
+{
+    Matrix A(10, 10);
+    A.randomize(-1, 1);
+    store->publish("A", A, true);
+    EXPECT_TRUE(store->contains("A"));
+    EXPECT_EQ(store->ref_count("A"), 0);
+    auto B = store->attach("A");
+    EXPECT_TRUE(B->is_equal_to(A, 0.0));
+
+    // the attached matrix stays valid after the segment is removed.
+    EXPECT_TRUE(store->remove("A"));
+    EXPECT_FALSE(store->remove("A"));
+    EXPECT_FALSE(store->contains("A"));
+    EXPECT_TRUE(B->is_equal_to(A, 0.0));
+    EXPECT_THROW(SharedMatrixStore("a/b"), matrix::exception::MatrixException);
+}
+
+TEST_F(SharedMemoryTest, corrupted_header_test)
+{
+    Matrix A(30, 20);
+    A.randomize(-1, 1);
+    auto P = store->publish("A", A);
+
+    // the data offset is at byte 40 of the segment header.
+    int fd = shm_open(("/" + prefix + ".A").c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void *addr =
+        mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(addr, MAP_FAILED);
+    uint64_t *offset = reinterpret_cast<uint64_t *>((char *)addr + 40);
+    const uint64_t old = *offset;
+    for (uint64_t bad : {old + (1 << 20), old - 8, (uint64_t)0}) {
+        *offset = bad;
+        EXPECT_THROW(store->attach("A"), matrix::exception::MatrixIOException);
+    }
+    *offset = old;
+    EXPECT_TRUE(store->attach("A")->is_equal_to(A, 0.0));
+    munmap(addr, sysconf(_SC_PAGESIZE));
+}
+
+TEST_F(SharedMemoryTest, multi_process_test)
+{
+    Matrix A(64, 100);
+    A.randomize(-1, 1);
+    auto P = store->publish("A", A);
+
+    const int nproc = 3;
+    for (int i = 0; i < nproc; i++) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            bool equal = store->attach("A")->is_equal_to(A, 0.0);
+            _exit(equal ? 0 : 1);
+        }
+    }
+    for (int i = 0; i < nproc; i++) {
+        int status = 0;
+        ASSERT_GT(wait(&status), 0);
+        EXPECT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+    EXPECT_EQ(store->ref_count("A"), 1);
+}
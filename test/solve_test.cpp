@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <vector>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+
+/**
+ * test functions to solve linear systems.
+ */
+struct SolveTest: public ::testing::Test {
+    Matrix A_gen;
+    Matrix A_sym;
+    Matrix A_spd;
+    Matrix B;
+    Matrix b;
+
+    virtual void SetUp() override
+    {
+        const size_t n = 50;
+        A_gen.resize(n, n);
+        A_gen.randomize(-1, 1);
+        for (size_t i = 0; i < n; i++)
+            A_gen(i, i) += n;
+
+        A_sym.resize(n, n);
+        A_sym.randomize(-1, 1);
+        A_sym.to_symmetric("L");
+
+        // spd matrix: A_gen * A_gen^T is positive definite.
+        A_spd.resize(n, n);
+        mult_dgemm(1.0, A_gen, "N", A_gen, "T", 0.0, A_spd);
+
+        B.resize(n, 7);
+        B.randomize(-1, 1);
+        b.resize(n, 1);
+        b.randomize(-1, 1);
+    }
+
+    virtual void TearDown() override {}
+};
+
+TEST_F(SolveTest, general_matrix_dgetrs_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A_gen);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    MatrixXd b_mxd = Matrix_to_MatrixXd(b);
+    MatrixXd X_ref = A_mxd.partialPivLu().solve(B_mxd);
+    MatrixXd x_ref = A_mxd.partialPivLu().solve(b_mxd);
+
+    Matrix A = A_gen;
+    Matrix X = B;
+    matrix::solve_gen_matrix_dgetrs(A, X);
+    EXPECT_TRUE(X.is_equal_to(MatrixXd_to_Matrix(X_ref), 1e-10));
+
+    A = A_gen;
+    Matrix x = b;
+    matrix::solve_gen_matrix_dgetrs(A, x);
+    EXPECT_TRUE(x.is_equal_to(MatrixXd_to_Matrix(x_ref), 1e-10));
+}
+
+TEST_F(SolveTest, spd_matrix_dpotrs_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A_spd);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    MatrixXd X_mxd = A_mxd.llt().solve(B_mxd);
+    Matrix X_ref = MatrixXd_to_Matrix(X_mxd);
+
+    Matrix A = A_spd;
+    A(1, 0) = 999;
+    Matrix X = B;
+    matrix::solve_spd_matrix_dpotrs("U", A, X);
+    EXPECT_TRUE(X.is_equal_to(X_ref, 1e-10));
+
+    A = A_spd;
+    A(0, 1) = 999;
+    X = B;
+    matrix::solve_spd_matrix_dpotrs("L", A, X);
+    EXPECT_TRUE(X.is_equal_to(X_ref, 1e-10));
+
+    // indefinite matrix cannot be solved by Cholesky factorization.
+    A = A_spd;
+    A.scale(-1.0);
+    X = B;
+    EXPECT_THROW(matrix::solve_spd_matrix_dpotrs("U", A, X),
+                 matrix::exception::MatrixOperationError);
+}
+
+TEST_F(SolveTest, symmetric_matrix_dsytrs_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A_sym);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    MatrixXd X_mxd = A_mxd.fullPivLu().solve(B_mxd);
+    Matrix X_ref = MatrixXd_to_Matrix(X_mxd);
+
+    Matrix A = A_sym;
+    A(1, 0) = 999;
+    Matrix X = B;
+    matrix::solve_sym_matrix_dsytrs("U", A, X);
+    EXPECT_TRUE(X.is_equal_to(X_ref, 1e-8));
+
+    A = A_sym;
+    A(0, 1) = 999;
+    X = B;
+    matrix::solve_sym_matrix_dsytrs("L", A, X);
+    EXPECT_TRUE(X.is_equal_to(X_ref, 1e-8));
+}
+
+TEST_F(SolveTest, dimension_check_test)
+{
+    Matrix A = A_gen;
+    Matrix X(A.row() + 1, 2);
+    EXPECT_THROW(matrix::solve_gen_matrix_dgetrs(A, X),
+                 matrix::exception::DimensionError);
+    EXPECT_THROW(matrix::solve_gen_matrix_dgetrs(A, A),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(SolveTest, triangular_dtrmm_dtrsm_test)
+{
+    const size_t n = A_gen.row();
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A_gen);
+    MatrixXd U_mxd = A_mxd.triangularView<Eigen::Upper>();
+    MatrixXd L_mxd = A_mxd.triangularView<Eigen::UnitLower>();
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    Matrix BT = B;
+    BT.transpose();
+    MatrixXd BT_mxd = Matrix_to_MatrixXd(BT);
+
+    // B = 2 * U * B
+    Matrix X = B;
+    matrix::mult_dtrmm("L", "U", "N", "N", 2.0, A_gen, X);
+    MatrixXd ref = 2.0 * U_mxd * B_mxd;
+    EXPECT_TRUE(X.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    // B^T = B^T * L^T, with unit diagonal.
+    X = BT;
+    matrix::mult_dtrmm("R", "L", "T", "U", 1.0, A_gen, X);
+    ref = BT_mxd * L_mxd.transpose();
+    EXPECT_TRUE(X.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    // U^T * X = B
+    X = B;
+    matrix::solve_tri_matrix_dtrsm("L", "U", "T", "N", 1.0, A_gen, X);
+    ref = U_mxd.transpose().triangularView<Eigen::Lower>().solve(B_mxd);
+    EXPECT_TRUE(X.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    // X * L = 3 * B^T, with unit diagonal.
+    X = BT;
+    matrix::solve_tri_matrix_dtrsm("R", "L", "N", "U", 3.0, A_gen, X);
+    ref = 3.0 * BT_mxd * L_mxd.inverse();
+    EXPECT_TRUE(X.is_equal_to(MatrixXd_to_Matrix(ref), 1e-8));
+    EXPECT_EQ(X.row(), B.col());
+    EXPECT_EQ(X.col(), n);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using matrix::Matrix;
+using matrix::SparseMatrix;
+using std::vector;
+
+struct SparseMatrixTest: public ::testing::Test {
+    /**
+     * @brief Get a random matrix with about \p density of the elements being
+     * nonzero.
+     */
+    Matrix sparse_matrix(size_t row, size_t col, double density)
+    {
+        Matrix A(row, col);
+        Matrix mask(row, col);
+        A.randomize(-1, 1);
+        mask.randomize(0, 1);
+        for (size_t i = 0; i < A.size(); i++) {
+            if (mask.data()[i] > density) {
+                A.data()[i] = 0.0;
+            }
+        }
+        return A;
+    }
+};
+
+TEST_F(SparseMatrixTest, conversion_test)
+{
+    Matrix A = sparse_matrix(13, 17, 0.2);
+    A(0, 0) = 1e-14;
+    SparseMatrix S(A, 1e-12);
+    A(0, 0) = 0.0;
+    EXPECT_TRUE(S.to_matrix().is_equal_to(A, 0.0));
+    EXPECT_EQ(S.row_ptr().back(), S.nnz());
+    for (size_t i = 0; i < A.row(); i++) {
+        for (size_t j = 0; j < A.col(); j++) {
+            EXPECT_EQ(S(i, j), A(i, j));
+        }
+    }
+
+    SparseMatrix T = S.transpose();
+    EXPECT_EQ(T.row(), A.col());
+    EXPECT_EQ(T.nnz(), S.nnz());
+    Matrix At = A;
+    At.transpose();
+    EXPECT_TRUE(T.to_matrix().is_equal_to(At, 0.0));
+
+    SparseMatrix C(S.row(), S.col(), S.row_ptr(), S.col_index(), S.values());
+    EXPECT_TRUE(C.to_matrix().is_equal_to(A, 0.0));
+    EXPECT_EQ(SparseMatrix(Matrix(0, 0)).nnz(), 0);
+
+    // non-finite elements are never dropped.
+    Matrix N(2, 3);
+    N.fill_all(0.0);
+    N(0, 2) = std::nan("");
+    N(1, 1) = -INFINITY;
+    SparseMatrix SN(N, 1.0);
+    EXPECT_EQ(SN.nnz(), 2);
+    EXPECT_TRUE(std::isnan(SN(0, 2)));
+    EXPECT_EQ(SN(1, 1), -INFINITY);
+
+    // invalid CSR arrays.
+    EXPECT_THROW(SparseMatrix(2, 2, {0, 1}, {0}, {1.0}),
+                 matrix::exception::MatrixException);
+    EXPECT_THROW(SparseMatrix(2, 2, {0, 2, 2}, {1, 0}, {1.0, 2.0}),
+                 matrix::exception::MatrixException);
+    EXPECT_THROW(SparseMatrix(2, 2, {0, 1, 1}, {2}, {1.0}),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(SparseMatrixTest, triplets_test)
+{
+    const vector<size_t> rows = {2, 0, 2, 1, 2, 0};
+    const vector<size_t> cols = {3, 1, 0, 2, 3, 1};
+    const vector<double> values = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    SparseMatrix S = SparseMatrix::from_triplets(3, 4, rows, cols, values);
+    EXPECT_EQ(S.nnz(), 4);
+    EXPECT_EQ(S(0, 1), 8.0);
+    EXPECT_EQ(S(1, 2), 4.0);
+    EXPECT_EQ(S(2, 0), 3.0);
+    EXPECT_EQ(S(2, 3), 6.0);
+    EXPECT_EQ(S(1, 1), 0.0);
+    EXPECT_EQ(S.col_index(), vector<size_t>({1, 2, 0, 3}));
+
+    EXPECT_THROW(SparseMatrix::from_triplets(3, 3, rows, cols, values),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(SparseMatrixTest, product_test)
+{
+    for (double density : {0.0, 0.05, 0.5}) {
+        Matrix A = sparse_matrix(67, 45, density);
+        SparseMatrix S(A);
+
+        Matrix x(45, 1);
+        x.randomize(-1, 1);
+        Matrix ref(67, 1);
+        ref.randomize(-1, 1);
+        vector<double> xv(x.data(), x.data() + x.size());
+        vector<double> y(ref.data(), ref.data() + ref.size());
+        matrix::mult_dgemm(2.0, A, "N", x, "N", 0.5, ref);
+        matrix::mult_spmv(2.0, S, xv, 0.5, y);
+        for (size_t i = 0; i < y.size(); i++) {
+            EXPECT_NEAR(y[i], ref.data()[i], 1e-12);
+        }
+
+        // the column blocks and the tails of the kernels.
+        for (size_t n : {1, 7, 16, 37}) {
+            Matrix B(45, n);
+            B.randomize(-1, 1);
+            Matrix C(67, n);
+            C.randomize(-1, 1);
+            Matrix D = C;
+            matrix::mult_dgemm(-1.0, A, "N", B, "N", 2.0, C);
+            matrix::mult_spmm(-1.0, S, B, 2.0, D);
+            EXPECT_TRUE(D.is_equal_to(C, 1e-12));
+
+            // C is not read if beta is 0.
+            D.fill_all(std::nan(""));
+            matrix::mult_dgemm(1.0, A, "N", B, "N", 0.0, C);
+            matrix::mult_spmm(1.0, S, B, 0.0, D);
+            EXPECT_TRUE(D.is_equal_to(C, 1e-12));
+        }
+    }
+
+    SparseMatrix S(3, 4);
+    vector<double> x(3), y(3);
+    EXPECT_THROW(matrix::mult_spmv(1.0, S, x, 0.0, y),
+                 matrix::exception::MatrixException);
+    Matrix B(4, 2), C(3, 3);
+    EXPECT_THROW(matrix::mult_spmm(1.0, S, B, 0.0, C),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(SparseMatrixTest, binary_io_test)
+{
+    std::string file_path = realpath(__FILE__, NULL);
+    std::string bin_path =
+        file_path.substr(0, file_path.rfind("/")) + "/sparse_matrix.bin.tem";
+
+    Matrix A = sparse_matrix(31, 19, 0.3);
+    SparseMatrix S(A);
+    matrix::write_sparse_matrix_to_binary(S, bin_path.c_str());
+    auto S_read = matrix::read_sparse_matrix_from_binary(bin_path.c_str());
+    EXPECT_EQ(S_read->row(), S.row());
+    EXPECT_EQ(S_read->col(), S.col());
+    EXPECT_EQ(S_read->row_ptr(), S.row_ptr());
+    EXPECT_EQ(S_read->col_index(), S.col_index());
+    EXPECT_TRUE(S_read->to_matrix().is_equal_to(A, 0.0));
+
+    // trailing bytes and an invalid CSR payload are rejected.
+    std::FILE *f = std::fopen(bin_path.c_str(), "ab");
+    std::fputc(0, f);
+    std::fclose(f);
+    EXPECT_THROW(matrix::read_sparse_matrix_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+    SparseMatrix T = SparseMatrix::from_triplets(3, 3, {0, 1}, {1, 2},
+                                                 {1.0, 2.0});
+    matrix::write_sparse_matrix_to_binary(T, bin_path.c_str());
+    f = std::fopen(bin_path.c_str(), "r+b");
+    // the column index of the first element, after the header and row_ptr.
+    std::fseek(f, 32 + 4 * 8, SEEK_SET);
+    const uint64_t bad = 3;
+    std::fwrite(&bad, sizeof(bad), 1, f);
+    std::fclose(f);
+    EXPECT_THROW(matrix::read_sparse_matrix_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+
+    // a dense matrix file is rejected.
+    vector<std::shared_ptr<const Matrix>> mat{std::make_shared<Matrix>(A)};
+    matrix::write_matrices_to_binary(mat, bin_path.c_str());
+    EXPECT_THROW(matrix::read_sparse_matrix_from_binary(bin_path.c_str()),
+                 matrix::exception::MatrixIOException);
+    std::remove(bin_path.c_str());
+}
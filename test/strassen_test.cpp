@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+using std::string;
+using std::vector;
+
+/**
+ * C = alpha * op(A) * op(B) + beta * C with op(A): m x k, op(B): k x n,
+ * calculated by mult_dgemm_fast() and compared with Eigen.
+ */
+static void check_dgemm_fast(size_t m, size_t n, size_t k, const string &op_A,
+                             const string &op_B, double alpha, double beta,
+                             size_t cutoff, size_t max_scratch = 0)
+{
+    Matrix A = (op_A == "N" ? Matrix(m, k) : Matrix(k, m));
+    Matrix B = (op_B == "N" ? Matrix(k, n) : Matrix(n, k));
+    Matrix C(m, n);
+    A.randomize(-1, 1);
+    B.randomize(-1, 1);
+    C.randomize(-1, 1);
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    if (op_A == "T")
+        A_mxd.transposeInPlace();
+    if (op_B == "T")
+        B_mxd.transposeInPlace();
+    MatrixXd ref = alpha * A_mxd * B_mxd + beta * Matrix_to_MatrixXd(C);
+
+    mult_dgemm_fast(alpha, A, op_A, B, op_B, beta, C, cutoff, max_scratch);
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-9))
+        << "m=" << m << ", n=" << n << ", k=" << k << ", op_A=" << op_A
+        << ", op_B=" << op_B << ", cutoff=" << cutoff;
+}
+
+TEST(mult_dgemm_fast, square_test)
+{
+    for (auto op_A : {"N", "T"}) {
+        for (auto op_B : {"N", "T"}) {
+            check_dgemm_fast(64, 64, 64, op_A, op_B, 1.0, 0.0, 8);
+            check_dgemm_fast(64, 64, 64, op_A, op_B, -0.5, 2.0, 16);
+        }
+    }
+}
+
+TEST(mult_dgemm_fast, odd_dimension_test)
+{
+    // odd dimensions at different levels of recursion.
+    const vector<vector<size_t>> dims = {
+        {33, 33, 33}, {45, 38, 51}, {50, 67, 41}, {7, 9, 11}};
+    for (auto &d : dims) {
+        for (auto op_A : {"N", "T"}) {
+            for (auto op_B : {"N", "T"}) {
+                check_dgemm_fast(d[0], d[1], d[2], op_A, op_B, 1.0, 0.0, 4);
+            }
+        }
+        check_dgemm_fast(d[0], d[1], d[2], "T", "N", 1.5, -1.0, 4);
+    }
+}
+
+TEST(mult_dgemm_fast, scratch_limit_test)
+{
+    // no recursion within the scratch memory, or below the cutoff.
+    check_dgemm_fast(40, 40, 40, "N", "N", 1.0, 0.0, 4, sizeof(double));
+    check_dgemm_fast(40, 40, 40, "N", "T", 1.0, 1.0, 4, 40 * 40);
+    check_dgemm_fast(40, 40, 40, "T", "N", 1.0, 0.0, 64);
+    // only the first levels of recursion.
+    check_dgemm_fast(64, 64, 64, "N", "N", 1.0, 0.0, 4,
+                     (32 * 32 * 2 + 16 * 16 * 2) * sizeof(double));
+}
+
+TEST(mult_dgemm_fast, exception_test)
+{
+    Matrix A(4, 3);
+    Matrix B(4, 3);
+    Matrix C(4, 4);
+    EXPECT_THROW(mult_dgemm_fast(1.0, A, "N", B, "N", 0.0, C),
+                 matrix::exception::DimensionError);
+    EXPECT_THROW(mult_dgemm_fast(1.0, A, "N", B, "X", 0.0, C),
+                 matrix::exception::MatrixException);
+    EXPECT_THROW(mult_dgemm_fast(1.0, C, "N", C, "N", 0.0, C),
+                 matrix::exception::MatrixException);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+
+/**
+ * test symmetry-exploiting matrix products: dsyrk, dsyr2k and dsymm.
+ */
+struct SymmProductsTest: public ::testing::Test {
+    Matrix A;
+    Matrix B;
+    Matrix S;
+    Matrix C;
+
+    virtual void SetUp() override
+    {
+        A.resize(30, 17);
+        A.randomize(-1, 1);
+        B.resize(30, 17);
+        B.randomize(-1, 1);
+        S.resize(30, 30);
+        S.randomize(-1, 1);
+        S.to_symmetric("L");
+        C.resize(30, 30);
+        C.randomize(-1, 1);
+        C.to_symmetric("U");
+    }
+
+    virtual void TearDown() override {}
+};
+
+TEST_F(SymmProductsTest, dsyrk_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd C_mxd = Matrix_to_MatrixXd(C);
+    for (auto uplo : {"U", "L"}) {
+        Matrix AAT = C;
+        matrix::mult_dsyrk(uplo, 2.0, A, "N", 0.5, AAT);
+        MatrixXd ref = 2.0 * A_mxd * A_mxd.transpose() + 0.5 * C_mxd;
+        EXPECT_TRUE(AAT.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+        Matrix ATA(A.col(), A.col());
+        matrix::mult_dsyrk(uplo, 1.0, A, "T", 0.0, ATA);
+        ref = A_mxd.transpose() * A_mxd;
+        EXPECT_TRUE(ATA.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    }
+
+    // only the requested triangular part is touched.
+    Matrix AAT(A.row(), A.row());
+    AAT.fill_all(7.0);
+    matrix::mult_dsyrk("U", 1.0, A, "N", 0.0, AAT, false);
+    MatrixXd ref = A_mxd * A_mxd.transpose();
+    for (size_t i = 0; i < AAT.row(); i++) {
+        for (size_t j = 0; j < AAT.col(); j++) {
+            if (j >= i)
+                EXPECT_NEAR(AAT(i, j), ref(i, j), 1e-10);
+            else
+                EXPECT_EQ(AAT(i, j), 7.0);
+        }
+    }
+
+    Matrix bad(A.col(), A.col());
+    EXPECT_THROW(matrix::mult_dsyrk("U", 1.0, A, "N", 0.0, bad),
+                 matrix::exception::DimensionError);
+    EXPECT_THROW(matrix::mult_dsyrk("X", 1.0, A, "T", 0.0, bad),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(SymmProductsTest, dsyr2k_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd B_mxd = Matrix_to_MatrixXd(B);
+    MatrixXd C_mxd = Matrix_to_MatrixXd(C);
+    for (auto uplo : {"U", "L"}) {
+        Matrix R = C;
+        matrix::mult_dsyr2k(uplo, 1.5, A, B, "N", -1.0, R);
+        MatrixXd ref = 1.5 * (A_mxd * B_mxd.transpose() +
+                              B_mxd * A_mxd.transpose()) -
+                       C_mxd;
+        EXPECT_TRUE(R.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+        Matrix RT(A.col(), A.col());
+        matrix::mult_dsyr2k(uplo, 1.0, A, B, "T", 0.0, RT);
+        ref = A_mxd.transpose() * B_mxd + B_mxd.transpose() * A_mxd;
+        EXPECT_TRUE(RT.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    }
+}
+
+TEST_F(SymmProductsTest, dsymm_test)
+{
+    MatrixXd S_mxd = Matrix_to_MatrixXd(S);
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+
+    // only the referred triangular part of S is kept.
+    Matrix S_upper = S;
+    Matrix S_lower = S;
+    for (size_t i = 0; i < S.row(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            S_upper(i, j) = 0.0;
+            S_lower(j, i) = 0.0;
+        }
+    }
+
+    Matrix SA(A.row(), A.col());
+    SA.fill_all(1.0);
+    matrix::mult_dsymm("L", "U", 2.0, S_upper, A, 1.0, SA);
+    MatrixXd ref = 2.0 * S_mxd * A_mxd + MatrixXd::Ones(A.row(), A.col());
+    EXPECT_TRUE(SA.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    Matrix AT = A;
+    AT.transpose();
+    Matrix ATS(AT.row(), AT.col());
+    matrix::mult_dsymm("R", "L", 1.0, S_lower, AT, 0.0, ATS);
+    ref = A_mxd.transpose() * S_mxd;
+    EXPECT_TRUE(ATS.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    EXPECT_THROW(matrix::mult_dsymm("R", "L", 1.0, S, A, 0.0, SA),
+                 matrix::exception::DimensionError);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using matrix::Matrix;
+using matrix::SymmetricMatrix;
+using std::string;
+using std::vector;
+
+struct SymmetricMatrixTest: public ::testing::Test {
+    const vector<SymmetricMatrix::Storage> storages = {
+        SymmetricMatrix::kRFP, SymmetricMatrix::kPacked};
+
+    /**
+     * @brief Get a random symmetric positive definite matrix.
+     */
+    Matrix spd_matrix(size_t n)
+    {
+        Matrix B(n, n);
+        B.randomize(-1, 1);
+        Matrix A(n, n);
+        matrix::mult_dsyrk("U", 1.0, B, "N", 0.0, A);
+        for (size_t i = 0; i < n; i++) {
+            A(i, i) += n;
+        }
+        return A;
+    }
+};
+
+TEST_F(SymmetricMatrixTest, storage_test)
+{
+    for (size_t n : {0, 1, 5, 6}) {
+        Matrix A(n, n);
+        A.randomize(-1, 1);
+        A.to_symmetric("L");
+        for (auto storage : storages) {
+            for (string uplo : {"U", "L"}) {
+                SymmetricMatrix S(A, storage, uplo);
+                EXPECT_EQ(S.size(), n * (n + 1) / 2);
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = 0; j < n; j++) {
+                        EXPECT_EQ(S(i, j), A(i, j));
+                    }
+                }
+                EXPECT_TRUE(S.to_matrix().is_equal_to(A, 0.0));
+                for (auto other : storages) {
+                    SymmetricMatrix T = S.to_storage(other);
+                    EXPECT_EQ(T.storage(), other);
+                    EXPECT_TRUE(T.to_matrix().is_equal_to(A, 0.0));
+                }
+            }
+        }
+    }
+
+    // only the given triangle is referred.
+    Matrix A(4, 4);
+    A.randomize(-1, 1);
+    SymmetricMatrix S(A, SymmetricMatrix::kRFP, "U");
+    S(3, 1) = 2.0;
+    EXPECT_EQ(S(1, 3), 2.0);
+    EXPECT_EQ(S(0, 2), A(0, 2));
+    EXPECT_EQ(S(2, 0), A(0, 2));
+    EXPECT_THROW(SymmetricMatrix(Matrix(2, 3)),
+                 matrix::exception::DimensionError);
+}
+
+TEST_F(SymmetricMatrixTest, invert_solve_test)
+{
+    for (size_t n : {7, 10}) {
+        const Matrix A = spd_matrix(n);
+        Matrix inv = A;
+        matrix::invert_spd_matrix_dpotri("L", inv);
+        Matrix B(n, 3);
+        B.randomize(-1, 1);
+        Matrix X = B;
+        Matrix A_copy = A;
+        matrix::solve_spd_matrix_dpotrs("L", A_copy, X);
+
+        for (auto storage : storages) {
+            SymmetricMatrix S(A, storage);
+            matrix::invert_spd_matrix_dpftri(S);
+            EXPECT_TRUE(S.to_matrix().is_equal_to(inv, 1e-10));
+
+            SymmetricMatrix T(A, storage, "U");
+            Matrix Y = B;
+            matrix::solve_spd_matrix_dpftrs(T, Y);
+            EXPECT_TRUE(Y.is_equal_to(X, 1e-10));
+        }
+    }
+
+    Matrix A(3, 3);
+    A.fill_all(0.0);
+    A(0, 0) = -1.0;
+    SymmetricMatrix S(A);
+    EXPECT_THROW(matrix::invert_spd_matrix_dpftri(S),
+                 matrix::exception::MatrixOperationError);
+}
+
+TEST_F(SymmetricMatrixTest, rank_k_update_test)
+{
+    for (string op : {"N", "T"}) {
+        for (auto storage : storages) {
+            Matrix A = op == "N" ? Matrix(9, 4) : Matrix(4, 9);
+            A.randomize(-1, 1);
+            Matrix C(9, 9);
+            C.randomize(-1, 1);
+            C.to_symmetric("U");
+            SymmetricMatrix S(C, storage);
+            matrix::mult_dsyrk("U", 0.5, A, op, 2.0, C);
+            matrix::mult_dsfrk(0.5, A, op, 2.0, S);
+            EXPECT_EQ(S.storage(), storage);
+            EXPECT_TRUE(S.to_matrix().is_equal_to(C, 1e-12));
+        }
+    }
+}
+
+TEST_F(SymmetricMatrixTest, diagonalize_test)
+{
+    const size_t n = 12;
+    Matrix A(n, n);
+    A.randomize(-1, 1);
+    A.to_symmetric("U");
+    Matrix V = A;
+    vector<double> ref(n);
+    matrix::diagonalize_sym_matrix_dsyev("U", V, ref);
+
+    for (auto storage : storages) {
+        vector<double> eig(n);
+        Matrix Q;
+        matrix::diagonalize_sym_matrix_dspevd(SymmetricMatrix(A, storage),
+                                              eig, Q);
+        for (size_t k = 0; k < n; k++) {
+            EXPECT_NEAR(eig[k], ref[k], 1e-10);
+            // each row of Q is an eigenvector.
+            for (size_t i = 0; i < n; i++) {
+                double Aq = 0.0;
+                for (size_t j = 0; j < n; j++) {
+                    Aq += A(i, j) * Q(k, j);
+                }
+                EXPECT_NEAR(Aq, eig[k] * Q(k, i), 1e-10);
+            }
+        }
+    }
+}
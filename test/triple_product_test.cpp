@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <Eigen/Dense>
+#include <memory>
+#include <vector>
+#include "utils.h"
+
+using matrix::Matrix;
+using Eigen::MatrixXd;
+using std::shared_ptr;
+using std::vector;
+
+/**
+ * test three matrix multiplication A * B * A^T and A^T * B * A.
+ */
+struct TripleProductTest: public ::testing::Test {
+    // A: 150 x 90, so that the half computation of the symmetric result runs
+    // over several blocks.
+    Matrix A;
+    Matrix B_row;
+    Matrix B_col;
+    Matrix S_row;
+    Matrix S_col;
+
+    virtual void SetUp() override
+    {
+        A.resize(150, 90);
+        A.randomize(-1, 1);
+        B_row.resize(150, 150);
+        B_row.randomize(-1, 1);
+        B_col.resize(90, 90);
+        B_col.randomize(-1, 1);
+        S_row = B_row;
+        S_row.to_symmetric("U");
+        S_col = B_col;
+        S_col.to_symmetric("L");
+    }
+
+    virtual void TearDown() override {}
+};
+
+TEST_F(TripleProductTest, scratch_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd ref = A_mxd * Matrix_to_MatrixXd(B_col) * A_mxd.transpose();
+    Matrix C(A.row(), A.row());
+    Matrix scratch;
+    EXPECT_EQ(matrix::mult_dgemm_ABAT(A, B_col, C, &scratch), 0);
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    EXPECT_EQ(scratch.row(), A.row());
+    EXPECT_EQ(scratch.col(), B_col.col());
+
+    // the scratch buffer is reused, and resized for a different shape.
+    const double *buf = scratch.data();
+    EXPECT_EQ(matrix::mult_dgemm_ABAT(A, B_col, C, &scratch), 0);
+    EXPECT_EQ(buf, scratch.data());
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    ref = A_mxd.transpose() * Matrix_to_MatrixXd(B_row) * A_mxd;
+    Matrix D(A.col(), A.col());
+    EXPECT_EQ(matrix::mult_dgemm_ATBA(A, B_row, D, &scratch), 0);
+    EXPECT_TRUE(D.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+    EXPECT_THROW(matrix::mult_dgemm_ATBA(A, B_row, D, &D),
+                 matrix::exception::MatrixException);
+}
+
+TEST_F(TripleProductTest, symmetric_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    MatrixXd ref = A_mxd * Matrix_to_MatrixXd(S_col) * A_mxd.transpose();
+    Matrix C(A.row(), A.row());
+    matrix::mult_dsymm_ABAT("L", A, S_col, C);
+    EXPECT_TRUE(C.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    EXPECT_TRUE(C.is_symmetric(0.0));
+
+    ref = A_mxd.transpose() * Matrix_to_MatrixXd(S_row) * A_mxd;
+    Matrix D(A.col(), A.col());
+    Matrix scratch;
+    matrix::mult_dsymm_ATBA("U", A, S_row, D, &scratch);
+    EXPECT_TRUE(D.is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    EXPECT_TRUE(D.is_symmetric(0.0));
+
+    Matrix bad(A.row(), A.col());
+    EXPECT_THROW(matrix::mult_dsymm_ABAT("L", A, S_col, bad),
+                 matrix::exception::DimensionError);
+}
+
+TEST_F(TripleProductTest, batched_test)
+{
+    MatrixXd A_mxd = Matrix_to_MatrixXd(A);
+    const size_t nbatch = 5;
+    vector<shared_ptr<const Matrix>> B_col_vec;
+    vector<shared_ptr<Matrix>> C_vec;
+    vector<shared_ptr<const Matrix>> B_row_vec;
+    vector<shared_ptr<Matrix>> D_vec;
+    for (size_t i = 0; i < nbatch; i++) {
+        auto B = std::make_shared<Matrix>(A.col(), A.col());
+        B->randomize(-1, 1);
+        B_col_vec.push_back(B);
+        C_vec.push_back(std::make_shared<Matrix>(A.row(), A.row()));
+        B = std::make_shared<Matrix>(A.row(), A.row());
+        B->randomize(-1, 1);
+        B_row_vec.push_back(B);
+        D_vec.push_back(std::make_shared<Matrix>(A.col(), A.col()));
+    }
+
+    EXPECT_EQ(matrix::mult_dgemm_ABAT_batched(A, B_col_vec, C_vec), 0);
+    EXPECT_EQ(matrix::mult_dgemm_ATBA_batched(A, B_row_vec, D_vec), 0);
+    for (size_t i = 0; i < nbatch; i++) {
+        Matrix B = *B_col_vec[i];
+        MatrixXd ref = A_mxd * Matrix_to_MatrixXd(B) * A_mxd.transpose();
+        EXPECT_TRUE(C_vec[i]->is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+
+        B = *B_row_vec[i];
+        ref = A_mxd.transpose() * Matrix_to_MatrixXd(B) * A_mxd;
+        EXPECT_TRUE(D_vec[i]->is_equal_to(MatrixXd_to_Matrix(ref), 1e-10));
+    }
+
+    // B and C are not paired.
+    C_vec.pop_back();
+    EXPECT_THROW(matrix::mult_dgemm_ABAT_batched(A, B_col_vec, C_vec),
+                 matrix::exception::MatrixException);
+    // dimension error.
+    EXPECT_THROW(matrix::mult_dgemm_ABAT_batched(A, B_row_vec, D_vec),
+                 matrix::exception::DimensionError);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <matrix/matrix.h>
+#include <thread>
+#include <vector>
+
+using matrix::Matrix;
+using std::vector;
+
+/**
+ * Invert and diagonalize matrices with different dimensions repeatedly, so
+ * that the cached lapack workspace is reused and grows.
+ */
+static void run_lapack_routines(size_t n_max)
+{
+    for (size_t k = 0; k < 3; ++k) {
+        for (size_t n = 1; n <= n_max; n += 7) {
+            Matrix A(n, n);
+            A.randomize(-1, 1);
+            A.to_symmetric("L");
+            for (size_t i = 0; i < n; ++i)
+                A(i, i) += n;
+
+            Matrix A_inv = A;
+            matrix::invert_sym_matrix_dsytri("U", A_inv);
+            Matrix I(n, n);
+            mult_dgemm(1.0, A, "N", A_inv, "N", 0.0, I);
+            EXPECT_TRUE(I.is_identity(1e-8));
+
+            A_inv = A;
+            matrix::invert_gen_matrix_dgetri(A_inv);
+            mult_dgemm(1.0, A, "N", A_inv, "N", 0.0, I);
+            EXPECT_TRUE(I.is_identity(1e-8));
+
+            Matrix Q = A;
+            vector<double> eig(n);
+            matrix::diagonalize_sym_matrix_dsyev("L", Q, eig);
+            for (size_t i = 1; i < n; ++i)
+                EXPECT_LE(eig[i - 1], eig[i]);
+        }
+    }
+}
+
+TEST(LapackWorkspaceTest, reuse_test)
+{
+    run_lapack_routines(60);
+    matrix::release_lapack_workspace();
+    run_lapack_routines(30);
+}
+
+TEST(LapackWorkspaceTest, multi_thread_test)
+{
+    vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.push_back(std::thread(run_lapack_routines, 40));
+    for (auto &t : threads)
+        t.join();
+}